@@ -0,0 +1,10 @@
+	XOR	R0 R0 R0
+	SUBS	F1 F1 F1
+L:	LWS	F2 0(R1)
+	MULTS	F3 F2 F2
+	ADDS	F1 F1 F3
+	ADDI	R1 R1 0x4
+	SUBI	R7 R7 0x1
+	BNEZ	R7 L
+	SWS	F1 0(R2)
+	EOP
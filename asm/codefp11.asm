@@ -0,0 +1,16 @@
+	XOR	R0 R0 R0
+	SUBS	F1 F1 F1
+L:	LWS	F2 0(R1)
+	MULTS	F3 F2 F2
+	ADDS	F1 F1 F3
+	ADDI	R1 R1 0x4
+	SUBI	R7 R7 0x1
+	BNEZ	R7 L
+	ADDI	R5 R0 0x1
+A:	SWAP	R5 0(R8)
+	BNEZ	R5 A
+	LWS	F4 0(R2)
+	ADDS	F4 F4 F1
+	SWS	F4 0(R2)
+	SW	R0 0(R8)
+	EOP
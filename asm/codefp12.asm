@@ -0,0 +1,18 @@
+	XOR	R0 R0 R0
+O:	ADD	R1 R10 R0
+	ADD	R7 R11 R0
+L:	LWS	F2 0(R1)
+	ADDS	F1 F1 F2
+	ADDI	R1 R1 4
+	SUBI	R7 R7 1
+	BNEZ	R7 L
+	ADD	R7 R12 R0
+C:	MULTS	F3 F1 F4
+	DIVS	F5 F3 F4
+	SUBI	R7 R7 1
+	BNEZ	R7 C
+	SUBI	R9 R9 1
+	BNEZ	R9 O
+	SWS	F1 0(R2)
+	SWS	F5 4(R2)
+	EOP
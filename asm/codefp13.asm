@@ -0,0 +1,16 @@
+	XOR	R0 R0 R0
+	ADDI	R1 R0 0xA000
+	ADDI	R2 R0 0xA100
+	ADDI	R3 R0 0x8
+	SUBS	F3 F3 F3
+	LWS	F1 0(R2)
+L:	LW	R4 0(R1)
+	SWS	F1 0(R4)
+	LWS	F2 4(R2)
+	ADDS	F3 F3 F2
+	ADDI	R1 R1 0x4
+	ADDI	R2 R2 0x4
+	SUBI	R3 R3 0x1
+	BNEZ	R3 L
+	SWS	F3 0(R2)
+	EOP
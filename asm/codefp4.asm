@@ -0,0 +1,8 @@
+LWS   F1 0(R1)
+DIVS  F2 F1 F3
+ADDS  F4 F2 F5
+MULTS F6 F7 F8
+SUBS  F5 F7 F8
+ADDI  R2 R1 4
+SWS   F6 0(R2)
+EOP
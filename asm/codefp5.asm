@@ -0,0 +1,20 @@
+	XOR	R0 R0 R0
+	ADDI	R1 R0 0xA000
+	LWS	F1 0(R1)
+	LWS	F2 4(R1)
+	ADDS	F3 F1 F2
+	ADDS	F4 F1 F1
+	ADDS	F5 F2 F2
+	ADDS	F6 F1 F2
+	MULTS	F7 F1 F2
+	MULTS	F8 F2 F2
+	MULTS	F9 F1 F1
+	DIVS	F10 F2 F1
+	DIVS	F11 F1 F2
+	ADDS	F12 F3 F4
+	ADDS	F13 F5 F6
+	SWS	F12 8(R1)
+	SWS	F13 12(R1)
+	SWS	F10 16(R1)
+	SWS	F11 20(R1)
+	EOP
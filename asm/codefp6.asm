@@ -0,0 +1,17 @@
+	XOR	R0 R0 R0
+	ADDI	R1 R0 0xA000
+	ADDI	R2 R0 0x64
+	ADDI	R3 R0 0x7
+	DIV	R4 R2 R3
+	DIV	R5 R4 R3
+	MULT	R6 R4 R5
+	LWS	F1 0(R1)
+	LWS	F2 4(R1)
+	MULTS	F3 F1 F1
+	DIVS	F4 F2 F1
+	DIVS	F5 F1 F1
+	SW	R6 8(R1)
+	SWS	F3 12(R1)
+	SWS	F4 16(R1)
+	SWS	F5 20(R1)
+	EOP
@@ -0,0 +1,15 @@
+	XOR	R0 R0 R0
+	ADDI	R1 R0 0xA000
+	ADDI	R2 R0 0x4
+	LWS	F1 0(R1)
+	LWS	F0 4(R1)
+T1:	LW	R3 8(R1)
+	LWS	F2 8(R1)
+	DIVS	F3 F2 F1
+	BGEZ	R3 T2
+	ADDS	F3 F0 F0
+T2:	SWS	F3 24(R1)
+	ADDI	R1 R1 0x4
+	SUBI	R2 R2 0x1
+	BNEZ	R2 T1
+	EOP
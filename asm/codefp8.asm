@@ -0,0 +1,17 @@
+	XOR	R0 R0 R0
+	ADDI	R1 R0 0xA000
+	ADDI	R3 R0 0x5
+	LWS	F1 0(R1)
+T1:	LWS	F2 4(R1)
+	LWS	F3 8(R1)
+	LWS	F4 12(R1)
+	ADDS	F5 F2 F3
+	ADDS	F5 F5 F4
+	DIVS	F6 F5 F1
+	SWS	F6 40(R1)
+	ADDI	R1 R1 0x4
+	SUBI	R3 R3 0x1
+	BNEZ	R3 T1
+	LWS	F7 36(R1)
+	SWS	F7 44(R1)
+	EOP
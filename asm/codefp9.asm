@@ -0,0 +1,16 @@
+	XOR	R0 R0 R0
+	ADDI	R1 R0 0xA000
+	ADDI	R2 R0 0x4
+	LWS	F1 0(R1)
+T1:	LWS	F2 4(R1)
+	DIVS	F3 F2 F1
+	SWS	F3 32(R1)
+	ADDI	R4 R1 0x10
+	ADDI	R5 R1 0x20
+	XORI	R6 R1 0xFF
+	ANDI	R7 R1 0xF0
+	ORI	R8 R1 0x3
+	ADDI	R1 R1 0x4
+	SUBI	R2 R2 0x1
+	BNEZ	R2 T1
+	EOP
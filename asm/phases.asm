@@ -0,0 +1,18 @@
+	XOR	R0 R0 R0
+O:	ADD	R1 R10 R0
+	ADD	R7 R11 R0
+L:	LW	R4 0(R1)
+	ADD	R3 R3 R4
+	ADDI	R1 R1 4
+	SUBI	R7 R7 1
+	BNEZ	R7 L
+	ADD	R7 R12 R0
+C:	XOR	R5 R3 R7
+	ADD	R6 R5 R6
+	SUBI	R7 R7 1
+	BNEZ	R7 C
+	SUBI	R9 R9 1
+	BNEZ	R9 O
+	SW	R3 0(R2)
+	SW	R6 4(R2)
+	EOP
@@ -0,0 +1,15 @@
+	XOR	R0 R0 R0
+	ADD	R3 R0 R0
+L:	LW	R4 0(R1)
+	ADD	R3 R3 R4
+	ADDI	R1 R1 4
+	SUBI	R7 R7 1
+	BNEZ	R7 L
+	ADDI	R5 R0 1
+A:	SWAP	R5 0(R8)
+	BNEZ	R5 A
+	LW	R6 0(R2)
+	ADD	R6 R6 R3
+	SW	R6 0(R2)
+	SW	R0 0(R8)
+	EOP
@@ -0,0 +1,9 @@
+	XOR	R0 R0 R0
+	ADD	R3 R0 R0
+L:	LW	R4 0(R1)
+	ADD	R3 R3 R4
+	ADDI	R1 R1 4
+	SUBI	R7 R7 1
+	BNEZ	R7 L
+	SW	R3 0(R2)
+	EOP
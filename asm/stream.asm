@@ -0,0 +1,17 @@
+	XOR	R0 R0 R0
+	ADDI	R1 R0 0xA000
+	ADDI	R2 R0 0xB000
+	ADDI	R7 R0 3
+L:	LW	R3 0(R1)
+	LW	R4 4(R1)
+	LW	R5 8(R1)
+	LW	R6 12(R1)
+	ADDI	R1 R1 16
+	SUBI	R7 R7 1
+	ADD	R3 R3 R4
+	ADD	R5 R5 R6
+	ADD	R3 R3 R5
+	SW	R3 0(R2)
+	ADDI	R2 R2 4
+	BNEZ	R7 L
+	EOP
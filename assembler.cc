@@ -0,0 +1,36 @@
+#include "sim_pipe.h"
+
+using namespace std;
+
+/* Assembler of the integer simulator: writes the program "input.asm" to the object file "output.obj", which
+   load_program() maps directly. The optional data file holds "address value" lines (decimal or 0x-prefixed
+   hexadecimal), saved in the object file as its initialised data memory.
+
+   Usage: assembler input.asm output.obj [data.txt] */
+
+int main(int argc, char **argv){
+
+	if (argc < 3 || argc > 4){
+		printf("Usage: %s input.asm output.obj [data.txt]\n", argv[0]);
+		return 1;
+	}
+
+	sim_pipe *mips = new sim_pipe(1024*1024, 0);
+	unsigned data_start = 0, data_end = 0;
+	if (argc == 4){
+		FILE *data = fopen(argv[3], "r");
+		ASSERT(data, "Unable to open data file %s", argv[3]);
+		char address[32], value[32];
+		while (fscanf(data, "%31s %31s", address, value) == 2){
+			unsigned a = strtoul(address, NULL, 0);
+			ASSERT(a % 4 == 0, "Misaligned data address %s", address);
+			mips->write_memory(a, strtoul(value, NULL, 0));
+			if (data_end == 0 || a < data_start) data_start = a;
+			if (a + 4 > data_end) data_end = a + 4;
+		}
+		fclose(data);
+	}
+	mips->assemble(argv[1], argv[2], data_start, data_end);
+	delete mips;
+	return 0;
+}
@@ -0,0 +1,17 @@
+#include "barrier.h"
+
+barrier::barrier(unsigned parties) : arrived(0), generation(0){
+   ASSERT( parties > 0, "Unsupported number of parties (=%d)", parties );
+   this->parties          = parties;
+}
+
+void barrier::wait(){
+   unsigned current       = generation.load();
+   if(arrived.fetch_add(1) + 1 == parties) {
+      arrived.store(0);
+      generation.fetch_add(1);
+      return;
+   }
+   while(generation.load() == current)
+      std::this_thread::yield();
+}
@@ -0,0 +1,49 @@
+#ifndef BARRIER_H_
+#define BARRIER_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <atomic>
+#include <thread>
+
+#include "sim_assert.h"
+
+// Synchronization of the host threads simulating the cores of a multicore system: the shared data memory and the
+// L1s touched in lock step (the timing of the lock step run), or quanta exchanging them at their end
+typedef enum {DETERMINISTIC, RELAXED} sync_mode_t;
+
+// Access of a core to the shared data memory, logged during a quantum
+typedef struct{
+   unsigned             cycle;
+   unsigned             core;
+   unsigned             address;
+   unsigned             value;
+   bool                 atomic;         // SWAP: the core waits for the old value
+} memory_event_t;
+
+//----------------------------------------------------------------------
+// Barrier between the host threads simulating the cores of a multicore
+// system; shared by the integer and floating point simulators
+//
+// Every party spins (yielding the host CPU) until all of them have
+// arrived; the last one to arrive starts a new generation, so the
+// barrier can be reused right away. The atomics order everything a
+// thread did before the barrier before what the others do after it.
+//----------------------------------------------------------------------
+class barrier{
+
+   public:
+
+      unsigned          parties;
+      std::atomic<unsigned> arrived;
+      std::atomic<unsigned> generation;
+
+   public:
+
+      barrier(unsigned parties);
+
+      //returns once all the parties have called wait()
+      void wait();
+};
+
+#endif /*BARRIER_H_*/
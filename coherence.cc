@@ -0,0 +1,231 @@
+#include "coherence.h"
+
+using namespace std;
+
+coherence::coherence(unsigned cores, coherence_protocol_t protocol, unsigned cache_size, unsigned line_size, unsigned ways,
+                     unsigned hit_latency, unsigned memory_latency, unsigned transfer_latency, unsigned bus_cycles){
+   ASSERT( cores > 0, "Unsupported number of cores (=%d)", cores );
+   ASSERT( line_size >= 4 && line_size % 4 == 0, "Unsupported cache line size (=%d)", line_size );
+   ASSERT( ways > 0 && cache_size >= line_size * ways && cache_size % (line_size * ways) == 0,
+           "Unsupported cache organization (size=%d, line size=%d, ways=%d)", cache_size, line_size, ways );
+   ASSERT( bus_cycles > 0, "Unsupported bus occupancy (=%d)", bus_cycles );
+   this->cores            = cores;
+   this->protocol         = protocol;
+   this->sets             = cache_size / (line_size * ways);
+   this->ways             = ways;
+   this->line_size        = line_size;
+   this->hit_latency      = hit_latency;
+   this->memory_latency   = memory_latency;
+   this->transfer_latency = transfer_latency;
+   this->bus_cycles       = bus_cycles;
+   line_t invalid         = {LINE_INVALID, 0, 0};
+   lines.assign(cores * sets * ways, invalid);
+   bus_ready              = 0;
+   deferred               = false;
+   pending.assign(cores, vector<bus_event_t>());
+   hits.assign(cores, 0);
+   misses.assign(cores, 0);
+   for(int i = 0; i < NUM_BUS_TRANSACTIONS; i++)
+      transactions[i]     = 0;
+   invalidations          = 0;
+   cache_transfers        = 0;
+   bus_wait_cycles        = 0;
+}
+
+//----------------------------------------------------------------------
+// Returns the valid copy of "line" held by the L1 of "core", if any
+//----------------------------------------------------------------------
+coherence::line_t* coherence::lookup(unsigned core, unsigned line){
+   unsigned base          = (core * sets + line % sets) * ways;
+   for(unsigned i = base; i < base + ways; i++) {
+      if(lines[i].state != LINE_INVALID && lines[i].tag == line / sets)
+         return &lines[i];
+   }
+   return NULL;
+}
+
+//----------------------------------------------------------------------
+// Picks the way of the set of "line" that receives it: an invalid way,
+// or else the least recently used one
+//----------------------------------------------------------------------
+coherence::line_t& coherence::victim(unsigned core, unsigned line){
+   unsigned base          = (core * sets + line % sets) * ways;
+   unsigned pick          = base;
+   for(unsigned i = base; i < base + ways; i++) {
+      if(lines[i].state == LINE_INVALID)
+         return lines[i];
+      if(lines[i].last_use < lines[pick].last_use)
+         pick             = i;
+   }
+   return lines[pick];
+}
+
+//----------------------------------------------------------------------
+// Every other L1 snoops the transaction of "core" on "line": a read
+// demotes the copies to shared, a read exclusive or an upgrade
+// invalidates them. Returns the number of copies found, and whether a
+// modified copy supplied the data
+//----------------------------------------------------------------------
+unsigned coherence::snoop(unsigned core, unsigned line, bus_transaction_t transaction, bool &supplied){
+   unsigned copies        = 0;
+   supplied               = false;
+   for(unsigned c = 0; c < cores; c++) {
+      line_t *other       = (c == core) ? NULL : lookup(c, line);
+      if(other == NULL)
+         continue;
+      copies++;
+      supplied           |= (other->state == LINE_MODIFIED);
+      if(transaction == BUS_READ)
+         other->state     = LINE_SHARED;
+      else {
+         other->state     = LINE_INVALID;
+         invalidations++;
+      }
+   }
+   return copies;
+}
+
+//----------------------------------------------------------------------
+// Counts the copies of "line" held by the other L1s at the start of the
+// quantum, and whether one of them is modified (deferred mode)
+//----------------------------------------------------------------------
+unsigned coherence::peek(unsigned core, unsigned line, bool &supplied){
+   unsigned copies        = 0;
+   supplied               = false;
+   for(unsigned c = 0; c < cores; c++) {
+      unsigned base       = (c * sets + line % sets) * ways;
+      for(unsigned i = base; c != core && i < base + ways; i++) {
+         if(snapshot[i].state == LINE_INVALID || snapshot[i].tag != line / sets)
+            continue;
+         copies++;
+         supplied        |= (snapshot[i].state == LINE_MODIFIED);
+      }
+   }
+   return copies;
+}
+
+//----------------------------------------------------------------------
+// Grants the bus to a transaction requested at "cycle": returns the
+// cycles it waits for the transactions ahead of it
+//----------------------------------------------------------------------
+unsigned coherence::arbitrate(unsigned cycle){
+   unsigned start         = max(cycle, bus_ready);
+   bus_ready              = start + bus_cycles;
+   bus_wait_cycles       += start - cycle;
+   return start - cycle;
+}
+
+//----------------------------------------------------------------------
+// Places a transaction on the bus and lets the other L1s snoop it.
+// Returns the cycles it waits for the bus; the evicted modified line is
+// written back from a buffer, after the miss, without holding the core
+//----------------------------------------------------------------------
+unsigned coherence::place(const bus_event_t& event, unsigned &copies, bool &supplied){
+   transactions[event.transaction]++;
+   copies                 = 0;
+   supplied               = false;
+   if(event.transaction == BUS_WRITEBACK) {
+      bus_ready           = max(bus_ready, event.cycle) + bus_cycles;
+      return 0;
+   }
+   unsigned wait          = arbitrate(event.cycle);
+   copies                 = snoop(event.core, event.line, event.transaction, supplied);
+   if(event.transaction != BUS_UPGRADE)
+      cache_transfers    += supplied;
+   return wait;
+}
+
+unsigned coherence::access(unsigned core, unsigned address, bool write, unsigned cycle){
+   ASSERT( core < cores, "Unknown core (=%d)", core );
+   unsigned line          = address / line_size;
+   line_t *entry          = lookup(core, line);
+
+   // hit: reads hit in any state, writes in the exclusive states (MESI upgrades E to M silently)
+   if(entry != NULL && (!write || entry->state == LINE_MODIFIED || entry->state == LINE_EXCLUSIVE)) {
+      if(write)
+         entry->state     = LINE_MODIFIED;
+      entry->last_use     = cycle;
+      hits[core]++;
+      return hit_latency;
+   }
+   misses[core]++;
+
+   // write to a shared line: invalidate the other copies, no data needed; miss: fetch the line from the L1
+   // holding it modified, or else from data memory
+   bus_event_t event      = {cycle, core, line, (entry != NULL) ? BUS_UPGRADE : write ? BUS_READ_EXCLUSIVE : BUS_READ};
+   line_t *slot           = (entry != NULL) ? entry : &victim(core, line);
+   bus_event_t writeback  = {cycle, core, slot->tag * sets + line % sets, BUS_WRITEBACK};
+   bool dirty             = (entry == NULL && slot->state == LINE_MODIFIED);
+   unsigned wait          = 0;
+   unsigned copies;
+   bool supplied;
+   if(deferred) {
+      copies              = peek(core, line, supplied);
+      pending[core].push_back(event);
+      if(dirty)
+         pending[core].push_back(writeback);
+   } else {
+      wait                = place(event, copies, supplied);
+      if(dirty)
+         place(writeback, copies, supplied);
+   }
+   if(write)
+      slot->state         = LINE_MODIFIED;
+   else
+      slot->state         = (protocol == MESI && copies == 0) ? LINE_EXCLUSIVE : LINE_SHARED;
+   slot->tag              = line / sets;
+   slot->last_use         = cycle;
+   if(event.transaction == BUS_UPGRADE)
+      return hit_latency + wait + bus_cycles;
+   return hit_latency + wait + bus_cycles + (supplied ? transfer_latency : memory_latency);
+}
+
+void coherence::defer(bool deferred){
+   for(unsigned c = 0; c < cores; c++)
+      ASSERT( pending[c].empty(), "Transactions of core %d not exchanged", c );
+   this->deferred         = deferred;
+   snapshot               = lines;
+}
+
+static bool earlier(const coherence::bus_event_t& a, const coherence::bus_event_t& b){
+   return a.cycle < b.cycle || (a.cycle == b.cycle && a.core < b.core);
+}
+
+void coherence::exchange(){
+   vector<bus_event_t> events;
+   for(unsigned c = 0; c < cores; c++) {
+      events.insert(events.end(), pending[c].begin(), pending[c].end());
+      pending[c].clear();
+   }
+   stable_sort(events.begin(), events.end(), earlier);
+   for(unsigned i = 0; i < events.size(); i++) {
+      unsigned copies;
+      bool supplied;
+      place(events[i], copies, supplied);
+   }
+   snapshot               = lines;
+}
+
+unsigned coherence::get_hits(unsigned core){
+   return hits[core];
+}
+
+unsigned coherence::get_misses(unsigned core){
+   return misses[core];
+}
+
+unsigned coherence::get_transactions(bus_transaction_t transaction){
+   return transactions[transaction];
+}
+
+unsigned coherence::get_invalidations(){
+   return invalidations;
+}
+
+unsigned coherence::get_cache_transfers(){
+   return cache_transfers;
+}
+
+unsigned coherence::get_bus_wait_cycles(){
+   return bus_wait_cycles;
+}
@@ -0,0 +1,122 @@
+#ifndef COHERENCE_H_
+#define COHERENCE_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+#include <algorithm>
+
+#include "sim_assert.h"
+
+// Snooping coherence protocol kept by the private L1 caches
+typedef enum {MSI, MESI} coherence_protocol_t;
+
+// State of a line in a private L1 cache
+typedef enum {LINE_INVALID, LINE_SHARED, LINE_EXCLUSIVE, LINE_MODIFIED} line_state_t;
+
+// Transactions placed on the snooping bus
+typedef enum {BUS_READ, BUS_READ_EXCLUSIVE, BUS_UPGRADE, BUS_WRITEBACK, NUM_BUS_TRANSACTIONS} bus_transaction_t;
+
+//----------------------------------------------------------------------
+// Private L1 data caches of a multicore system, kept coherent by a
+// snooping bus; shared by the integer and floating point simulators
+//
+// The caches only track line states: the data always lives in the
+// shared data memory, which the cores read and write directly. Every
+// access is looked up in the L1 of its core; a miss or a write to a
+// shared line places a transaction on the bus, which every other L1
+// snoops. A line held modified elsewhere is supplied cache to cache
+// (and written back), otherwise it comes from data memory. The bus
+// serves one transaction at a time, "bus_cycles" cycles each, so the
+// cores queue for it; writebacks of evicted modified lines hold the
+// bus but not the core. Transactions complete atomically, and the bus
+// catches up with the clock lazily, whenever it is called.
+//
+// While the cores run a relaxed quantum in parallel (deferred mode), an
+// access only updates the L1 of its own core and sees the other L1s as
+// they were at the start of the quantum; its transaction is queued, and
+// the transactions of all cores are placed on the bus in cycle order at
+// the end of the quantum. The time spent waiting for the bus is then
+// only accounted, not charged to the cores.
+//----------------------------------------------------------------------
+class coherence{
+
+   public:
+
+      struct line_t{
+         line_state_t   state;
+         unsigned       tag;
+         unsigned       last_use;    // LRU stamp: cycle of the last access
+      };
+
+      // Transaction requested by a core
+      struct bus_event_t{
+         unsigned       cycle;
+         unsigned       core;
+         unsigned       line;
+         bus_transaction_t transaction;
+      };
+
+      unsigned          cores;
+      coherence_protocol_t protocol;
+      unsigned          sets;
+      unsigned          ways;
+      unsigned          line_size;
+      unsigned          hit_latency;
+      unsigned          memory_latency;
+      unsigned          transfer_latency;
+      unsigned          bus_cycles;
+
+      std::vector<line_t> lines;                  // cores x sets x ways
+      unsigned          bus_ready;                // first cycle the bus is free
+
+      // Deferred mode: line states at the start of the quantum, and the transactions of each core queued since
+      bool              deferred;
+      std::vector<line_t> snapshot;
+      std::vector< std::vector<bus_event_t> > pending;
+
+      std::vector<unsigned> hits;                 // per core
+      std::vector<unsigned> misses;
+      unsigned          transactions[NUM_BUS_TRANSACTIONS];
+      unsigned          invalidations;
+      unsigned          cache_transfers;
+      unsigned          bus_wait_cycles;
+
+   public:
+
+      coherence(unsigned cores, coherence_protocol_t protocol, unsigned cache_size, unsigned line_size, unsigned ways,
+                unsigned hit_latency, unsigned memory_latency, unsigned transfer_latency, unsigned bus_cycles=1);
+
+      //looks up the access of "core" to "address" starting at "cycle", updating the line states of every L1,
+      //and returns the number of cycles it takes
+      unsigned access(unsigned core, unsigned address, bool write, unsigned cycle);
+
+      line_t*  lookup(unsigned core, unsigned line);
+      line_t&  victim(unsigned core, unsigned line);
+      unsigned snoop(unsigned core, unsigned line, bus_transaction_t transaction, bool &supplied);
+      unsigned peek(unsigned core, unsigned line, bool &supplied);
+      unsigned arbitrate(unsigned cycle);
+      unsigned place(const bus_event_t& event, unsigned &copies, bool &supplied);
+
+      //enters (or leaves) the deferred mode: the cores may then access their own L1 from different host threads
+      void     defer(bool deferred);
+
+      //places the transactions queued during the quantum on the bus, in cycle order (deferred mode)
+      void     exchange();
+
+      //returns the number of accesses of "core" that hit or missed in its L1 (a write to a shared line is a miss)
+      unsigned get_hits(unsigned core);
+      unsigned get_misses(unsigned core);
+
+      //returns the number of bus transactions of the given type
+      unsigned get_transactions(bus_transaction_t transaction);
+
+      //returns the number of lines invalidated by snooping, and of misses served by another L1
+      unsigned get_invalidations();
+      unsigned get_cache_transfers();
+
+      //returns the number of cycles the cores waited for the bus
+      unsigned get_bus_wait_cycles();
+};
+
+#endif /*COHERENCE_H_*/
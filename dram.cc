@@ -0,0 +1,160 @@
+#include "dram.h"
+
+using namespace std;
+
+dram::dram(unsigned channels, unsigned banks, unsigned row_size, page_policy_t policy, unsigned t_rcd, unsigned t_cas, unsigned t_rp, unsigned t_burst){
+   ASSERT( channels > 0 && banks > 0, "Unsupported DRAM organization (channels=%d, banks=%d)", channels, banks );
+   ASSERT( row_size >= 4 && row_size % 4 == 0, "Unsupported DRAM row size (=%d)", row_size );
+   ASSERT( t_burst > 0, "Unsupported DRAM burst length (=%d)", t_burst );
+   this->channels       = channels;
+   this->banks          = banks;
+   this->row_size       = row_size;
+   this->policy         = policy;
+   this->t_rcd          = t_rcd;
+   this->t_cas          = t_cas;
+   this->t_rp           = t_rp;
+   this->t_burst        = t_burst;
+   bank_t closed        = {false, 0, 0};
+   bank_state.assign(channels * banks, closed);
+   bus_ready.assign(channels, 0);
+   command_ready.assign(channels, 0);
+   next_id              = 0;
+   now                  = 0;
+   row_hits             = 0;
+   row_misses           = 0;
+   row_conflicts        = 0;
+   total_latency        = 0;
+   completed            = 0;
+}
+
+//----------------------------------------------------------------------
+// Queue an access: rows are interleaved across channels, then banks
+//----------------------------------------------------------------------
+unsigned dram::enqueue(unsigned address, bool write, unsigned cycle){
+   advance(cycle);
+   unsigned row_index   = address / row_size;
+   request_t request;
+   request.address      = address;
+   request.write        = write;
+   request.arrival      = cycle;
+   request.channel      = row_index % channels;
+   request.bank         = (row_index / channels) % banks;
+   request.row          = row_index / (channels * banks);
+   request.started      = false;
+   request.done_cycle   = 0;
+   requests[next_id]    = request;
+   return next_id++;
+}
+
+void dram::warm(unsigned address){
+   unsigned row_index   = address / row_size;
+   bank_t& bank         = bank_state[(row_index % channels) * banks + (row_index / channels) % banks];
+   bank.open            = (policy == OPEN_PAGE);
+   bank.row             = row_index / (channels * banks);
+}
+
+bool dram::complete(unsigned id, unsigned cycle){
+   advance(cycle);
+   map<unsigned, request_t>::iterator it = requests.find(id);
+   ASSERT( it != requests.end(), "Unknown DRAM request (=%d)", id );
+   if(!it->second.started || it->second.done_cycle > cycle)
+      return false;
+   total_latency       += it->second.done_cycle - it->second.arrival;
+   completed++;
+   requests.erase(it);
+   return true;
+}
+
+//----------------------------------------------------------------------
+// Catch up with the clock: schedule every cycle up to "cycle"
+//----------------------------------------------------------------------
+void dram::advance(unsigned cycle){
+   for(unsigned c = now; c <= cycle; c++) {
+      bool waiting = false;
+      for(map<unsigned, request_t>::iterator it = requests.begin(); it != requests.end() && !waiting; it++)
+         waiting = !it->second.started;
+      if(!waiting)
+         break;
+      schedule(c);
+   }
+   now = max(now, cycle);
+}
+
+//----------------------------------------------------------------------
+// FR-FCFS: per channel, start the oldest row hit to a ready bank, or
+// else the oldest request to a ready bank
+//----------------------------------------------------------------------
+void dram::schedule(unsigned cycle){
+   for(unsigned ch = 0; ch < channels; ch++) {
+      if(command_ready[ch] > cycle)
+         continue;
+      request_t* pick = NULL;
+      for(map<unsigned, request_t>::iterator it = requests.begin(); it != requests.end(); it++) {
+         request_t& request = it->second;
+         if(request.started || request.channel != ch || request.arrival > cycle)
+            continue;
+         bank_t& bank    = bank_state[ch * banks + request.bank];
+         if(bank.ready_cycle > cycle)
+            continue;
+         if(bank.open && bank.row == request.row) {
+            pick         = &request;
+            break;
+         }
+         if(pick == NULL)
+            pick         = &request;
+      }
+      if(pick != NULL)
+         start(*pick, cycle);
+   }
+}
+
+//----------------------------------------------------------------------
+// Start an access: open the row if needed, then transfer the data on
+// the channel bus. A bank serves one access at a time
+//----------------------------------------------------------------------
+void dram::start(request_t& request, unsigned cycle){
+   bank_t& bank          = bank_state[request.channel * banks + request.bank];
+   unsigned latency;
+   if(bank.open && bank.row == request.row) {
+      row_hits++;
+      latency            = t_cas;
+   } else if(!bank.open) {
+      row_misses++;
+      latency            = t_rcd + t_cas;
+   } else {
+      row_conflicts++;
+      latency            = t_rp + t_rcd + t_cas;
+   }
+   unsigned data         = max(cycle + latency, bus_ready[request.channel]);
+   request.started       = true;
+   request.done_cycle    = data + t_burst;
+   bus_ready[request.channel]     = request.done_cycle;
+   command_ready[request.channel] = cycle + 1;
+   if(policy == OPEN_PAGE) {
+      bank.open          = true;
+      bank.row           = request.row;
+      bank.ready_cycle   = request.done_cycle;
+   } else {
+      bank.open          = false;
+      bank.ready_cycle   = request.done_cycle + t_rp;
+   }
+}
+
+//----------------------------------------------------------------------
+// DRAM statistics
+//----------------------------------------------------------------------
+unsigned dram::get_row_hits(){
+   return row_hits;
+}
+
+unsigned dram::get_row_misses(){
+   return row_misses;
+}
+
+unsigned dram::get_row_conflicts(){
+   return row_conflicts;
+}
+
+float dram::get_avg_latency(){
+   return completed ? (float) total_latency / (float) completed : 0;
+}
@@ -0,0 +1,97 @@
+#ifndef DRAM_H_
+#define DRAM_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <map>
+#include <vector>
+#include <algorithm>
+
+#include "sim_assert.h"
+
+// Row buffer management: keep the row open after an access, or precharge the bank right away
+typedef enum {OPEN_PAGE, CLOSED_PAGE} page_policy_t;
+
+//----------------------------------------------------------------------
+// DRAM timing model shared by the integer and floating point simulators
+//
+// Addresses are interleaved across channels, then banks, one row at a
+// time. Every channel has a request queue served FR-FCFS: each cycle
+// the controller starts the oldest request hitting an open row of a
+// ready bank, or else the oldest request to a ready bank. An access
+// takes tCAS on a row hit, tRCD+tCAS on a closed bank and tRP+tRCD+tCAS
+// on a row conflict, followed by a burst on the channel data bus.
+// Requests are polled for completion; the controller catches up with
+// the clock lazily, whenever it is called.
+//----------------------------------------------------------------------
+class dram{
+
+   public:
+
+      struct request_t{
+         unsigned       address;
+         bool           write;
+         unsigned       arrival;
+         unsigned       channel;
+         unsigned       bank;
+         unsigned       row;
+         bool           started;
+         unsigned       done_cycle;
+      };
+
+      struct bank_t{
+         bool           open;
+         unsigned       row;
+         unsigned       ready_cycle;   // first cycle the bank accepts a new access
+      };
+
+      unsigned          channels;
+      unsigned          banks;
+      unsigned          row_size;
+      page_policy_t     policy;
+      unsigned          t_rcd;
+      unsigned          t_cas;
+      unsigned          t_rp;
+      unsigned          t_burst;
+
+      std::map<unsigned, request_t> requests;     // outstanding requests by id, in arrival order
+      std::vector<bank_t> bank_state;             // channels x banks
+      std::vector<unsigned> bus_ready;            // first cycle each channel data bus is free
+      std::vector<unsigned> command_ready;        // first cycle each channel starts another request
+      unsigned          next_id;
+      unsigned          now;                      // cycles up to now have been scheduled
+
+      unsigned          row_hits;
+      unsigned          row_misses;
+      unsigned          row_conflicts;
+      unsigned long     total_latency;
+      unsigned          completed;
+
+   public:
+
+      dram(unsigned channels, unsigned banks, unsigned row_size, page_policy_t policy, unsigned t_rcd, unsigned t_cas, unsigned t_rp, unsigned t_burst=1);
+
+      //queues an access arriving at "cycle" and returns its id
+      unsigned enqueue(unsigned address, bool write, unsigned cycle);
+
+      //returns true (and forgets the request) once request "id" has completed by "cycle"
+      bool     complete(unsigned id, unsigned cycle);
+
+      void     advance(unsigned cycle);
+
+      //leaves the bank of "address" as an access executed without timing would: its row open (OPEN_PAGE) or the
+      //bank closed (CLOSED_PAGE); the statistics are left as they are
+      void     warm(unsigned address);
+      void     schedule(unsigned cycle);
+      void     start(request_t& request, unsigned cycle);
+
+      //returns the number of accesses that hit the open row, found the bank closed, or had to close another row
+      unsigned get_row_hits();
+      unsigned get_row_misses();
+      unsigned get_row_conflicts();
+
+      //returns the average number of cycles from arrival to completion of the requests
+      float    get_avg_latency();
+};
+
+#endif /*DRAM_H_*/
@@ -0,0 +1,111 @@
+#include "pmu.h"
+
+using namespace std;
+
+static const char *event_names[NUM_EVENTS] = {"cycles", "instructions", "integer ops", "fp ops", "load ops", "store ops", "branch ops",
+                                             "stalls", "RAW stalls", "WAW stalls", "structural stalls", "control stalls", "memory stalls",
+                                             "integer busy", "adder busy", "multiplier busy", "divider busy", "memory busy",
+                                             "memory accesses", "memory misses", "taken branches", "backward branches"};
+
+pmu::pmu(unsigned num_counters){
+   ASSERT( num_counters > 0, "The PMU needs at least one counter" );
+   counter_t counter             = { EVENT_CYCLES, false, 0, 0, UINT_MAX, 0 };
+   counters.assign(num_counters, counter);
+   events                        = 0;
+   ranged                        = 0;
+   for(unsigned e = 0; e < NUM_EVENTS; e++)
+      totals[e]                  = 0;
+   attach();
+}
+
+void pmu::attach(){
+   retired_pc                    = UINT_MAX;
+}
+
+//----------------------------------------------------------------------
+// Programming the counters
+//----------------------------------------------------------------------
+void pmu::configure(unsigned counter, pmu_event_t event, unsigned low, unsigned high){
+   ASSERT( counter < counters.size(), "Counter %u out of range (%u counters)", counter, (unsigned) counters.size() );
+   ASSERT( event < NUM_EVENTS, "Invalid event %d", event );
+   ASSERT( low <= high, "Invalid PC range 0x%x-0x%x", low, high );
+   counter_t setting             = { event, false, 0, low, high, totals[event] };
+   counters[counter]             = setting;
+   update_events();
+}
+
+void pmu::start(unsigned counter){
+   ASSERT( counter < counters.size(), "Counter %u out of range (%u counters)", counter, (unsigned) counters.size() );
+   if(!counters[counter].running)
+      counters[counter].base     = totals[counters[counter].event];
+   counters[counter].running     = true;
+   update_events();
+}
+
+void pmu::stop(unsigned counter){
+   ASSERT( counter < counters.size(), "Counter %u out of range (%u counters)", counter, (unsigned) counters.size() );
+   counters[counter].value       = read(counter);
+   counters[counter].running     = false;
+   update_events();
+}
+
+void pmu::reset(unsigned counter){
+   ASSERT( counter < counters.size(), "Counter %u out of range (%u counters)", counter, (unsigned) counters.size() );
+   counters[counter].value       = 0;
+   counters[counter].base        = totals[counters[counter].event];
+}
+
+unsigned long pmu::read(unsigned counter){
+   ASSERT( counter < counters.size(), "Counter %u out of range (%u counters)", counter, (unsigned) counters.size() );
+   const counter_t& setting      = counters[counter];
+   if(setting.running && unranged(counter))
+      return setting.value + totals[setting.event] - setting.base;
+   return setting.value;
+}
+
+bool pmu::unranged(unsigned counter){
+   return counters[counter].low == 0 && counters[counter].high == UINT_MAX;
+}
+
+void pmu::update_events(){
+   events                        = 0;
+   ranged                        = 0;
+   for(unsigned e = 0; e < NUM_EVENTS; e++)
+      by_event[e].clear();
+   for(unsigned i = 0; i < counters.size(); i++) {
+      if(!counters[i].running)
+         continue;
+      events                    |= 1u << counters[i].event;
+      if(unranged(i))
+         continue;
+      ranged                    |= 1u << counters[i].event;
+      by_event[counters[i].event].push_back(i);
+   }
+}
+
+//----------------------------------------------------------------------
+// Counting
+//----------------------------------------------------------------------
+void pmu::add(pmu_event_t event, unsigned pc, unsigned long n){
+   for(unsigned i = 0; i < by_event[event].size(); i++) {
+      counter_t& counter         = counters[by_event[event][i]];
+      if(pc >= counter.low && pc <= counter.high)
+         counter.value          += n;
+   }
+}
+
+const char *pmu::name(pmu_event_t event){
+   return event < NUM_EVENTS ? event_names[event] : "?";
+}
+
+void pmu::print(){
+   for(unsigned i = 0; i < counters.size(); i++) {
+      const counter_t& counter   = counters[i];
+      printf("counter %2u: %-18s", i, name(counter.event));
+      if(counter.low != 0 || counter.high != UINT_MAX)
+         printf(" 0x%08x-0x%08x", counter.low, counter.high);
+      else
+         printf(" %-21s", "all");
+      printf(" %-7s %lu\n", counter.running ? "running" : "stopped", read(i));
+   }
+}
@@ -0,0 +1,123 @@
+#ifndef PMU_H_
+#define PMU_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <vector>
+#include "profiler.h"
+
+#include "sim_assert.h"
+
+// Events of the performance monitoring unit:
+// - clock cycles;
+// - retired instructions, in total and by class (integer ALU, floating point, loads, stores and SWAP, branches and jumps);
+// - stall cycles, in total and by cause (as the stall_cause_t of the profiler);
+// - cycles the integer, adder, multiplier and divider units and the data memory are busy;
+// - data memory accesses, and the ones that waited for data memory or missed in the L1;
+// - taken branches, and the taken backward ones
+typedef enum {EVENT_CYCLES, EVENT_INSTRUCTIONS, EVENT_INTEGER_OPS, EVENT_FP_OPS, EVENT_LOAD_OPS, EVENT_STORE_OPS, EVENT_BRANCH_OPS,
+              EVENT_STALLS, EVENT_RAW_STALLS, EVENT_WAW_STALLS, EVENT_STRUCTURAL_STALLS, EVENT_CONTROL_STALLS, EVENT_MEMORY_STALLS,
+              EVENT_INTEGER_BUSY, EVENT_ADDER_BUSY, EVENT_MULTIPLIER_BUSY, EVENT_DIVIDER_BUSY, EVENT_MEMORY_BUSY,
+              EVENT_MEMORY_ACCESSES, EVENT_MEMORY_MISSES, EVENT_TAKEN_BRANCHES, EVENT_BACKWARD_BRANCHES, NUM_EVENTS} pmu_event_t;
+
+//----------------------------------------------------------------------
+// Performance monitoring unit, shared by the integer and floating point
+// simulators
+//
+// A fixed number of counters, each programmed with an event and an
+// optional PC range, and started, stopped, read and reset on its own.
+// Every event belongs to the instruction it happens to: a retired
+// instruction, the one stalling, the one occupying a unit or accessing
+// memory, the branch taken. Clock cycles belong to the last instruction
+// retired. A counter with a PC range only counts the events of the
+// instructions in it (both ends included); one without counts them all.
+//
+// The simulators only report the events some running counter counts
+// (one test of a mask), and nothing at all when no unit is attached.
+// An event counted adds to its total, which the running counters
+// without a PC range read from (their value and the total when last
+// started or reset), so only the counters with a range are looked up,
+// in the list of their event.
+//----------------------------------------------------------------------
+class pmu{
+
+   public:
+
+      // Programmable counter
+      struct counter_t{
+         pmu_event_t    event;
+         bool           running;
+         unsigned long  value;
+         unsigned       low;                      // PC range counted
+         unsigned       high;
+         unsigned long  base;                     // total of the event when started or reset (without a PC range)
+      };
+
+      std::vector<counter_t> counters;
+      unsigned          events;                   // mask of the events of the running counters
+      unsigned          ranged;                   // mask of the events of the running counters with a PC range
+      unsigned long     totals[NUM_EVENTS];       // occurrences of every event counted
+      std::vector<unsigned> by_event[NUM_EVENTS]; // running counters with a PC range of every event
+      unsigned          retired_pc;               // PC of the last instruction retired (UINT_MAX before the first)
+
+   public:
+
+      pmu(unsigned num_counters=4);
+
+      //programs "counter" to count "event" in the instructions from "low" to "high" (all of them by default); the
+      //counter is stopped and reset
+      void     configure(unsigned counter, pmu_event_t event, unsigned low=0, unsigned high=UINT_MAX);
+
+      //starts, stops or resets "counter", or returns its value
+      void     start(unsigned counter);
+      void     stop(unsigned counter);
+      void     reset(unsigned counter);
+      unsigned long read(unsigned counter);
+
+      //starts the unit over (called by the simulator it is attached to): no instruction retired yet, the counters keep
+      //their events and values
+      void     attach();
+
+      //returns true if a running counter counts "event"
+      bool counting(pmu_event_t event){
+         return (events >> event) & 1;
+      }
+
+      //counts "n" occurrences of "event" in the instruction at "pc"
+      void count(pmu_event_t event, unsigned pc, unsigned long n=1){
+         if((events >> event) & 1) {
+            totals[event]       += n;
+            if((ranged >> event) & 1)
+               add(event, pc, n);
+         }
+      }
+
+      //counts "cycles" stall cycles of "cause" in the instruction at "pc"
+      void stall(unsigned pc, stall_cause_t cause, unsigned cycles=1){
+         count(EVENT_STALLS, pc, cycles);
+         count((pmu_event_t)(EVENT_RAW_STALLS + cause), pc, cycles);
+      }
+
+      //counts "cycles" clock cycles
+      void cycle(unsigned cycles=1){
+         count(EVENT_CYCLES, retired_pc, cycles);
+      }
+
+      //adds "n" to the running counters of "event" with a PC range holding "pc"
+      void     add(pmu_event_t event, unsigned pc, unsigned long n);
+
+      //returns the name of "event"
+      static const char *name(pmu_event_t event);
+
+      //returns true if "counter" counts the events of every instruction
+      bool     unranged(unsigned counter);
+
+      //recomputes the events counted and their running counters with a PC range
+      void     update_events();
+
+      //prints the event, PC range, state and value of every counter
+      void     print();
+};
+
+#endif /*PMU_H_*/
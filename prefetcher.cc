@@ -0,0 +1,148 @@
+#include "prefetcher.h"
+
+using namespace std;
+
+prefetcher::prefetcher(unsigned policies, unsigned degree, unsigned line_size, unsigned buffer_entries, unsigned table_entries){
+   ASSERT( degree > 0 && buffer_entries > 0 && table_entries > 0, "Unsupported prefetcher configuration (degree=%d, buffer=%d, table=%d)", degree, buffer_entries, table_entries );
+   ASSERT( line_size >= 4 && line_size % 4 == 0, "Unsupported prefetch line size (=%d)", line_size );
+   this->policies       = policies;
+   this->degree         = degree;
+   this->line_size      = line_size;
+   this->buffer_entries = buffer_entries;
+   stride_entry_t no_stride = {false, 0, 0, 0, 0};
+   stream_entry_t no_stream = {false, 0, 0};
+   stride_table.assign(table_entries, no_stride);
+   stream_table.assign(table_entries, no_stream);
+   next_stream          = 0;
+   issued               = 0;
+   useful               = 0;
+   late                 = 0;
+   hits                 = 0;
+   accesses             = 0;
+}
+
+//----------------------------------------------------------------------
+// Demand load: look the line up in the prefetch buffer, then let every
+// enabled policy issue its prefetches
+//----------------------------------------------------------------------
+unsigned prefetcher::access(unsigned pc, unsigned address, unsigned cycle, unsigned latency){
+   unsigned line  = address / line_size;
+   unsigned wait  = latency;
+   accesses++;
+   for(unsigned i = 0; i < buffer.size(); i++) {
+      if(buffer[i].line != line)
+         continue;
+      wait        = (buffer[i].ready_cycle > cycle) ? min(buffer[i].ready_cycle - cycle, latency) : 0;
+      hits++;
+      if(!buffer[i].used) {
+         buffer[i].used = true;
+         useful++;
+         late    += (wait != 0);
+      }
+      break;
+   }
+
+   if(policies & PREFETCH_NEXT_LINE) {
+      for(unsigned k = 1; k <= degree; k++)
+         prefetch(line + k, cycle, latency);
+   }
+   if(policies & PREFETCH_STRIDE)
+      train_stride(pc, address, cycle, latency);
+   if(policies & PREFETCH_STREAM)
+      train_stream(line, cycle, latency);
+   return wait;
+}
+
+//----------------------------------------------------------------------
+// Functional warming: a load with no latency, left out of the counts
+//----------------------------------------------------------------------
+void prefetcher::warm(unsigned pc, unsigned address){
+   unsigned counts[5]  = {issued, useful, late, hits, accesses};
+   access(pc, address, 0, 0);
+   issued              = counts[0];
+   useful              = counts[1];
+   late                = counts[2];
+   hits                = counts[3];
+   accesses            = counts[4];
+}
+
+//----------------------------------------------------------------------
+// Start filling a line, replacing the oldest line of a full buffer
+//----------------------------------------------------------------------
+void prefetcher::prefetch(unsigned line, unsigned cycle, unsigned latency){
+   for(unsigned i = 0; i < buffer.size(); i++) {
+      if(buffer[i].line == line)
+         return;
+   }
+   if(buffer.size() == buffer_entries)
+      buffer.pop_front();
+   prefetch_line_t fill = {line, cycle + latency, false};
+   buffer.push_back(fill);
+   issued++;
+}
+
+//----------------------------------------------------------------------
+// Reference prediction table: once a load repeats the same non-zero
+// stride, prefetch "degree" strides ahead of it
+//----------------------------------------------------------------------
+void prefetcher::train_stride(unsigned pc, unsigned address, unsigned cycle, unsigned latency){
+   stride_entry_t& entry = stride_table[(pc / 4) % stride_table.size()];
+   if(!entry.valid || entry.pc != pc) {
+      stride_entry_t fresh = {true, pc, address, 0, 0};
+      entry               = fresh;
+      return;
+   }
+   int stride             = (int)(address - entry.last_address);
+   if(stride == entry.stride)
+      entry.confidence    = min(entry.confidence + 1, 3u);
+   else if(entry.confidence > 0)
+      entry.confidence--;
+   else
+      entry.stride        = stride;
+   entry.last_address     = address;
+   if(entry.confidence == 0 || entry.stride == 0)
+      return;
+   for(unsigned k = 1; k <= degree; k++)
+      prefetch((address + entry.stride * (int)k) / line_size, cycle, latency);
+}
+
+//----------------------------------------------------------------------
+// Stream detection: accesses to consecutive lines (in either direction)
+// start a stream, which then runs "degree" lines ahead of the loads
+//----------------------------------------------------------------------
+void prefetcher::train_stream(unsigned line, unsigned cycle, unsigned latency){
+   for(unsigned i = 0; i < stream_table.size(); i++) {
+      stream_entry_t& stream = stream_table[i];
+      if(!stream.valid)
+         continue;
+      if(line == stream.last_line)
+         return;
+      bool follows        = (stream.direction != 0 && line == stream.last_line + stream.direction);
+      bool starts         = (stream.direction == 0 && (line == stream.last_line + 1 || line == stream.last_line - 1));
+      if(!follows && !starts)
+         continue;
+      stream.direction    = (int)(line - stream.last_line);
+      stream.last_line    = line;
+      for(unsigned k = 1; k <= degree; k++)
+         prefetch(line + stream.direction * (int)k, cycle, latency);
+      return;
+   }
+   stream_entry_t fresh   = {true, line, 0};
+   stream_table[next_stream] = fresh;
+   next_stream            = (next_stream + 1) % stream_table.size();
+}
+
+//----------------------------------------------------------------------
+// Prefetcher statistics
+//----------------------------------------------------------------------
+float prefetcher::get_accuracy(){
+   return issued ? (float) useful / (float) issued : 0;
+}
+
+float prefetcher::get_coverage(){
+   return accesses ? (float) hits / (float) accesses : 0;
+}
+
+float prefetcher::get_timeliness(){
+   return useful ? (float) (useful - late) / (float) useful : 0;
+}
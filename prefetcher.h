@@ -0,0 +1,93 @@
+#ifndef PREFETCHER_H_
+#define PREFETCHER_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <deque>
+#include <vector>
+
+#include "sim_assert.h"
+
+// Prefetching policies, combined as a bit mask
+typedef enum {PREFETCH_NEXT_LINE = 1, PREFETCH_STRIDE = 2, PREFETCH_STREAM = 4} prefetch_policy_t;
+
+//----------------------------------------------------------------------
+// Data prefetcher shared by the integer and floating point simulators
+//
+// The prefetcher observes the loads reaching the memory stage and
+// fills lines into a small prefetch buffer ahead of the demand
+// accesses. A fill takes the data memory latency; a load finding its
+// line in the buffer waits only for what is left of the fill. The data
+// memory has no cache, so a line defaults to one word.
+//----------------------------------------------------------------------
+class prefetcher{
+
+   public:
+
+      // Line held (or being filled) in the prefetch buffer
+      struct prefetch_line_t{
+         unsigned       line;
+         unsigned       ready_cycle;
+         bool           used;
+      };
+
+      // Reference prediction table entry (per-PC stride detection)
+      struct stride_entry_t{
+         bool           valid;
+         unsigned       pc;
+         unsigned       last_address;
+         int            stride;
+         unsigned       confidence;
+      };
+
+      // Stream detector: run of accesses to consecutive lines
+      struct stream_entry_t{
+         bool           valid;
+         unsigned       last_line;
+         int            direction;     // +1/-1 once detected, 0 while training
+      };
+
+      unsigned          policies;
+      unsigned          degree;
+      unsigned          line_size;
+      unsigned          buffer_entries;
+
+      std::deque<prefetch_line_t> buffer;
+      std::vector<stride_entry_t> stride_table;
+      std::vector<stream_entry_t> stream_table;
+      unsigned          next_stream;
+
+      unsigned          issued;
+      unsigned          useful;
+      unsigned          late;
+      unsigned          hits;
+      unsigned          accesses;
+
+   public:
+
+      //policies: bit mask of prefetch_policy_t; degree: lines prefetched ahead of every trigger
+      prefetcher(unsigned policies, unsigned degree=1, unsigned line_size=4, unsigned buffer_entries=16, unsigned table_entries=16);
+
+      //returns the number of cycles the load of "address" by the instruction at "pc" waits for data memory
+      //(latency = data memory latency), and trains the prefetcher with the access
+      unsigned access(unsigned pc, unsigned address, unsigned cycle, unsigned latency);
+
+      void     prefetch(unsigned line, unsigned cycle, unsigned latency);
+
+      //trains the prefetcher with the load of "address" by the instruction at "pc" executed without timing: the
+      //lines it prefetches are ready at once, and the statistics are left as they are
+      void     warm(unsigned pc, unsigned address);
+      void     train_stride(unsigned pc, unsigned address, unsigned cycle, unsigned latency);
+      void     train_stream(unsigned line, unsigned cycle, unsigned latency);
+
+      //returns the fraction of the issued prefetches used by a load
+      float    get_accuracy();
+
+      //returns the fraction of the loads that found their line in the prefetch buffer
+      float    get_coverage();
+
+      //returns the fraction of the useful prefetches completed before the load needed them
+      float    get_timeliness();
+};
+
+#endif /*PREFETCHER_H_*/
@@ -0,0 +1,162 @@
+#include "profiler.h"
+#include <string.h>
+#include <limits.h>
+#include <string>
+#include <algorithm>
+
+using namespace std;
+
+static const char *stage_names[NUM_PROFILED_STAGES] = {"IF", "ID", "EX", "MEM", "WB"};
+static const char *cause_names[NUM_STALL_CAUSES] = {"RAW", "WAW", "struct", "control", "memory"};
+
+profiler::profiler(){
+   start(0);
+}
+
+void profiler::start(unsigned base_address, unsigned long cycle){
+   this->base_address            = base_address;
+   counters.clear();
+   table                         = NULL;
+   entries                       = 0;
+   total_cycles                  = 0;
+   charged                       = cycle;
+   last_fetch                    = UINT_MAX;
+   stamps.assign(16, stamp_t());                // none live
+   stamp_mask                    = stamps.size() - 1;
+}
+
+void profiler::grow(unsigned pc){
+   ASSERT( pc >= base_address && pc % 4 == 0, "PC %x is outside the program profiled", pc );
+   counters.resize((pc - base_address) / 4 + 1, counters_t());
+   table                         = counters.data();
+   entries                       = counters.size();
+}
+
+//----------------------------------------------------------------------
+// Double the stamps, moving those in flight to their new slots, until
+// the slot of "seq" is free
+//----------------------------------------------------------------------
+profiler::stamp_t& profiler::make_room(unsigned seq){
+   vector<stamp_t> live;
+   for(unsigned i = 0; i < stamps.size(); i++) {
+      if(stamps[i].live)
+         live.push_back(stamps[i]);
+   }
+   bool placed                   = false;
+   while(!placed) {
+      stamps.assign(2 * stamps.size(), stamp_t());
+      stamp_mask                 = stamps.size() - 1;
+      placed                     = true;
+      for(unsigned i = 0; i < live.size(); i++) {
+         stamp_t& stamp          = stamps[live[i].seq & stamp_mask];
+         placed                  = placed && !stamp.live;
+         stamp                   = live[i];
+      }
+      placed                     = placed && !stamps[seq & stamp_mask].live;
+   }
+   return stamps[seq & stamp_mask];
+}
+
+//----------------------------------------------------------------------
+// Profile statistics
+//----------------------------------------------------------------------
+profiler::counters_t profiler::get(unsigned pc){
+   unsigned index                = (pc - base_address) / 4;
+   return (pc >= base_address && index < counters.size()) ? counters[index] : counters_t();
+}
+
+unsigned long profiler::get_cycles(){
+   return total_cycles;
+}
+
+static bool hotter(const profiler::loop_t& a, const profiler::loop_t& b){
+   return a.cycles != b.cycles ? a.cycles > b.cycles : a.head < b.head;
+}
+
+vector<profiler::loop_t> profiler::get_loops(){
+   vector<loop_t> loops;
+   for(unsigned i = 0; i < counters.size(); i++) {
+      if(counters[i].back_edges == 0)
+         continue;
+      loop_t loop                = { counters[i].target, base_address + 4 * i, 0, counters[i].fetches };
+      for(unsigned j = (loop.head - base_address) / 4; j <= i; j++)
+         loop.cycles            += counters[j].cycles;
+      loops.push_back(loop);
+   }
+   sort(loops.begin(), loops.end(), hotter);
+   return loops;
+}
+
+//----------------------------------------------------------------------
+// Report: every instruction is found on its line of the source (after
+// the labels that open the line), in program order
+//----------------------------------------------------------------------
+void profiler::print(const char *source_file, unsigned loops){
+   FILE *source                  = fopen(source_file, "r");
+   ASSERT( source != NULL, "Unable to open file %s", source_file );
+   vector<string> text;
+   vector<unsigned> lines;
+   char buffer[4096];
+   string labels;
+   for(unsigned line = 1; fgets(buffer, sizeof(buffer), source) != NULL; line++) {
+      string instruction;
+      for(char *token = strtok(buffer, " \t\r\n"); token != NULL; token = strtok(NULL, " \t\r\n")) {
+         if(instruction.empty() && token[strlen(token) - 1] == ':')
+            labels              += string(token) + " ";
+         else
+            instruction         += (instruction.empty() ? "" : " ") + string(token);
+      }
+      if(instruction.empty())
+         continue;
+      text.push_back(labels + instruction);
+      lines.push_back(line);
+      labels.clear();
+   }
+   fclose(source);
+
+   printf("Profile of %s: %lu clock cycles\n", source_file, total_cycles);
+   printf("%-10s %4s  %-24s %7s %7s", "PC", "line", "instruction", "fetched", "cycles");
+   for(unsigned s = 0; s < NUM_PROFILED_STAGES; s++)
+      printf(" %7s", stage_names[s]);
+   for(unsigned c = 0; c < NUM_STALL_CAUSES; c++)
+      printf(" %7s", cause_names[c]);
+   printf(" %7s %7s\n", "access", "miss");
+   for(unsigned i = 0; i < counters.size(); i++) {
+      const counters_t& counter  = counters[i];
+      if(counter.fetches == 0 && counter.cycles == 0)
+         continue;
+      printf("0x%08x %4u  %-24s %7lu %7lu", base_address + 4 * i, i < lines.size() ? lines[i] : 0, i < text.size() ? text[i].c_str() : "?",
+             counter.fetches, counter.cycles);
+      for(unsigned s = 0; s < NUM_PROFILED_STAGES; s++)
+         printf(" %7lu", counter.stage_cycles[s]);
+      for(unsigned c = 0; c < NUM_STALL_CAUSES; c++)
+         printf(" %7lu", counter.stalls[c]);
+      printf(" %7lu %7lu\n", counter.accesses, counter.misses);
+   }
+
+   vector<loop_t> hottest        = get_loops();
+   printf("Hottest loops:\n");
+   for(unsigned l = 0; l < hottest.size() && l < loops; l++) {
+      const loop_t& loop         = hottest[l];
+      unsigned first             = (loop.head - base_address) / 4;
+      unsigned last              = (loop.tail - base_address) / 4;
+      unsigned hot               = first;
+      for(unsigned i = first; i <= last; i++) {
+         if(counters[i].cycles > counters[hot].cycles)
+            hot                  = i;
+      }
+      unsigned cause             = 0;
+      for(unsigned c = 1; c < NUM_STALL_CAUSES; c++) {
+         if(counters[hot].stalls[c] > counters[hot].stalls[cause])
+            cause                = c;
+      }
+      printf("   %u. lines %u-%u (0x%08x-0x%08x): %lu cycles (%.2f%%), %lu iterations, %.2f cycles/iteration\n", l + 1,
+             first < lines.size() ? lines[first] : 0, last < lines.size() ? lines[last] : 0, loop.head, loop.tail, loop.cycles,
+             total_cycles ? 100.0 * loop.cycles / total_cycles : 0, loop.iterations, loop.iterations ? (double) loop.cycles / loop.iterations : 0);
+      printf("      hottest line %u (%s): %lu cycles", hot < lines.size() ? lines[hot] : 0, hot < text.size() ? text[hot].c_str() : "?",
+             counters[hot].cycles);
+      if(counters[hot].stalls[cause] > 0)
+         printf(", %lu %s stall cycles", counters[hot].stalls[cause], cause_names[cause]);
+      printf("\n");
+   }
+}
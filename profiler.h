@@ -0,0 +1,260 @@
+#ifndef PROFILER_H_
+#define PROFILER_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <vector>
+
+#include "sim_assert.h"
+
+// Pipeline stages profiled (IF, ID, EX, MEM and WB, as the stage_t of the simulators)
+#define NUM_PROFILED_STAGES 5
+
+// Causes of the stall cycles of the profile: a source register not yet written, an older write to the destination
+// still in flight, a busy unit, queue or write port, a branch not yet resolved, and the data memory
+typedef enum {STALL_RAW, STALL_WAW, STALL_STRUCTURAL, STALL_CONTROL, STALL_MEMORY, NUM_STALL_CAUSES} stall_cause_t;
+
+//----------------------------------------------------------------------
+// Per-instruction profile of a program run, shared by the integer and
+// floating point simulators
+//
+// The counters of the static instructions are kept in a flat array
+// indexed by PC: how often each instruction was fetched, the clock
+// cycles charged to it, the cycles it spent in every pipeline stage,
+// the stall cycles it caused by cause, its data memory accesses and
+// misses, and its taken branches. Every instruction in flight is
+// stamped with the clock cycle it enters a stage, and the difference is
+// added to the stage it leaves, so nothing is done in the cycles in
+// between (the cycles of ID are carried to EX, and added with its own
+// in a single lookup). The stamps are kept here, out of the instructions
+// the pipelines copy from latch to latch, by the sequence number the
+// simulator gives every instruction it fetches: a ring indexed by the
+// low bits, grown when an instruction still in flight holds the slot of
+// a new one. The clock cycles up to every write-back are
+// charged to the instruction written back, the one the pipeline was
+// waiting on, so the cycles of the instructions add up to those of the
+// run. IF counts the cycle of the fetch and the cycles waiting for
+// decode. A fused pair is profiled at its second instruction.
+//
+// The report maps the PCs back to the lines and labels of the assembly
+// source, and ranks the loops (from the target of a taken backward
+// branch to the branch) by the cycles of their instructions.
+//----------------------------------------------------------------------
+class profiler{
+
+   public:
+
+      // Counters of a static instruction
+      struct counters_t{
+         unsigned long  fetches;
+         unsigned long  cycles;
+         unsigned long  stage_cycles[NUM_PROFILED_STAGES];
+         unsigned long  stalls[NUM_STALL_CAUSES];
+         unsigned long  accesses;                 // loads and stores to data memory
+         unsigned long  misses;                   // accesses that waited for data memory, or missed in the L1
+         unsigned long  taken;
+         unsigned long  back_edges;               // taken branches to a lower PC (to "target")
+         unsigned       target;
+      };
+
+      // Loop of the program: from the target of a taken backward branch (head) to the branch (tail)
+      struct loop_t{
+         unsigned       head;
+         unsigned       tail;
+         unsigned long  cycles;                   // of the instructions from head to tail
+         unsigned long  iterations;               // executions of the tail
+      };
+
+      // Stamps of an instruction in flight
+      struct stamp_t{
+         unsigned       seq;                      // sequence number of the instruction
+         bool           live;                     // fetched and not yet written back (or dropped)
+         unsigned       entered;                  // clock cycle it entered its stage
+         unsigned       decoded;                  // clock cycles it spent in ID, added as it leaves EX
+      };
+
+      unsigned          base_address;
+      std::vector<counters_t> counters;          // by (pc - base_address) / 4
+      counters_t        *table;                   // counters.data() and counters.size(), kept for the lookups
+      unsigned          entries;
+      unsigned long     total_cycles;
+      unsigned long     charged;                  // clock cycle the cycles are charged up to
+      unsigned          last_fetch;               // PC of the last instruction fetched
+      std::vector<stamp_t> stamps;               // by sequence number modulo their number, a power of 2
+      unsigned          stamp_mask;
+
+   public:
+
+      profiler();
+
+      //starts a profile of the program loaded at "base_address" at clock cycle "cycle" (called by the simulator it is
+      //attached to)
+      void     start(unsigned base_address, unsigned long cycle=0);
+
+      //counters of the instruction at "pc"
+      counters_t& at(unsigned pc){
+         unsigned index          = (pc - base_address) / 4;
+         if(index >= entries)
+            grow(pc);
+         return table[index];
+      }
+
+      //makes room for the counters of the instruction at "pc"
+      void     grow(unsigned pc);
+
+      //stamps of the instruction numbered "seq" (NULL if it is not in flight)
+      stamp_t* find(unsigned seq){
+         stamp_t& stamp          = stamps[seq & stamp_mask];
+         return (stamp.live && stamp.seq == seq) ? &stamp : NULL;
+      }
+
+      //stamps the instruction numbered "seq" as it enters its first stage at clock cycle "now"
+      stamp_t& issue(unsigned seq, unsigned now){
+         stamp_t *stamp          = &stamps[seq & stamp_mask];
+         if(stamp->live && stamp->seq != seq)
+            stamp                = &make_room(seq);
+         stamp->seq              = seq;
+         stamp->live             = true;
+         stamp->entered          = now;
+         stamp->decoded          = 0;
+         return *stamp;
+      }
+
+      //grows the stamps until the slot of "seq" is free, returning it
+      stamp_t& make_room(unsigned seq);
+
+      //the instruction numbered "seq" leaves the pipeline without a write-back
+      void drop(unsigned seq){
+         stamp_t *stamp          = find(seq);
+         if(stamp != NULL)
+            stamp->live          = false;
+      }
+
+      //events of the instruction at "pc" (an undefined "pc", a bubble, is left out)
+      void access(unsigned pc, bool miss){
+         counters_t& counter     = at(pc);
+         counter.accesses++;
+         counter.misses         += miss;
+      }
+
+      void branch(unsigned pc, unsigned target){
+         counters_t& counter     = at(pc);
+         counter.taken++;
+         if(target <= pc) {
+            counter.back_edges++;
+            counter.target       = target;
+         }
+      }
+
+      //the instruction at "pc" is fetched and numbered "seq", entering IF at clock cycle "now"
+      void fetch(unsigned pc, unsigned seq, unsigned now){
+         counters_t& counter     = at(pc);
+         counter.fetches++;
+         counter.stage_cycles[0]++;             // the cycle of the fetch
+         last_fetch              = pc;
+         issue(seq, now);
+      }
+
+      void cycle(unsigned pc, unsigned cycles=1){
+         if(pc == UINT_MAX)
+            return;
+         at(pc).cycles          += cycles;
+         total_cycles           += cycles;
+      }
+
+      void stage(unsigned pc, unsigned stage, unsigned cycles=1){
+         if(pc != UINT_MAX)
+            at(pc).stage_cycles[stage] += cycles;
+      }
+
+      //the instruction at "pc", numbered "seq", leaves "stage" for the next one at clock cycle "now" (an undefined
+      //"pc", a bubble, is left out)
+      void leave(unsigned pc, unsigned stage, unsigned seq, unsigned now){
+         stamp_t *stamp          = (pc != UINT_MAX) ? find(seq) : NULL;
+         if(stamp == NULL)
+            return;
+         at(pc).stage_cycles[stage] += now - stamp->entered;
+         stamp->entered          = now;
+      }
+
+      //the instruction at "pc", numbered "seq", leaves ID at clock cycle "now", as "copy" (the instruction itself, or
+      //the copy of EOP leaving while EOP stays in ID), carrying its cycles of ID along, or adding them at once when
+      //"fused" (the first instruction of a fused pair)
+      void decode(unsigned pc, unsigned seq, unsigned copy, bool fused, unsigned now){
+         stamp_t *stamp          = (pc != UINT_MAX) ? find(seq) : NULL;
+         if(stamp == NULL)
+            return;
+         unsigned decoded        = now - stamp->entered;
+         stamp->entered          = now;
+         if(fused) {
+            at(pc).stage_cycles[1] += decoded;
+            decoded              = 0;
+         }
+         if(copy != seq)
+            stamp                = &issue(copy, now);
+         stamp->decoded          = decoded;
+      }
+
+      //the instruction at "pc", numbered "seq", leaves EX for MEM at clock cycle "now": one lookup for its cycles of ID
+      //and EX
+      void execute(unsigned pc, unsigned seq, unsigned now){
+         stamp_t *stamp          = (pc != UINT_MAX) ? find(seq) : NULL;
+         if(stamp == NULL)
+            return;
+         counters_t& counter     = at(pc);
+         counter.stage_cycles[1] += stamp->decoded;
+         counter.stage_cycles[2] += now - stamp->entered;
+         stamp->entered          = now;
+      }
+
+      //adds the cycles of ID the instruction at "pc", numbered "seq", carries through EX, as a run stops with it there
+      void flush_decoded(unsigned pc, unsigned seq){
+         stamp_t *stamp          = (pc != UINT_MAX) ? find(seq) : NULL;
+         if(stamp == NULL)
+            return;
+         at(pc).stage_cycles[1] += stamp->decoded;
+         stamp->decoded          = 0;
+      }
+
+      //the instruction at "pc", numbered "seq", leaves MEM at clock cycle "now", for the cycle of WB, and the clock
+      //cycles up to its write-back are charged to it
+      void write_back(unsigned pc, unsigned seq, unsigned now){
+         counters_t& counter     = at(pc);
+         stamp_t *stamp          = find(seq);
+         if(stamp != NULL) {
+            counter.stage_cycles[3] += now - stamp->entered;
+            stamp->live          = false;
+         }
+         counter.stage_cycles[4]++;
+         counter.cycles         += now + 1 - charged;
+         total_cycles           += now + 1 - charged;
+         charged                 = now + 1;
+      }
+
+      //charges the clock cycles up to "now" (excluded) not charged yet to the instruction at "pc"
+      void charge(unsigned pc, unsigned long now){
+         cycle(pc, now - charged);
+         charged                 = now;
+      }
+
+      void stall(unsigned pc, stall_cause_t cause, unsigned cycles=1){
+         if(pc != UINT_MAX)
+            at(pc).stalls[cause] += cycles;
+      }
+
+      //returns the counters of the instruction at "pc" (all 0 if it never ran)
+      counters_t get(unsigned pc);
+
+      //returns the clock cycles profiled
+      unsigned long get_cycles();
+
+      //returns the loops of the program, hottest first
+      std::vector<loop_t> get_loops();
+
+      //prints the counters of every instruction that ran next to its line of "source_file", the assembly program
+      //profiled, followed by the "loops" hottest loops
+      void     print(const char *source_file, unsigned loops=5);
+};
+
+#endif /*PROFILER_H_*/
@@ -0,0 +1,169 @@
+#include "program.h"
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+using namespace std;
+
+// Object file header: magic, ISA (0 integer, 1 floating point), instructions, literals, symbols, segments; words
+// are in the byte order of the host, which maps them as they are
+static const unsigned OBJECT_MAGIC  = 0x314A424F;    // "OBJ1"
+static const unsigned HEADER_WORDS  = 6;
+
+program::program(bool fp){
+   this->fp         = fp;
+   mapping          = NULL;
+   mapping_bytes    = 0;
+   text_words       = NULL;
+   text_count       = 0;
+   pool_words       = NULL;
+   pool_count       = 0;
+   literal          = 0;
+}
+
+program::~program(){
+   if(mapping != NULL)
+      munmap(mapping, mapping_bytes);
+}
+
+void program::save(const char *filename){
+   vector<unsigned> words;
+   words.push_back(OBJECT_MAGIC);
+   words.push_back(fp);
+   words.push_back(text.size());
+   words.push_back(pool.size());
+   words.push_back(symbols.size());
+   words.push_back(data.size());
+   words.insert(words.end(), text.begin(), text.end());
+   words.insert(words.end(), pool.begin(), pool.end());
+   for(unsigned i = 0; i < symbols.size(); i++) {
+      unsigned length = symbols[i].name.size();
+      vector<unsigned> name((length + 3) / 4, 0);
+      memcpy(name.data(), symbols[i].name.c_str(), length);
+      words.push_back(symbols[i].index);
+      words.push_back(length);
+      words.insert(words.end(), name.begin(), name.end());
+   }
+   for(unsigned i = 0; i < data.size(); i++) {
+      words.push_back(data[i].address);
+      words.push_back(data[i].words.size());
+      words.insert(words.end(), data[i].words.begin(), data[i].words.end());
+   }
+   FILE *file = fopen(filename, "wb");
+   ASSERT( file, "Unable to create object file %s", filename );
+   ASSERT( fwrite(&words[0], sizeof(unsigned), words.size(), file) == words.size(), "Unable to write object file %s", filename );
+   fclose(file);
+}
+
+void program::map(const char *filename){
+   ASSERT( mapping == NULL, "An object file is already mapped" );
+   int descriptor = open(filename, O_RDONLY);
+   ASSERT( descriptor >= 0, "Unable to open object file %s", filename );
+   struct stat status;
+   fstat(descriptor, &status);
+   mapping_bytes  = status.st_size;
+   ASSERT( mapping_bytes >= HEADER_WORDS * sizeof(unsigned), "Truncated object file %s", filename );
+   mapping        = mmap(NULL, mapping_bytes, PROT_READ, MAP_PRIVATE, descriptor, 0);
+   close(descriptor);
+   ASSERT( mapping != MAP_FAILED, "Unable to map object file %s", filename );
+
+   const unsigned *words = (const unsigned *) mapping;
+   const unsigned *end   = words + mapping_bytes / sizeof(unsigned);
+   ASSERT( words[0] == OBJECT_MAGIC, "%s is not an object file", filename );
+   fp             = words[1];
+   text_count     = words[2];
+   pool_count     = words[3];
+   unsigned symbol_count  = words[4];
+   unsigned segment_count = words[5];
+   text_words     = words + HEADER_WORDS;
+   pool_words     = text_words + text_count;
+   literal        = 0;
+
+   const unsigned *next = pool_words + pool_count;
+   ASSERT( next <= end, "Truncated object file %s", filename );
+   symbols.clear();
+   for(unsigned i = 0; i < symbol_count; i++) {
+      ASSERT( next + 2 <= end && next + 2 + (next[1] + 3) / 4 <= end, "Truncated object file %s", filename );
+      symbol_t symbol;
+      symbol.index   = next[0];
+      symbol.name    = string((const char *)(next + 2), next[1]);
+      symbols.push_back(symbol);
+      next          += 2 + (next[1] + 3) / 4;
+   }
+   data.clear();
+   for(unsigned i = 0; i < segment_count; i++) {
+      ASSERT( next + 2 <= end && next + 2 + next[1] <= end, "Truncated object file %s", filename );
+      segment_t segment;
+      segment.address = next[0];
+      segment.words.assign(next + 2, next + 2 + next[1]);
+      data.push_back(segment);
+      next          += 2 + next[1];
+   }
+}
+
+bool program::is_object(const char *filename){
+   unsigned magic = 0;
+   FILE *file     = fopen(filename, "rb");
+   ASSERT( file, "Unable to open file %s", filename );
+   bool object    = (fread(&magic, sizeof(unsigned), 1, file) == 1 && magic == OBJECT_MAGIC);
+   fclose(file);
+   return object;
+}
+
+//----------------------------------------------------------------------
+// Encoding
+//----------------------------------------------------------------------
+void program::emit(unsigned opcode, unsigned a, unsigned b, unsigned tail){
+   ASSERT( opcode < 32 && a < 64 && b < 64 && tail < 0x8000, "Instruction does not fit an object word (opcode %d)", opcode );
+   text.push_back((opcode << 27) | (a << 21) | (b << 15) | tail);
+}
+
+unsigned program::reg_field(unsigned reg, bool is_float){
+   ASSERT( reg < 32, "Register %d does not exist", reg );
+   return reg | (is_float ? OBJECT_FLOAT_REGISTER : 0);
+}
+
+unsigned program::immediate_field(unsigned immediate){
+   int value = immediate;
+   if(value >= -(1 << 13) && value < (1 << 13))
+      return immediate & 0x3FFF;
+   pool.push_back(immediate);
+   return OBJECT_LITERAL;
+}
+
+//----------------------------------------------------------------------
+// Decoding
+//----------------------------------------------------------------------
+unsigned program::opcode(unsigned index){
+   return text_words[index] >> 27;
+}
+
+unsigned program::field_a(unsigned index){
+   return (text_words[index] >> 21) & 0x3F;
+}
+
+unsigned program::field_b(unsigned index){
+   return (text_words[index] >> 15) & 0x3F;
+}
+
+unsigned program::field_c(unsigned index){
+   return text_words[index] & 0x3F;
+}
+
+unsigned program::immediate(unsigned index){
+   if(text_words[index] & OBJECT_LITERAL) {
+      ASSERT( literal < pool_count, "Literal pool exhausted at instruction %d", index );
+      return pool_words[literal++];
+   }
+   return ((int)(text_words[index] << 18)) >> 18;
+}
+
+unsigned program::reg(unsigned field){
+   return field & 0x1F;
+}
+
+bool program::is_float(unsigned field){
+   return field & OBJECT_FLOAT_REGISTER;
+}
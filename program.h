@@ -0,0 +1,104 @@
+#ifndef PROGRAM_H_
+#define PROGRAM_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+#include "sim_assert.h"
+
+// Instruction word of an object file: opcode_t of the simulator in bits 27-31, fields A (bits 21-26) and B (bits
+// 15-20) and a tail (bits 0-14) holding either field C (bits 0-5) or an immediate. A register field is the register
+// number, plus 32 for a floating point register. An immediate is a 14-bit signed value, or, when bit 14 is set, the
+// next word of the literal pool
+#define OBJECT_FLOAT_REGISTER  0x20
+#define OBJECT_LITERAL         0x4000
+
+//----------------------------------------------------------------------
+// Assembled program of the integer or floating point simulator, kept
+// in an object file
+//
+// The file holds the encoded instructions, a literal pool with the
+// immediates that do not fit in an instruction word (consumed in
+// program order), the labels of the program and the initialised data
+// memory, and is laid out in 32-bit words so that it can be mapped
+// and decoded in place:
+//
+//    header    magic, ISA, instructions, literals, symbols, segments
+//    text      one word per instruction
+//    pool      one word per literal
+//    symbols   instruction index, name length, name padded to a word
+//    segments  address, words, contents
+//----------------------------------------------------------------------
+class program{
+
+   public:
+
+      // Label of the program: the index of the instruction that follows it
+      struct symbol_t{
+         std::string    name;
+         unsigned       index;
+      };
+
+      // Initialised data memory, starting at "address"
+      struct segment_t{
+         unsigned       address;
+         std::vector<unsigned> words;
+      };
+
+      bool              fp;                       // assembled for the floating point simulator
+
+      // Program being assembled
+      std::vector<unsigned> text;
+      std::vector<unsigned> pool;
+      std::vector<symbol_t> symbols;
+      std::vector<segment_t> data;
+
+      // Object file mapped in memory (none when NULL): text and pool point into the mapping
+      void              *mapping;
+      size_t            mapping_bytes;
+      const unsigned    *text_words;
+      unsigned          text_count;
+      const unsigned    *pool_words;
+      unsigned          pool_count;
+      unsigned          literal;                  // next literal of the pool to decode
+
+   public:
+
+      program(bool fp=false);
+
+      ~program();
+
+      //writes the program assembled so far to the object file "filename"
+      void save(const char *filename);
+
+      //maps the object file "filename": its instructions and symbols can then be decoded, and its data segments
+      //are read into "data"
+      void map(const char *filename);
+
+      //returns true if "filename" is an object file rather than assembly
+      static bool is_object(const char *filename);
+
+      //encodes an instruction word and appends it to the text
+      void emit(unsigned opcode, unsigned a=0, unsigned b=0, unsigned tail=0);
+
+      //returns the field of register "reg"
+      unsigned reg_field(unsigned reg, bool is_float=false);
+
+      //returns the tail encoding the immediate "immediate", moving it to the literal pool if it does not fit
+      unsigned immediate_field(unsigned immediate);
+
+      //decoding of the "index"-th instruction word of a mapped file
+      unsigned opcode(unsigned index);
+      unsigned field_a(unsigned index);
+      unsigned field_b(unsigned index);
+      unsigned field_c(unsigned index);
+      unsigned immediate(unsigned index);         // call in program order: literals are consumed as decoded
+
+      //returns the register number and the floating point flag of a register field
+      static unsigned reg(unsigned field);
+      static bool is_float(unsigned field);
+};
+
+#endif /*PROGRAM_H_*/
@@ -0,0 +1,86 @@
+#include "sampler.h"
+#include <math.h>
+#include <limits.h>
+
+using namespace std;
+
+sampler::sampler(unsigned period, unsigned unit, unsigned warmup, double target_error, double confidence, unsigned min_units){
+   ASSERT( unit > 0 && period >= warmup + unit, "Unsupported sampling (period=%d, warm-up=%d, unit=%d)", period, warmup, unit );
+   ASSERT( target_error > 0 && confidence > 0 && confidence < 1 && min_units > 1, "Unsupported sampling target (error=%f, confidence=%f, units=%d)", target_error, confidence, min_units );
+   this->period                  = period;
+   this->warmup                  = warmup;
+   this->unit                    = unit;
+   this->target_error            = target_error;
+   this->confidence              = confidence;
+   this->min_units               = min_units;
+   // erf(z / sqrt(2)) = confidence, solved by bisection
+   double low                    = 0;
+   double high                   = 10;
+   for(unsigned i = 0; i < 60; i++) {
+      z                          = (low + high) / 2;
+      if(erf(z / sqrt(2.0)) < confidence)
+         low                     = z;
+      else
+         high                    = z;
+   }
+   cpi_sum                       = 0;
+   cpi_squares                   = 0;
+   converged                     = false;
+   instructions                  = 0;
+   detailed_instructions         = 0;
+   detailed_cycles               = 0;
+}
+
+unsigned sampler::fast_forward(){
+   return converged ? UINT_MAX : period - warmup - unit;
+}
+
+void sampler::measure(unsigned cycles){
+   double value                  = (double) cycles / (double) unit;
+   cpi.push_back(value);
+   cpi_sum                      += value;
+   cpi_squares                  += value * value;
+   converged                     = (cpi.size() >= min_units && get_error() <= target_error);
+}
+
+//----------------------------------------------------------------------
+// Sampling statistics
+//----------------------------------------------------------------------
+unsigned sampler::get_units(){
+   return cpi.size();
+}
+
+bool sampler::get_converged(){
+   return converged;
+}
+
+double sampler::get_CPI(){
+   return cpi.empty() ? 0 : cpi_sum / cpi.size();
+}
+
+double sampler::get_error(){
+   unsigned n                    = cpi.size();
+   if(n < 2 || cpi_sum == 0)
+      return 0;
+   double mean                   = cpi_sum / n;
+   double variance               = max(0.0, (cpi_squares - n * mean * mean) / (n - 1));
+   return z * sqrt(variance / n) / mean;
+}
+
+double sampler::get_clock_cycles(){
+   return get_CPI() * instructions;
+}
+
+unsigned long sampler::get_instructions(){
+   return instructions;
+}
+
+double sampler::get_detailed_fraction(){
+   return instructions ? (double) detailed_instructions / (double) instructions : 0;
+}
+
+void sampler::print(){
+   printf("Sampled CPI = %.4f +/- %.2f%% (%.1f%% confidence), %u units of %u instructions every %u%s\n", get_CPI(), 100 * get_error(),
+          100 * confidence, get_units(), unit, period, converged ? ", converged" : "");
+   printf("Instructions = %lu (%.2f%% in detail), estimated clock cycles = %.0f\n", instructions, 100 * get_detailed_fraction(), get_clock_cycles());
+}
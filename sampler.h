@@ -0,0 +1,78 @@
+#ifndef SAMPLER_H_
+#define SAMPLER_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+#include "sim_assert.h"
+
+//----------------------------------------------------------------------
+// Statistical sampling of a program run, shared by the integer and
+// floating point simulators
+//
+// Every "period" instructions, a sampling unit is simulated in detail:
+// "warmup" instructions bring the pipeline from empty to a
+// representative state, then the CPI of the next "unit" instructions
+// is measured. The instructions in between run functionally, with no
+// timing, while still training the prefetcher and opening the DRAM
+// rows as the program would (functional warming). The CPI of the whole
+// program is estimated by the mean CPI of the units, with a confidence
+// interval from their variance; once at least "min_units" units have
+// been measured and the interval is within "target_error" of the mean,
+// no more units are taken and the rest of the program runs
+// functionally. NOPs are not counted as instructions: they cannot be
+// told apart from the pipeline bubbles when they commit.
+//----------------------------------------------------------------------
+class sampler{
+
+   public:
+
+      unsigned          period;
+      unsigned          warmup;
+      unsigned          unit;
+      double            target_error;             // relative half-width of the confidence interval
+      double            confidence;
+      double            z;                        // standard normal quantile of the confidence level
+      unsigned          min_units;
+
+      std::vector<double> cpi;                    // CPI of every unit measured
+      double            cpi_sum;
+      double            cpi_squares;
+      bool              converged;
+      unsigned long     instructions;             // executed by the program, in detail or functionally
+      unsigned long     detailed_instructions;
+      unsigned long     detailed_cycles;          // pipeline warm-up and drain included
+
+   public:
+
+      sampler(unsigned period, unsigned unit=1000, unsigned warmup=2000, double target_error=0.02, double confidence=0.997, unsigned min_units=30);
+
+      //returns the number of instructions to run functionally before the next unit (all the rest once converged)
+      unsigned fast_forward();
+
+      //adds a unit that took "cycles" clock cycles to commit its "unit" measured instructions
+      void     measure(unsigned cycles);
+
+      //returns the number of units measured
+      unsigned get_units();
+
+      //returns true once the confidence interval is within the target error
+      bool     get_converged();
+
+      //returns the estimated CPI of the program, and the relative half-width of its confidence interval
+      double   get_CPI();
+      double   get_error();
+
+      //returns the estimated clock cycles of the program (estimated CPI times the instructions it executed)
+      double   get_clock_cycles();
+
+      //returns the number of instructions executed by the program, and the fraction simulated in detail
+      unsigned long get_instructions();
+      double   get_detailed_fraction();
+
+      //prints the estimate and how it was obtained
+      void     print();
+};
+
+#endif /*SAMPLER_H_*/
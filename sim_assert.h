@@ -0,0 +1,14 @@
+#ifndef SIM_ASSERT_H_
+#define SIM_ASSERT_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+
+// Checks of the simulator: print the failing condition with its file and line, and abort
+#define ASSERT( condition, statement, ... ) \
+   if( !(condition) ) { \
+      printf( "[ASSERT] In File: %s, Line: %d => " #statement "\n", __FILE__, __LINE__, ##__VA_ARGS__ ); \
+      abort(); \
+   }
+
+#endif /*SIM_ASSERT_H_*/
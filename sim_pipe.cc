@@ -5,16 +5,199 @@ static const char *reg_names[NUM_SP_REGISTERS] = {"PC", "NPC", "IR", "A", "B", "
 static const char *stage_names[NUM_STAGES] = {"IF", "ID", "EX", "MEM", "WB"};
 
 //Mapping strings into its opcode
-map <string, opcode_t> opcode_2str = { {"LW", LW}, {"SW", SW}, {"ADD", ADD}, {"SUB", SUB}, {"XOR", XOR}, {"OR", OR}, {"AND", AND}, {"MULT", MULT}, {"DIV", DIV}, {"ADDI", ADDI}, {"SUBI", SUBI}, {"XORI", XORI}, {"ORI", ORI}, {"ANDI", ANDI}, {"BEQZ", BEQZ}, {"BNEZ", BNEZ}, {"BLTZ", BLTZ}, {"BGTZ", BGTZ}, {"BLEZ", BLEZ}, {"BGEZ", BGEZ}, {"JUMP", JUMP}, {"EOP", EOP}, {"NOP", NOP} };
+map <string, opcode_t> opcode_2str = { {"LW", LW}, {"SW", SW}, {"SWAP", SWAP}, {"ADD", ADD}, {"SUB", SUB}, {"XOR", XOR}, {"OR", OR}, {"AND", AND}, {"MULT", MULT}, {"DIV", DIV}, {"ADDI", ADDI}, {"SUBI", SUBI}, {"XORI", XORI}, {"ORI", ORI}, {"ANDI", ANDI}, {"BEQZ", BEQZ}, {"BNEZ", BNEZ}, {"BLTZ", BLTZ}, {"BGTZ", BGTZ}, {"BLEZ", BLEZ}, {"BGEZ", BGEZ}, {"JUMP", JUMP}, {"EOP", EOP}, {"NOP", NOP} };
 
 sim_pipe::sim_pipe(unsigned mem_size, unsigned mem_latency){
    this->dataMemSize            = mem_size;
    this->Data_Memory_Latency    = mem_latency;
    this->instruct_memory        = NULL;
    stall_count                  = 0;
+   cc_count                     = 0;
+   instCount                    = 0;
+   num_mshrs                    = 0;
+   mshr_file                    = NULL;
+   mshr_full_stalls             = 0;
+   mshr_merges                  = 0;
+   max_outstanding_loads        = 0;
+   data_prefetcher              = NULL;
+   dram_model                   = NULL;
+   dram_request                 = -1;
+   store_buffer_size            = 0;
+   store_buffer_full_stalls     = 0;
+   store_forwarding_hits        = 0;
+   store_buffer_occupancy       = 0;
+   max_store_buffer_occupancy   = 0;
+   issue_width                  = 1;
+   issue_mem_ops                = 1;
+   issue_alu_ops                = 1;
+   wb_ports                     = 1;
+   wide_branch_in_ex            = false;
+   wide_eop_issued              = false;
+   fetch_queue_size             = 0;
+   fetch_cycles                 = 1;
+   fetch_wait                   = 0;
+   fetch_stopped                = false;
+   fetch_eop                    = false;
+   fetch_starved_cycles         = 0;
+   fetch_queue_occupancy        = 0;
+   max_fetch_queue_occupancy    = 0;
+   fetch_stages                 = 1;
+   decode_stages                = 1;
+   memory_stages                = 1;
+   fusion_idioms                = 0;
+   compare_branch_fusions       = 0;
+   increment_load_fusions       = 0;
+   thread_policy                = ROUND_ROBIN;
+   thread_issue_slots           = 1;
+   switch_penalty               = 0;
+   current_thread               = 0;
+   switch_wait                  = 0;
+   thread_switches              = 0;
+   caches                       = NULL;
+   core_id                      = 0;
+   deferred                     = false;
+   atomic_issued                = false;
+   atomic_ready                 = false;
+   atomic_value                 = UNDEFINED;
+   replay                       = NULL;
+   fetch_seq                    = 0;
+   steady_state                 = false;
+   steady_head                  = UNDEFINED;
+   steady_head_fetched          = false;
+   steady_path_valid            = false;
+   steady_last.valid            = false;
+   sampling                     = NULL;
+   profiling                    = NULL;
+   monitoring                   = NULL;
    reset();
 }
 
+//----------------------------------------------------------------------
+// Enable the Non-Blocking Memory Stage
+//----------------------------------------------------------------------
+void sim_pipe::set_mshrs(unsigned mshrs){
+   ASSERT( mshrs == 0 || memory_stages == 1, "The non-blocking memory stage is a single pipeline stage" );
+   num_mshrs         = mshrs;
+   mshr_file         = (mshr_t*) realloc(mshr_file, num_mshrs * sizeof(mshr_t));
+   for(unsigned i = 0; i < num_mshrs; i++) {
+      mshr_file[i].valid = false;
+   }
+   wb_queue.clear();
+}
+
+//----------------------------------------------------------------------
+// Enable the Store Buffer
+//----------------------------------------------------------------------
+void sim_pipe::set_store_buffer(unsigned entries){
+   store_buffer_size = entries;
+   store_buffer.clear();
+}
+
+//----------------------------------------------------------------------
+// Attach a Data Prefetcher
+//----------------------------------------------------------------------
+void sim_pipe::set_prefetcher(unsigned policies, unsigned degree, unsigned line_size, unsigned buffer_entries){
+   ASSERT( policies == 0 || dram_model == NULL, "The prefetcher only models the fixed data memory latency" );
+   delete data_prefetcher;
+   data_prefetcher = (policies != 0) ? new prefetcher(policies, degree, line_size, buffer_entries) : NULL;
+}
+
+//----------------------------------------------------------------------
+// Attach a DRAM Timing Model
+//----------------------------------------------------------------------
+void sim_pipe::set_dram(unsigned channels, unsigned banks, unsigned row_size, page_policy_t policy, unsigned t_rcd, unsigned t_cas, unsigned t_rp, unsigned t_burst){
+   ASSERT( data_prefetcher == NULL && issue_width == 1, "The DRAM model is only attached to the scalar in-order memory stage" );
+   delete dram_model;
+   dram_model   = new dram(channels, banks, row_size, policy, t_rcd, t_cas, t_rp, t_burst);
+   dram_request = -1;
+}
+
+//----------------------------------------------------------------------
+// Enable the Decoupled Front-End
+//----------------------------------------------------------------------
+void sim_pipe::set_fetch_queue(unsigned entries, unsigned fetch_cycles){
+   ASSERT( entries == 0 || (issue_width == 1 && fetch_stages + decode_stages == 2), "The fetch queue is only modelled by the scalar pipeline with single-stage fetch and decode" );
+   ASSERT( fetch_cycles > 0, "Unsupported fetch latency (=%d)", fetch_cycles );
+   fetch_queue_size  = entries;
+   this->fetch_cycles = fetch_cycles;
+   fetch_wait        = 0;
+   fetch_queue.clear();
+   fetch_stopped     = false;
+   fetch_eop         = false;
+}
+
+//----------------------------------------------------------------------
+// Set the Pipeline Depth: the sub-stages beyond the first of fetch and
+// decode, and of memory, start out holding bubbles
+//----------------------------------------------------------------------
+void sim_pipe::set_pipeline_depth(unsigned fetch_stages, unsigned decode_stages, unsigned memory_stages){
+   ASSERT( fetch_stages > 0 && decode_stages > 0 && memory_stages > 0, "Unsupported pipeline depth (fetch=%d, decode=%d, memory=%d)", fetch_stages, decode_stages, memory_stages );
+   ASSERT( issue_width == 1 && (fetch_stages + decode_stages == 2 || fetch_queue_size == 0) && (memory_stages == 1 || num_mshrs == 0), "The pipeline depth is only configurable in the scalar pipeline with lock-stepped fetch and a blocking memory stage" );
+   this->fetch_stages   = fetch_stages;
+   this->decode_stages  = decode_stages;
+   this->memory_stages  = memory_stages;
+   fetch_entry_t bubble;
+   bubble.instruction.set_stall();
+   bubble.npc           = UNDEFINED;
+   front_end.assign(fetch_stages + decode_stages - 2, bubble);
+   wb_entry_t empty     = { bubble.instruction, UNDEFINED, UNDEFINED, -1 };
+   memory_pipe.assign(memory_stages - 1, empty);
+   fetch_stopped        = false;
+   fetch_eop            = false;
+}
+
+//----------------------------------------------------------------------
+// Enable Macro-Op Fusion
+//----------------------------------------------------------------------
+void sim_pipe::set_fusion(unsigned idioms){
+   ASSERT( idioms == 0 || issue_width == 1, "Macro-op fusion is only modelled by the scalar pipeline" );
+   fusion_idioms = idioms;
+}
+
+//----------------------------------------------------------------------
+// Fuse "instruction" with the "next" one when the pair is an enabled
+// idiom: the result keeps the branch or load of "next", reading its
+// first source from the ALU operation of "instruction". Returns the
+// idiom, 0 if the pair does not fuse
+//----------------------------------------------------------------------
+unsigned sim_pipe::fuse(instruction_t &instruction, instruction_t next){
+   bool alu_op             = (instruction.opcode >= ADD && instruction.opcode <= AND) || (instruction.opcode >= ADDI && instruction.opcode <= ANDI);
+   unsigned idiom          = 0;
+   if(!alu_op || !next.src1_op || next.src1 != instruction.dest)
+      return 0;
+   if((fusion_idioms & FUSE_COMPARE_BRANCH) && next.opcode >= BEQZ && next.opcode <= BGEZ)
+      idiom                = FUSE_COMPARE_BRANCH;
+   else if((fusion_idioms & FUSE_INCREMENT_LOAD) && (instruction.opcode == ADDI || instruction.opcode == SUBI) && next.opcode == LW)
+      idiom                = FUSE_INCREMENT_LOAD;
+   else
+      return 0;
+   next.fused_opcode       = instruction.opcode;
+   next.fused_dest         = instruction.dest;
+   next.fused_immediate    = instruction.immediate;
+   next.seq                = instruction.seq;
+   next.src1               = instruction.src1;
+   next.src1_op            = instruction.src1_op;
+   next.src2               = instruction.src2;
+   next.src2_op            = instruction.src2_op;
+   instruction             = next;
+   return idiom;
+}
+
+//----------------------------------------------------------------------
+// Returns true while the access of the instruction in MEM is in flight:
+// the fixed latency count, or the DRAM request issued on its first cycle
+//----------------------------------------------------------------------
+bool sim_pipe::memory_busy(unsigned address, bool write){
+   if(dram_model == NULL)
+      return data_memory_latency_count-- != 0;
+   if(dram_request == -1)
+      dram_request = dram_model->enqueue(address, write, cc_count);
+   if(!dram_model->complete(dram_request, cc_count))
+      return true;
+   dram_request = -1;
+   return false;
+}
+
 //----------------------------------------------------------------------
 // Reset the Pipeline
 //----------------------------------------------------------------------
@@ -31,6 +214,7 @@ void sim_pipe::reset(){
    //Reset the General Purpose Registers 
    for(int i = 0; i < NUM_GP_REGISTERS; i++) {
       int_file[i].value = UNDEFINED;
+      int_file[i].busy  = 0;
    }
    //Reset the Special Purpose Registers
    for(int i = 0; i < NUM_STAGES; i++) {
@@ -45,23 +229,109 @@ void sim_pipe::reset(){
 // Run Function
 //----------------------------------------------------------------------
 void sim_pipe::run(unsigned cycles){
+  ASSERT( replay == NULL || (issue_width == 1 && contexts.empty()), "A trace is only replayed by the scalar pipeline" );
+  ASSERT( !steady_state || (issue_width == 1 && contexts.empty() && replay == NULL && caches == NULL && dram_model == NULL && data_prefetcher == NULL && num_mshrs == 0 && store_buffer_size == 0),
+          "Steady-state extrapolation needs the scalar pipeline with the fixed data memory latency" );
+  ASSERT( profiling == NULL || (issue_width == 1 && contexts.empty() && !steady_state), "The profiler needs the scalar pipeline without steady-state extrapolation" );
+  ASSERT( monitoring == NULL || (issue_width == 1 && contexts.empty() && !steady_state), "The PMU needs the scalar pipeline without steady-state extrapolation" );
+  if(issue_width > 1) {
+     run_wide(cycles);
+     return;
+  }
+  if(!contexts.empty()) {
+     run_threads(cycles);
+     return;
+  }
+  if(replay != NULL && cycles == 0 && timed_replay()) {
+     replay_timing();
+     return;
+  }
   bool run_2_completion = (cycles == 0);
   bool stall;  
    while(cycles-- || run_2_completion) {
-      if(MIPS_WB()) return;
+      if(MIPS_WB()) break;
+      if(monitoring != NULL)
+         pmu_cycle();
       if( !MIPS_MEM() ) {
          MIPS_EXE();
          stall = MIPS_ID();
          MIPS_IF(stall);
       }
+      else if(fetch_queue_size > 0)
+         MIPS_IF(true);            // the decoupled front-end keeps fetching while the memory stage stalls
+      else if(replay != NULL) {
+         // replaying a trace, skip the cycles the rest of the memory latency keeps the whole pipeline frozen
+         unsigned skip       = run_2_completion ? frozen_cycles() : min(frozen_cycles(), cycles);
+         if(profiling != NULL && skip > 0)
+            profiling->stall(instruction_register[MEM].pc, STALL_MEMORY, skip);
+         if(monitoring != NULL && skip > 0) {
+            pmu_cycle(skip);
+            monitoring->stall(instruction_register[MEM].pc, STALL_MEMORY, skip);
+         }
+         data_memory_latency_count -= skip;
+         stall_count         += skip;
+         cc_count            += skip;
+         cycles              -= run_2_completion ? 0 : skip;
+      }
       cc_count++;
+      if(steady_head_fetched) {
+         // the loop head was fetched: check for a steady state, and skip the iterations it extrapolates
+         unsigned skip       = steady_checkpoint(run_2_completion ? UINT_MAX : cycles);
+         cycles              -= run_2_completion ? 0 : skip;
+      }
    }
+   if(profiling != NULL)
+      profile_flush();
 }
 
 instruction_t sim_pipe::index_instruction ( unsigned pc ) {
    unsigned index = (pc - this->baseAddress)/4;
    instCount++;
-   return *(instruct_memory[index]);
+   if(replay != NULL) {
+      ASSERT( fetch_seq < replay->size() && replay->get(fetch_seq).pc == pc, "The trace does not follow the pipeline at PC %x", pc );
+      instruction_t instruction = decode_record(fetch_seq);
+      if(instruction.opcode != EOP)
+         fetch_seq++;
+      if(profiling != NULL)
+         profiling->fetch(pc, instruction.seq, cc_count + 1);
+      return instruction;
+   }
+   if(sampling != NULL)
+      sample_fetch_limit += (instruct_memory[index]->opcode == NOP);      // NOPs are not counted by the sampling
+   if(sampling != NULL && (instCount > (int)sample_fetch_limit || instruct_memory[index]->opcode == EOP)) {
+      // end of the sampling unit: the pipeline drains as it does at the end of the program
+      instruction_t stop;
+      stop.opcode        = EOP;
+      instCount         -= (instruct_memory[index]->opcode != EOP);
+      sample_resume_pc   = pc;
+      return stop;
+   }
+   if(steady_state)
+      steady_fetch(pc);
+   instruction_t instruction = *(instruct_memory[index]);
+   instruction.pc            = pc;
+   if(profiling != NULL) {
+      instruction.seq        = fetch_seq;
+      fetch_seq             += (instruction.opcode != EOP);
+      profiling->fetch(pc, instruction.seq, cc_count + 1);
+   }
+   return instruction;
+}
+
+//----------------------------------------------------------------------
+// Instruction following "instruction" (at "npc") in program order
+//----------------------------------------------------------------------
+instruction_t sim_pipe::next_instruction ( instruction_t& instruction, unsigned npc ) {
+   if(replay != NULL)
+      return decode_record(replay_record(instruction.seq) + 1);
+   if(sampling != NULL && npc == sample_resume_pc) {
+      instruction_t stop;                          // the EOP ending the sampling unit, already fetched
+      stop.opcode  = EOP;
+      return stop;
+   }
+   instruction_t next         = *(instruct_memory[(npc - baseAddress)/4]);
+   next.pc                    = npc;
+   return next;
 }
 
 //----------------------------------------------------------------------
@@ -69,43 +339,187 @@ instruction_t sim_pipe::index_instruction ( unsigned pc ) {
 //----------------------------------------------------------------------
 void sim_pipe::MIPS_IF(bool stall) {
    unsigned program_counter         ;
-   instruction_t instruction        ; 
 
    if(sp_registers[MEM][COND] == 1) { 
+    if(steady_state && sp_registers[MEM][ALU_OUTPUT] < sp_registers[IF][PC])
+       steady_loop(sp_registers[MEM][ALU_OUTPUT]);
     sp_registers[IF][PC]      = sp_registers[MEM][ALU_OUTPUT]; 
    }
+   if(fetch_queue_size > 0) {
+      fetch_ahead(stall);
+      return;
+   }
+   if(!front_end.empty()) {
+      if(!stall)
+         advance_front_end();
+      return;
+   }
    program_counter            = sp_registers[IF][PC];
 
    //Check if were not in stall
    if( !stall ){
-    instruction      = index_instruction(program_counter);
-      if(instruction.opcode != EOP )
+    instruction_register[ID]  = index_instruction(program_counter);
+      if(instruction_register[ID].opcode != EOP )
           set_sp_register(PC, IF, program_counter + 4);
           sp_registers[ID][NPC]     = sp_registers[IF][PC];
-          instruction_register[ID]  = instruction;
    }
 }
 
+//----------------------------------------------------------------------
+// Decoupled front-end: fetch runs ahead of decode into the fetch queue,
+// one instruction every fetch_cycles cycles, and stops after a branch
+// until decode accepts an instruction again (the branch has resolved
+// and redirected the PC) or after EOP. Decode takes the head of the
+// queue
+//----------------------------------------------------------------------
+void sim_pipe::fetch_ahead(bool stall) {
+   if(fetch_stopped && !fetch_eop && !stall && fetch_queue.empty())
+      fetch_stopped              = false;
+   if(!fetch_stopped && fetch_queue.size() < fetch_queue_size && ++fetch_wait >= fetch_cycles) {
+      fetch_entry_t entry;
+      unsigned program_counter   = sp_registers[IF][PC];
+      fetch_wait                 = 0;
+      entry.instruction          = index_instruction(program_counter);
+      if(entry.instruction.opcode != EOP)
+         sp_registers[IF][PC]    = program_counter + 4;
+      entry.npc                  = sp_registers[IF][PC];
+      fetch_eop                  = (entry.instruction.opcode == EOP);
+      fetch_stopped              = entry.instruction.branch_op || fetch_eop;
+      fetch_queue.push_back(entry);
+   }
+   if(!stall) {
+      fetch_starved_cycles      += (fetch_queue.empty() && !fetch_eop);
+      if(fetch_queue.empty())
+         instruction_register[ID].set_stall();
+      else {
+         if(profiling != NULL)
+            profiling->leave(fetch_queue.front().instruction.pc, IF, fetch_queue.front().instruction.seq, cc_count + 1);
+         instruction_register[ID]  = fetch_queue.front().instruction;
+         sp_registers[ID][NPC]     = fetch_queue.front().npc;
+         fetch_queue.pop_front();
+      }
+   }
+   fetch_queue_occupancy        += fetch_queue.size();
+   max_fetch_queue_occupancy     = max(max_fetch_queue_occupancy, (unsigned)fetch_queue.size());
+}
+
+//----------------------------------------------------------------------
+// Deeper front-end: the extra fetch and decode sub-stages form a delay
+// line ahead of ID, advancing whenever ID accepts an instruction. Fetch
+// stops after a branch, filling the sub-stages behind it with bubbles,
+// until they have drained and ID accepts again (the branch has resolved
+// and redirected the PC), and after EOP
+//----------------------------------------------------------------------
+void sim_pipe::advance_front_end() {
+   bool drained                 = true;
+   for(unsigned i = 0; i < front_end.size(); i++) {
+      drained                   = drained && front_end[i].instruction.is_stall;
+   }
+   if(fetch_stopped && !fetch_eop && drained)
+      fetch_stopped             = false;
+
+   fetch_entry_t entry;
+   entry.instruction.set_stall();
+   entry.npc                    = UNDEFINED;
+   if(!fetch_stopped) {
+      unsigned program_counter  = sp_registers[IF][PC];
+      entry.instruction         = index_instruction(program_counter);
+      if(entry.instruction.opcode != EOP)
+         sp_registers[IF][PC]   = program_counter + 4;
+      entry.npc                 = sp_registers[IF][PC];
+      fetch_eop                 = (entry.instruction.opcode == EOP);
+      fetch_stopped             = entry.instruction.branch_op || fetch_eop;
+   }
+   else if(!fetch_eop) {
+      stall_count++;            // bubble behind an unresolved branch
+      if(profiling != NULL)
+         profiling->stall(profiling->last_fetch, STALL_CONTROL);
+      if(monitoring != NULL)
+         monitoring->stall(sp_registers[IF][PC] - 4, STALL_CONTROL);
+   }
+   front_end.push_back(entry);
+   if(profiling != NULL)
+      profiling->leave(front_end.front().instruction.pc, IF, front_end.front().instruction.seq, cc_count + 1);
+   instruction_register[ID]     = front_end.front().instruction;
+   sp_registers[ID][NPC]        = front_end.front().npc;
+   front_end.pop_front();
+}
+
+//----------------------------------------------------------------------
+// Drop the second instruction of a fused pair from the front-end: the
+// head of the fetch queue or of the front-end sub-stages, or else the
+// next instruction to fetch
+//----------------------------------------------------------------------
+void sim_pipe::skip_fetch(bool branch) {
+   if(!fetch_queue.empty()) {
+      if(profiling != NULL) {
+         profiling->leave(fetch_queue.front().instruction.pc, IF, fetch_queue.front().instruction.seq, cc_count + 1);
+         profiling->drop(fetch_queue.front().instruction.seq);
+      }
+      fetch_queue.pop_front();
+      return;
+   }
+   if(!front_end.empty()) {
+      if(profiling != NULL) {
+         profiling->leave(front_end.front().instruction.pc, IF, front_end.front().instruction.seq, cc_count + 1);
+         profiling->drop(front_end.front().instruction.seq);
+      }
+      front_end.front().instruction.set_stall();
+      return;
+   }
+   if(steady_state)
+      steady_fetch(sp_registers[IF][PC]);
+   if(profiling != NULL) {
+      profiling->fetch(sp_registers[IF][PC], fetch_seq, cc_count + 1);
+      profiling->drop(fetch_seq);
+   }
+   sp_registers[IF][PC]         += 4;
+   instCount++;
+   fetch_seq++;
+   if(fetch_queue_size > 0)
+      fetch_stopped              = branch;
+}
+
 //----------------------------------------------------------------------
 // MIPS: Instruction Decode
 //----------------------------------------------------------------------
 bool sim_pipe::MIPS_ID() {
-   instruction_t instruction;                   
-   instruction = instruction_register[ID];
+   instruction_t instruction           = instruction_register[ID];
    sp_registers[EX][NPC]               = sp_registers[ID][NPC];
+
+   // Macro-op fusion: decode the instruction together with the next one
+   unsigned fused                      = 0;
+   if(fusion_idioms != 0 && instruction.opcode != NOP && instruction.opcode != EOP)
+      fused                            = fuse(instruction, next_instruction(instruction, sp_registers[ID][NPC]));
    
    // Handling of RAW Data Hazards
    if(( instruction.src1_op && int_file[instruction.src1].busy ) || (instruction.src2_op && int_file[instruction.src2].busy)) {
       stall_count++;
+      if(profiling != NULL)
+         profiling->stall(instruction.pc, STALL_RAW);
+      if(monitoring != NULL)
+         monitoring->stall(instruction.pc, STALL_RAW);
       instruction_register[EX].set_stall();
       clear_sp_register(EX);
       return true;
    }
+
+   if(profiling != NULL)
+      profile_decode(instruction, fused != 0);
     
    //Increment busy to say that the destination register is busy being written to 
    if(instruction.dest_op)
       int_file[instruction.dest].busy++;
 
+   // A fused pair also writes the result of its ALU operation, and fetch skips its second instruction
+   if(fused != 0) {
+      int_file[instruction.fused_dest].busy++;
+      skip_fetch(instruction.branch_op);
+      sp_registers[EX][NPC]            += 4;
+      compare_branch_fusions           += (fused == FUSE_COMPARE_BRANCH);
+      increment_load_fusions           += (fused == FUSE_INCREMENT_LOAD);
+   }
+
     // Set Special Purpose Registers in the Execute Stage
     sp_registers[EX][A]                 = (instruction.src1_op) ? get_gp_register(instruction.src1) : UNDEFINED;
     sp_registers[EX][B]                 = (instruction.src2_op) ? get_gp_register(instruction.src2) : UNDEFINED;
@@ -114,6 +528,10 @@ bool sim_pipe::MIPS_ID() {
    //Checking if we have a Control Hazard
    if(instruction.branch_op) { 
       stall_count++;
+      if(profiling != NULL)
+         profiling->stall(instruction.pc, STALL_CONTROL);
+      if(monitoring != NULL)
+         monitoring->stall(instruction.pc, STALL_CONTROL);
       instruction_register[ID].set_stall();
       clear_sp_register(ID);
       instruction_register[EX]              = instruction;
@@ -121,6 +539,10 @@ bool sim_pipe::MIPS_ID() {
    }
    else if (instruction_register[EX].branch_op) {
       stall_count++;
+      if(profiling != NULL)
+         profiling->stall(instruction_register[EX].pc, STALL_CONTROL);
+      if(monitoring != NULL)
+         monitoring->stall(instruction_register[EX].pc, STALL_CONTROL);
       instruction_register[ID].set_stall();
       clear_sp_register(ID);
       instruction_register[EX]              = instruction;
@@ -143,6 +565,7 @@ unsigned sim_pipe::alu (unsigned value1, unsigned value2, opcode_t opcode){
 
    switch( opcode ){
       case LW ... ADD:
+      case SWAP:
       case ADDI:
       case BEQZ ... NOP:
          output      = value1 + value2;
@@ -187,16 +610,41 @@ unsigned sim_pipe::alu (unsigned value1, unsigned value2, opcode_t opcode){
 // MIPS Execute Stage
 //----------------------------------------------------------------------
 void sim_pipe::MIPS_EXE() {
-   instruction_t instruction;
-
-   instruction  = instruction_register[EX]; 
+   instruction_t instruction  = instruction_register[EX]; 
 
    for(int i = 0; i < NUM_SP_REGISTERS; i++) {
       sp_registers[MEM][i]    = UNDEFINED;
    }
    sp_registers[MEM][COND]    = 0;
    sp_registers[MEM][B]       = sp_registers[EX][B];
-   switch(instruction.opcode) {
+   if(replay != NULL && instruction.pc != UNDEFINED && instruction.opcode != EOP) {
+      // replayed instruction: the outcome comes from the trace (the record of the branch or load of a fused pair)
+      const trace_record_t& record     = replay->get(replay_record(instruction.seq) + (instruction.fused_opcode != NOP));
+      sp_registers[MEM][ALU_OUTPUT]    = record.address;
+      sp_registers[MEM][COND]          = record.taken;
+   }
+   else if(instruction.fused_opcode != NOP) {
+      // fused pair: the ALU operation feeds the first source of the branch or the load
+      instruction.fused_value  = alu(get_gp_register(instruction.src1), instruction.src2_op ? get_gp_register(instruction.src2) : instruction.fused_immediate, instruction.fused_opcode);
+      int value                = instruction.fused_value;
+      bool cond                = false;
+      switch(instruction.opcode) {
+         case BEQZ: cond = value == 0; break;
+         case BNEZ: cond = value != 0; break;
+         case BLTZ: cond = value <  0; break;
+         case BGTZ: cond = value >  0; break;
+         case BLEZ: cond = value <= 0; break;
+         case BGEZ: cond = value >= 0; break;
+         default: break;
+      }
+      if(instruction.opcode == LW)
+         sp_registers[MEM][ALU_OUTPUT] = instruction.immediate + value;
+      else {
+         sp_registers[MEM][ALU_OUTPUT] = alu(sp_registers[EX][NPC], sp_registers[EX][IMM], instruction.opcode);
+         sp_registers[MEM][COND]       = cond;
+      }
+   }
+   else switch(instruction.opcode) {
       case ADD ... DIV:
          sp_registers[MEM][ALU_OUTPUT] = alu(get_gp_register(instruction.src1), 
          get_gp_register(instruction.src2), instruction.opcode);
@@ -209,6 +657,7 @@ void sim_pipe::MIPS_EXE() {
          sp_registers[MEM][ALU_OUTPUT] = address_gen (instruction);
          break;
       case SW:
+      case SWAP:
          sp_registers[MEM][ALU_OUTPUT] = address_gen (instruction);
          break;
       case BEQZ:
@@ -244,14 +693,216 @@ void sim_pipe::MIPS_EXE() {
          break;
    }
    instruction_register[MEM]  = instruction;
-   data_memory_latency_count  = Data_Memory_Latency;
+   if(instruction.opcode == LW)
+      data_memory_latency_count  = load_latency(sp_registers[EX][NPC] - 4, sp_registers[MEM][ALU_OUTPUT]);
+   else if(caches != NULL && (instruction.opcode == SW || instruction.opcode == SWAP))
+      data_memory_latency_count  = caches->access(core_id, sp_registers[MEM][ALU_OUTPUT], true, cc_count);
+   else
+      data_memory_latency_count  = Data_Memory_Latency;
+   if(profiling != NULL)
+      profile_memory(instruction);
+   if(monitoring != NULL)
+      pmu_memory(instruction);
+}
+
+//----------------------------------------------------------------------
+// Cycles the load of "address" waits for data memory: the memory
+// latency, what is left of a prefetch of its line, or the latency of
+// the private L1 of a multicore core
+//----------------------------------------------------------------------
+unsigned sim_pipe::load_latency(unsigned pc, unsigned address) {
+   if(caches != NULL)
+      return caches->access(core_id, address, false, cc_count);
+   return (data_prefetcher != NULL) ? data_prefetcher->access(pc, address, cc_count, Data_Memory_Latency) : Data_Memory_Latency;
+}
+
+//----------------------------------------------------------------------
+// Count down the outstanding misses, releasing the queued loads of
+// every MSHR that completes
+//----------------------------------------------------------------------
+void sim_pipe::tick_mshrs() {
+   for(unsigned i = 0; i < num_mshrs; i++) {
+      if(!mshr_file[i].valid)
+         continue;
+      if(dram_model != NULL ? !dram_model->complete(mshr_file[i].request, cc_count) : --mshr_file[i].latency_count != 0)
+         continue;
+      for(unsigned j = 0; j < wb_queue.size(); j++) {
+         if(wb_queue[j].mshr == (int)i)
+            wb_queue[j].mshr = -1;
+      }
+      mshr_file[i].valid = false;
+   }
+}
+
+//----------------------------------------------------------------------
+// Returns the MSHR tracking "address" (merging with an outstanding miss
+// to the same address), or -1 when all of them are busy
+//----------------------------------------------------------------------
+int sim_pipe::allocate_mshr(unsigned address, unsigned latency) {
+   int free_mshr = -1;
+   for(unsigned i = 0; i < num_mshrs; i++) {
+      if(mshr_file[i].valid && mshr_file[i].address == address) {
+         mshr_merges++;
+         return i;
+      }
+      if(!mshr_file[i].valid && free_mshr == -1)
+         free_mshr = i;
+   }
+   if(free_mshr != -1) {
+      mshr_file[free_mshr].valid         = true;
+      mshr_file[free_mshr].address       = address;
+      mshr_file[free_mshr].latency_count = latency;
+      if(dram_model != NULL)
+         mshr_file[free_mshr].request    = dram_model->enqueue(address, false, cc_count);
+   }
+   return free_mshr;
+}
+
+//----------------------------------------------------------------------
+// Write the oldest buffered store to data memory once its latency has
+// elapsed (one store at a time through the write port)
+//----------------------------------------------------------------------
+void sim_pipe::drain_store_buffer() {
+   store_buffer_occupancy      += store_buffer.size();
+   max_store_buffer_occupancy   = max(max_store_buffer_occupancy, (unsigned)store_buffer.size());
+   if(store_buffer.empty())
+      return;
+   if(dram_model != NULL ? !dram_model->complete(store_buffer.front().request, cc_count) : --store_buffer.front().latency_count != 0)
+      return;
+   write_memory(store_buffer.front().address, store_buffer.front().value);
+   store_buffer.pop_front();
+}
+
+//----------------------------------------------------------------------
+// Look up the youngest buffered store to "address"
+//----------------------------------------------------------------------
+bool sim_pipe::forward_store(unsigned address, unsigned &value) {
+   for(int i = store_buffer.size() - 1; i >= 0; i--) {
+      if(store_buffer[i].address == address) {
+         value = store_buffer[i].value;
+         store_forwarding_hits++;
+         return true;
+      }
+   }
+   return false;
 }
 
 //----------------------------------------------------------------------
 // MIPS Memory Stage
 //----------------------------------------------------------------------
 bool sim_pipe::MIPS_MEM() {
-   instruction_t instruction                   = instruction_register[MEM]; 
+   instruction_t& instruction                  = instruction_register[MEM];
+   bool          forwarded                     = false;
+   unsigned      forwarded_value               = UNDEFINED;
+
+   ASSERT( instruction.opcode != SWAP || (store_buffer_size == 0 && num_mshrs == 0), "SWAP is only modelled by the blocking memory stage" );
+
+  //--------------------------------------------------------------------
+  // Store buffer: a load hitting a buffered store is forwarded, a store
+  // finding the buffer full stalls and EOP waits for the buffer to drain
+  //--------------------------------------------------------------------
+   if(store_buffer_size > 0) {
+      drain_store_buffer();
+      bool hold                                = false;
+      switch(instruction.opcode) {
+         case LW:
+            forwarded                          = forward_store(sp_registers[MEM][ALU_OUTPUT], forwarded_value);
+            break;
+
+         case SW:
+            if(store_buffer.size() == store_buffer_size) {
+               stall_count++;
+               store_buffer_full_stalls++;
+               if(profiling != NULL)
+                  profiling->stall(instruction.pc, STALL_STRUCTURAL);
+               if(monitoring != NULL)
+                  monitoring->stall(instruction.pc, STALL_STRUCTURAL);
+               hold                            = true;
+            }
+            break;
+
+         case EOP:
+            hold                               = !store_buffer.empty();
+            break;
+
+         default: break;
+      }
+      if(hold) {
+         if(num_mshrs == 0) {
+            instruction_register[WB].set_stall();
+            clear_sp_register(WB);
+         }
+         return true;
+      }
+   }
+
+  //--------------------------------------------------------------------
+  // Non-blocking memory stage: a load reads memory on entry, waits for
+  // its data in an MSHR and is queued for in-order write-back while the
+  // rest of the pipeline keeps running
+  //--------------------------------------------------------------------
+   if(num_mshrs > 0) {
+      tick_mshrs();
+
+      wb_entry_t entry;
+      entry.instruction                     = instruction;
+      entry.alu_output                      = sp_registers[MEM][ALU_OUTPUT];
+      entry.lmd                             = UNDEFINED;
+      entry.mshr                            = -1;
+
+      switch(instruction.opcode) {
+         case LW:
+            if(forwarded) {
+               entry.lmd                    = forwarded_value;
+               break;
+            }
+            if(data_memory_latency_count != 0 || dram_model != NULL) {
+               entry.mshr                   = allocate_mshr( sp_registers[MEM][ALU_OUTPUT], data_memory_latency_count );
+               if(entry.mshr == -1) {       // Structural hazard: all MSHRs busy
+                  stall_count++;
+                  mshr_full_stalls++;
+                  if(profiling != NULL)
+                     profiling->stall(instruction.pc, STALL_STRUCTURAL);
+                  if(monitoring != NULL)
+                     monitoring->stall(instruction.pc, STALL_STRUCTURAL);
+                  return true;
+               }
+            }
+            entry.lmd                       = read_memory( sp_registers[MEM][ALU_OUTPUT] );
+            break;
+
+         case SW:
+            if(store_buffer_size > 0 && (Data_Memory_Latency != 0 || dram_model != NULL)) {
+               store_entry_t store          = { sp_registers[MEM][ALU_OUTPUT], (unsigned)get_gp_register(instruction.src2), Data_Memory_Latency, -1 };
+               store_buffer.push_back(store);
+               if(dram_model != NULL)
+                  store_buffer.back().request = dram_model->enqueue(store.address, true, cc_count);
+               break;
+            }
+            if(memory_busy(sp_registers[MEM][ALU_OUTPUT], true)){ // Introduce Data Memory Latency
+               stall_count++;
+               if(profiling != NULL)
+                  profiling->stall(instruction.pc, STALL_MEMORY);
+               if(monitoring != NULL)
+                  monitoring->stall(instruction.pc, STALL_MEMORY);
+               return true;
+            }
+            write_memory(sp_registers[MEM][ALU_OUTPUT], get_gp_register(instruction.src2));
+            break;
+
+         default: break;
+      }
+      if(instruction.opcode != NOP)          // bubbles do not occupy the write-back queue
+         wb_queue.push_back(entry);
+
+      unsigned outstanding                  = 0;
+      for(unsigned j = 0; j < wb_queue.size(); j++) {
+         outstanding                       += (wb_queue[j].mshr != -1);
+      }
+      max_outstanding_loads                 = max(max_outstanding_loads, outstanding);
+      return false;
+   }
+
    sp_registers[WB][LMD]                       = UNDEFINED;
 
   //--------------------------------------------------------------------
@@ -259,8 +910,16 @@ bool sim_pipe::MIPS_MEM() {
   //--------------------------------------------------------------------
    switch(instruction.opcode) {
       case LW:
-         while(data_memory_latency_count--){ // Introduce Data Memory Latency
+         if(forwarded) {
+            sp_registers[WB][LMD]            = forwarded_value;
+            break;
+         }
+         if(memory_busy(sp_registers[MEM][ALU_OUTPUT], false)){ // Introduce Data Memory Latency
             stall_count++;
+            if(profiling != NULL)
+               profiling->stall(instruction.pc, STALL_MEMORY);
+            if(monitoring != NULL)
+               monitoring->stall(instruction.pc, STALL_MEMORY);
             instruction_register[WB].set_stall();
             clear_sp_register(WB);
             return true;
@@ -269,8 +928,19 @@ bool sim_pipe::MIPS_MEM() {
          break;
 
       case SW:
-         while(data_memory_latency_count--){ // Introduce Data Memory Latency
+         if(store_buffer_size > 0 && (Data_Memory_Latency != 0 || dram_model != NULL)) {
+            store_entry_t store              = { sp_registers[MEM][ALU_OUTPUT], (unsigned)get_gp_register(instruction.src2), Data_Memory_Latency, -1 };
+            store_buffer.push_back(store);
+            if(dram_model != NULL)
+               store_buffer.back().request = dram_model->enqueue(store.address, true, cc_count);
+            break;
+         }
+         if(memory_busy(sp_registers[MEM][ALU_OUTPUT], true)){ // Introduce Data Memory Latency
             stall_count++;
+            if(profiling != NULL)
+               profiling->stall(instruction.pc, STALL_MEMORY);
+            if(monitoring != NULL)
+               monitoring->stall(instruction.pc, STALL_MEMORY);
             instruction_register[WB].set_stall();
             clear_sp_register(WB);
             return true;
@@ -278,6 +948,32 @@ bool sim_pipe::MIPS_MEM() {
          write_memory(sp_registers[MEM][ALU_OUTPUT], get_gp_register(instruction.src2));
          break;
 
+      case SWAP:                                // atomic: the read and the write take place in the same cycle
+         if((!atomic_issued && memory_busy(sp_registers[MEM][ALU_OUTPUT], true)) || (deferred && !atomic_ready)){
+            if(deferred && !atomic_issued){     // running a quantum: the swap takes place at its end
+               memory_event_t event          = {(unsigned)cc_count, core_id, sp_registers[MEM][ALU_OUTPUT], (unsigned)get_gp_register(instruction.src2), true};
+               memory_events.push_back(event);
+               atomic_issued                 = true;
+            }
+            stall_count++;
+            if(profiling != NULL)
+               profiling->stall(instruction.pc, STALL_MEMORY);
+            if(monitoring != NULL)
+               monitoring->stall(instruction.pc, STALL_MEMORY);
+            instruction_register[WB].set_stall();
+            clear_sp_register(WB);
+            return true;
+         }
+         if(atomic_ready){
+            sp_registers[WB][LMD]            = atomic_value;
+            atomic_issued                    = false;
+            atomic_ready                     = false;
+         } else {
+            sp_registers[WB][LMD]            = read_memory( sp_registers[MEM][ALU_OUTPUT] );
+            write_memory(sp_registers[MEM][ALU_OUTPUT], get_gp_register(instruction.src2));
+         }
+         break;
+
       default: break;
    }
    instruction_register[WB]                  = instruction;
@@ -289,16 +985,53 @@ bool sim_pipe::MIPS_MEM() {
 // MIPS Writeback Stage
 //----------------------------------------------------------------------
 bool sim_pipe::MIPS_WB() {
-  instruction_t instruction; 
-  instruction = instruction_register[WB];
+
+  //Non-blocking memory stage: retire the head of the write-back queue once its data is back
+  if(num_mshrs > 0) {
+    if(wb_queue.empty() || wb_queue.front().mshr != -1) {
+      instruction_register[WB].set_stall();
+      clear_sp_register(WB);
+      return false;
+    }
+    instruction_register[WB]        = wb_queue.front().instruction;
+    sp_registers[WB][ALU_OUTPUT]    = wb_queue.front().alu_output;
+    sp_registers[WB][LMD]           = wb_queue.front().lmd;
+    wb_queue.pop_front();
+  }
+  //Deeper memory pipeline: the result leaving MEM reaches WB after the extra memory sub-stages
+  if(!memory_pipe.empty()) {
+    wb_entry_t entry                = { instruction_register[WB], sp_registers[WB][ALU_OUTPUT], sp_registers[WB][LMD], -1 };
+    memory_pipe.push_back(entry);
+    instruction_register[WB]        = memory_pipe.front().instruction;
+    sp_registers[WB][ALU_OUTPUT]    = memory_pipe.front().alu_output;
+    sp_registers[WB][LMD]           = memory_pipe.front().lmd;
+    memory_pipe.pop_front();
+  }
+  instruction_t& instruction        = instruction_register[WB];
+
+  //Steady-state extrapolation: the instruction (both of a fused pair) is no longer in flight
+  if(steady_state && instruction.opcode != NOP && instruction.opcode != EOP)
+    steady_in_flight.erase(steady_in_flight.begin(), steady_in_flight.begin() + min((size_t)(instruction.fused_opcode != NOP ? 2 : 1), steady_in_flight.size()));
+
+  //Sampled simulation: the instruction (both of a fused pair) commits
+  if(sampling != NULL && instruction.opcode != NOP && instruction.opcode != EOP)
+    sample_commit(instruction.fused_opcode != NOP ? 2 : 1);
+
+  //Profile: the instruction leaves MEM for WB (EOP ends the run)
+  if(profiling != NULL)
+    profile_write_back(instruction);
    
   //If End of Operation Return
   if (instruction.opcode == EOP){
     return true;
   }
+  if(monitoring != NULL && instruction.opcode != NOP)
+    pmu_retire(instruction);
   //else Writeback to the General Purpose Register
+  if(instruction.fused_opcode != NOP)
+     set_gp_register(instruction.fused_dest, instruction.fused_value);
   if(instruction.dest_op) {
-     set_gp_register(instruction.dest, (instruction.opcode == LW) ? sp_registers[WB][LMD] : sp_registers[WB][ALU_OUTPUT]);
+     set_gp_register(instruction.dest, (instruction.opcode == LW || instruction.opcode == SWAP) ? sp_registers[WB][LMD] : sp_registers[WB][ALU_OUTPUT]);
   }
   return false;
 }
@@ -307,10 +1040,27 @@ bool sim_pipe::MIPS_WB() {
 sim_pipe::~sim_pipe(){
 }
 
-void sim_pipe::load_program(const char *filename, unsigned base_address){
-   parse(filename);
+void sim_pipe::load_program(const char *filename, unsigned base_address, unsigned thread){
+   ASSERT( thread == 0 || thread < contexts.size(), "Hardware thread %d does not exist", thread );
+   if(thread > 0) {
+      // parse() builds the program in instruct_memory
+      instruction_pointer *program         = instruct_memory;
+      instruct_memory                      = NULL;
+      program::is_object(filename) ? load_object(filename) : parse(filename);
+      contexts[thread].instruct_memory     = instruct_memory;
+      contexts[thread].base_address        = base_address;
+      contexts[thread].pc                  = base_address;
+      instruct_memory                      = program;
+      return;
+   }
+   program::is_object(filename) ? load_object(filename) : parse(filename);
    sp_registers[IF][PC]   = base_address;
    baseAddress            = base_address;
+   if(!contexts.empty()) {
+      contexts[0].instruct_memory          = instruct_memory;
+      contexts[0].base_address             = base_address;
+      contexts[0].pc                       = base_address;
+   }
 }
 
 //----------------------------------------------------------------------
@@ -339,17 +1089,20 @@ unsigned sim_pipe::get_sp_register(sp_register_t reg, stage_t s){
 //----------------------------------------------------------------------
 // Returns value of general purpose register
 //----------------------------------------------------------------------
-int sim_pipe::get_gp_register(unsigned reg){
-   return this->int_file[reg].value;
+int sim_pipe::get_gp_register(unsigned reg, unsigned thread){
+   ASSERT( thread == 0 || thread < contexts.size(), "Hardware thread %d does not exist", thread );
+   return (thread == 0) ? this->int_file[reg].value : contexts[thread].int_file[reg].value;
 }
 
 //----------------------------------------------------------------------
 // Sets value of general purpose register
 //----------------------------------------------------------------------
-void sim_pipe::set_gp_register(unsigned reg, int value){
-   this->int_file[reg].value         = value;
-   if( this->int_file[reg].busy != 0 )
-      this->int_file[reg].busy--;
+void sim_pipe::set_gp_register(unsigned reg, int value, unsigned thread){
+   ASSERT( thread == 0 || thread < contexts.size(), "Hardware thread %d does not exist", thread );
+   int_file_t *file                  = (thread == 0) ? this->int_file : contexts[thread].int_file;
+   file[reg].value                   = value;
+   if( file[reg].busy != 0 )
+      file[reg].busy--;
 }
 
 //----------------------------------------------------------------------
@@ -363,6 +1116,12 @@ float sim_pipe::get_IPC(){
 // Returns Total Instructions Executed
 //----------------------------------------------------------------------
 unsigned sim_pipe::get_instructions_executed(){
+   if(!contexts.empty()) {
+      unsigned instructions = 0;
+      for(unsigned i = 0; i < contexts.size(); i++)
+         instructions += contexts[i].instructions;
+      return instructions;
+   }
    return instCount - 1; 
 }
 
@@ -380,6 +1139,146 @@ unsigned sim_pipe::get_clock_cycles(){
    return cc_count; 
 }
 
+//----------------------------------------------------------------------
+// Returns Stalls caused by all MSHRs being busy
+//----------------------------------------------------------------------
+unsigned sim_pipe::get_mshr_full_stalls(){
+   return mshr_full_stalls;
+}
+
+//----------------------------------------------------------------------
+// Returns Loads merged into an outstanding MSHR
+//----------------------------------------------------------------------
+unsigned sim_pipe::get_mshr_merges(){
+   return mshr_merges;
+}
+
+//----------------------------------------------------------------------
+// Returns the peak number of outstanding loads
+//----------------------------------------------------------------------
+unsigned sim_pipe::get_max_outstanding_loads(){
+   return max_outstanding_loads;
+}
+
+//----------------------------------------------------------------------
+// Returns Stalls caused by a full store buffer
+//----------------------------------------------------------------------
+unsigned sim_pipe::get_store_buffer_full_stalls(){
+   return store_buffer_full_stalls;
+}
+
+//----------------------------------------------------------------------
+// Returns Loads forwarded from the store buffer
+//----------------------------------------------------------------------
+unsigned sim_pipe::get_store_forwarding_hits(){
+   return store_forwarding_hits;
+}
+
+//----------------------------------------------------------------------
+// Returns the average store buffer occupancy per clock cycle
+//----------------------------------------------------------------------
+float sim_pipe::get_store_buffer_avg_occupancy(){
+   return cc_count ? (float) store_buffer_occupancy / (float) cc_count : 0;
+}
+
+//----------------------------------------------------------------------
+// Returns the peak store buffer occupancy
+//----------------------------------------------------------------------
+unsigned sim_pipe::get_store_buffer_max_occupancy(){
+   return max_store_buffer_occupancy;
+}
+
+//----------------------------------------------------------------------
+// Prefetcher statistics (0 without a prefetcher)
+//----------------------------------------------------------------------
+float sim_pipe::get_prefetch_accuracy(){
+   return (data_prefetcher != NULL) ? data_prefetcher->get_accuracy() : 0;
+}
+
+float sim_pipe::get_prefetch_coverage(){
+   return (data_prefetcher != NULL) ? data_prefetcher->get_coverage() : 0;
+}
+
+float sim_pipe::get_prefetch_timeliness(){
+   return (data_prefetcher != NULL) ? data_prefetcher->get_timeliness() : 0;
+}
+
+//----------------------------------------------------------------------
+// DRAM statistics (0 without a DRAM model)
+//----------------------------------------------------------------------
+unsigned sim_pipe::get_dram_row_hits(){
+   return (dram_model != NULL) ? dram_model->get_row_hits() : 0;
+}
+
+unsigned sim_pipe::get_dram_row_misses(){
+   return (dram_model != NULL) ? dram_model->get_row_misses() : 0;
+}
+
+unsigned sim_pipe::get_dram_row_conflicts(){
+   return (dram_model != NULL) ? dram_model->get_row_conflicts() : 0;
+}
+
+float sim_pipe::get_dram_avg_latency(){
+   return (dram_model != NULL) ? dram_model->get_avg_latency() : 0;
+}
+
+//----------------------------------------------------------------------
+// Returns the average fetch queue occupancy per clock cycle
+//----------------------------------------------------------------------
+float sim_pipe::get_fetch_queue_avg_occupancy(){
+   return cc_count ? (float) fetch_queue_occupancy / (float) cc_count : 0;
+}
+
+//----------------------------------------------------------------------
+// Returns the peak fetch queue occupancy
+//----------------------------------------------------------------------
+unsigned sim_pipe::get_fetch_queue_max_occupancy(){
+   return max_fetch_queue_occupancy;
+}
+
+//----------------------------------------------------------------------
+// Returns the cycles decode found the fetch queue empty
+//----------------------------------------------------------------------
+unsigned sim_pipe::get_fetch_starved_cycles(){
+   return fetch_starved_cycles;
+}
+
+//----------------------------------------------------------------------
+// Returns the instruction pairs fused with the given idiom
+//----------------------------------------------------------------------
+unsigned sim_pipe::get_fusion_hits(fusion_idiom_t idiom){
+   return (idiom == FUSE_COMPARE_BRANCH) ? compare_branch_fusions : increment_load_fusions;
+}
+
+//----------------------------------------------------------------------
+// Returns the cycles in which the superscalar core issued a group of
+// the given size
+//----------------------------------------------------------------------
+unsigned sim_pipe::get_issue_histogram(unsigned instructions){
+   return instructions < issue_histogram.size() ? issue_histogram[instructions] : 0;
+}
+
+//----------------------------------------------------------------------
+// Per-thread statistics of the multithreaded core
+//----------------------------------------------------------------------
+unsigned sim_pipe::get_thread_instructions(unsigned thread){
+   ASSERT( thread < contexts.size(), "Hardware thread %d does not exist", thread );
+   return contexts[thread].instructions;
+}
+
+unsigned sim_pipe::get_thread_cycles(unsigned thread){
+   ASSERT( thread < contexts.size(), "Hardware thread %d does not exist", thread );
+   return contexts[thread].done ? contexts[thread].finish_cycle : cc_count;
+}
+
+float sim_pipe::get_thread_IPC(unsigned thread){
+   return get_thread_cycles(thread) ? (float) get_thread_instructions(thread) / (float) get_thread_cycles(thread) : 0;
+}
+
+unsigned sim_pipe::get_thread_switches(){
+   return thread_switches;
+}
+
 int sim_pipe::labelToPC( const char* filename, const char* label, unsigned pc_index ){
    FILE* temp  = fopen(filename, "r");
    int line    = 0;
@@ -399,12 +1298,32 @@ int sim_pipe::labelToPC( const char* filename, const char* label, unsigned pc_in
    return ((line - pc_index - 1) * 4);
 }
 
+void sim_pipe::scan_labels(const char *filename, map<string, unsigned>& labels){
+   FILE* temp     = fopen(filename, "r");
+   ASSERT(temp, "Unable to open file %s", filename);
+   unsigned line  = 0;
+   char str[4096];
+   while(fscanf(temp, "%4095s", str) == 1){
+      unsigned length = strlen(str);
+      if(str[length-1] == ':'){
+         str[length-1] = '\0';
+         labels.insert(make_pair(string(str), line));
+      }
+      if( opcode_2str.count( string( str ) ) > 0 )
+         line++;
+   }
+   fclose(temp);
+}
+
 int sim_pipe::parse( const char* filename ){
    FILE* trace;
    char buff[4096], label[1024];
    int a, b, c, lineNo = 0;
    char imm[100];
+   map<string, unsigned> labels;
 
+   // labels are resolved from a single scan of the file; labelToPC() handles the ones never defined
+   scan_labels(filename, labels);
    trace  = fopen(filename, "r");
 
    do {
@@ -436,7 +1355,7 @@ int sim_pipe::parse( const char* filename ){
             fscanf(trace, "R%d %s", &a, label);
             
             instructP->src1       = a;
-            instructP->immediate  = labelToPC( filename, label, lineNo );
+            instructP->immediate  = labels.count(label) ? (labels[label] - lineNo - 1) * 4 : labelToPC( filename, label, lineNo );
             instructP->src1_op  = true;
             instructP->branch_op  = true;
             break;
@@ -458,7 +1377,7 @@ int sim_pipe::parse( const char* filename ){
 
          case JUMP:
             fscanf(trace, "%s", label);
-            instructP->immediate  = labelToPC( filename, label, lineNo );
+            instructP->immediate  = labels.count(label) ? (labels[label] - lineNo - 1) * 4 : labelToPC( filename, label, lineNo );
             instructP->branch_op  = true;
             break;
 
@@ -480,6 +1399,17 @@ int sim_pipe::parse( const char* filename ){
             instructP->src1_op  = true;
             break;
 
+         case SWAP:
+            fscanf(trace, "R%d %d(R%d)", &a, &b, &c);
+            instructP->dest        = a;
+            instructP->src2       = a;
+            instructP->immediate  = b;
+            instructP->src1       = c;
+            instructP->dest_op  = true;
+            instructP->src2_op  = true;
+            instructP->src1_op  = true;
+            break;
+
          case EOP:
          case NOP:
             break;
@@ -498,6 +1428,8 @@ int sim_pipe::parse( const char* filename ){
 // Read Memory
 //----------------------------------------------------------------------
 unsigned sim_pipe::read_memory(unsigned address){
+   if(deferred && own_writes.count(address))
+      return own_writes[address];
    unsigned value = 0;
    value |= data_memory[address + 0];
    value |= data_memory[address + 1] << 8;  
@@ -511,6 +1443,12 @@ unsigned sim_pipe::read_memory(unsigned address){
 //----------------------------------------------------------------------
 void sim_pipe::write_memory(unsigned address, unsigned value){
    ASSERT( address % 4 == 0, "Unaligned memory access found at address %x", address ); 
+   if(deferred){
+      memory_event_t event = {(unsigned)cc_count, core_id, address, value, false};
+      memory_events.push_back(event);
+      own_writes[address] = value;
+      return;
+   }
    data_memory[address + 0] = value;
    data_memory[address + 1] = value >> 8;
    data_memory[address + 2] = value >> 16;
@@ -13,7 +13,9 @@
 #include <malloc.h>
 
 #include <vector>
+#include <deque>
 #include <algorithm>
+#include <climits>
 
 #define UNDEFINED 0xFFFFFFFF //constant used to initialize registers
 #define NUM_SP_REGISTERS 9
@@ -21,20 +23,34 @@
 #define NUM_OPCODES 16
 #define NUM_STAGES 5
 
-#define ASSERT( condition, statement, ... ) \
-   if( !(condition) ) { \
-      printf( "[ASSERT] In File: %s, Line: %d => " #statement "\n", __FILE__, __LINE__, ##__VA_ARGS__ ); \
-      abort(); \
-   }
+#include "sim_assert.h"
+
+#include "prefetcher.h"
+#include "dram.h"
+#include "coherence.h"
+#include "barrier.h"
+#include "trace.h"
+#include "program.h"
+#include "sampler.h"
+#include "simpoint.h"
+#include "profiler.h"
+#include "pmu.h"
 
 using namespace std;
 typedef enum {PC, NPC, IR, A, B, IMM, COND, ALU_OUTPUT, LMD} sp_register_t;
 
-typedef enum {LW, SW, ADD, SUB, XOR, OR, AND, MULT, DIV, ADDI, SUBI, XORI, ORI, ANDI, BEQZ, BNEZ, BLTZ, BGTZ, BLEZ, BGEZ, JUMP, EOP, NOP} opcode_t;
-const string opcode_str[] = {"LW", "SW", "ADD", "SUB", "XOR", "OR", "AND", "MULT", "DIV", "ADDI", "SUBI", "XORI", "ORI", "ANDI", "BEQZ", "BNEZ", "BLTZ", "BGTZ", "BLEZ", "BGEZ", "JUMP", "EOP", "NOP"};
+typedef enum {LW, SW, ADD, SUB, XOR, OR, AND, MULT, DIV, ADDI, SUBI, XORI, ORI, ANDI, BEQZ, BNEZ, BLTZ, BGTZ, BLEZ, BGEZ, JUMP, EOP, NOP, SWAP} opcode_t;
+const string opcode_str[] = {"LW", "SW", "ADD", "SUB", "XOR", "OR", "AND", "MULT", "DIV", "ADDI", "SUBI", "XORI", "ORI", "ANDI", "BEQZ", "BNEZ", "BLTZ", "BGTZ", "BLEZ", "BGEZ", "JUMP", "EOP", "NOP", "SWAP"};
 
 typedef enum {IF, ID, EX, MEM, WB} stage_t;
 
+// Macro-op fusion idioms recognised at decode, combined as a bit mask
+typedef enum {FUSE_COMPARE_BRANCH = 1, FUSE_INCREMENT_LOAD = 2} fusion_idiom_t;
+
+// Thread scheduling of the multithreaded core: a different thread every cycle, a thread until it waits for
+// data memory, or several threads issuing in the same cycle
+typedef enum {ROUND_ROBIN, SWITCH_ON_STALL, SIMULTANEOUS} thread_policy_t;
+
 typedef struct instruction_t* instruction_pointer;
 
 struct instruction_t{
@@ -48,6 +64,14 @@ struct instruction_t{
    bool               src2_op;
    bool               branch_op;
    bool               is_stall;
+   opcode_t           fused_opcode;     // ALU operation fused in front of the instruction (NOP if none); its
+   unsigned           fused_dest;       // result is written to fused_dest and replaces the first source
+   unsigned           fused_immediate;
+   unsigned           fused_value;
+   unsigned           pc;               // address the instruction was fetched from (UNDEFINED for bubbles)
+   unsigned           seq;              // number of the dynamic instruction, when replaying a trace (the low 32 bits
+                                        // of its record) or profiling (the key of its stamps); a fused pair has the
+                                        // one of its first
 
    instruction_t(){
       no_operation();
@@ -64,6 +88,12 @@ struct instruction_t{
       src2_op    = false;
       is_stall   = false;
       branch_op  = false;
+      fused_opcode    = NOP;
+      fused_dest      = UNDEFINED;
+      fused_immediate = UNDEFINED;
+      fused_value     = UNDEFINED;
+      pc              = UNDEFINED;
+      seq             = UNDEFINED;
    }
 
    void set_stall(){
@@ -81,6 +111,94 @@ public:
       int            busy;
    };
 
+   // Miss Status Holding Register: one outstanding load to data memory
+   struct mshr_t{
+      bool           valid;
+      unsigned       address;
+      unsigned       latency_count;
+      int            request;       // DRAM request of the miss
+   };
+
+   // Store retired into the store buffer, waiting to be written to data memory
+   struct store_entry_t{
+      unsigned       address;
+      unsigned       value;
+      unsigned       latency_count;
+      int            request;       // DRAM request of the write, -1 without a DRAM model
+   };
+
+   // Entry of the in-order write-back queue used by the non-blocking memory stage
+   struct wb_entry_t{
+      instruction_t  instruction;
+      unsigned       alu_output;
+      unsigned       lmd;
+      int            mshr;          // MSHR the entry waits on, -1 once the result is ready
+   };
+
+   // Instruction waiting in the fetch queue of the decoupled front-end
+   struct fetch_entry_t{
+      instruction_t  instruction;
+      unsigned       npc;
+   };
+
+   // Instruction slot of a pipeline latch of the superscalar core
+   struct wide_slot_t{
+      instruction_t  instruction;
+      unsigned       npc;
+      unsigned       alu_output;
+      unsigned       lmd;
+   };
+
+   // Instruction slot of the multithreaded core, tagged with its hardware thread
+   struct thread_slot_t{
+      instruction_t  instruction;
+      unsigned       thread;
+      unsigned       npc;
+      unsigned       alu_output;
+      unsigned       lmd;
+      bool           cond;
+      unsigned       ready_cycle;   // cycle the data memory access of a parked load/store completes
+   };
+
+   // Pipeline state at a fetch of a loop head, and the counters the iterations that follow add to
+   struct steady_checkpoint_t{
+      bool           valid;
+      vector<unsigned> key;           // latches, busy registers, memory latency count, front-end, instructions in flight
+      unsigned       cycles;
+      unsigned       stalls;
+      unsigned       fetches;
+      unsigned       starved_cycles;
+      unsigned long  queue_occupancy;
+      unsigned       compare_branch_fusions;
+      unsigned       increment_load_fusions;
+   };
+
+   // Loop iterations extrapolated in one step
+   struct steady_state_event_t{
+      unsigned       head;          // PC of the loop head
+      unsigned       cycle;         // clock cycle the pipeline was found in steady state
+      unsigned       iterations;
+      unsigned       cycles;        // per iteration
+      unsigned       stalls;
+      unsigned       instructions;
+   };
+
+   // Hardware thread context: architectural state, program and fetch state of one thread
+   struct thread_context_t{
+      int_file_t           *int_file;         // thread 0 runs on the simulator register file
+      instruction_pointer  *instruct_memory;
+      unsigned             base_address;
+      unsigned             pc;
+      bool                 has_fetched;
+      thread_slot_t        fetched;           // instruction waiting to issue
+      bool                 branch_pending;    // fetch waits for a branch to resolve
+      bool                 eop_fetched;
+      unsigned             memory_pending;    // loads/stores waiting for data memory
+      bool                 done;
+      unsigned             instructions;
+      unsigned             finish_cycle;
+   };
+
    int                  cc_count;
    int                  instCount;
    int                  stall_count;
@@ -100,25 +218,293 @@ public:
    unsigned             Data_Memory_Latency;
    unsigned             data_memory_latency_count;
 
+   // Non-blocking memory stage (disabled when num_mshrs == 0)
+   unsigned             num_mshrs;
+   mshr_t               *mshr_file;
+   deque<wb_entry_t>    wb_queue;
+   unsigned             mshr_full_stalls;
+   unsigned             mshr_merges;
+   unsigned             max_outstanding_loads;
+
+   // Data prefetcher (disabled when NULL)
+   prefetcher           *data_prefetcher;
+
+   // DRAM timing model replacing the fixed data memory latency (disabled when NULL)
+   dram                 *dram_model;
+   int                  dram_request;             // access of the instruction in MEM, -1 if none
+
+   // Store buffer (disabled when store_buffer_size == 0)
+   unsigned             store_buffer_size;
+   deque<store_entry_t> store_buffer;
+   unsigned             store_buffer_full_stalls;
+   unsigned             store_forwarding_hits;
+   unsigned long        store_buffer_occupancy;
+   unsigned             max_store_buffer_occupancy;
+
+   // Decoupled front-end (disabled when fetch_queue_size == 0)
+   unsigned             fetch_queue_size;
+   unsigned             fetch_cycles;
+   unsigned             fetch_wait;               // cycles spent on the access under way
+   deque<fetch_entry_t> fetch_queue;
+   bool                 fetch_stopped;            // fetch waits for a branch to resolve, or has reached EOP
+   bool                 fetch_eop;
+   unsigned             fetch_starved_cycles;
+   unsigned long        fetch_queue_occupancy;
+   unsigned             max_fetch_queue_occupancy;
+
+   // Deeper pipeline: the extra fetch/decode sub-stages ahead of ID and the extra memory sub-stages ahead of WB
+   unsigned             fetch_stages;
+   unsigned             decode_stages;
+   unsigned             memory_stages;
+   deque<fetch_entry_t> front_end;                // oldest first
+   deque<wb_entry_t>    memory_pipe;              // oldest first
+
+   // Superscalar core (used when issue_width > 1)
+   unsigned             issue_width;
+   unsigned             issue_mem_ops;
+   unsigned             issue_alu_ops;
+   unsigned             wb_ports;
+   vector<wide_slot_t>  wide_latch[NUM_STAGES];   // fetch group waiting in ID, groups entering EX/MEM/WB
+   bool                 wide_branch_in_ex;
+   bool                 wide_eop_issued;
+   vector<unsigned>     issue_histogram;
+
+   // Macro-op fusion at decode (disabled when fusion_idioms == 0)
+   unsigned             fusion_idioms;
+   unsigned             compare_branch_fusions;
+   unsigned             increment_load_fusions;
+
+   // Multithreaded core (used when contexts is not empty)
+   thread_policy_t      thread_policy;
+   unsigned             thread_issue_slots;
+   unsigned             switch_penalty;
+   vector<thread_context_t> contexts;
+   vector<thread_slot_t> thread_latch[NUM_STAGES];   // groups entering EX/MEM/WB
+   vector<thread_slot_t> parked;                     // loads/stores waiting for data memory, oldest first
+   unsigned             current_thread;              // thread issued last (running thread when switching on stall)
+   unsigned             switch_wait;                 // cycles left of a thread switch
+   unsigned             thread_switches;
+
+   // Private L1 of a core of a multicore system (disabled when NULL)
+   coherence            *caches;
+   unsigned             core_id;
+
+   // Relaxed quantum run on a host thread of its own: the writes to the shared data memory are logged (and forwarded
+   // to the later loads of the core), and a SWAP waits for its old value until the end of the quantum
+   bool                 deferred;
+   vector<memory_event_t> memory_events;
+   map<unsigned, unsigned> own_writes;
+   bool                 atomic_issued;
+   bool                 atomic_ready;
+   unsigned             atomic_value;
+
+   // Trace replayed instead of the program (disabled when NULL), and the number of the next instruction fetched in
+   // program order (its trace record), counted when replaying or profiling
+   trace                *replay;
+   uint64_t             fetch_seq;
+
+   // Steady-state extrapolation of loops (disabled when steady_state is false): the PCs of the instructions fetched
+   // and not yet written back, the target of the last backward branch taken, the PCs fetched since its last fetch
+   // and the pipeline state then
+   bool                 steady_state;
+   deque<unsigned>      steady_in_flight;         // oldest first, NOP and EOP left out
+   unsigned             steady_head;
+   bool                 steady_head_fetched;
+   vector<unsigned>     steady_path;
+   bool                 steady_path_valid;
+   steady_checkpoint_t  steady_last;
+   vector<steady_state_event_t> steady_state_log;
+
+   // Sampled simulation (disabled when sampling is NULL): fetch stops the unit simulated in detail with an EOP past
+   // "sample_fetch_limit" instructions fetched, and the unit counts the instructions it commits
+   sampler              *sampling;
+   unsigned             sample_fetch_limit;
+   unsigned             sample_resume_pc;         // PC of the EOP that stopped the unit
+   unsigned             sample_commits;
+   unsigned             sample_start_cycle;       // commit of the last warm-up instruction
+   unsigned             sample_end_cycle;         // commit of the last measured instruction
+
+   // Per-instruction profile of the scalar pipeline (disabled when NULL)
+   profiler             *profiling;
+
+   // Performance monitoring unit of the scalar pipeline (disabled when NULL)
+   pmu                  *monitoring;
+
    sim_pipe(unsigned data_mem_size, unsigned data_mem_latency);
 
    ~sim_pipe();
    instruction_t index_instruction ( unsigned pc );
+   instruction_t next_instruction ( instruction_t& instruction, unsigned npc );
+   instruction_t decode_record ( uint64_t index );
+   uint64_t replay_record ( unsigned seq );
+   unsigned frozen_cycles();
+   bool     timed_replay();
+   void     replay_timing();
+   void     steady_fetch(unsigned pc);
+   void     steady_loop(unsigned head);
+   unsigned steady_checkpoint(unsigned budget);
+   steady_checkpoint_t steady_snapshot();
+   unsigned extrapolate(unsigned max_iterations);
+   unsigned functional_step(unsigned pc, int *regs, bool memory, unsigned &alu_output, unsigned &lmd, bool &cond, deque<pair<unsigned, unsigned> > *undo=NULL);
+   bool     fast_forward(unsigned &pc, unsigned instructions, simpoint *profile=NULL);
+   bool     sample_unit(unsigned &pc);
+   void     sample_commit(unsigned instructions);
+   void     restart(unsigned pc);
+   void     profile_decode(instruction_t& instruction, bool fused);
+   void     profile_memory(instruction_t& instruction);
+   void     profile_write_back(instruction_t& instruction);
+   void     profile_flush();
+   void     pmu_cycle(unsigned cycles=1);
+   void     pmu_memory(const instruction_t& instruction);
+   void     pmu_retire(const instruction_t& instruction);
 
    void     MIPS_IF(bool stall);
+   void     fetch_ahead(bool stall);
+   void     advance_front_end();
+   void     skip_fetch(bool branch);
    bool     MIPS_ID(); 
    void     MIPS_EXE();
    bool     MIPS_MEM();
    bool     MIPS_WB();
 
+   void     tick_mshrs();
+   int      allocate_mshr(unsigned address, unsigned latency);
+   unsigned load_latency(unsigned pc, unsigned address);
+   bool     memory_busy(unsigned address, bool write);
+   void     drain_store_buffer();
+   bool     forward_store(unsigned address, unsigned &value);
+
+   void     WIDE_IF(bool stall);
+   bool     WIDE_ID();
+   void     WIDE_EXE();
+   bool     WIDE_MEM();
+   bool     WIDE_WB();
+   void     run_wide(unsigned cycles);
+
+   bool     thread_ready(unsigned thread);
+   void     THREAD_IF();
+   void     THREAD_ID();
+   void     THREAD_EXE();
+   void     THREAD_MEM();
+   bool     THREAD_WB();
+   void     run_threads(unsigned cycles);
+
+   unsigned fuse(instruction_t &instruction, instruction_t next);
+
    unsigned address_gen(instruction_t instruct);
    unsigned alu (unsigned value1, unsigned value2, opcode_t opcode);
 
    int parse(const char *filename);
    int labelToPC( const char* filename, const char* label, unsigned pc_index );
-
-   //loads the assembly program in file "filename" in instruction memory at the specified address
-   void load_program(const char *filename, unsigned base_address=0x0);
+   void scan_labels(const char *filename, map<string, unsigned>& labels);
+   int load_object(const char *filename);
+
+   //loads the assembly program or object file "filename" in instruction memory at the specified address
+   //(in the instruction memory of hardware thread "thread" of the multithreaded core); the data segments
+   //of an object file are written to data memory
+   void load_program(const char *filename, unsigned base_address=0x0, unsigned thread=0);
+
+   //assembles the program in file "asm_filename" into the object file "object_filename", with the contents
+   //of data memory in [data_start, data_end) as its initialised data
+   void assemble(const char *asm_filename, const char *object_filename, unsigned data_start=0, unsigned data_end=0);
+
+   //enables the non-blocking memory stage with "mshrs" miss status holding registers (0 restores the blocking stage)
+   //must be called before the program starts running
+   void set_mshrs(unsigned mshrs);
+
+   //enables a store buffer with "entries" entries (0 disables it): stores retire into the buffer, which is
+   //drained to data memory in the background, and later loads to a buffered address are forwarded from it
+   void set_store_buffer(unsigned entries);
+
+   //attaches a data prefetcher observing the loads (policies: bit mask of prefetch_policy_t, 0 detaches it)
+   void set_prefetcher(unsigned policies, unsigned degree=1, unsigned line_size=4, unsigned buffer_entries=16);
+
+   //replaces the fixed data memory latency with a DRAM timing model (channels x banks, "row_size" bytes per row,
+   //timings in clock cycles); loads, stores and buffered stores queue for the DRAM
+   void set_dram(unsigned channels, unsigned banks, unsigned row_size, page_policy_t policy, unsigned t_rcd, unsigned t_cas, unsigned t_rp, unsigned t_burst=1);
+
+   //decouples fetch from decode with a fetch queue of "entries" instructions (0 restores the lock-stepped fetch):
+   //fetch keeps filling the queue while decode or the memory stage stall, up to the next branch (until it resolves);
+   //every instruction memory access takes "fetch_cycles" cycles
+   void set_fetch_queue(unsigned entries, unsigned fetch_cycles=1);
+
+   //splits fetch, decode and memory access into "fetch_stages", "decode_stages" and "memory_stages" pipeline
+   //stages (1 each = the 5-stage pipeline): the extra front-end stages add to the branch penalty, the extra memory
+   //stages delay every write-back; must be called before the program starts running
+   void set_pipeline_depth(unsigned fetch_stages, unsigned decode_stages, unsigned memory_stages);
+
+   //sets the superscalar issue width: up to "width" instructions are fetched, decoded and issued per cycle (1 = scalar pipeline)
+   //must be called before the program starts running
+   void set_issue_width(unsigned width);
+
+   //per-cycle limits of the superscalar core: loads/stores and other operations issued, and register write-back ports
+   //(all default to the issue width)
+   void set_issue_limits(unsigned mem_ops, unsigned alu_ops, unsigned wb_ports);
+
+   //enables macro-op fusion at decode (idioms: bit mask of fusion_idiom_t, 0 disables it): an ALU operation followed
+   //by a conditional branch on its result, or an ADDI/SUBI followed by a load based on the incremented register,
+   //issue and execute as a single operation
+   void set_fusion(unsigned idioms);
+
+   //turns the pipeline into a multithreaded core with "threads" hardware threads, each with its own PC, registers
+   //and program, sharing the pipeline and data memory; a load or store blocks only its own thread. "policy" picks the
+   //threads that issue: ROUND_ROBIN a different ready thread every cycle, SWITCH_ON_STALL the same thread until it
+   //waits for data memory (a switch costs "switch_penalty" cycles), SIMULTANEOUS up to "issue_slots" ready threads
+   //per cycle; must be called before the program starts running, with the other core options disabled
+   void set_threads(unsigned threads, thread_policy_t policy, unsigned issue_slots=1, unsigned switch_penalty=1);
+
+   //makes the simulator a core of a multicore system: core "core" works on the shared data memory "memory",
+   //through its private L1 in "caches"
+   void attach(unsigned char *memory, coherence *caches, unsigned core);
+
+   //returns true if the next clock cycle may access the shared data memory or the L1s: the instruction in MEM
+   //completes its access, or the one in EX enters MEM and looks up its L1
+   bool shared_access_ahead();
+
+   //returns a lower bound (at most "limit") on the clock cycles ahead that cannot access the shared data memory or
+   //the L1s: the rest of the latency of the access in MEM, or the distance of the next load, store or SWAP through
+   //the pipeline and the straight-line code at the fetch PC
+   unsigned private_cycles(unsigned limit);
+
+   //runs the loaded program functionally, without timing, and appends its dynamic instruction stream to "stream";
+   //leaves the registers and data memory as the program does
+   void record_trace(trace *stream);
+
+   //replays "stream" instead of a program: the pipeline is timed as when running the program, but the branch
+   //outcomes and effective addresses come from the trace and the register and memory values are not modelled; run
+   //to completion with no fusion, front-end, memory or monitoring option other than the prefetcher, the replay is
+   //timed record by record, without the pipeline latches, and takes the same cycles and stalls
+   void load_trace(trace *stream);
+
+   //enables steady-state extrapolation of loops: once the pipeline is in the same state at two fetches of the
+   //target of a backward branch, the iterations that follow the same path are executed without timing, and their
+   //cycles, stalls and instructions added from those of the iteration observed (the results are those of the full
+   //simulation); needs the scalar pipeline with the fixed data memory latency, no store buffer and no MSHRs,
+   //and must be called before the program starts running
+   void set_steady_state(bool enable);
+
+   //runs the loaded program to completion with statistical sampling (see sampler.h): the scalar pipeline simulates
+   //the sampling units in detail, and the instructions between them run functionally; leaves the registers and data
+   //memory as the program does, and the estimate in "sampling" (the statistics of the simulator cover the units only)
+   void sample(sampler *sampling);
+
+   //profiles the loaded program for simulation points (see simpoint.h): runs it functionally to completion, recording
+   //the basic block vectors of its intervals, then chooses the points
+   void profile(simpoint *points);
+
+   //runs the loaded program to completion simulating only the points chosen by profiling it (from the same initial
+   //state) in detail, and the instructions before them functionally; leaves the registers and data memory as the
+   //program does, and the estimate in "points" (the statistics of the simulator cover the points only)
+   void simulate_points(simpoint *points);
+
+   //profiles the loaded program instruction by instruction into "profiling" (see profiler.h) as it runs on the scalar
+   //pipeline, until called again with NULL; must be called once the program is loaded. There is no branch prediction,
+   //so no mispredictions are counted
+   void set_profiler(profiler *profiling);
+
+   //counts the events programmed in the counters of "monitoring" (see pmu.h) as programs run on the scalar pipeline,
+   //until called again with NULL; the counters are programmed, started and stopped through "monitoring"
+   void set_pmu(pmu *monitoring);
 
    //runs the simulator for "cycles" clock cycles (run the program to completion if cycles=0) 
    void run(unsigned cycles=0);
@@ -147,11 +533,11 @@ public:
    void set_sp_register(sp_register_t reg, stage_t s, unsigned value);
   void clear_sp_register(stage_t s);
 
-	//returns value of the specified general purpose register
-	int get_gp_register(unsigned reg);
+	//returns value of the specified general purpose register (of hardware thread "thread")
+	int get_gp_register(unsigned reg, unsigned thread=0);
 
-	// set the value of the given general purpose register to "value"
-	void set_gp_register(unsigned reg, int value);
+	// set the value of the given general purpose register (of hardware thread "thread") to "value"
+	void set_gp_register(unsigned reg, int value, unsigned thread=0);
 
 	//returns the IPC
 	float get_IPC();
@@ -165,6 +551,69 @@ public:
 	//returns the number of clock cycles
 	unsigned get_clock_cycles();
 
+	//returns the number of cycles the memory stage stalled because all MSHRs were busy
+	unsigned get_mshr_full_stalls();
+
+	//returns the number of loads merged into an already outstanding MSHR
+	unsigned get_mshr_merges();
+
+	//returns the largest number of loads outstanding at the same time
+	unsigned get_max_outstanding_loads();
+
+	//returns the number of cycles a store stalled because the store buffer was full
+	unsigned get_store_buffer_full_stalls();
+
+	//returns the number of loads served by forwarding from the store buffer
+	unsigned get_store_forwarding_hits();
+
+	//returns the average and the peak number of stores held in the store buffer
+	float    get_store_buffer_avg_occupancy();
+	unsigned get_store_buffer_max_occupancy();
+
+	//returns the fraction of the prefetches used by a load, the fraction of the loads served by a prefetch,
+	//and the fraction of the useful prefetches completed before the load needed them
+	float    get_prefetch_accuracy();
+	float    get_prefetch_coverage();
+	float    get_prefetch_timeliness();
+
+	//returns the number of DRAM accesses that hit the open row, found the bank closed, or had to close another row
+	unsigned get_dram_row_hits();
+	unsigned get_dram_row_misses();
+	unsigned get_dram_row_conflicts();
+
+	//returns the average DRAM access latency, queueing included
+	float    get_dram_avg_latency();
+
+	//returns the average and the peak number of instructions held in the fetch queue
+	float    get_fetch_queue_avg_occupancy();
+	unsigned get_fetch_queue_max_occupancy();
+
+	//returns the number of cycles decode was ready for an instruction but found the fetch queue empty
+	unsigned get_fetch_starved_cycles();
+
+	//returns the number of clock cycles in which the superscalar core issued "instructions" instructions
+	unsigned get_issue_histogram(unsigned instructions);
+
+	//returns the number of instruction pairs fused with the given idiom
+	unsigned get_fusion_hits(fusion_idiom_t idiom);
+
+	//returns the number of instructions executed by hardware thread "thread", and the clock cycles it took to finish
+	unsigned get_thread_instructions(unsigned thread);
+	unsigned get_thread_cycles(unsigned thread);
+
+	//returns the IPC of hardware thread "thread" over the cycles it ran
+	float    get_thread_IPC(unsigned thread);
+
+	//returns the number of switches between threads of the SWITCH_ON_STALL policy
+	unsigned get_thread_switches();
+
+	//returns the number of loop iterations, and of clock cycles, extrapolated rather than simulated
+	unsigned get_extrapolated_iterations();
+	unsigned get_extrapolated_cycles();
+
+	//prints every engagement of the steady-state extrapolation
+	void print_steady_state();
+
 	//prints the content of the data memory within the specified address range
 	void print_memory(unsigned start_address, unsigned end_address);
 
@@ -178,4 +627,92 @@ public:
 
 };
 
+//----------------------------------------------------------------------
+// Multicore system: scalar pipelines sharing one data memory, each
+// through a private L1 kept coherent by a snooping bus. The cores run
+// in lock step, one clock cycle each in turn, or a quantum each on
+// host threads of their own.
+//----------------------------------------------------------------------
+class sim_pipe_multicore{
+
+public:
+   vector<sim_pipe*>    cores;
+   vector<char>         finished;                   // per core (not vector<bool>: written by different host threads)
+   coherence            *caches;
+   unsigned char*       data_memory;
+   unsigned             dataMemSize;
+
+   // Host-parallel simulation (lock step on the calling thread when host_threads is 0)
+   unsigned             host_threads;
+   sync_mode_t          sync_mode;
+   unsigned             quantum;
+   unsigned             run_ahead;                  // fewest cycles a core runs ahead on its own (deterministic mode)
+   unsigned             quantum_cycles;             // length of the quantum being run
+   unsigned             quanta;
+   unsigned             horizon;                    // cycle the cores run ahead to (deterministic mode)
+   bool                 stopping;
+   barrier              *sync;
+
+   //instantiates "cores" cores sharing a data memory of "data_mem_size" bytes with a "data_mem_latency" cycles
+   //latency; every core has a private L1 of "cache_size" bytes ("line_size" bytes per line, "ways"-way set
+   //associative) hit in "hit_latency" cycles, kept coherent with "protocol": a miss holds the bus for "bus_cycles"
+   //cycles, and a line modified in another L1 takes "transfer_latency" cycles to come from it
+   sim_pipe_multicore(unsigned cores, unsigned data_mem_size, unsigned data_mem_latency, coherence_protocol_t protocol=MESI,
+                      unsigned cache_size=1024, unsigned line_size=16, unsigned ways=2, unsigned hit_latency=0,
+                      unsigned transfer_latency=2, unsigned bus_cycles=1);
+
+   ~sim_pipe_multicore();
+
+   //returns core "core" (to load its program, set its registers and read its statistics)
+   sim_pipe *core(unsigned core);
+
+   //simulates the cores on "threads" host threads (0 runs them in lock step on the calling thread), each core running
+   //at most "quantum" cycles on its own between synchronizations: DETERMINISTIC stops every core before a cycle that
+   //may touch the shared data memory or the L1s, and runs those cycles in lock step (the results and timing of the
+   //lock step run), along with the cycles of the cores less than "run_ahead" cycles away from such a cycle; RELAXED
+   //runs whole quanta, then exchanges the shared data memory accesses and bus transactions
+   void set_host_threads(unsigned threads, sync_mode_t mode=DETERMINISTIC, unsigned quantum=1000, unsigned run_ahead=16);
+
+   //runs the system for "cycles" clock cycles (until every core has completed its program if cycles=0)
+   void run(unsigned cycles=0);
+   void run_parallel(unsigned cycles);
+   void run_quantum(unsigned thread);
+   void host_worker(unsigned thread);
+   void exchange();
+   unsigned earliest(unsigned stop);
+   void lock_step(unsigned stop);
+
+   //returns the number of quanta run on the host threads
+   unsigned get_quanta();
+
+   //returns the mean relative difference between the clock cycles of every core and those of the same core in
+   //"reference", the same system run in lock step
+   float    get_timing_error(sim_pipe_multicore *reference);
+
+   //returns the number of clock cycles until the last core completed, and the instructions executed by all cores over them
+   unsigned get_clock_cycles();
+   float    get_IPC();
+
+   //returns the number of accesses of "core" that hit or missed in its L1 (a write to a shared line is a miss)
+   unsigned get_cache_hits(unsigned core);
+   unsigned get_cache_misses(unsigned core);
+
+   //returns the number of bus transactions of the given type
+   unsigned get_bus_transactions(bus_transaction_t transaction);
+
+   //returns the number of lines invalidated by snooping, and of misses served by another L1
+   unsigned get_invalidations();
+   unsigned get_cache_transfers();
+
+   //returns the number of cycles the cores waited for the bus
+   unsigned get_bus_wait_cycles();
+
+   //prints the content of the shared data memory within the specified address range
+   void print_memory(unsigned start_address, unsigned end_address);
+
+   //writes/reads an integer value to/from the shared data memory at the specified address
+   void write_memory(unsigned address, unsigned value);
+   unsigned read_memory(unsigned address);
+};
+
 #endif /*SIM_PIPE_H_*/
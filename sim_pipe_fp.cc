@@ -8,13 +8,92 @@ using namespace std;
 static const char *reg_names[NUM_SP_REGISTERS] = {"PC", "NPC", "IR", "A", "B", "IMM", "COND", "ALU_OUTPUT", "LMD"};
 static const char *stage_names[NUM_STAGES] = {"IF", "ID", "EX", "MEM", "WB"};
 
-map <string, opcode_t> opcode_2str = { {"LW", LW}, {"SW", SW}, {"ADD", ADD}, {"ADDI", ADDI}, {"SUB", SUB}, {"SUBI", SUBI}, {"XOR", XOR}, {"XORI", XORI}, {"OR", OR}, {"ORI", ORI}, {"AND", AND}, {"ANDI", ANDI}, {"MULT", MULT}, {"DIV", DIV}, {"BEQZ", BEQZ}, {"BNEZ", BNEZ}, {"BLTZ", BLTZ}, {"BGTZ", BGTZ}, {"BLEZ", BLEZ}, {"BGEZ", BGEZ}, {"JUMP", JUMP}, {"EOP", EOP}, {"NOP", NOP}, {"LWS", LWS}, {"SWS", SWS}, {"ADDS", ADDS}, {"SUBS", SUBS}, {"MULTS", MULTS}, {"DIVS", DIVS}};
+map <string, opcode_t> opcode_2str = { {"LW", LW}, {"SW", SW}, {"SWAP", SWAP}, {"ADD", ADD}, {"ADDI", ADDI}, {"SUB", SUB}, {"SUBI", SUBI}, {"XOR", XOR}, {"XORI", XORI}, {"OR", OR}, {"ORI", ORI}, {"AND", AND}, {"ANDI", ANDI}, {"MULT", MULT}, {"DIV", DIV}, {"BEQZ", BEQZ}, {"BNEZ", BNEZ}, {"BLTZ", BLTZ}, {"BGTZ", BGTZ}, {"BLEZ", BLEZ}, {"BGEZ", BGEZ}, {"JUMP", JUMP}, {"EOP", EOP}, {"NOP", NOP}, {"LWS", LWS}, {"SWS", SWS}, {"ADDS", ADDS}, {"SUBS", SUBS}, {"MULTS", MULTS}, {"DIVS", DIVS}};
 
-sim_pipe_fp::sim_pipe_fp(unsigned mem_size, unsigned mem_latency){
+sim_pipe_fp::sim_pipe_fp(unsigned mem_size, unsigned mem_latency, scheduler_t scheduler){
    dataMemSize  = mem_size;
    memLatency   = mem_latency;
    instMemory   = NULL;
    stall_count          = 0;
+   cycleCount           = 0;
+   instruction_count    = 0;
+   num_mshrs            = 0;
+   mshr_file            = NULL;
+   mshr_full_stalls     = 0;
+   mshr_merges          = 0;
+   max_outstanding_loads = 0;
+   data_prefetcher      = NULL;
+   dram_model           = NULL;
+   dram_request         = -1;
+   store_buffer_size    = 0;
+   store_buffer_full_stalls = 0;
+   store_forwarding_hits = 0;
+   store_buffer_occupancy = 0;
+   max_store_buffer_occupancy = 0;
+   this->scheduler      = scheduler;
+   rob_size             = 16;
+   rob                  = NULL;
+   fu_status            = NULL;
+   num_fu               = 0;
+   issue_seq            = 0;
+   for(int i = 0; i < EXE_UNIT_SIZE; i++) {
+      num_rs[i]         = 0;
+      rs_file[i]        = NULL;
+   }
+   for(int i = 0; i < NUM_OPCODES; i++)
+      opcode_latency[i] = 0;
+   early_out_divide     = false;
+   fp_fast_path         = false;
+   issue_width          = 1;
+   issue_mem_ops        = 1;
+   issue_alu_ops        = 1;
+   wb_ports             = 1;
+   wide_branch_done     = false;
+   lsq_size             = 0;
+   lsq                  = NULL;
+   lsq_head             = 0;
+   lsq_count            = 0;
+   load_ports           = 1;
+   store_ports          = 1;
+   disambiguation       = CONSERVATIVE;
+   lsq_full_stalls      = 0;
+   lsq_forwards         = 0;
+   lsq_replays          = 0;
+   lsq_bypasses         = 0;
+   renaming             = false;
+   rename_seq           = 0;
+   free_list_stalls     = 0;
+   fusion_idioms        = 0;
+   compare_branch_fusions = 0;
+   increment_load_fusions = 0;
+   fetch_stages         = 1;
+   decode_stages        = 1;
+   memory_stages        = 1;
+   fetch_queue_size     = 0;
+   fetch_cycles         = 1;
+   fetch_wait           = 0;
+   fetch_stopped        = false;
+   fetch_eop            = false;
+   fetch_starved_cycles = 0;
+   fetch_queue_occupancy = 0;
+   max_fetch_queue_occupancy = 0;
+   thread_policy        = ROUND_ROBIN;
+   thread_issue_slots   = 1;
+   switch_penalty       = 0;
+   current_thread       = 0;
+   switch_wait          = 0;
+   thread_switches      = 0;
+   caches               = NULL;
+   core_id              = 0;
+   deferred             = false;
+   atomic_issued        = false;
+   atomic_ready         = false;
+   atomic_value         = UNDEFINED;
+   replay               = NULL;
+   fetch_seq            = 0;
+   sampling             = NULL;
+   profiling            = NULL;
+   monitoring           = NULL;
    reset();
 }
 
@@ -25,40 +104,442 @@ void sim_pipe_fp::init_exec_unit(exe_unit_t exec_unit, unsigned latency, unsigne
    float_point_exe_reg[exec_unit].init(instances, latency+1);
 }
 
-void sim_pipe_fp::load_program(const char *filename, unsigned base_address){
-   instMemSize            = parse(filename);
+void sim_pipe_fp::set_opcode_latency(opcode_t opcode, unsigned latency){
+   opcode_latency[opcode] = latency + 1;
+}
+
+void sim_pipe_fp::set_operand_dependent_latency(bool early_out_divide, bool fp_fast_path){
+   this->early_out_divide = early_out_divide;
+   this->fp_fast_path     = fp_fast_path;
+}
+
+void sim_pipe_fp::set_initiation_interval(exe_unit_t exec_unit, unsigned interval){
+   ASSERT( interval > 0, "Unsupported initiation interval (=%d)", interval );
+   float_point_exe_reg[exec_unit].initiation_interval = interval;
+   float_point_exe_reg[exec_unit].layout();
+}
+
+//----------------------------------------------------------------------
+// Per-cycle execution unit statistics: operations in flight (for
+// "cycles" cycles in which the units do not move)
+//----------------------------------------------------------------------
+void sim_pipe_fp::account_exec_units(unsigned cycles){
+   for(int i = 0; i < EXE_UNIT_SIZE; i++){
+      execUnitT& unit   = float_point_exe_reg[i];
+      unsigned in_flight = 0;
+      for(int j = 0; j < unit.num_exe_pipe_units; j++)
+         in_flight     += (unit.exe_pipe_units[j].latency_exe != 0 && unit.exe_pipe_units[j].instruction.opcode != EOP);
+      unit.occupancy   += in_flight * cycles;
+      unit.max_occupancy = max(unit.max_occupancy, in_flight);
+   }
+}
+
+void sim_pipe_fp::set_mshrs(unsigned mshrs){
+   ASSERT( mshrs == 0 || memory_stages == 1, "The non-blocking memory stage is a single pipeline stage" );
+   num_mshrs    = mshrs;
+   mshr_file    = (mshr_t*)realloc(mshr_file, num_mshrs * sizeof(mshr_t));
+   for(unsigned i = 0; i < num_mshrs; i++) {
+      mshr_file[i].valid = false;
+   }
+   wb_queue.clear();
+}
+
+void sim_pipe_fp::set_prefetcher(unsigned policies, unsigned degree, unsigned line_size, unsigned buffer_entries){
+   ASSERT( policies == 0 || dram_model == NULL, "The prefetcher only models the fixed data memory latency" );
+   delete data_prefetcher;
+   data_prefetcher = (policies != 0) ? new prefetcher(policies, degree, line_size, buffer_entries) : NULL;
+}
+
+//----------------------------------------------------------------------
+// Cycles the load of "address" waits for data memory: the memory
+// latency, what is left of a prefetch of its line, or the latency of
+// the private L1 of a multicore core
+//----------------------------------------------------------------------
+unsigned sim_pipe_fp::load_latency(unsigned pc, unsigned address){
+   if(caches != NULL)
+      return caches->access(core_id, address, false, cycleCount);
+   return (data_prefetcher != NULL) ? data_prefetcher->access(pc, address, cycleCount, memLatency) : memLatency;
+}
+
+void sim_pipe_fp::set_dram(unsigned channels, unsigned banks, unsigned row_size, page_policy_t policy, unsigned t_rcd, unsigned t_cas, unsigned t_rp, unsigned t_burst){
+   ASSERT( data_prefetcher == NULL && scheduler == IN_ORDER && issue_width == 1, "The DRAM model is only attached to the scalar in-order memory stage" );
+   delete dram_model;
+   dram_model   = new dram(channels, banks, row_size, policy, t_rcd, t_cas, t_rp, t_burst);
+   dram_request = -1;
+}
+
+//----------------------------------------------------------------------
+// Returns true while the access of the instruction in MEM is in flight:
+// the fixed latency count, or the DRAM request issued on its first cycle
+//----------------------------------------------------------------------
+bool sim_pipe_fp::memory_busy(unsigned address, bool write){
+   if(dram_model == NULL)
+      return data_memory_latency_count-- != 0;
+   if(dram_request == -1)
+      dram_request = dram_model->enqueue(address, write, cycleCount);
+   if(!dram_model->complete(dram_request, cycleCount))
+      return true;
+   dram_request = -1;
+   return false;
+}
+
+void sim_pipe_fp::set_store_buffer(unsigned entries){
+   store_buffer_size    = entries;
+   store_buffer.clear();
+}
+
+//----------------------------------------------------------------------
+// Register renaming: the architectural registers start out mapped to
+// the first physical registers, holding their current values, and the
+// remaining physical registers go to the free list
+//----------------------------------------------------------------------
+void sim_pipe_fp::set_register_renaming(unsigned int_registers, unsigned fp_registers){
+   ASSERT( scheduler == IN_ORDER && issue_width == 1 && lsq_size == 0 && fusion_idioms == 0, "Register renaming is only modelled by the scalar in-order pipeline without a load/store queue or macro-op fusion" );
+   unsigned registers[2] = {int_registers, fp_registers};
+   for(int f = 0; f < 2; f++) {
+      ASSERT( registers[f] > NUM_GP_REGISTERS, "Unsupported number of physical registers (=%d)", registers[f] );
+      rename_file_t& file = rename_file[f];
+      file.value.assign(registers[f], UNDEFINED);
+      file.ready.assign(registers[f], true);
+      file.free_list.clear();
+      for(unsigned p = 0; p < registers[f]; p++) {
+         if(p >= NUM_GP_REGISTERS) {
+            file.free_list.push_back(p);
+            continue;
+         }
+         file.value[p]     = f ? float2unsigned(fp_file[p].value) : int_file[p].value;
+         file.map[p]       = p;
+         file.arch[p]      = p;
+         file.arch_seq[p]  = 0;
+      }
+   }
+   renaming             = true;
+   rename_seq           = 0;
+}
+
+//----------------------------------------------------------------------
+// Give the destination of an issuing instruction a free physical
+// register, which later instructions read from
+//----------------------------------------------------------------------
+void sim_pipe_fp::rename_destination(instruction_t& instruction){
+   if(!instruction.dest_op)
+      return;
+   rename_file_t& file          = rename_file[instruction.dest_float_op];
+   instruction.pdest            = file.free_list.front();
+   instruction.rename_seq       = ++rename_seq;
+   file.free_list.pop_front();
+   file.ready[instruction.pdest] = false;
+   file.map[instruction.dest]   = instruction.pdest;
+}
+
+//----------------------------------------------------------------------
+// Write back a renamed result. Results complete out of order, so only
+// the youngest completed write becomes architectural state; the
+// physical register it replaces (or the result itself, if a younger
+// write already completed) is no longer reachable and is freed, since
+// the operands are read at issue
+//----------------------------------------------------------------------
+void sim_pipe_fp::rename_write(instruction_t& instruction, unsigned value){
+   rename_file_t& file          = rename_file[instruction.dest_float_op];
+   file.value[instruction.pdest] = value;
+   file.ready[instruction.pdest] = true;
+   if(instruction.rename_seq > file.arch_seq[instruction.dest]) {
+      file.free_list.push_back(file.arch[instruction.dest]);
+      file.arch[instruction.dest]     = instruction.pdest;
+      file.arch_seq[instruction.dest] = instruction.rename_seq;
+   }
+   else
+      file.free_list.push_back(instruction.pdest);
+}
+
+//----------------------------------------------------------------------
+// Macro-op fusion
+//----------------------------------------------------------------------
+void sim_pipe_fp::set_fusion(unsigned idioms){
+   ASSERT( idioms == 0 || (scheduler == IN_ORDER && issue_width == 1 && !renaming && lsq_size == 0), "Macro-op fusion is only modelled by the scalar in-order pipeline without renaming or a load/store queue" );
+   fusion_idioms        = idioms;
+}
+
+//----------------------------------------------------------------------
+// Fuse "instruction" with the "next" one when the pair is an enabled
+// idiom: the result keeps the branch or load of "next", reading its
+// first source from the integer ALU operation of "instruction". Returns
+// the idiom, 0 if the pair does not fuse
+//----------------------------------------------------------------------
+unsigned sim_pipe_fp::fuse(instruction_t& instruction, instruction_t next){
+   bool alu_op             = (instruction.opcode >= ADD && instruction.opcode <= AND) || (instruction.opcode >= ADDI && instruction.opcode <= ANDI);
+   unsigned idiom          = 0;
+   if(!alu_op || !next.src1_op || next.src1_float_op || next.src1 != instruction.dest)
+      return 0;
+   if((fusion_idioms & FUSE_COMPARE_BRANCH) && next.opcode >= BEQZ && next.opcode <= BGEZ)
+      idiom                = FUSE_COMPARE_BRANCH;
+   else if((fusion_idioms & FUSE_INCREMENT_LOAD) && (instruction.opcode == ADDI || instruction.opcode == SUBI) && (next.opcode == LW || next.opcode == LWS))
+      idiom                = FUSE_INCREMENT_LOAD;
+   else
+      return 0;
+   next.fused_opcode       = instruction.opcode;
+   next.fused_dest         = instruction.dest;
+   next.fused_imm          = instruction.imm;
+   next.seq                = instruction.seq;
+   next.src1               = instruction.src1;
+   next.src1_op            = instruction.src1_op;
+   next.src2               = instruction.src2;
+   next.src2_op            = instruction.src2_op;
+   instruction             = next;
+   return idiom;
+}
+
+//----------------------------------------------------------------------
+// Decoupled front-end
+//----------------------------------------------------------------------
+void sim_pipe_fp::set_fetch_queue(unsigned entries, unsigned fetch_cycles){
+   ASSERT( entries == 0 || (scheduler == IN_ORDER && issue_width == 1 && fetch_stages + decode_stages == 2), "The fetch queue is only modelled by the scalar in-order pipeline with single-stage fetch and decode" );
+   ASSERT( fetch_cycles > 0, "Unsupported fetch latency (=%d)", fetch_cycles );
+   fetch_queue_size     = entries;
+   this->fetch_cycles   = fetch_cycles;
+   fetch_wait           = 0;
+   fetch_queue.clear();
+   fetch_stopped        = false;
+   fetch_eop            = false;
+}
+
+//----------------------------------------------------------------------
+// Pipeline depth: the sub-stages beyond the first of fetch and decode,
+// and of memory, start out holding bubbles
+//----------------------------------------------------------------------
+void sim_pipe_fp::set_pipeline_depth(unsigned fetch_stages, unsigned decode_stages, unsigned memory_stages){
+   ASSERT( fetch_stages > 0 && decode_stages > 0 && memory_stages > 0, "Unsupported pipeline depth (fetch=%d, decode=%d, memory=%d)", fetch_stages, decode_stages, memory_stages );
+   ASSERT( scheduler == IN_ORDER && issue_width == 1 && (fetch_stages + decode_stages == 2 || fetch_queue_size == 0) && (memory_stages == 1 || (num_mshrs == 0 && lsq_size == 0)),
+           "The pipeline depth is only configurable in the scalar in-order pipeline with lock-stepped fetch and a blocking memory stage" );
+   this->fetch_stages   = fetch_stages;
+   this->decode_stages  = decode_stages;
+   this->memory_stages  = memory_stages;
+   fetch_entry_t bubble;
+   bubble.instruction.set_stall();
+   bubble.npc           = UNDEFINED;
+   front_end.assign(fetch_stages + decode_stages - 2, bubble);
+   wb_entry_t empty     = { bubble.instruction, UNDEFINED, UNDEFINED, -1 };
+   memory_pipe.assign(memory_stages - 1, empty);
+   fetch_stopped        = false;
+   fetch_eop            = false;
+}
+
+void sim_pipe_fp::load_program(const char *filename, unsigned base_address, unsigned thread){
+   ASSERT( thread == 0 || thread < contexts.size(), "Hardware thread %d does not exist", thread );
+   if(thread > 0) {
+      // parse() builds the program in instMemory
+      instructPT *program               = instMemory;
+      instMemory                        = NULL;
+      contexts[thread].instMemSize      = program::is_object(filename) ? load_object(filename) : parse(filename);
+      contexts[thread].instMemory       = instMemory;
+      contexts[thread].base_address     = base_address;
+      contexts[thread].pc               = base_address;
+      instMemory                        = program;
+      return;
+   }
+   instMemSize            = program::is_object(filename) ? load_object(filename) : parse(filename);
    sp_registers[IF][PC]  = base_address;
    baseAddress      = base_address;
+   if(!contexts.empty()) {
+      contexts[0].instMemory            = instMemory;
+      contexts[0].instMemSize           = instMemSize;
+      contexts[0].base_address          = base_address;
+      contexts[0].pc                    = base_address;
+   }
 }
 
 instruction_t sim_pipe_fp::fetchInstruction ( unsigned pc ) {
+   if(replay != NULL) {
+      ASSERT( fetch_seq < replay->size() && replay->get(fetch_seq).pc == pc, "The trace does not follow the pipeline at PC %x", pc );
+      instruction_t instruction = decode_record(fetch_seq);
+      if(instruction.opcode != EOP) {
+         fetch_seq++;
+         instruction_count++;
+      }
+      if(profiling != NULL)
+         profiling->fetch(pc, instruction.seq, cycleCount + 1);
+      return instruction;
+   }
    int      index     = (pc - baseAddress)/4;
    ASSERT((index >= 0) && (index < instMemSize), "out of bound access of instruction memory %d", index);
    instruction_t instruction = *(instMemory[index]);
+   if(sampling != NULL)
+      sample_fetch_limit    += (instruction.opcode == NOP);   // NOPs are not counted by the sampling
+   if(sampling != NULL && (instruction_count >= (int)sample_fetch_limit || instruction.opcode == EOP)) {
+      // end of the sampling unit: the pipeline drains as it does at the end of the program
+      instruction.nop();
+      instruction.opcode     = EOP;
+      sample_resume_pc       = pc;
+      return instruction;
+   }
    if(instruction.opcode != EOP)
       instruction_count++;
+   instruction.pc            = pc;
+   if(profiling != NULL) {
+      instruction.seq        = fetch_seq;
+      fetch_seq             += (instruction.opcode != EOP);
+      profiling->fetch(pc, instruction.seq, cycleCount + 1);
+   }
    return instruction;
 }
 
+//----------------------------------------------------------------------
+// Instruction following "instruction" (at "npc") in program order
+//----------------------------------------------------------------------
+instruction_t sim_pipe_fp::next_instruction ( instruction_t& instruction, uint32_t npc ) {
+   if(replay != NULL)
+      return decode_record(replay_record(instruction.seq) + 1);
+   if(sampling != NULL && npc == sample_resume_pc) {
+      instruction_t stop;                          // the EOP ending the sampling unit, already fetched
+      stop.opcode          = EOP;
+      return stop;
+   }
+   instruction_t next              = *(instMemory[(npc - baseAddress)/4]);
+   next.pc                         = npc;
+   return next;
+}
+
 void sim_pipe_fp::MIPS_IF(bool stall) {
    bool cond                       = get_sp_register(COND, MEM);
    uint32_t alu_output             = get_sp_register(ALU_OUTPUT, MEM);
    sp_registers[IF][PC]            = cond ? alu_output : sp_registers[IF][PC];
+   if(fetch_queue_size > 0) {
+      fetch_ahead(stall);
+      return;
+   }
+   if(!front_end.empty()) {
+      if(!stall)
+         advance_front_end();
+      return;
+   }
    uint32_t currentFetchPC         = sp_registers[IF][PC];
 
 
    if( !stall ){
-      instruction_t instruction           = fetchInstruction(currentFetchPC);
-      if(instruction.opcode != EOP )
+      instruction_register[ID]         = fetchInstruction(currentFetchPC);
+      if(instruction_register[ID].opcode != EOP )
          set_sp_register(PC, IF, currentFetchPC + 4);
 
       sp_registers[ID][NPC]       = sp_registers[IF][PC];
+   }
+}
+
+//----------------------------------------------------------------------
+// Decoupled front-end: fetch runs ahead of decode into the fetch queue,
+// one instruction every fetch_cycles cycles, and stops after a branch
+// until decode accepts an instruction again (the branch has resolved
+// and redirected the PC) or after EOP. Decode takes the head of the
+// queue
+//----------------------------------------------------------------------
+void sim_pipe_fp::fetch_ahead(bool stall) {
+   if(fetch_stopped && !fetch_eop && !stall && fetch_queue.empty())
+      fetch_stopped                = false;
+   if(!fetch_stopped && fetch_queue.size() < fetch_queue_size && ++fetch_wait >= fetch_cycles) {
+      fetch_entry_t entry;
+      uint32_t pc                  = sp_registers[IF][PC];
+      fetch_wait                   = 0;
+      entry.instruction            = fetchInstruction(pc);
+      if(entry.instruction.opcode != EOP)
+         sp_registers[IF][PC]      = pc + 4;
+      entry.npc                    = sp_registers[IF][PC];
+      fetch_eop                    = (entry.instruction.opcode == EOP);
+      fetch_stopped                = entry.instruction.branch_op || fetch_eop;
+      fetch_queue.push_back(entry);
+   }
+   if(!stall) {
+      fetch_starved_cycles        += (fetch_queue.empty() && !fetch_eop);
+      if(fetch_queue.empty())
+         instruction_register[ID].set_stall();
+      else {
+         if(profiling != NULL)
+            profiling->leave(fetch_queue.front().instruction.pc, IF, fetch_queue.front().instruction.seq, cycleCount + 1);
+         instruction_register[ID]  = fetch_queue.front().instruction;
+         sp_registers[ID][NPC]     = fetch_queue.front().npc;
+         fetch_queue.pop_front();
+      }
+   }
+   fetch_queue_occupancy          += fetch_queue.size();
+   max_fetch_queue_occupancy       = max(max_fetch_queue_occupancy, (unsigned)fetch_queue.size());
+}
+
+//----------------------------------------------------------------------
+// Deeper front-end: the extra fetch and decode sub-stages form a delay
+// line ahead of ID, advancing whenever ID accepts an instruction. Fetch
+// stops after a branch, filling the sub-stages behind it with bubbles,
+// until they have drained and ID accepts again (the branch has resolved
+// and redirected the PC), and after EOP
+//----------------------------------------------------------------------
+void sim_pipe_fp::advance_front_end() {
+   bool drained                   = true;
+   for(unsigned i = 0; i < front_end.size(); i++) {
+      drained                     = drained && front_end[i].instruction.is_stall;
+   }
+   if(fetch_stopped && !fetch_eop && drained)
+      fetch_stopped               = false;
+
+   fetch_entry_t entry;
+   entry.instruction.set_stall();
+   entry.npc                      = UNDEFINED;
+   if(!fetch_stopped) {
+      uint32_t pc                 = sp_registers[IF][PC];
+      entry.instruction           = fetchInstruction(pc);
+      if(entry.instruction.opcode != EOP)
+         sp_registers[IF][PC]     = pc + 4;
+      entry.npc                   = sp_registers[IF][PC];
+      fetch_eop                   = (entry.instruction.opcode == EOP);
+      fetch_stopped               = entry.instruction.branch_op || fetch_eop;
+   }
+   else if(!fetch_eop) {
+      stall_count++;              // bubble behind an unresolved branch
+      if(profiling != NULL)
+         profiling->stall(profiling->last_fetch, STALL_CONTROL);
+      if(monitoring != NULL)
+         monitoring->stall(sp_registers[IF][PC] - 4, STALL_CONTROL);
+   }
+   front_end.push_back(entry);
+   if(profiling != NULL)
+      profiling->leave(front_end.front().instruction.pc, IF, front_end.front().instruction.seq, cycleCount + 1);
+   instruction_register[ID]       = front_end.front().instruction;
+   sp_registers[ID][NPC]          = front_end.front().npc;
+   front_end.pop_front();
+}
 
-      instruction_register[ID]         = instruction;
+//----------------------------------------------------------------------
+// Drop the second instruction of a fused pair from the front-end: the
+// head of the fetch queue or of the front-end sub-stages, or else the
+// next instruction to fetch
+//----------------------------------------------------------------------
+void sim_pipe_fp::skip_fetch(bool branch) {
+   if(!fetch_queue.empty()) {
+      if(profiling != NULL) {
+         profiling->leave(fetch_queue.front().instruction.pc, IF, fetch_queue.front().instruction.seq, cycleCount + 1);
+         profiling->drop(fetch_queue.front().instruction.seq);
+      }
+      fetch_queue.pop_front();
+      return;
+   }
+   if(!front_end.empty()) {
+      if(profiling != NULL) {
+         profiling->leave(front_end.front().instruction.pc, IF, front_end.front().instruction.seq, cycleCount + 1);
+         profiling->drop(front_end.front().instruction.seq);
+      }
+      front_end.front().instruction.set_stall();
+      return;
    }
+   if(profiling != NULL) {
+      profiling->fetch(sp_registers[IF][PC], fetch_seq, cycleCount + 1);
+      profiling->drop(fetch_seq);
+   }
+   sp_registers[IF][PC]           += 4;
+   instruction_count++;
+   fetch_seq++;
+   if(fetch_queue_size > 0)
+      fetch_stopped                = branch;
 }
 
 bool sim_pipe_fp::check_busy_status(unsigned regNo, bool isF) {
+   if(renaming)
+      return !rename_file[isF].ready[rename_file[isF].map[regNo]];
    return isF ? fp_file[regNo].busy : int_file[regNo].busy;
 }
 
@@ -76,6 +557,7 @@ exe_unit_t sim_pipe_fp::convert_op_to_exe_unit(opcode_t opcode){
    switch( opcode ){
       case ADD ... AND:
       case BEQZ ... SWS:
+      case SWAP:
          unit = INTEGER;
          break;
 
@@ -105,41 +587,91 @@ exe_unit_t sim_pipe_fp::convert_op_to_exe_unit(opcode_t opcode){
 
 
 int sim_pipe_fp::exLatency(opcode_t opcode) {
+   if(opcode_latency[opcode] != 0)
+      return opcode_latency[opcode];
    return float_point_exe_reg[convert_op_to_exe_unit(opcode)].latency;
 }
 
+static bool zero_or_denormal(unsigned value){
+   return ((value >> 23) & 0xFF) == 0;
+}
+
+//----------------------------------------------------------------------
+// Operand-dependent latency: an early-out integer divider iterates over
+// the significant bits of the dividend only, and FP multiplies and
+// divides with a zero or denormal operand take a single cycle
+//----------------------------------------------------------------------
+int sim_pipe_fp::exLatency(instruction_t& instruction, unsigned a, unsigned b) {
+   int latency = exLatency(instruction.opcode);
+   switch(instruction.opcode) {
+      case DIV:
+         if(early_out_divide) {
+            unsigned dividend = ((int)a < 0) ? -a : a;
+            int bits          = dividend ? 32 - __builtin_clz(dividend) : 0;
+            latency           = 1 + max(1, ((latency - 1) * bits + 31) / 32);
+         }
+         break;
+
+      case MULTS:
+      case DIVS:
+         if(fp_fast_path && (zero_or_denormal(a) || zero_or_denormal(b)))
+            latency = 2;
+         break;
+
+      default: break;
+   }
+   return latency;
+}
+
 //----------------------------------------------------------------------
 // MIPS: Instruction Decode
 //----------------------------------------------------------------------
 bool sim_pipe_fp::MIPS_ID() {
    bool stall_execute                   = false;
+   stall_cause_t cause                  = STALL_RAW;
    instruction_t instruction            = instruction_register[ID];
-   int latency                          = instruction.is_stall ? 0 : exLatency(instruction.opcode);
+   unsigned fused                       = 0;
+   if(fusion_idioms != 0 && instruction.opcode != NOP && instruction.opcode != EOP)
+      fused                             = fuse(instruction, next_instruction(instruction, sp_registers[ID][NPC]));
+   unsigned a                           = (instruction.src1_op) ? regRead(instruction.src1, instruction.src1_float_op) : UNDEFINED;
+   unsigned b                           = (instruction.src2_op) ? regRead(instruction.src2, instruction.src2_float_op) : UNDEFINED;
+   if(replay != NULL && instruction.pc != UNDEFINED && instruction.opcode != EOP) {
+      // replayed instruction: the operands setting its latency come from the trace (of the branch or load of a fused
+      // pair)
+      const trace_record_t& record      = replay->get(replay_record(instruction.seq) + (instruction.fused_opcode != NOP));
+      a                                 = record.a;
+      b                                 = record.b;
+   }
+   int latency                          = instruction.is_stall ? 0 : exLatency(instruction, a, b);
+   bool lsq_op                          = lsq_size > 0 && instruction.opcode >= LW && instruction.opcode <= SWS;
    sp_registers[EX][NPC]                = sp_registers[ID][NPC];
+   ASSERT( instruction.opcode != SWAP || (lsq_size == 0 && store_buffer_size == 0 && num_mshrs == 0), "SWAP is only modelled by the blocking memory stage" );
 
    
   //-------------------------------------------------------------------
-  // Check for RAW Hazards
+  // Check for RAW Hazards (loads and stores wait for their registers in
+  // the load/store queue)
   //-------------------------------------------------------------------
-   if( (instruction.src1_op && check_busy_status(instruction.src1, instruction.src1_float_op)) || 
-    (instruction.src2_op && check_busy_status(instruction.src2, instruction.src2_float_op)) ) {
+   if( !lsq_op && ((instruction.src1_op && check_busy_status(instruction.src1, instruction.src1_float_op)) || 
+    (instruction.src2_op && check_busy_status(instruction.src2, instruction.src2_float_op))) ) {
       stall_execute                 = true;
    }
 
-   for(int i = 0; i < EXE_UNIT_SIZE && !stall_execute; i++){
+   for(int i = 0; i < EXE_UNIT_SIZE && !stall_execute && !lsq_op; i++){
       for(int j = 0; j < float_point_exe_reg[i].num_exe_pipe_units; j++){
          execLaneT exe_pipe_unit = float_point_exe_reg[i].exe_pipe_units[j];
-         if(latency == exe_pipe_unit.latency_exe && latency != 0) {
+         if(latency == exe_pipe_unit.latency_exe && latency != 0 && exe_pipe_unit.station < 0) {
             stall_execute           = true;
+            cause                   = STALL_STRUCTURAL;   // the write port in the cycle it would complete
             break;
          }
       }
    }
 
   //-------------------------------------------------------------------
-  // Check for WAW Hazards
+  // Check for WAW Hazards (none once the destinations are renamed)
   //-------------------------------------------------------------------
-   if(!stall_execute) { 
+   if(!stall_execute && !renaming && !lsq_op) { 
       for(int i = 0; i < EXE_UNIT_SIZE && !stall_execute; i++){
          for(int j = 0; j < float_point_exe_reg[i].num_exe_pipe_units; j++) {
             execLaneT exe_pipe_unit       = float_point_exe_reg[i].exe_pipe_units[j];
@@ -148,29 +680,67 @@ bool sim_pipe_fp::MIPS_ID() {
                   (instruction.dest_float_op == exe_pipe_unit.instruction.dest_float_op)  && 
                   (latency <= exe_pipe_unit.latency_exe && latency != 0) ){       
                stall_execute     = true;
+               cause             = STALL_WAW;
                break;
             }
          }
       }
    }
 
+   // a fused pair also writes the result of its ALU operation, which must complete in order with the other writes
+   if(!stall_execute && fusion_idioms != 0) {
+      cause                    = STALL_WAW;
+      stall_execute            = (fused != 0 && check_busy_status(instruction.fused_dest, false));
+      for(int i = 0; i < EXE_UNIT_SIZE && !stall_execute; i++){
+         for(int j = 0; j < float_point_exe_reg[i].num_exe_pipe_units; j++) {
+            execLaneT exe_pipe_unit       = float_point_exe_reg[i].exe_pipe_units[j];
+            if( instruction.dest_op && !instruction.dest_float_op && exe_pipe_unit.instruction.fused_opcode != NOP && 
+                  instruction.dest == exe_pipe_unit.instruction.fused_dest && latency <= exe_pipe_unit.latency_exe && latency != 0 ){
+               stall_execute     = true;
+               break;
+            }
+         }
+      }
+   }
+
+   // writes to a register complete in order: a queued load waits for the older writes, later writes wait for the load
+   if(!stall_execute && lsq_size > 0 && instruction.dest_op) {
+      cause                    = STALL_WAW;
+      stall_execute            = lsq_op ? check_busy_status(instruction.dest, instruction.dest_float_op) : lsq_load_pending(instruction.dest, instruction.dest_float_op);
+   }
+
   //-------------------------------------------------------------------
   // Check for Free Executional Units- Structural Hazard
   //-------------------------------------------------------------------
-   if(!stall_execute) {
-      bool is_exe_unit_avail    = false;
-      for(int j = 0; j < float_point_exe_reg[convert_op_to_exe_unit(instruction.opcode)].num_exe_pipe_units; j++){
-         if(float_point_exe_reg[convert_op_to_exe_unit(instruction.opcode)].exe_pipe_units[j].latency_exe == 0) {
-            is_exe_unit_avail   = true;
-            break;
-         }
-      }
-      stall_execute            = !is_exe_unit_avail;
+   if(!stall_execute && lsq_op) {
+      cause                    = STALL_STRUCTURAL;
+      stall_execute            = (lsq_count == lsq_size);
+      lsq_full_stalls         += stall_execute;
+   }
+   else if(!stall_execute) {
+      cause                    = STALL_STRUCTURAL;
+      stall_execute            = float_point_exe_reg[convert_op_to_exe_unit(instruction.opcode)].free_lane(cycleCount + 1) == -1;
+   }
+   if(!stall_execute && lsq_size > 0 && instruction.opcode == EOP) {
+      stall_execute            = (lsq_count != 0);
+   }
+   if(!stall_execute && renaming && instruction.dest_op && rename_file[instruction.dest_float_op].free_list.empty()) {
+      stall_execute            = true;
+      cause                    = STALL_STRUCTURAL;
+      free_list_stalls++;
    }
    
 
    bool branch_op                     = instruction.branch_op || instruction_register[EX].branch_op || check_branch();
 
+   // the instruction in the latch leaves ID for EX (EOP stays, decoded again, and every copy leaving is numbered as an
+   // instruction of its own), carrying its cycles of ID along; the first instruction of a fused pair keeps its own
+   if(profiling != NULL && !stall_execute) {
+      if(instruction.opcode == EOP)
+         instruction.seq                 = ++fetch_seq;
+      profiling->decode(instruction_register[ID].pc, instruction_register[ID].seq, instruction.seq, fused != 0, cycleCount + 1);
+   }
+
   //-------------------------------------------------------------------
   // Check for Control Hazards
   //-------------------------------------------------------------------
@@ -178,6 +748,10 @@ bool sim_pipe_fp::MIPS_ID() {
    if( branch_op && !stall_execute ) { 
       instruction_register[ID].set_stall();
       if(!(instruction.opcode == EOP)) stall_count++;
+      if(profiling != NULL && instruction.opcode != EOP)
+         profiling->stall(branch_pc(instruction), STALL_CONTROL);
+      if(monitoring != NULL && instruction.opcode != EOP)
+         monitoring->stall(branch_pc(instruction), STALL_CONTROL);
       clear_sp_register(ID);
    }
 
@@ -186,16 +760,39 @@ bool sim_pipe_fp::MIPS_ID() {
       clear_sp_register(EX);
       if(!(instruction.opcode == EOP))  stall_count++;
       else sp_registers[EX][NPC]       = sp_registers[ID][NPC];
+      if(profiling != NULL && instruction.opcode != EOP) {
+         if(instruction.is_stall)          // a bubble behind a branch waits for the unit of the branch
+            profiling->stall(branch_pc(instruction), STALL_CONTROL);
+         else
+            profiling->stall(instruction.pc, cause);
+      }
+      if(monitoring != NULL && instruction.opcode != EOP)
+         monitoring->stall(instruction.is_stall ? branch_pc(instruction) : instruction.pc, instruction.is_stall ? STALL_CONTROL : cause);
       return true;
    } 
    else{
-      if(instruction.dest_op){
+      if(renaming)
+         rename_destination(instruction);
+      else if(lsq_op) {
+         lsq_issue(instruction, sp_registers[ID][NPC]);
+         instruction.set_stall();
+      }
+      else if(instruction.dest_op){
          int_file[instruction.dest].busy += !(instruction.dest_float_op); 
          fp_file[instruction.dest].busy  +=  (instruction.dest_float_op); 
       }
 
-      sp_registers[EX][A]                 = (instruction.src1_op) ? regRead(instruction.src1, instruction.src1_float_op) : UNDEFINED;
-      sp_registers[EX][B]                 = (instruction.src2_op) ? regRead(instruction.src2, instruction.src2_float_op) : UNDEFINED;
+      // fetch skips the second instruction of a fused pair
+      if(fused != 0) {
+         int_file[instruction.fused_dest].busy++;
+         skip_fetch(instruction.branch_op);
+         sp_registers[EX][NPC]           += 4;
+         compare_branch_fusions          += (fused == FUSE_COMPARE_BRANCH);
+         increment_load_fusions          += (fused == FUSE_INCREMENT_LOAD);
+      }
+
+      sp_registers[EX][A]                 = a;
+      sp_registers[EX][B]                 = b;
       sp_registers[EX][IMM]               = instruction.imm;
 
       instruction_register[EX]            = instruction;
@@ -215,6 +812,7 @@ unsigned sim_pipe_fp::aluF (unsigned _value1, unsigned _value2, bool value1F, bo
       case ADD:
       case BEQZ ... ADDI:
       case JUMP ... ADDS:
+      case SWAP:
          output      = value1 + value2;
          break;
 
@@ -278,6 +876,7 @@ unsigned sim_pipe_fp::alu (unsigned _value1, unsigned _value2, bool value1F, boo
       case ADD:
       case BEQZ ... ADDI:
       case JUMP ... ADDS:
+      case SWAP:
          output      = value1 + value2;
          break;
 
@@ -319,16 +918,23 @@ unsigned sim_pipe_fp::alu (unsigned _value1, unsigned _value2, bool value1F, boo
    return output;
 }
 
-instruction_t sim_pipe_fp::execInst(int& count, uint32_t& b, uint32_t& npc){
+instruction_t sim_pipe_fp::execInst(int& count, uint32_t& a, uint32_t& b, uint32_t& npc){
    instruction_t instruction;
    count = 0;
    for(int i = 0; i < EXE_UNIT_SIZE; i++){
       for(int j = 0; j < float_point_exe_reg[i].num_exe_pipe_units; j++){
          if( float_point_exe_reg[i].exe_pipe_units[j].latency_exe != 0 ) {
             float_point_exe_reg[i].exe_pipe_units[j].latency_exe--;
-            if( float_point_exe_reg[i].exe_pipe_units[j].latency_exe == 0 ) {
+            if( float_point_exe_reg[i].exe_pipe_units[j].latency_exe == 0 && float_point_exe_reg[i].exe_pipe_units[j].station >= 0 ) {
+               // address generated for the load/store queue, which takes over from here
+               execLaneT& lane = float_point_exe_reg[i].exe_pipe_units[j];
+               lsq_address_ready(lane.station, lane.instruction.imm + lane.a);
+               lane.station    = -1;
+            }
+            else if( float_point_exe_reg[i].exe_pipe_units[j].latency_exe == 0 ) {
                count++;
                instruction  = float_point_exe_reg[i].exe_pipe_units[j].instruction;
+               a            = float_point_exe_reg[i].exe_pipe_units[j].a;
                b            = float_point_exe_reg[i].exe_pipe_units[j].b;
                npc          = float_point_exe_reg[i].exe_pipe_units[j].exNpc;
             }
@@ -341,6 +947,53 @@ instruction_t sim_pipe_fp::execInst(int& count, uint32_t& b, uint32_t& npc){
    return instruction;
 }
 
+//----------------------------------------------------------------------
+// Branch Condition (the register value is compared as a signed integer)
+//----------------------------------------------------------------------
+bool sim_pipe_fp::branch_taken(opcode_t opcode, unsigned value){
+   int signed_value = (int)value;
+   switch( opcode ){
+      case BEQZ: return signed_value == 0;
+      case BNEZ: return signed_value != 0;
+      case BLTZ: return signed_value <  0;
+      case BGTZ: return signed_value >  0;
+      case BLEZ: return signed_value <= 0;
+      case BGEZ: return signed_value >= 0;
+      case JUMP: return true;
+      default:   return false;
+   }
+}
+
+//----------------------------------------------------------------------
+// Execute an instruction on already captured operand values (used by
+// the out-of-order cores): returns the result and sets the branch
+// condition
+//----------------------------------------------------------------------
+unsigned sim_pipe_fp::evaluate(instruction_t& instruction, unsigned npc, unsigned vj, unsigned vk, bool& cond){
+   cond = false;
+   switch(instruction.opcode) {
+      case LW ... SWS:
+      case SWAP:
+         return instruction.imm + vj;
+
+      case ADD ... DIV:
+      case ADDS ... DIVS:
+         return alu(vj, vk, instruction.src1_float_op, instruction.src2_float_op, instruction.opcode);
+
+      case ADDI ... ANDI:
+         return alu(vj, instruction.imm, instruction.src1_float_op, false, instruction.opcode);
+
+      case BEQZ ... BGEZ:
+      case JUMP:
+         cond = branch_taken(instruction.opcode, vj);
+         return alu(npc, instruction.imm, false, false, instruction.opcode);
+
+      default:
+         ASSERT(false, "Unknown operation encountered");
+         return UNDEFINED;
+   }
+}
+
 int sim_pipe_fp::getMaxTtl() {
    int latency_exe = 0;
    for(int i = 0; i < EXE_UNIT_SIZE; i++){
@@ -357,104 +1010,323 @@ void sim_pipe_fp::MIPS_EXE() {
    clear_sp_register(MEM);
    sp_registers[MEM][COND]     = 0;
 
-   for(int j = 0; j < float_point_exe_reg[convert_op_to_exe_unit(instruction.opcode)].num_exe_pipe_units; j++){
-      if(float_point_exe_reg[convert_op_to_exe_unit(instruction.opcode)].exe_pipe_units[j].latency_exe == 0) {
-         float_point_exe_reg[convert_op_to_exe_unit(instruction.opcode)].exe_pipe_units[j].instruction = instruction;
-         if(instruction.opcode == EOP) {
-            float_point_exe_reg[convert_op_to_exe_unit(instruction.opcode)].exe_pipe_units[j].latency_exe   = getMaxTtl() + 1;
-         }
-         else 
-            float_point_exe_reg[convert_op_to_exe_unit(instruction.opcode)].exe_pipe_units[j].latency_exe   = instruction.is_stall ? 0 : exLatency(instruction.opcode);
-         float_point_exe_reg[convert_op_to_exe_unit(instruction.opcode)].exe_pipe_units[j].b        = sp_registers[EX][B];
-         float_point_exe_reg[convert_op_to_exe_unit(instruction.opcode)].exe_pipe_units[j].exNpc    = sp_registers[EX][NPC];
-         break;
+   execUnitT& unit             = float_point_exe_reg[convert_op_to_exe_unit(instruction.opcode)];
+   int lane                    = unit.free_lane(cycleCount);
+   if(lane != -1) {
+      unit.exe_pipe_units[lane].instruction = instruction;
+      if(instruction.opcode == EOP) {
+         unit.exe_pipe_units[lane].latency_exe   = getMaxTtl() + 1;
       }
+      else 
+         unit.exe_pipe_units[lane].latency_exe   = instruction.is_stall ? 0 : exLatency(instruction, sp_registers[EX][A], sp_registers[EX][B]);
+      unit.exe_pipe_units[lane].a        = sp_registers[EX][A];
+      unit.exe_pipe_units[lane].b        = sp_registers[EX][B];
+      unit.exe_pipe_units[lane].exNpc    = sp_registers[EX][NPC];
+      unit.exe_pipe_units[lane].station  = -1;
+      unit.exe_pipe_units[lane].seq      = issue_seq++;
+      if(!instruction.is_stall && instruction.opcode != EOP)
+         unit.start(lane, cycleCount);
    }
+   if(lsq_size > 0)
+      lsq_dispatch_agen();
 
    int count;
+   uint32_t a;
    uint32_t b;
    uint32_t npc;
-   instruction = execInst(count, b, npc);
+   instruction = execInst(count, a, b, npc);
 
    if(count != 0) {
-      uint32_t src1 = instruction.src1;
-      uint32_t src2 = instruction.src2;
       bool src1_float_op    = instruction.src1_float_op;
       bool src2_float_op    = instruction.src2_float_op;
+      // renamed operands are read at issue, the others when the instruction leaves the unit
+      uint32_t value1       = (renaming || !instruction.src1_op) ? a : regRead(instruction.src1, src1_float_op);
+      uint32_t value2       = (renaming || !instruction.src2_op) ? b : regRead(instruction.src2, src2_float_op);
 
       sp_registers[MEM][B] = b;
-      switch(instruction.opcode) {
-         case LW ... SWS:
-            sp_registers[MEM][ALU_OUTPUT] = address_gen (instruction);
-            break;
+      if(replay != NULL && instruction.pc != UNDEFINED && instruction.opcode != EOP) {
+         // replayed instruction: the outcome comes from the trace (the record of the branch or load of a fused pair)
+         const trace_record_t& record  = replay->get(replay_record(instruction.seq) + (instruction.fused_opcode != NOP));
+         sp_registers[MEM][ALU_OUTPUT] = record.address;
+         sp_registers[MEM][COND]       = record.taken;
+      }
+      else {
+         if(instruction.fused_opcode != NOP) {
+            // fused pair: the ALU operation feeds the first source of the branch or the load
+            instruction.fused_value = alu(value1, instruction.src2_op ? value2 : instruction.fused_imm, false, false, instruction.fused_opcode);
+            value1                  = instruction.fused_value;
+         }
+         switch(instruction.opcode) {
+            case LW ... SWS:
+            case SWAP:
+               sp_registers[MEM][ALU_OUTPUT] = instruction.imm + value1;
+               break;
 
-         case ADD ... DIV:
-         case ADDS ... DIVS:
-            sp_registers[MEM][ALU_OUTPUT] = alu(regRead(src1, src1_float_op), regRead(src2, src2_float_op), src1_float_op, src2_float_op, instruction.opcode);
-            break;
+            case ADD ... DIV:
+            case ADDS ... DIVS:
+               sp_registers[MEM][ALU_OUTPUT] = alu(value1, value2, src1_float_op, src2_float_op, instruction.opcode);
+               break;
 
-         case ADDI ... ANDI:
-            sp_registers[MEM][ALU_OUTPUT] = alu(regRead(src1, src1_float_op), instruction.imm, src1_float_op, false, instruction.opcode);
-            break;
+            case ADDI ... ANDI:
+               sp_registers[MEM][ALU_OUTPUT] = alu(value1, instruction.imm, src1_float_op, false, instruction.opcode);
+               break;
 
-         case BLTZ:
-            sp_registers[MEM][COND]       = regRead(src1, src1_float_op) < 0;
-            sp_registers[MEM][ALU_OUTPUT] = alu(npc, instruction.imm, false, false, instruction.opcode);
-            break;
+            case BEQZ ... BGEZ:
+               sp_registers[MEM][ALU_OUTPUT] = alu(npc, instruction.imm, false, false, instruction.opcode);
+               sp_registers[MEM][COND]       = branch_taken(instruction.opcode, value1);
+               break;
 
-         case BNEZ:
-            sp_registers[MEM][ALU_OUTPUT] = alu(npc, instruction.imm, false, false, instruction.opcode);
-            sp_registers[MEM][COND]       = regRead(src1, src1_float_op) != 0;
-            break;
+            case JUMP:
+               sp_registers[MEM][ALU_OUTPUT] = alu(npc, instruction.imm, false, false, instruction.opcode);
+               sp_registers[MEM][COND]       = 1;
+               break;
 
-         case BEQZ:
-            sp_registers[MEM][ALU_OUTPUT] = alu(npc, instruction.imm, false, false, instruction.opcode);
-            sp_registers[MEM][COND]       = regRead(src1, src1_float_op) == 0;
-            break;
+            case NOP:
+            case EOP:
+               break;
 
-         case BGTZ:
-            sp_registers[MEM][ALU_OUTPUT] = alu(npc, instruction.imm, false, false, instruction.opcode);
-            sp_registers[MEM][COND]       = regRead(src1, src1_float_op) > 0;
-            break;
+            default:
+               ASSERT(false, "Unknown operation encountered");
+               break;
+         }
+      }
+   }
+   if(profiling != NULL)
+      profile_memory(instruction);
+   instruction_register[MEM]  = instruction;
+   if(instruction.opcode == LW || instruction.opcode == LWS)
+      data_memory_latency_count                 = load_latency(npc - 4, sp_registers[MEM][ALU_OUTPUT]);
+   else if(caches != NULL && (instruction.opcode == SW || instruction.opcode == SWS || instruction.opcode == SWAP))
+      data_memory_latency_count                 = caches->access(core_id, sp_registers[MEM][ALU_OUTPUT], true, cycleCount);
+   else
+      data_memory_latency_count                 = memLatency;
+   if(profiling != NULL) {
+      if(sp_registers[MEM][COND] == 1)
+         profiling->branch(instruction.pc, sp_registers[MEM][ALU_OUTPUT]);
+      if((instruction.opcode >= LW && instruction.opcode <= SWS) || instruction.opcode == SWAP)
+         profiling->access(instruction.pc, dram_model != NULL || data_memory_latency_count > (caches != NULL ? caches->hit_latency : 0));
+   }
+   if(monitoring != NULL) {
+      if(sp_registers[MEM][COND] == 1) {
+         monitoring->count(EVENT_TAKEN_BRANCHES, instruction.pc);
+         if(sp_registers[MEM][ALU_OUTPUT] <= instruction.pc)
+            monitoring->count(EVENT_BACKWARD_BRANCHES, instruction.pc);
+      }
+      if((instruction.opcode >= LW && instruction.opcode <= SWS) || instruction.opcode == SWAP) {
+         monitoring->count(EVENT_MEMORY_ACCESSES, instruction.pc);
+         if(dram_model != NULL || data_memory_latency_count > (caches != NULL ? caches->hit_latency : 0))
+            monitoring->count(EVENT_MEMORY_MISSES, instruction.pc);
+      }
+   }
+}
 
-         case BGEZ:
-            sp_registers[MEM][ALU_OUTPUT] = alu(npc, instruction.imm, false, false, instruction.opcode);
-            sp_registers[MEM][COND]       = regRead(src1, src1_float_op) >= 0;
-            break;
+//----------------------------------------------------------------------
+// Count down the outstanding misses, releasing the queued loads of
+// every MSHR that completes
+//----------------------------------------------------------------------
+void sim_pipe_fp::tick_mshrs() {
+   for(unsigned i = 0; i < num_mshrs; i++) {
+      if(!mshr_file[i].valid)
+         continue;
+      if(dram_model != NULL ? !dram_model->complete(mshr_file[i].request, cycleCount) : --mshr_file[i].latency_count != 0)
+         continue;
+      for(unsigned j = 0; j < wb_queue.size(); j++) {
+         if(wb_queue[j].mshr == (int)i)
+            wb_queue[j].mshr = -1;
+      }
+      mshr_file[i].valid = false;
+   }
+}
 
-         case BLEZ:
-            sp_registers[MEM][ALU_OUTPUT] = alu(npc, instruction.imm, false, false, instruction.opcode);
-            sp_registers[MEM][COND]       = regRead(src1, src1_float_op) <= 0;
+//----------------------------------------------------------------------
+// Returns the MSHR tracking "address" (merging with an outstanding miss
+// to the same address), or -1 when all of them are busy
+//----------------------------------------------------------------------
+int sim_pipe_fp::allocate_mshr(unsigned address, unsigned latency) {
+   int free_mshr = -1;
+   for(unsigned i = 0; i < num_mshrs; i++) {
+      if(mshr_file[i].valid && mshr_file[i].address == address) {
+         mshr_merges++;
+         return i;
+      }
+      if(!mshr_file[i].valid && free_mshr == -1)
+         free_mshr = i;
+   }
+   if(free_mshr != -1) {
+      mshr_file[free_mshr].valid         = true;
+      mshr_file[free_mshr].address       = address;
+      mshr_file[free_mshr].latency_count = latency;
+      if(dram_model != NULL)
+         mshr_file[free_mshr].request    = dram_model->enqueue(address, false, cycleCount);
+   }
+   return free_mshr;
+}
+
+//----------------------------------------------------------------------
+// Write the oldest buffered store to data memory once its latency has
+// elapsed (one store at a time through the write port)
+//----------------------------------------------------------------------
+void sim_pipe_fp::drain_store_buffer() {
+   store_buffer_occupancy      += store_buffer.size();
+   max_store_buffer_occupancy   = max(max_store_buffer_occupancy, (unsigned)store_buffer.size());
+   if(store_buffer.empty())
+      return;
+   if(dram_model != NULL ? !dram_model->complete(store_buffer.front().request, cycleCount) : --store_buffer.front().latency_count != 0)
+      return;
+   write_memory(store_buffer.front().address, store_buffer.front().value);
+   store_buffer.pop_front();
+}
+
+//----------------------------------------------------------------------
+// Look up the youngest buffered store to "address"
+//----------------------------------------------------------------------
+bool sim_pipe_fp::forward_store(unsigned address, unsigned &value) {
+   for(int i = store_buffer.size() - 1; i >= 0; i--) {
+      if(store_buffer[i].address == address) {
+         value = store_buffer[i].value;
+         store_forwarding_hits++;
+         return true;
+      }
+   }
+   return false;
+}
+
+bool sim_pipe_fp::MIPS_MEM() {
+
+   instruction_t& instruction                     = instruction_register[MEM];
+   bool          forwarded                        = false;
+   unsigned      forwarded_value                  = UNDEFINED;
+   bool          is_store                         = (instruction.opcode == SW || instruction.opcode == SWS || instruction.opcode == SWAP);
+
+   if(lsq_size > 0)
+      lsq_cycle();
+   unsigned      store_value                      = (!is_store) ? UNDEFINED : renaming ? sp_registers[MEM][B] : regRead(instruction.src2, instruction.src2_float_op);
+
+  //-------------------------------------------------------------------
+  // Store buffer: a load hitting a buffered store is forwarded, a store
+  // finding the buffer full stalls and EOP waits for the buffer to drain
+  //-------------------------------------------------------------------
+   if(store_buffer_size > 0) {
+      drain_store_buffer();
+      bool hold                                   = false;
+      switch(instruction.opcode) {
+         case LW:
+         case LWS:
+            forwarded                             = forward_store(sp_registers[MEM][ALU_OUTPUT], forwarded_value);
             break;
 
-         case JUMP:
-            sp_registers[MEM][ALU_OUTPUT] = alu(npc, instruction.imm, false, false, instruction.opcode);
-            sp_registers[MEM][COND]       = 1;
+         case SW:
+         case SWS:
+            if(store_buffer.size() == store_buffer_size) {
+               stall_count++;
+               store_buffer_full_stalls++;
+               if(profiling != NULL)
+                  profiling->stall(instruction.pc, STALL_STRUCTURAL);
+               if(monitoring != NULL)
+                  monitoring->stall(instruction.pc, STALL_STRUCTURAL);
+               hold                               = true;
+            }
             break;
 
-         case NOP:
          case EOP:
+            hold                                  = !store_buffer.empty();
             break;
 
-         default:
-            ASSERT(false, "Unknown operation encountered");
-            break;
+         default: break;
+      }
+      if(hold) {
+         if(num_mshrs == 0) {
+            instruction_register[WB].set_stall();
+            clear_sp_register(WB);
+         }
+         return true;
       }
    }
-   instruction_register[MEM]  = instruction;
-   data_memory_latency_count                    = memLatency;
-}
 
-bool sim_pipe_fp::MIPS_MEM() {
+  //-------------------------------------------------------------------
+  // Non-blocking memory stage: a load reads memory on entry, waits for
+  // its data in an MSHR and is queued for in-order write-back while the
+  // execution units keep running
+  //-------------------------------------------------------------------
+   if(num_mshrs > 0) {
+      tick_mshrs();
+
+      wb_entry_t entry;
+      entry.instruction                        = instruction;
+      entry.alu_output                         = sp_registers[MEM][ALU_OUTPUT];
+      entry.lmd                                = UNDEFINED;
+      entry.mshr                               = -1;
+
+      switch(instruction.opcode) {
+         case LW:
+         case LWS:
+            if(forwarded) {
+               entry.lmd                       = forwarded_value;
+               break;
+            }
+            if(data_memory_latency_count != 0 || dram_model != NULL) {
+               entry.mshr                      = allocate_mshr( sp_registers[MEM][ALU_OUTPUT], data_memory_latency_count );
+               if(entry.mshr == -1) {
+                  stall_count++;
+                  mshr_full_stalls++;
+                  if(profiling != NULL)
+                     profiling->stall(instruction.pc, STALL_STRUCTURAL);
+                  if(monitoring != NULL)
+                     monitoring->stall(instruction.pc, STALL_STRUCTURAL);
+                  return true;
+               }
+            }
+            entry.lmd                          = read_memory( sp_registers[MEM][ALU_OUTPUT] );
+            break;
+
+         case SW:
+         case SWS:
+            if(store_buffer_size > 0 && (memLatency != 0 || dram_model != NULL)) {
+               store_entry_t store             = { sp_registers[MEM][ALU_OUTPUT], store_value, memLatency, -1 };
+               store_buffer.push_back(store);
+               if(dram_model != NULL)
+                  store_buffer.back().request = dram_model->enqueue(store.address, true, cycleCount);
+               break;
+            }
+            if(memory_busy(sp_registers[MEM][ALU_OUTPUT], true)){
+               stall_count++;
+               if(profiling != NULL)
+                  profiling->stall(instruction.pc, STALL_MEMORY);
+               if(monitoring != NULL)
+                  monitoring->stall(instruction.pc, STALL_MEMORY);
+               return true;
+            }
+            write_memory(sp_registers[MEM][ALU_OUTPUT], store_value);
+            break;
+
+         default: break;
+      }
+      if(instruction.opcode != NOP)          // bubbles do not occupy the write-back queue
+         wb_queue.push_back(entry);
+
+      unsigned outstanding                     = 0;
+      for(unsigned j = 0; j < wb_queue.size(); j++) {
+         outstanding                          += (wb_queue[j].mshr != -1);
+      }
+      max_outstanding_loads                    = max(max_outstanding_loads, outstanding);
+      return false;
+   }
 
-   instruction_t instruction                      = instruction_register[MEM]; 
    sp_registers[WB][LMD]                          = UNDEFINED;
 
    switch(instruction.opcode) {
       case LW:
       case LWS:
-         while(data_memory_latency_count--){
+         if(forwarded) {
+            sp_registers[WB][LMD]              = forwarded_value;
+            break;
+         }
+         if(memory_busy(sp_registers[MEM][ALU_OUTPUT], false)){
             stall_count++;
+            if(profiling != NULL)
+               profiling->stall(instruction.pc, STALL_MEMORY);
+            if(monitoring != NULL)
+               monitoring->stall(instruction.pc, STALL_MEMORY);
             instruction_register[WB].set_stall();
             clear_sp_register(WB);
             return true;
@@ -464,13 +1336,50 @@ bool sim_pipe_fp::MIPS_MEM() {
 
       case SW:
       case SWS:
-         while(data_memory_latency_count--){
+         if(store_buffer_size > 0 && (memLatency != 0 || dram_model != NULL)) {
+            store_entry_t store                = { sp_registers[MEM][ALU_OUTPUT], store_value, memLatency, -1 };
+            store_buffer.push_back(store);
+            if(dram_model != NULL)
+               store_buffer.back().request = dram_model->enqueue(store.address, true, cycleCount);
+            break;
+         }
+         if(memory_busy(sp_registers[MEM][ALU_OUTPUT], true)){
+            stall_count++;
+            if(profiling != NULL)
+               profiling->stall(instruction.pc, STALL_MEMORY);
+            if(monitoring != NULL)
+               monitoring->stall(instruction.pc, STALL_MEMORY);
+            instruction_register[WB].set_stall();
+            clear_sp_register(WB);
+            return true;
+         }
+         write_memory(sp_registers[MEM][ALU_OUTPUT], store_value);
+         break;
+
+      case SWAP:                                   // atomic: the read and the write take place in the same cycle
+         if((!atomic_issued && memory_busy(sp_registers[MEM][ALU_OUTPUT], true)) || (deferred && !atomic_ready)){
+            if(deferred && !atomic_issued){        // running a quantum: the swap takes place at its end
+               memory_event_t event            = {(unsigned)cycleCount, core_id, sp_registers[MEM][ALU_OUTPUT], store_value, true};
+               memory_events.push_back(event);
+               atomic_issued                   = true;
+            }
             stall_count++;
+            if(profiling != NULL)
+               profiling->stall(instruction.pc, STALL_MEMORY);
+            if(monitoring != NULL)
+               monitoring->stall(instruction.pc, STALL_MEMORY);
             instruction_register[WB].set_stall();
             clear_sp_register(WB);
             return true;
          }
-         write_memory(sp_registers[MEM][ALU_OUTPUT], regRead(instruction.src2, instruction.src2_float_op));
+         if(atomic_ready){
+            sp_registers[WB][LMD]              = atomic_value;
+            atomic_issued                      = false;
+            atomic_ready                       = false;
+         } else {
+            sp_registers[WB][LMD]              = read_memory( sp_registers[MEM][ALU_OUTPUT] );
+            write_memory(sp_registers[MEM][ALU_OUTPUT], store_value);
+         }
          break;
 
       default: break;
@@ -481,13 +1390,46 @@ bool sim_pipe_fp::MIPS_MEM() {
 }
 
 bool sim_pipe_fp::MIPS_WB() {
-   instruction_t instruction                = instruction_register[WB]; 
+   if(num_mshrs > 0) {
+      if(wb_queue.empty() || wb_queue.front().mshr != -1) {
+         instruction_register[WB].set_stall();
+         clear_sp_register(WB);
+         return false;
+      }
+      instruction_register[WB]              = wb_queue.front().instruction;
+      sp_registers[WB][ALU_OUTPUT]          = wb_queue.front().alu_output;
+      sp_registers[WB][LMD]                 = wb_queue.front().lmd;
+      wb_queue.pop_front();
+   }
+   // deeper memory pipeline: the result leaving MEM reaches WB after the extra memory sub-stages
+   if(!memory_pipe.empty()) {
+      wb_entry_t entry                      = { instruction_register[WB], sp_registers[WB][ALU_OUTPUT], sp_registers[WB][LMD], -1 };
+      memory_pipe.push_back(entry);
+      instruction_register[WB]              = memory_pipe.front().instruction;
+      sp_registers[WB][ALU_OUTPUT]          = memory_pipe.front().alu_output;
+      sp_registers[WB][LMD]                 = memory_pipe.front().lmd;
+      memory_pipe.pop_front();
+   }
+   instruction_t& instruction               = instruction_register[WB];
+   if(profiling != NULL)
+      profile_write_back(instruction);
    if (instruction.opcode == EOP){
       return true;
    }
+   if(monitoring != NULL && instruction.opcode != NOP)
+      pmu_retire(instruction);
+   // sampled simulation: the instruction (both of a fused pair) commits
+   if(sampling != NULL && instruction.opcode != NOP)
+      sample_commit(instruction.fused_opcode != NOP ? 2 : 1);
+   if(instruction.fused_opcode != NOP)
+      set_int_register(instruction.fused_dest, instruction.fused_value);
    if(instruction.dest_op) {
-      unsigned result = (instruction.opcode == LW || instruction.opcode == LWS) ? sp_registers[WB][LMD] : sp_registers[WB][ALU_OUTPUT];
-      if(instruction.dest_float_op) {
+      unsigned result = (instruction.opcode == LW || instruction.opcode == LWS || instruction.opcode == SWAP) ? sp_registers[WB][LMD] : sp_registers[WB][ALU_OUTPUT];
+      if(lsq_size > 0)
+         lsq_register_written(instruction.dest, instruction.dest_float_op, result);
+      if(renaming)
+         rename_write(instruction, result);
+      else if(instruction.dest_float_op) {
          set_fp_register(instruction.dest, unsigned2float(result));
       }
       else
@@ -497,16 +1439,57 @@ bool sim_pipe_fp::MIPS_WB() {
 }
 
 void sim_pipe_fp::run(unsigned cycles){
+   ASSERT( replay == NULL || (scheduler == IN_ORDER && issue_width == 1 && contexts.empty() && lsq_size == 0), "A trace is only replayed by the scalar in-order pipeline" );
+   ASSERT( profiling == NULL || (scheduler == IN_ORDER && issue_width == 1 && contexts.empty() && lsq_size == 0), "The profiler needs the scalar in-order pipeline without a load/store queue" );
+   ASSERT( monitoring == NULL || (scheduler == IN_ORDER && issue_width == 1 && contexts.empty() && lsq_size == 0), "The PMU needs the scalar in-order pipeline without a load/store queue" );
+   if(scheduler == TOMASULO) {
+      run_tomasulo(cycles);
+      return;
+   }
+   if(scheduler == SCOREBOARD) {
+      run_scoreboard(cycles);
+      return;
+   }
+   if(issue_width > 1) {
+      run_wide(cycles);
+      return;
+   }
+   if(!contexts.empty()) {
+      run_threads(cycles);
+      return;
+   }
    bool run_to_completion = (cycles == 0);
    while(cycles-- || run_to_completion) {
-      if(MIPS_WB()) return;
+      if(MIPS_WB()) break;
+      if(monitoring != NULL)
+         pmu_cycle();
       if( !MIPS_MEM() ) {
          MIPS_EXE();
          bool stall          = MIPS_ID();
          MIPS_IF(stall);
       }
+      else if(fetch_queue_size > 0)
+         MIPS_IF(true);      // the decoupled front-end keeps fetching while the memory stage stalls
+      else if(replay != NULL) {
+         // replaying a trace, skip the cycles the rest of the memory latency keeps the whole pipeline frozen
+         unsigned skip       = run_to_completion ? frozen_cycles() : min(frozen_cycles(), cycles);
+         if(profiling != NULL && skip > 0)
+            profiling->stall(instruction_register[MEM].pc, STALL_MEMORY, skip);
+         if(monitoring != NULL && skip > 0) {
+            pmu_cycle(skip);
+            monitoring->stall(instruction_register[MEM].pc, STALL_MEMORY, skip);
+         }
+         data_memory_latency_count -= skip;
+         stall_count         += skip;
+         account_exec_units(skip);
+         cycleCount          += skip;
+         cycles              -= run_to_completion ? 0 : skip;
+      }
+      account_exec_units();
       cycleCount++;
    }
+   if(profiling != NULL)
+      profile_flush();
 }
 void sim_pipe_fp::reset(){
    data_memory       = new unsigned char[dataMemSize];
@@ -520,10 +1503,16 @@ void sim_pipe_fp::reset(){
 
    for(int i = 0; i < NUM_GP_REGISTERS; i++) {
       int_file[i].value = UNDEFINED;
+      int_file[i].busy  = 0;
+      int_file[i].rob   = -1;
+      int_file[i].fu    = -1;
    }
 
    for(int i = 0; i < NUM_GP_REGISTERS; i++) {
       fp_file[i].value = UNDEFINED;
+      fp_file[i].busy  = 0;
+      fp_file[i].rob   = -1;
+      fp_file[i].fu    = -1;
    }
 
    for(int i = 0; i < NUM_STAGES; i++) {
@@ -579,12 +1568,32 @@ int sim_pipe_fp::labelToPC( const char* filename, const char* label, uint32_t pc
    return ((line - pc_index - 1) * 4);
 }
 
+void sim_pipe_fp::scan_labels(const char *filename, map<string, unsigned>& labels){
+   FILE* temp     = fopen(filename, "r");
+   ASSERT(temp, "Unable to open file %s", filename);
+   unsigned line  = 0;
+   char str[1024];
+   while(fscanf(temp, "%1023s", str) == 1){
+      unsigned length = strlen(str);
+      if(str[length-1] == ':'){
+         str[length-1] = '\0';
+         labels.insert(make_pair(string(str), line));
+      }
+      if( opcode_2str.count( string( str ) ) > 0 )
+         line++;
+   }
+   fclose(temp);
+}
+
 int sim_pipe_fp::parse( const char* filename ){
    FILE* trace;
    char buff[1024], label[495];
    int a, b, c, lineNo = 0;
    char imm[32];
+   map<string, unsigned> labels;
 
+   // labels are resolved from a single scan of the file; labelToPC() handles the ones never defined
+   scan_labels(filename, labels);
    trace  = fopen(filename, "r");
    ASSERT(trace, "Unable to open file %s", filename);
 
@@ -621,7 +1630,7 @@ int sim_pipe_fp::parse( const char* filename ){
             fscanf(trace, "%s", label);
             
             instructP->src1       = a;
-            instructP->imm        = labelToPC( filename, label, lineNo );
+            instructP->imm        = labels.count(label) ? (labels[label] - lineNo - 1) * 4 : labelToPC( filename, label, lineNo );
             instructP->src1_op  = true;
             instructP->branch_op  = true;
             break;
@@ -644,7 +1653,7 @@ int sim_pipe_fp::parse( const char* filename ){
 
          case JUMP:
             fscanf(trace, "%s", label);
-            instructP->imm        = labelToPC( filename, label, lineNo );
+            instructP->imm        = labels.count(label) ? (labels[label] - lineNo - 1) * 4 : labelToPC( filename, label, lineNo );
             instructP->branch_op  = true;
             break;
 
@@ -660,6 +1669,20 @@ int sim_pipe_fp::parse( const char* filename ){
             instructP->src1_op  = true;
             break;
 
+         case SWAP:
+            a                     = parseReg(trace, instructP->dest_float_op);
+            fscanf(trace, "%d(", &b);
+            c                     = parseReg(trace, instructP->src1_float_op);
+            ASSERT( !instructP->dest_float_op, "SWAP exchanges an integer register" );
+            instructP->dest        = a;
+            instructP->src2       = a;
+            instructP->imm        = b;
+            instructP->src1       = c;
+            instructP->dest_op   = true;
+            instructP->src2_op  = true;
+            instructP->src1_op  = true;
+            break;
+
          case SW:
          case SWS:
             a                     = parseReg(trace, instructP->src2_float_op);
@@ -702,20 +1725,10 @@ uint32_t sim_pipe_fp::parseReg( FILE* trace, bool& is_float ){
    return reg;
 }
 
-inline unsigned sim_pipe_fp::float2unsigned(float value){
-        unsigned result;
-        memcpy(&result, &value, sizeof value);
-        return result;
-}
-
-inline float sim_pipe_fp::unsigned2float(unsigned value){
-        float result;
-        memcpy(&result, &value, sizeof value);
-        return result;
-}
-
 
 unsigned sim_pipe_fp::regRead(unsigned reg, bool isF){
+   if(renaming)
+      return rename_file[isF].value[rename_file[isF].map[reg]];
    return isF ? float2unsigned(fp_file[reg].value) : int_file[reg].value;
 }
 
@@ -745,14 +1758,28 @@ unsigned sim_pipe_fp::get_sp_register(sp_register_t reg, stage_t s){
 //----------------------------------------------------------------------
 // Gets value of Integer General-Purpose register
 //----------------------------------------------------------------------
-int sim_pipe_fp::get_int_register(unsigned reg){
+int sim_pipe_fp::get_int_register(unsigned reg, unsigned thread){
+   ASSERT( thread == 0 || thread < contexts.size(), "Hardware thread %d does not exist", thread );
+   if(thread > 0)
+      return contexts[thread].int_file[reg].value;
+   if(renaming)
+      return rename_file[0].value[rename_file[0].arch[reg]];
 	return int_file[reg].value; 
 }
 
 //----------------------------------------------------------------------
 // Sets value of Integer General-Purpose register
 //----------------------------------------------------------------------
-void sim_pipe_fp::set_int_register(unsigned reg, int value){
+void sim_pipe_fp::set_int_register(unsigned reg, int value, unsigned thread){
+   ASSERT( thread == 0 || thread < contexts.size(), "Hardware thread %d does not exist", thread );
+   if(thread > 0) {
+      contexts[thread].int_file[reg].value = value;
+      return;
+   }
+   if(renaming) {
+      rename_file[0].value[rename_file[0].arch[reg]] = value;
+      return;
+   }
    int_file[reg].value = value;
    if(int_file[reg].busy != 0)
       int_file[reg].busy--;
@@ -761,14 +1788,28 @@ void sim_pipe_fp::set_int_register(unsigned reg, int value){
 //----------------------------------------------------------------------
 // Returns value of Floating-Point General-Purpose register
 //----------------------------------------------------------------------
-float sim_pipe_fp::get_fp_register(unsigned reg){
+float sim_pipe_fp::get_fp_register(unsigned reg, unsigned thread){
+   ASSERT( thread == 0 || thread < contexts.size(), "Hardware thread %d does not exist", thread );
+   if(thread > 0)
+      return contexts[thread].fp_file[reg].value;
+   if(renaming)
+      return unsigned2float(rename_file[1].value[rename_file[1].arch[reg]]);
 	return fp_file[reg].value;
 }
 
 //----------------------------------------------------------------------
 // Sets value of Floating-Point General-Purpose register
 //----------------------------------------------------------------------
-void sim_pipe_fp::set_fp_register(unsigned reg, float value){
+void sim_pipe_fp::set_fp_register(unsigned reg, float value, unsigned thread){
+   ASSERT( thread == 0 || thread < contexts.size(), "Hardware thread %d does not exist", thread );
+   if(thread > 0) {
+      contexts[thread].fp_file[reg].value = value;
+      return;
+   }
+   if(renaming) {
+      rename_file[1].value[rename_file[1].arch[reg]] = float2unsigned(value);
+      return;
+   }
    fp_file[reg].value = value;
    if(fp_file[reg].busy != 0)
       fp_file[reg].busy--;
@@ -785,6 +1826,12 @@ float sim_pipe_fp::get_IPC(){
 // Returns Total Instructions Executed
 //----------------------------------------------------------------------
 unsigned sim_pipe_fp::get_instructions_executed(){
+   if(!contexts.empty()) {
+      unsigned instructions = 0;
+      for(unsigned i = 0; i < contexts.size(); i++)
+         instructions += contexts[i].instructions;
+      return instructions;
+   }
 	return instruction_count; 
 }
 
@@ -802,10 +1849,204 @@ unsigned sim_pipe_fp::get_clock_cycles(){
    return cycleCount; 
 }
 
+//----------------------------------------------------------------------
+// Returns Stalls caused by all MSHRs being busy
+//----------------------------------------------------------------------
+unsigned sim_pipe_fp::get_mshr_full_stalls(){
+   return mshr_full_stalls;
+}
+
+//----------------------------------------------------------------------
+// Returns Loads merged into an outstanding MSHR
+//----------------------------------------------------------------------
+unsigned sim_pipe_fp::get_mshr_merges(){
+   return mshr_merges;
+}
+
+//----------------------------------------------------------------------
+// Returns the peak number of outstanding loads
+//----------------------------------------------------------------------
+unsigned sim_pipe_fp::get_max_outstanding_loads(){
+   return max_outstanding_loads;
+}
+
+//----------------------------------------------------------------------
+// Returns Stalls caused by a full store buffer
+//----------------------------------------------------------------------
+unsigned sim_pipe_fp::get_store_buffer_full_stalls(){
+   return store_buffer_full_stalls;
+}
+
+//----------------------------------------------------------------------
+// Returns Loads forwarded from the store buffer
+//----------------------------------------------------------------------
+unsigned sim_pipe_fp::get_store_forwarding_hits(){
+   return store_forwarding_hits;
+}
+
+//----------------------------------------------------------------------
+// Returns the average store buffer occupancy per clock cycle
+//----------------------------------------------------------------------
+float sim_pipe_fp::get_store_buffer_avg_occupancy(){
+   return cycleCount ? (float) store_buffer_occupancy / (float) cycleCount : 0;
+}
+
+//----------------------------------------------------------------------
+// Returns the peak store buffer occupancy
+//----------------------------------------------------------------------
+unsigned sim_pipe_fp::get_store_buffer_max_occupancy(){
+   return max_store_buffer_occupancy;
+}
+
+//----------------------------------------------------------------------
+// Prefetcher statistics (0 without a prefetcher)
+//----------------------------------------------------------------------
+float sim_pipe_fp::get_prefetch_accuracy(){
+   return (data_prefetcher != NULL) ? data_prefetcher->get_accuracy() : 0;
+}
+
+float sim_pipe_fp::get_prefetch_coverage(){
+   return (data_prefetcher != NULL) ? data_prefetcher->get_coverage() : 0;
+}
+
+float sim_pipe_fp::get_prefetch_timeliness(){
+   return (data_prefetcher != NULL) ? data_prefetcher->get_timeliness() : 0;
+}
+
+//----------------------------------------------------------------------
+// DRAM statistics (0 without a DRAM model)
+//----------------------------------------------------------------------
+unsigned sim_pipe_fp::get_dram_row_hits(){
+   return (dram_model != NULL) ? dram_model->get_row_hits() : 0;
+}
+
+unsigned sim_pipe_fp::get_dram_row_misses(){
+   return (dram_model != NULL) ? dram_model->get_row_misses() : 0;
+}
+
+unsigned sim_pipe_fp::get_dram_row_conflicts(){
+   return (dram_model != NULL) ? dram_model->get_row_conflicts() : 0;
+}
+
+float sim_pipe_fp::get_dram_avg_latency(){
+   return (dram_model != NULL) ? dram_model->get_avg_latency() : 0;
+}
+
+//----------------------------------------------------------------------
+// Load/store queue statistics
+//----------------------------------------------------------------------
+unsigned sim_pipe_fp::get_lsq_full_stalls(){
+   return lsq_full_stalls;
+}
+
+unsigned sim_pipe_fp::get_lsq_forwards(){
+   return lsq_forwards;
+}
+
+unsigned sim_pipe_fp::get_lsq_bypasses(){
+   return lsq_bypasses;
+}
+
+unsigned sim_pipe_fp::get_lsq_replays(){
+   return lsq_replays;
+}
+
+//----------------------------------------------------------------------
+// Returns the cycles in which issue waited for a free physical register
+//----------------------------------------------------------------------
+unsigned sim_pipe_fp::get_free_list_stalls(){
+   return free_list_stalls;
+}
+
+//----------------------------------------------------------------------
+// Returns the average fetch queue occupancy per clock cycle
+//----------------------------------------------------------------------
+float sim_pipe_fp::get_fetch_queue_avg_occupancy(){
+   return cycleCount ? (float) fetch_queue_occupancy / (float) cycleCount : 0;
+}
+
+//----------------------------------------------------------------------
+// Returns the peak fetch queue occupancy
+//----------------------------------------------------------------------
+unsigned sim_pipe_fp::get_fetch_queue_max_occupancy(){
+   return max_fetch_queue_occupancy;
+}
+
+//----------------------------------------------------------------------
+// Returns the cycles decode found the fetch queue empty
+//----------------------------------------------------------------------
+unsigned sim_pipe_fp::get_fetch_starved_cycles(){
+   return fetch_starved_cycles;
+}
+
+//----------------------------------------------------------------------
+// Returns the instruction pairs fused with the given idiom
+//----------------------------------------------------------------------
+unsigned sim_pipe_fp::get_fusion_hits(fusion_idiom_t idiom){
+   return (idiom == FUSE_COMPARE_BRANCH) ? compare_branch_fusions : increment_load_fusions;
+}
+
+//----------------------------------------------------------------------
+// Returns the cycles in which the superscalar core issued a group of
+// the given size
+//----------------------------------------------------------------------
+unsigned sim_pipe_fp::get_issue_histogram(unsigned instructions){
+   return instructions < issue_histogram.size() ? issue_histogram[instructions] : 0;
+}
+
+//----------------------------------------------------------------------
+// Per-thread statistics of the multithreaded core
+//----------------------------------------------------------------------
+unsigned sim_pipe_fp::get_thread_instructions(unsigned thread){
+   ASSERT( thread < contexts.size(), "Hardware thread %d does not exist", thread );
+   return contexts[thread].instructions;
+}
+
+unsigned sim_pipe_fp::get_thread_cycles(unsigned thread){
+   ASSERT( thread < contexts.size(), "Hardware thread %d does not exist", thread );
+   return contexts[thread].done ? contexts[thread].finish_cycle : cycleCount;
+}
+
+float sim_pipe_fp::get_thread_IPC(unsigned thread){
+   return get_thread_cycles(thread) ? (float) get_thread_instructions(thread) / (float) get_thread_cycles(thread) : 0;
+}
+
+unsigned sim_pipe_fp::get_thread_switches(){
+   return thread_switches;
+}
+
+//----------------------------------------------------------------------
+// Returns the average number of operations in flight in an execution
+// unit per clock cycle
+//----------------------------------------------------------------------
+float sim_pipe_fp::get_unit_avg_occupancy(exe_unit_t exec_unit){
+   return cycleCount ? (float) float_point_exe_reg[exec_unit].occupancy / (float) cycleCount : 0;
+}
+
+//----------------------------------------------------------------------
+// Returns the peak number of operations in flight in an execution unit
+//----------------------------------------------------------------------
+unsigned sim_pipe_fp::get_unit_max_occupancy(exe_unit_t exec_unit){
+   return float_point_exe_reg[exec_unit].max_occupancy;
+}
+
+//----------------------------------------------------------------------
+// Returns the fraction of the issue slots of an execution unit that
+// started an operation
+//----------------------------------------------------------------------
+float sim_pipe_fp::get_unit_utilization(exe_unit_t exec_unit){
+   execUnitT& unit   = float_point_exe_reg[exec_unit];
+   int interval      = unit.initiation_interval ? unit.initiation_interval : unit.latency;
+   float slots       = (float) unit.instances * (float) cycleCount / (float) interval;
+   return slots > 0 ? (float) unit.started / slots : 0;
+}
+
 unsigned sim_pipe_fp::read_memory(unsigned address){
    unsigned value = 0;
    ASSERT( address % 4 == 0, "Unaligned memory access found at address %x", address ); 
    ASSERT ( (address >= 0) && (address < dataMemSize), "Out of bounds memory accessed: Seg Fault!!!!" );
+   if(deferred && own_writes.count(address))
+      return own_writes[address];
    value |= data_memory[address + 0];
    value |= data_memory[address + 1] << 8;  
    value |= data_memory[address + 2] << 16;
@@ -816,6 +2057,12 @@ unsigned sim_pipe_fp::read_memory(unsigned address){
 void sim_pipe_fp::write_memory(unsigned address, unsigned value){
    ASSERT( address % 4 == 0, "Unaligned memory access found at address %x", address ); 
    ASSERT ( (address >= 0) && (address < dataMemSize), "Out of bounds memory accessed: Seg Fault!!!!" );
+   if(deferred){
+      memory_event_t event = {(unsigned)cycleCount, core_id, address, value, false};
+      memory_events.push_back(event);
+      own_writes[address] = value;
+      return;
+   }
    data_memory[address + 0] = value;
    data_memory[address + 1] = value >> 8;
    data_memory[address + 2] = value >> 16;
@@ -13,33 +13,62 @@
 #include <malloc.h>
 
 #include <vector>
+#include <deque>
 #include <algorithm>
+#include <climits>
 
 #define UNDEFINED 0xFFFFFFFF 
 #define DATA_UNDEF 0
 #define NUM_SP_REGISTERS 9
 #define NUM_GP_REGISTERS 32
-#define NUM_OPCODES 29
+#define NUM_OPCODES 30
 #define NUM_STAGES 5
 
-#define ASSERT( condition, statement, ... ) \
-   if( !(condition) ) { \
-      printf( "[ASSERT] In File: %s, Line: %d => " #statement "\n", __FILE__, __LINE__, ##__VA_ARGS__ ); \
-      abort(); \
-   }
+#include "sim_assert.h"
+
+#include "prefetcher.h"
+#include "dram.h"
+#include "coherence.h"
+#include "barrier.h"
+#include "trace.h"
+#include "program.h"
+#include "sampler.h"
+#include "simpoint.h"
+#include "profiler.h"
+#include "pmu.h"
 
 using namespace std;
 
 typedef enum {PC, NPC, IR, A, B, IMM, COND, ALU_OUTPUT, LMD} sp_register_t;
 
-typedef enum {ADD, SUB, XOR, OR, AND, MULT, DIV, BEQZ, BNEZ, BLTZ, BGTZ, BLEZ, BGEZ, ADDI, SUBI, XORI, ORI, ANDI, JUMP, EOP, NOP, LW, SW, LWS, SWS, ADDS, SUBS, MULTS, DIVS} opcode_t;
+typedef enum {ADD, SUB, XOR, OR, AND, MULT, DIV, BEQZ, BNEZ, BLTZ, BGTZ, BLEZ, BGEZ, ADDI, SUBI, XORI, ORI, ANDI, JUMP, EOP, NOP, LW, SW, LWS, SWS, ADDS, SUBS, MULTS, DIVS, SWAP} opcode_t;
 
-const string opcode_str[] = {"ADD", "SUB", "XOR", "OR", "AND", "MULT", "DIV", "BEQZ", "BNEZ", "BLTZ", "BGTZ", "BLEZ", "BGEZ", "ADDI", "SUBI", "XORI", "ORI", "ANDI", "JUMP", "EOP", "NOP", "LW", "SW", "LWS", "SWS", "ADDS", "SUBS", "MULTS", "DIVS"};
+const string opcode_str[] = {"ADD", "SUB", "XOR", "OR", "AND", "MULT", "DIV", "BEQZ", "BNEZ", "BLTZ", "BGTZ", "BLEZ", "BGEZ", "ADDI", "SUBI", "XORI", "ORI", "ANDI", "JUMP", "EOP", "NOP", "LW", "SW", "LWS", "SWS", "ADDS", "SUBS", "MULTS", "DIVS", "SWAP"};
 
 typedef enum {IF, ID, EX, MEM, WB} stage_t;
 
 typedef enum {INTEGER, ADDER, MULTIPLIER, DIVIDER, EXE_UNIT_SIZE} exe_unit_t;
 
+// Instruction scheduling performed by the core, selected at construction
+typedef enum {IN_ORDER, TOMASULO, SCOREBOARD} scheduler_t;
+
+// Progress of an instruction held in a Tomasulo reservation station
+typedef enum {RS_WAIT, RS_EXEC, RS_MEM_WAIT, RS_STORE_DATA, RS_DONE} rs_state_t;
+
+// Scoreboard stage reached by the instruction held in a functional unit (instruction status)
+typedef enum {SB_ISSUED, SB_READ_OPERANDS, SB_EXECUTED} sb_state_t;
+
+// Memory disambiguation of the load/store queue: a load waits for the addresses of all older stores, or
+// speculates past the unknown ones and replays if one turns out to match
+typedef enum {CONSERVATIVE, SPECULATIVE} disambiguation_t;
+
+// Macro-op fusion idioms recognised at decode, combined as a bit mask
+typedef enum {FUSE_COMPARE_BRANCH = 1, FUSE_INCREMENT_LOAD = 2} fusion_idiom_t;
+
+// Thread scheduling of the multithreaded core: a different thread every cycle, a thread until it waits for
+// data memory, or several threads issuing in the same cycle
+typedef enum {ROUND_ROBIN, SWITCH_ON_STALL, SIMULTANEOUS} thread_policy_t;
+
 typedef struct instruction_t* instructPT;
 
 struct instruction_t{
@@ -56,6 +85,16 @@ struct instruction_t{
    bool               src2_float_op;
    bool               is_stall;
    bool               branch_op;
+   uint32_t           pdest;        // physical destination register and rename order (register renaming)
+   unsigned           rename_seq;
+   opcode_t           fused_opcode;   // integer ALU operation fused in front of the instruction (NOP if none); its
+   uint32_t           fused_dest;     // result is written to fused_dest and replaces the first source
+   uint32_t           fused_imm;
+   uint32_t           fused_value;
+   unsigned           pc;             // address the instruction was fetched from (UNDEFINED for bubbles)
+   unsigned           seq;            // number of the dynamic instruction when replaying a trace (the low 32 bits of
+                                      // its record) or profiling (the key of its stamps), UNDEFINED otherwise; a
+                                      // fused pair has the one of its first instruction
 
    instruction_t(){
       nop();
@@ -79,6 +118,14 @@ struct instruction_t{
       dest_float_op = false;
       src1_float_op = false;
       src2_float_op = false;
+      pdest         = UNDEFINED;
+      rename_seq    = 0;
+      fused_opcode  = NOP;
+      fused_dest    = UNDEFINED;
+      fused_imm     = UNDEFINED;
+      fused_value   = UNDEFINED;
+      pc            = UNDEFINED;
+      seq           = UNDEFINED;
    }
 
    void set_stall(){
@@ -97,6 +144,11 @@ class sim_pipe_fp{
          int            latency_exe;
          unsigned       b;
          unsigned       exNpc;
+         int            station;          // reservation station served by the lane (out-of-order cores), or load/store queue entry generating its address
+         unsigned       a;                // operands captured at issue and issue order (superscalar core)
+         unsigned       seq;
+         int            instance;         // unit instance the lane belongs to
+         unsigned       thread;           // hardware thread of the operation (multithreaded core)
 
          execLaneT(){
             latency_exe            = 0;
@@ -108,23 +160,204 @@ class sim_pipe_fp{
          execLaneT      *exe_pipe_units;
          int            num_exe_pipe_units;
          int            latency;
+         int            instances;
+         int            initiation_interval;   // cycles between two operations entering an instance, 0 if not pipelined
+         int            *next_start;           // first cycle each instance accepts a new operation
+         unsigned       started;               // operations started
+         unsigned long  occupancy;             // operations in flight, summed over the clock cycles
+         unsigned       max_occupancy;
 
          execUnitT(){
             exe_pipe_units          = NULL;
             num_exe_pipe_units       = 0;
             latency        = 0;
+            instances      = 0;
+            initiation_interval = 0;
+            next_start     = NULL;
+            started        = 0;
+            occupancy      = 0;
+            max_occupancy  = 0;
          }
 
          void init(int num_exe_pipe_units, int latency){
             ASSERT( latency > 0, "Impractical latency found (=%d)", latency );
             ASSERT( num_exe_pipe_units > 0, "Unsupported number of exe_pipe_units (=%d)", num_exe_pipe_units );
-            this->num_exe_pipe_units += num_exe_pipe_units;
+            this->instances += num_exe_pipe_units;
             this->latency   = latency;
-            exe_pipe_units           = (execLaneT*)realloc(exe_pipe_units, this->num_exe_pipe_units * sizeof(execLaneT));
+            layout();
+         }
+
+         // operations an instance holds in flight: one lane each
+         int depth(){
+            return initiation_interval ? (latency + initiation_interval - 1) / initiation_interval : 1;
+         }
+
+         void layout(){
+            num_exe_pipe_units       = instances * depth();
+            exe_pipe_units           = (execLaneT*)realloc(exe_pipe_units, num_exe_pipe_units * sizeof(execLaneT));
+            next_start               = (int*)realloc(next_start, instances * sizeof(int));
+            for(int j = 0; j < num_exe_pipe_units; j++) {
+               exe_pipe_units[j].latency_exe = 0;
+               exe_pipe_units[j].instruction.set_stall();
+               exe_pipe_units[j].instance    = j / depth();
+               exe_pipe_units[j].station     = -1;
+            }
+            for(int i = 0; i < instances; i++)
+               next_start[i]         = 0;
+         }
+
+         bool accepts(int lane, int cycle){
+            return exe_pipe_units[lane].latency_exe == 0 && next_start[exe_pipe_units[lane].instance] <= cycle;
+         }
+
+         // first lane able to start an operation in the given cycle, -1 if none
+         int free_lane(int cycle){
+            for(int j = 0; j < num_exe_pipe_units; j++)
+               if(accepts(j, cycle))
+                  return j;
+            return -1;
+         }
+
+         // instances able to start an operation in the given cycle
+         int free_instances(int cycle){
+            int count = 0;
+            for(int i = 0; i < instances; i++) {
+               for(int j = i * depth(); j < (i + 1) * depth(); j++) {
+                  if(accepts(j, cycle)) {
+                     count++;
+                     break;
+                  }
+               }
+            }
+            return count;
+         }
+
+         void start(int lane, int cycle){
+            next_start[exe_pipe_units[lane].instance] = cycle + initiation_interval;
+            started++;
          }
       };
       
 
+      // Miss Status Holding Register: one outstanding load to data memory
+      struct mshr_t{
+         bool           valid;
+         unsigned       address;
+         unsigned       latency_count;
+         int            request;       // DRAM request of the miss
+      };
+
+      // Store retired into the store buffer, waiting to be written to data memory
+      struct store_entry_t{
+         unsigned       address;
+         unsigned       value;
+         unsigned       latency_count;
+         int            request;       // DRAM request of the write, -1 without a DRAM model
+      };
+
+      // Load or store waiting in the load/store queue of the in-order core
+      struct lsq_entry_t{
+         instruction_t  instruction;
+         unsigned       npc;
+         unsigned       base;            // base register and store data, captured when the older writes complete
+         unsigned       data;
+         int            base_pending;    // older writes to the register still outstanding
+         int            data_pending;
+         bool           agen_started;
+         bool           address_ready;
+         unsigned       address;
+         bool           started;         // memory access (or forwarding) under way
+         bool           speculative;     // load started past an older store with an unknown address
+         unsigned       value;
+         unsigned       done_cycle;
+         bool           done;
+      };
+
+      // Entry of the in-order write-back queue used by the non-blocking memory stage
+      struct wb_entry_t{
+         instruction_t  instruction;
+         unsigned       alu_output;
+         unsigned       lmd;
+         int            mshr;          // MSHR the entry waits on, -1 once the result is ready
+      };
+
+      // Instruction waiting in the fetch queue of the decoupled front-end
+      struct fetch_entry_t{
+         instruction_t  instruction;
+         unsigned       npc;
+      };
+
+      // Instruction slot of a pipeline latch of the superscalar core
+      struct wide_slot_t{
+         instruction_t  instruction;
+         unsigned       npc;
+         unsigned       a;
+         unsigned       b;
+         unsigned       alu_output;
+         unsigned       lmd;
+         unsigned       seq;
+      };
+
+      // Instruction slot of the multithreaded core, tagged with its hardware thread
+      struct thread_slot_t{
+         instruction_t  instruction;
+         unsigned       thread;
+         unsigned       npc;
+         unsigned       a;
+         unsigned       b;
+         unsigned       alu_output;
+         unsigned       lmd;
+         bool           cond;
+         unsigned       ready_cycle;   // cycle the data memory access of a parked load/store completes
+      };
+
+      // Tomasulo reservation station
+      struct reservation_station_t{
+         bool           busy;
+         rs_state_t     state;
+         instruction_t  instruction;
+         unsigned       npc;
+         unsigned       vj;
+         unsigned       vk;
+         int            qj;            // ROB entries producing the operands, -1 once the value is captured
+         int            qk;
+         int            rob;           // ROB entry receiving the result
+         unsigned       result;
+         bool           cond;
+         unsigned       ready_cycle;   // first cycle the station may start its next step
+         unsigned       done_cycle;    // cycle the result is ready for the common data bus
+      };
+
+      // Tomasulo reorder buffer entry
+      struct rob_entry_t{
+         bool           busy;
+         bool           ready;
+         instruction_t  instruction;
+         unsigned       value;
+         bool           address_ready;
+         unsigned       address;
+      };
+
+      // Scoreboard functional unit status, one per unit instance (lane) of float_point_exe_reg
+      struct fu_status_t{
+         bool           busy;
+         exe_unit_t     unit;
+         int            lane;
+         sb_state_t     state;
+         instruction_t  instruction;   // Op
+         unsigned       npc;
+         unsigned       seq;           // issue order
+         int            qj;            // functional units producing Fj/Fk, -1 if none
+         int            qk;
+         bool           rj;            // Fj/Fk available and not yet read
+         bool           rk;
+         unsigned       vj;
+         unsigned       vk;
+         unsigned       result;
+         bool           cond;
+         unsigned       ready_cycle;   // first cycle the unit may take its next step
+      };
+
       int               cycleCount;
       int               instruction_count;
       int               latCount;
@@ -135,6 +368,8 @@ class sim_pipe_fp{
       struct int_file_t{
          int            value;
          int            busy;
+         int            rob;           // ROB entry that will write the register, -1 if none (Tomasulo)
+         int            fu;            // functional unit that will write the register, -1 if none (scoreboard)
       };
 
       int_file_t        int_file[NUM_GP_REGISTERS];
@@ -142,10 +377,41 @@ class sim_pipe_fp{
       struct fp_file_t{
          float          value;
          int            busy;
+         int            rob;           // ROB entry that will write the register, -1 if none (Tomasulo)
+         int            fu;            // functional unit that will write the register, -1 if none (scoreboard)
       };
 
       fp_file_t          fp_file[NUM_GP_REGISTERS];
 
+      // Hardware thread context: architectural state, program and fetch state of one thread
+      struct thread_context_t{
+         int_file_t     *int_file;          // thread 0 runs on the simulator register files
+         fp_file_t      *fp_file;
+         instructPT     *instMemory;
+         int            instMemSize;
+         unsigned       base_address;
+         unsigned       pc;
+         bool           has_fetched;
+         thread_slot_t  fetched;            // instruction waiting to issue
+         bool           branch_pending;     // fetch waits for a branch to resolve
+         bool           eop_fetched;
+         unsigned       in_flight;          // instructions issued and not written back yet
+         unsigned       memory_pending;     // loads/stores waiting for data memory
+         bool           done;
+         unsigned       instructions;
+         unsigned       finish_cycle;
+      };
+
+      // Physical register file of the renaming in-order core, one for the integer and one for the FP registers
+      struct rename_file_t{
+         vector<unsigned> value;
+         vector<bool>   ready;
+         unsigned       map[NUM_GP_REGISTERS];        // rename table: physical register of the youngest issued write
+         unsigned       arch[NUM_GP_REGISTERS];       // physical register of the youngest completed write (architectural state)
+         unsigned       arch_seq[NUM_GP_REGISTERS];
+         deque<unsigned> free_list;
+      };
+
       execUnitT         float_point_exe_reg[EXE_UNIT_SIZE];
 
       unsigned          sp_registers[NUM_STAGES][NUM_SP_REGISTERS];
@@ -159,21 +425,311 @@ class sim_pipe_fp{
       unsigned          dataMemSize;
 
       unsigned          memLatency;
+      int               opcode_latency[NUM_OPCODES];   // per-opcode execution latency, 0 to use the unit latency
+      bool              early_out_divide;
+      bool              fp_fast_path;
       unsigned          data_memory_latency_count;
       unsigned          baseAddress;
 
+      // Non-blocking memory stage (disabled when num_mshrs == 0)
+      unsigned          num_mshrs;
+      mshr_t            *mshr_file;
+      deque<wb_entry_t> wb_queue;
+      unsigned          mshr_full_stalls;
+      unsigned          mshr_merges;
+      unsigned          max_outstanding_loads;
+
+      // Data prefetcher (disabled when NULL)
+      prefetcher        *data_prefetcher;
+
+      // DRAM timing model replacing the fixed data memory latency (disabled when NULL)
+      dram              *dram_model;
+      int               dram_request;        // access of the instruction in MEM, -1 if none
+
+      // Store buffer (disabled when store_buffer_size == 0)
+      unsigned          store_buffer_size;
+      deque<store_entry_t> store_buffer;
+      unsigned          store_buffer_full_stalls;
+      unsigned          store_forwarding_hits;
+      unsigned long     store_buffer_occupancy;
+      unsigned          max_store_buffer_occupancy;
+
+      // Load/store queue (disabled when lsq_size == 0)
+      unsigned          lsq_size;
+      lsq_entry_t       *lsq;
+      unsigned          lsq_head;
+      unsigned          lsq_count;
+      unsigned          load_ports;
+      unsigned          store_ports;
+      disambiguation_t  disambiguation;
+      unsigned          lsq_full_stalls;
+      unsigned          lsq_forwards;
+      unsigned          lsq_replays;
+      unsigned          lsq_bypasses;
+
+      // Out-of-order core (Tomasulo)
+      scheduler_t       scheduler;
+      unsigned          num_rs[EXE_UNIT_SIZE];
+      reservation_station_t *rs_file[EXE_UNIT_SIZE];
+      unsigned          rob_size;
+      rob_entry_t       *rob;
+      unsigned          rob_head;
+      unsigned          rob_count;
+      unsigned          fetch_pc;
+      bool              branch_pending;
+      bool              eop_issued;
+      unsigned          commit_latency_count;
+
+      // Scoreboard core
+      fu_status_t       *fu_status;
+      unsigned          num_fu;
+      unsigned          issue_seq;
+
+      // Superscalar in-order core (used when issue_width > 1)
+      unsigned          issue_width;
+      unsigned          issue_mem_ops;
+      unsigned          issue_alu_ops;
+      unsigned          wb_ports;
+      vector<wide_slot_t> wide_latch[NUM_STAGES];  // fetch group waiting in ID, groups entering EX/MEM/WB
+      bool              wide_branch_done;
+      vector<unsigned>  issue_histogram;
+
+      // Register renaming (disabled when renaming == false)
+      bool              renaming;
+      rename_file_t     rename_file[2];      // indexed by "is float"
+      unsigned          rename_seq;
+      unsigned          free_list_stalls;
+
+      // Macro-op fusion at decode (disabled when fusion_idioms == 0)
+      unsigned          fusion_idioms;
+      unsigned          compare_branch_fusions;
+      unsigned          increment_load_fusions;
+
+      // Decoupled front-end (disabled when fetch_queue_size == 0)
+      unsigned          fetch_queue_size;
+      unsigned          fetch_cycles;
+      unsigned          fetch_wait;          // cycles spent on the access under way
+      deque<fetch_entry_t> fetch_queue;
+      bool              fetch_stopped;       // fetch waits for a branch to resolve, or has reached EOP
+      bool              fetch_eop;
+      unsigned          fetch_starved_cycles;
+      unsigned long     fetch_queue_occupancy;
+      unsigned          max_fetch_queue_occupancy;
+
+      // Deeper pipeline: the extra fetch/decode sub-stages ahead of ID and the extra memory sub-stages ahead of WB
+      unsigned          fetch_stages;
+      unsigned          decode_stages;
+      unsigned          memory_stages;
+      deque<fetch_entry_t> front_end;        // oldest first
+      deque<wb_entry_t> memory_pipe;         // oldest first
+
+      // Multithreaded core (used when contexts is not empty)
+      thread_policy_t   thread_policy;
+      unsigned          thread_issue_slots;
+      unsigned          switch_penalty;
+      vector<thread_context_t> contexts;
+      vector<thread_slot_t> thread_latch[NUM_STAGES];   // groups entering EX/MEM/WB
+      vector<thread_slot_t> parked;                     // loads/stores waiting for data memory, oldest first
+      unsigned          current_thread;              // thread issued last (running thread when switching on stall)
+      unsigned          switch_wait;                 // cycles left of a thread switch
+      unsigned          thread_switches;
+
+      // Private L1 of a core of a multicore system (disabled when NULL)
+      coherence         *caches;
+      unsigned          core_id;
+
+      // Relaxed quantum run on a host thread of its own: the writes to the shared data memory are logged (and
+      // forwarded to the later loads of the core), and a SWAP waits for its old value until the end of the quantum
+      bool              deferred;
+      vector<memory_event_t> memory_events;
+      map<unsigned, unsigned> own_writes;
+      bool              atomic_issued;
+      bool              atomic_ready;
+      unsigned          atomic_value;
+
+      // Trace replayed instead of the program (disabled when NULL), and the number of the next instruction fetched in
+      // program order (its trace record), counted when replaying or profiling
+      trace             *replay;
+      uint64_t          fetch_seq;
+
+      // Sampled simulation (disabled when sampling is NULL): fetch stops the unit simulated in detail with an EOP
+      // past "sample_fetch_limit" instructions fetched, and the unit counts the instructions it commits
+      sampler           *sampling;
+      unsigned          sample_fetch_limit;
+      unsigned          sample_resume_pc;    // PC of the EOP that stopped the unit
+      unsigned          sample_commits;
+      unsigned          sample_start_cycle;  // commit of the last warm-up instruction
+      unsigned          sample_end_cycle;    // commit of the last measured instruction
+
+      // Per-instruction profile of the scalar in-order pipeline (disabled when NULL), and the instructions it has
+      // seen leave EX but not yet written back
+      profiler          *profiling;
+      unsigned          profiled_past_ex;
+
+      // Performance monitoring unit of the scalar in-order pipeline (disabled when NULL)
+      pmu               *monitoring;
+
    public:
 
-      sim_pipe_fp(unsigned data_mem_size, unsigned data_mem_latency);
+      sim_pipe_fp(unsigned data_mem_size, unsigned data_mem_latency, scheduler_t scheduler=IN_ORDER);
 
       ~sim_pipe_fp();
 
       void init_exec_unit(exe_unit_t exec_unit, unsigned latency, unsigned instances=1);
+
+      //sets the initiation interval of an execution unit: each instance accepts a new operation every "interval"
+      //cycles and holds several operations in flight (1 = fully pipelined); by default an instance is busy for the whole latency
+      void set_initiation_interval(exe_unit_t exec_unit, unsigned interval);
+
+      //sets the execution latency of an opcode, overriding the latency of its execution unit (e.g. MULT and MULTS)
+      void set_opcode_latency(opcode_t opcode, unsigned latency);
+
+      //enables operand-dependent latencies: integer divides finish early on dividends with leading zeros, and
+      //FP multiplies and divides with a zero or denormal operand take a single cycle
+      void set_operand_dependent_latency(bool early_out_divide, bool fp_fast_path);
+      void account_exec_units(unsigned cycles=1);
+
+      //enables the non-blocking memory stage with "mshrs" miss status holding registers (0 restores the blocking stage)
+      void set_mshrs(unsigned mshrs);
+      void tick_mshrs();
+      int  allocate_mshr(unsigned address, unsigned latency);
+
+      //attaches a data prefetcher observing the loads (policies: bit mask of prefetch_policy_t, 0 detaches it)
+      void set_prefetcher(unsigned policies, unsigned degree=1, unsigned line_size=4, unsigned buffer_entries=16);
+      unsigned load_latency(unsigned pc, unsigned address);
+      bool     memory_busy(unsigned address, bool write);
+
+      //replaces the fixed data memory latency with a DRAM timing model (channels x banks, "row_size" bytes per row,
+      //timings in clock cycles); loads, stores and buffered stores of the in-order core queue for the DRAM
+      void set_dram(unsigned channels, unsigned banks, unsigned row_size, page_policy_t policy, unsigned t_rcd, unsigned t_cas, unsigned t_rp, unsigned t_burst=1);
+
+      //sets the number of reservation stations of an execution unit (Tomasulo core, default: 2 per unit instance)
+      void set_reservation_stations(exe_unit_t exec_unit, unsigned stations);
+
+      //sets the number of reorder buffer entries (Tomasulo core, default: 16)
+      void set_rob_size(unsigned entries);
+
+      bool branch_taken(opcode_t opcode, unsigned value);
+      unsigned evaluate(instruction_t& instruction, unsigned npc, unsigned vj, unsigned vk, bool& cond);
+      unsigned rob_age(int entry);
+      void tomasulo_init();
+      void tomasulo_read_operand(unsigned reg, bool isF, unsigned& value, int& tag);
+      bool tomasulo_load_ready(reservation_station_t& station, unsigned& value, bool& forwarded);
+      bool tomasulo_commit();
+      void tomasulo_write_result();
+      void tomasulo_execute();
+      void tomasulo_issue();
+      void run_tomasulo(unsigned cycles);
+
+      void scoreboard_init();
+      int  &result_status(unsigned reg, bool isF);
+      bool scoreboard_war_hazard(int fu);
+      bool scoreboard_memory_order(int fu);
+      bool scoreboard_write_result();
+      void scoreboard_execute();
+      void scoreboard_read_operands();
+      void scoreboard_issue();
+      void run_scoreboard(unsigned cycles);
+
+      //sets the superscalar issue width of the in-order core: up to "width" instructions are fetched, decoded and
+      //issued per cycle (1 = scalar pipeline); must be called before the program starts running
+      void set_issue_width(unsigned width);
+
+      //per-cycle limits of the superscalar core: loads/stores and other operations issued, and register write-back
+      //ports, which also bound the results leaving the execution units in the same cycle (all default to the issue width)
+      void set_issue_limits(unsigned mem_ops, unsigned alu_ops, unsigned wb_ports);
+
+      void     WIDE_IF(bool stall);
+      bool     WIDE_ID();
+      void     WIDE_EXE();
+      bool     WIDE_MEM();
+      bool     WIDE_WB();
+      void     run_wide(unsigned cycles);
+
+      //enables a store buffer with "entries" entries (0 disables it): stores retire into the buffer, which is
+      //drained to data memory in the background, and later loads to a buffered address are forwarded from it
+      void set_store_buffer(unsigned entries);
+      void drain_store_buffer();
+      bool forward_store(unsigned address, unsigned &value);
+
+      //enables a load/store queue with "entries" entries in the scalar in-order core: loads and stores leave the
+      //pipeline at issue, generate their address on the INTEGER unit once their base register is written and access
+      //data memory through "load_ports" load and "store_ports" store ports, loads bypassing older stores
+      void set_load_store_queue(unsigned entries, unsigned load_ports=1, unsigned store_ports=1, disambiguation_t disambiguation=CONSERVATIVE);
+      unsigned lsq_age(unsigned slot);
+      void lsq_issue(instruction_t& instruction, unsigned npc);
+      void lsq_register_written(unsigned reg, bool isF, unsigned value);
+      bool lsq_load_pending(unsigned reg, bool isF);
+      void lsq_dispatch_agen();
+      void lsq_address_ready(unsigned slot, unsigned address);
+      bool lsq_load_ready(unsigned slot, unsigned& value, bool& forwarded);
+      bool lsq_unknown_store(unsigned slot);
+      void lsq_cycle();
+
+      //enables register renaming in the scalar in-order core with "int_registers" and "fp_registers" physical
+      //registers (at least one more than the architectural ones): destinations get a free physical register at
+      //issue, which removes WAW and WAR stalls, and issue stalls when the free list is empty
+      void set_register_renaming(unsigned int_registers, unsigned fp_registers);
+      void rename_destination(instruction_t& instruction);
+      void rename_write(instruction_t& instruction, unsigned value);
+
+      //enables macro-op fusion at decode in the scalar in-order core (idioms: bit mask of fusion_idiom_t, 0 disables
+      //it): an integer ALU operation followed by a conditional branch on its result, or an ADDI/SUBI followed by a
+      //load based on the incremented register, issue and execute as a single operation on the INTEGER unit
+      void set_fusion(unsigned idioms);
+      unsigned fuse(instruction_t& instruction, instruction_t next);
+
+      //decouples fetch from decode in the scalar in-order core with a fetch queue of "entries" instructions (0
+      //restores the lock-stepped fetch): fetch keeps filling the queue while decode or the memory stage stall, up
+      //to the next branch (until it resolves); every instruction memory access takes "fetch_cycles" cycles
+      void set_fetch_queue(unsigned entries, unsigned fetch_cycles=1);
+
+      //splits fetch, decode and memory access of the scalar in-order core into "fetch_stages", "decode_stages" and
+      //"memory_stages" pipeline stages (1 each = the 5-stage pipeline): the extra front-end stages add to the branch
+      //penalty, the extra memory stages delay every write-back; must be called before the program starts running
+      void set_pipeline_depth(unsigned fetch_stages, unsigned decode_stages, unsigned memory_stages);
+      void fetch_ahead(bool stall);
+      void advance_front_end();
+      void skip_fetch(bool branch);
+
+      //turns the scalar in-order core into a multithreaded core with "threads" hardware threads, each with its own
+      //PC, registers and program, sharing the pipeline, the execution units and data memory; a load or store blocks
+      //only its own thread. "policy" picks the threads that issue: ROUND_ROBIN a different ready thread every cycle,
+      //SWITCH_ON_STALL the same thread until it waits for data memory (a switch costs "switch_penalty" cycles),
+      //SIMULTANEOUS up to "issue_slots" ready threads per cycle; must be called before the program starts running,
+      //with the other core options disabled
+      void set_threads(unsigned threads, thread_policy_t policy, unsigned issue_slots=1, unsigned switch_penalty=1);
+      bool thread_ready(unsigned thread, vector<thread_slot_t>& group);
+      void THREAD_IF();
+      void THREAD_ID();
+      void THREAD_EXE();
+      void THREAD_MEM();
+      bool THREAD_WB();
+      void run_threads(unsigned cycles);
+
+      //makes the simulator a core of a multicore system: core "core" works on the shared data memory "memory",
+      //through its private L1 in "caches"
+      void attach(unsigned char *memory, coherence *caches, unsigned core);
+
+      //returns true if the next clock cycle may access the shared data memory or the L1s: the instruction in MEM
+      //completes its access, or one leaving the execution units enters MEM and looks up its L1
+      bool shared_access_ahead();
+
+      //returns a lower bound (at most "limit") on the clock cycles ahead that cannot access the shared data memory or
+      //the L1s: the rest of the latency of the access in MEM, or the distance of the next load, store or SWAP through
+      //the execution units, the pipeline and the straight-line code at the fetch PC
+      unsigned private_cycles(unsigned limit);
+
       instruction_t fetchInstruction ( uint32_t pc );
+      instruction_t next_instruction ( instruction_t& instruction, uint32_t npc );
+      instruction_t decode_record ( uint64_t index );
+      uint64_t replay_record ( unsigned seq );
+      unsigned frozen_cycles();
       bool check_busy_status(unsigned regNo, bool isF);
       bool check_branch();
       exe_unit_t convert_op_to_exe_unit(opcode_t opcode);
       int exLatency(opcode_t opcode);
+      int exLatency(instruction_t& instruction, unsigned a, unsigned b);
       void clear_sp_register(stage_t s); 
 
       void     MIPS_IF(bool stall);
@@ -187,8 +743,60 @@ class sim_pipe_fp{
 
       int parse(const char *filename);
       int  labelToPC( const char* filename, const char* label, uint32_t pc_index );
+      void scan_labels(const char *filename, map<string, unsigned>& labels);
+      int  load_object(const char *filename);
+
+      //loads the assembly program or object file "filename" in instruction memory at the specified address
+      //(in the instruction memory of hardware thread "thread" of the multithreaded core); the data segments
+      //of an object file are written to data memory
+      void load_program(const char *filename, unsigned base_address=0x0, unsigned thread=0);
+
+      //assembles the program in file "asm_filename" into the object file "object_filename", with the contents
+      //of data memory in [data_start, data_end) as its initialised data
+      void assemble(const char *asm_filename, const char *object_filename, unsigned data_start=0, unsigned data_end=0);
+
+      //runs the loaded program functionally, without timing, and appends its dynamic instruction stream to "stream";
+      //leaves the registers and data memory as the program does
+      void record_trace(trace *stream);
+
+      //replays "stream" instead of a program on the in-order pipeline: the timing is that of the program, but the
+      //branch outcomes, effective addresses and the operands setting operand-dependent latencies come from the trace
+      void load_trace(trace *stream);
 
-      void load_program(const char *filename, unsigned base_address=0x0);
+      //runs the loaded program to completion with statistical sampling (see sampler.h): the scalar in-order pipeline
+      //simulates the sampling units in detail, and the instructions between them run functionally; leaves the
+      //registers and data memory as the program does, and the estimate in "sampling" (the statistics of the
+      //simulator cover the units only)
+      void sample(sampler *sampling);
+      bool sample_unit(unsigned &pc);
+      void sample_commit(unsigned instructions);
+      void restart(unsigned pc);
+      bool fast_forward(unsigned &pc, unsigned instructions, simpoint *profile=NULL);
+
+      //profiles the loaded program for simulation points (see simpoint.h): runs it functionally to completion,
+      //recording the basic block vectors of its intervals, then chooses the points
+      void profile(simpoint *points);
+
+      //runs the loaded program to completion simulating only the points chosen by profiling it (from the same
+      //initial state) in detail, and the instructions before them functionally; leaves the registers and data memory
+      //as the program does, and the estimate in "points" (the statistics of the simulator cover the points only)
+      void simulate_points(simpoint *points);
+
+      //profiles the loaded program instruction by instruction into "profiling" (see profiler.h) as it runs on the
+      //scalar in-order pipeline, until called again with NULL; must be called once the program is loaded. There is
+      //no branch prediction, so no mispredictions are counted
+      void set_profiler(profiler *profiling);
+      void profile_memory(instruction_t& instruction);
+      void profile_write_back(instruction_t& instruction);
+      void profile_flush();
+      unsigned branch_pc(instruction_t& instruction);
+
+      //counts the events programmed in the counters of "monitoring" (see pmu.h) as programs run on the scalar
+      //in-order pipeline, until called again with NULL; the counters are programmed, started and stopped through
+      //"monitoring"
+      void set_pmu(pmu *monitoring);
+      void pmu_cycle(unsigned cycles=1);
+      void pmu_retire(const instruction_t& instruction);
 
       void run(unsigned cycles=0);
 
@@ -211,17 +819,17 @@ class sim_pipe_fp{
       void set_sp_register(sp_register_t reg, stage_t s, uint32_t value);
       unsigned regRead(unsigned reg, bool isF);
 
-      //returns value of the specified integer general purpose register
-      int get_int_register(unsigned reg);
+      //returns value of the specified integer general purpose register (of hardware thread "thread")
+      int get_int_register(unsigned reg, unsigned thread=0);
 
-      //set the value of the given integer general purpose register to "value"
-      void set_int_register(unsigned reg, int value);
+      //set the value of the given integer general purpose register (of hardware thread "thread") to "value"
+      void set_int_register(unsigned reg, int value, unsigned thread=0);
 
-      //returns value of the specified floating point general purpose register
-      float get_fp_register(unsigned reg);
+      //returns value of the specified floating point general purpose register (of hardware thread "thread")
+      float get_fp_register(unsigned reg, unsigned thread=0);
 
-      //set the value of the given floating point general purpose register to "value"
-      void set_fp_register(unsigned reg, float value);
+      //set the value of the given floating point general purpose register (of hardware thread "thread") to "value"
+      void set_fp_register(unsigned reg, float value, unsigned thread=0);
 
       //returns the IPC
       float get_IPC();
@@ -235,6 +843,82 @@ class sim_pipe_fp{
       //returns the number of clock cycles
       unsigned get_clock_cycles();
 
+      //returns the number of cycles the memory stage stalled because all MSHRs were busy
+      unsigned get_mshr_full_stalls();
+
+      //returns the number of loads merged into an already outstanding MSHR
+      unsigned get_mshr_merges();
+
+      //returns the largest number of loads outstanding at the same time
+      unsigned get_max_outstanding_loads();
+
+      //returns the number of cycles a store stalled because the store buffer was full
+      unsigned get_store_buffer_full_stalls();
+
+      //returns the number of loads served by forwarding from the store buffer
+      unsigned get_store_forwarding_hits();
+
+      //returns the average and the peak number of stores held in the store buffer
+      float    get_store_buffer_avg_occupancy();
+      unsigned get_store_buffer_max_occupancy();
+
+      //returns the fraction of the prefetches used by a load, the fraction of the loads served by a prefetch,
+      //and the fraction of the useful prefetches completed before the load needed them
+      float    get_prefetch_accuracy();
+      float    get_prefetch_coverage();
+      float    get_prefetch_timeliness();
+
+      //returns the number of DRAM accesses that hit the open row, found the bank closed, or had to close another row
+      unsigned get_dram_row_hits();
+      unsigned get_dram_row_misses();
+      unsigned get_dram_row_conflicts();
+
+      //returns the average DRAM access latency, queueing included
+      float    get_dram_avg_latency();
+
+      //returns the number of cycles a load or store waited to enter the full load/store queue
+      unsigned get_lsq_full_stalls();
+
+      //returns the number of loads forwarded from an older store of the load/store queue, the number of loads
+      //that read data memory ahead of an older store, and the number of loads replayed after a misspeculation
+      unsigned get_lsq_forwards();
+      unsigned get_lsq_bypasses();
+      unsigned get_lsq_replays();
+
+      //returns the number of cycles issue stalled because no physical register was free (register renaming)
+      unsigned get_free_list_stalls();
+
+      //returns the average and the peak number of instructions held in the fetch queue
+      float    get_fetch_queue_avg_occupancy();
+      unsigned get_fetch_queue_max_occupancy();
+
+      //returns the number of cycles decode was ready for an instruction but found the fetch queue empty
+      unsigned get_fetch_starved_cycles();
+
+      //returns the number of instruction pairs fused with the given idiom
+      unsigned get_fusion_hits(fusion_idiom_t idiom);
+
+      //returns the number of clock cycles in which the superscalar core issued "instructions" instructions
+      unsigned get_issue_histogram(unsigned instructions);
+
+      //returns the number of instructions executed by hardware thread "thread", and the clock cycles it took to finish
+      unsigned get_thread_instructions(unsigned thread);
+      unsigned get_thread_cycles(unsigned thread);
+
+      //returns the IPC of hardware thread "thread" over the cycles it ran
+      float    get_thread_IPC(unsigned thread);
+
+      //returns the number of switches between threads of the SWITCH_ON_STALL policy
+      unsigned get_thread_switches();
+
+      //returns the average and the peak number of operations in flight in an execution unit
+      float    get_unit_avg_occupancy(exe_unit_t exec_unit);
+      unsigned get_unit_max_occupancy(exe_unit_t exec_unit);
+
+      //returns the fraction of the issue slots of an execution unit (one per instance every initiation interval,
+      //or every latency if the unit is not pipelined) that started an operation
+      float    get_unit_utilization(exe_unit_t exec_unit);
+
       //prints the content of the data memory within the specified address range
       void print_memory(unsigned start_address, unsigned end_address);
 
@@ -242,10 +926,13 @@ class sim_pipe_fp{
       void write_memory(unsigned address, unsigned value);
 
       unsigned read_memory(unsigned address);
-      instruction_t execInst(int& count, uint32_t& b, uint32_t& npc);
+      instruction_t execInst(int& count, uint32_t& a, uint32_t& b, uint32_t& npc);
 
       //prints the values of the registers 
       void print_registers();
+
+      //prints the functional unit status and register result status tables of the scoreboard core
+      void print_scoreboard();
       
       int getMaxTtl();
       uint32_t parseReg( FILE* trace, bool& is_float );
@@ -253,4 +940,106 @@ class sim_pipe_fp{
       inline float unsigned2float(unsigned value);
 };
 
+// bit casts between the single precision values and the registers and memory words holding them (defined here, as
+// every translation unit of the simulator uses them)
+inline unsigned sim_pipe_fp::float2unsigned(float value){
+        unsigned result;
+        memcpy(&result, &value, sizeof value);
+        return result;
+}
+
+inline float sim_pipe_fp::unsigned2float(unsigned value){
+        float result;
+        memcpy(&result, &value, sizeof value);
+        return result;
+}
+
+//----------------------------------------------------------------------
+// Multicore system: scalar in-order cores sharing one data memory,
+// each through a private L1 kept coherent by a snooping bus. The cores
+// run in lock step, one clock cycle each in turn, or a quantum each on
+// host threads of their own.
+//----------------------------------------------------------------------
+class sim_pipe_fp_multicore{
+
+   public:
+      vector<sim_pipe_fp*> cores;
+      vector<char>      finished;                // per core (not vector<bool>: written by different host threads)
+      coherence         *caches;
+      unsigned char     *data_memory;
+      unsigned          dataMemSize;
+
+      // Host-parallel simulation (lock step on the calling thread when host_threads is 0)
+      unsigned          host_threads;
+      sync_mode_t       sync_mode;
+      unsigned          quantum;
+      unsigned          run_ahead;               // fewest cycles a core runs ahead on its own (deterministic mode)
+      unsigned          quantum_cycles;          // length of the quantum being run
+      unsigned          quanta;
+      unsigned          horizon;                 // cycle the cores run ahead to (deterministic mode)
+      bool              stopping;
+      barrier           *sync;
+
+      //instantiates "cores" cores sharing a data memory of "data_mem_size" bytes with a "data_mem_latency" cycles
+      //latency; every core has a private L1 of "cache_size" bytes ("line_size" bytes per line, "ways"-way set
+      //associative) hit in "hit_latency" cycles, kept coherent with "protocol": a miss holds the bus for "bus_cycles"
+      //cycles, and a line modified in another L1 takes "transfer_latency" cycles to come from it
+      sim_pipe_fp_multicore(unsigned cores, unsigned data_mem_size, unsigned data_mem_latency, coherence_protocol_t protocol=MESI,
+                            unsigned cache_size=1024, unsigned line_size=16, unsigned ways=2, unsigned hit_latency=0,
+                            unsigned transfer_latency=2, unsigned bus_cycles=1);
+
+      ~sim_pipe_fp_multicore();
+
+      //returns core "core" (to set up its execution units, load its program, set its registers and read its statistics)
+      sim_pipe_fp *core(unsigned core);
+
+      //simulates the cores on "threads" host threads (0 runs them in lock step on the calling thread), each core running
+      //at most "quantum" cycles on its own between synchronizations: DETERMINISTIC stops every core before a cycle that
+      //may touch the shared data memory or the L1s, and runs those cycles in lock step (the results and timing of the
+      //lock step run), along with the cycles of the cores less than "run_ahead" cycles away from such a cycle; RELAXED
+      //runs whole quanta, then exchanges the shared data memory accesses and bus transactions
+      void set_host_threads(unsigned threads, sync_mode_t mode=DETERMINISTIC, unsigned quantum=1000, unsigned run_ahead=16);
+
+      //runs the system for "cycles" clock cycles (until every core has completed its program if cycles=0)
+      void run(unsigned cycles=0);
+      void run_parallel(unsigned cycles);
+      void run_quantum(unsigned thread);
+      void host_worker(unsigned thread);
+      void exchange();
+      unsigned earliest(unsigned stop);
+      void lock_step(unsigned stop);
+
+      //returns the number of quanta run on the host threads
+      unsigned get_quanta();
+
+      //returns the mean relative difference between the clock cycles of every core and those of the same core in
+      //"reference", the same system run in lock step
+      float    get_timing_error(sim_pipe_fp_multicore *reference);
+
+      //returns the number of clock cycles until the last core completed, and the instructions executed by all cores over them
+      unsigned get_clock_cycles();
+      float    get_IPC();
+
+      //returns the number of accesses of "core" that hit or missed in its L1 (a write to a shared line is a miss)
+      unsigned get_cache_hits(unsigned core);
+      unsigned get_cache_misses(unsigned core);
+
+      //returns the number of bus transactions of the given type
+      unsigned get_bus_transactions(bus_transaction_t transaction);
+
+      //returns the number of lines invalidated by snooping, and of misses served by another L1
+      unsigned get_invalidations();
+      unsigned get_cache_transfers();
+
+      //returns the number of cycles the cores waited for the bus
+      unsigned get_bus_wait_cycles();
+
+      //prints the content of the shared data memory within the specified address range
+      void print_memory(unsigned start_address, unsigned end_address);
+
+      //writes/reads an integer value to/from the shared data memory at the specified address
+      void write_memory(unsigned address, unsigned value);
+      unsigned read_memory(unsigned address);
+};
+
 #endif /*SIM_PIPE_FP_H_*/
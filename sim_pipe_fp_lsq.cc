@@ -0,0 +1,245 @@
+#include "sim_pipe_fp.h"
+
+using namespace std;
+
+//----------------------------------------------------------------------
+// Load/store queue of the in-order core
+//
+// Loads and stores leave the pipeline at issue and wait in the queue,
+// in program order, for their registers: an entry counts the older
+// writes still outstanding to its base and data registers and captures
+// the value of the last one. Once the base register is known, the
+// address is generated on a free lane of the INTEGER unit. Every cycle
+// up to load_ports loads and store_ports stores start their access:
+// a store waits for its data, the older stores and the older loads,
+// and writes data memory after the memory latency; a load is forwarded
+// from the youngest older store to its address or reads data memory,
+// bypassing the older stores to other addresses. An older store with
+// an unknown address blocks the load (CONSERVATIVE), or the load goes
+// ahead, holds its result until that address is known and replays if
+// the addresses match (SPECULATIVE). Loads write their register through
+// a port of their own, and EOP issues once the queue is empty.
+//----------------------------------------------------------------------
+
+void sim_pipe_fp::set_load_store_queue(unsigned entries, unsigned load_ports, unsigned store_ports, disambiguation_t disambiguation){
+   ASSERT( entries > 0 && load_ports > 0 && store_ports > 0, "Unsupported load/store queue (entries=%d, load ports=%d, store ports=%d)", entries, load_ports, store_ports );
+   ASSERT( scheduler == IN_ORDER && issue_width == 1 && num_mshrs == 0 && store_buffer_size == 0 && dram_model == NULL && !renaming && fusion_idioms == 0 && memory_stages == 1,
+           "The load/store queue is only modelled by the scalar in-order pipeline with a single fixed-latency memory stage and no macro-op fusion" );
+   delete [] lsq;
+   lsq                  = new lsq_entry_t[entries];
+   lsq_size             = entries;
+   lsq_head             = 0;
+   lsq_count            = 0;
+   this->load_ports     = load_ports;
+   this->store_ports    = store_ports;
+   this->disambiguation = disambiguation;
+}
+
+//----------------------------------------------------------------------
+// Position of a queue entry relative to the head (0 = oldest)
+//----------------------------------------------------------------------
+unsigned sim_pipe_fp::lsq_age(unsigned slot){
+   return (slot - lsq_head + lsq_size) % lsq_size;
+}
+
+//----------------------------------------------------------------------
+// Queue a load or store leaving ID, reading the registers with no
+// older write outstanding
+//----------------------------------------------------------------------
+void sim_pipe_fp::lsq_issue(instruction_t& instruction, unsigned npc){
+   lsq_entry_t& entry         = lsq[(lsq_head + lsq_count++) % lsq_size];
+   bool is_store              = (instruction.opcode == SW || instruction.opcode == SWS);
+   entry.instruction          = instruction;
+   entry.npc                  = npc;
+   entry.base_pending         = instruction.src1_float_op ? fp_file[instruction.src1].busy : int_file[instruction.src1].busy;
+   entry.base                 = entry.base_pending ? UNDEFINED : regRead(instruction.src1, instruction.src1_float_op);
+   entry.data_pending         = !is_store ? 0 : instruction.src2_float_op ? fp_file[instruction.src2].busy : int_file[instruction.src2].busy;
+   entry.data                 = (!is_store || entry.data_pending) ? UNDEFINED : regRead(instruction.src2, instruction.src2_float_op);
+   entry.agen_started         = false;
+   entry.address_ready        = false;
+   entry.started              = false;
+   entry.speculative          = false;
+   entry.done                 = false;
+   if(instruction.dest_op){
+      int_file[instruction.dest].busy += !(instruction.dest_float_op);
+      fp_file[instruction.dest].busy  +=  (instruction.dest_float_op);
+   }
+}
+
+//----------------------------------------------------------------------
+// A register write completed: the entries waiting for it as their last
+// outstanding write capture the value
+//----------------------------------------------------------------------
+void sim_pipe_fp::lsq_register_written(unsigned reg, bool isF, unsigned value){
+   for(unsigned age = 0; age < lsq_count; age++) {
+      lsq_entry_t& entry      = lsq[(lsq_head + age) % lsq_size];
+      instruction_t& instruction = entry.instruction;
+      if(entry.base_pending > 0 && instruction.src1 == reg && instruction.src1_float_op == isF && --entry.base_pending == 0)
+         entry.base           = value;
+      if(entry.data_pending > 0 && instruction.src2 == reg && instruction.src2_float_op == isF && --entry.data_pending == 0)
+         entry.data           = value;
+   }
+}
+
+//----------------------------------------------------------------------
+// Returns true if a queued load has yet to write "reg"
+//----------------------------------------------------------------------
+bool sim_pipe_fp::lsq_load_pending(unsigned reg, bool isF){
+   for(unsigned age = 0; age < lsq_count; age++) {
+      lsq_entry_t& entry      = lsq[(lsq_head + age) % lsq_size];
+      if(!entry.done && entry.instruction.dest_op && entry.instruction.dest == reg && entry.instruction.dest_float_op == isF)
+         return true;
+   }
+   return false;
+}
+
+//----------------------------------------------------------------------
+// Start the address generation of the oldest entries with a known base
+// register on the INTEGER lanes left free by the pipeline
+//----------------------------------------------------------------------
+void sim_pipe_fp::lsq_dispatch_agen(){
+   execUnitT& unit            = float_point_exe_reg[INTEGER];
+   for(unsigned age = 0; age < lsq_count; age++) {
+      unsigned slot           = (lsq_head + age) % lsq_size;
+      lsq_entry_t& entry      = lsq[slot];
+      if(entry.agen_started || entry.base_pending != 0)
+         continue;
+      int lane                = unit.free_lane(cycleCount);
+      if(lane == -1)
+         return;
+      unit.exe_pipe_units[lane].instruction = entry.instruction;
+      unit.exe_pipe_units[lane].latency_exe = exLatency(entry.instruction, entry.base, entry.data);
+      unit.exe_pipe_units[lane].a           = entry.base;
+      unit.exe_pipe_units[lane].station     = slot;
+      unit.start(lane, cycleCount);
+      entry.agen_started      = true;
+   }
+}
+
+//----------------------------------------------------------------------
+// Address generated: a store address replays the younger loads that
+// went ahead of it to the same address
+//----------------------------------------------------------------------
+void sim_pipe_fp::lsq_address_ready(unsigned slot, unsigned address){
+   lsq_entry_t& entry         = lsq[slot];
+   entry.address              = address;
+   entry.address_ready        = true;
+   if(entry.instruction.opcode != SW && entry.instruction.opcode != SWS)
+      return;
+   for(unsigned age = lsq_age(slot) + 1; age < lsq_count; age++) {
+      lsq_entry_t& load       = lsq[(lsq_head + age) % lsq_size];
+      if(load.instruction.opcode != LW && load.instruction.opcode != LWS)
+         continue;
+      if(load.started && !load.done && load.address == address) {
+         load.started         = false;
+         load.speculative     = false;
+         lsq_replays++;
+      }
+   }
+}
+
+//----------------------------------------------------------------------
+// Memory disambiguation: returns true when the load can start, with its
+// value forwarded from the youngest older store to its address or read
+// from data memory
+//----------------------------------------------------------------------
+bool sim_pipe_fp::lsq_load_ready(unsigned slot, unsigned& value, bool& forwarded){
+   lsq_entry_t& load          = lsq[slot];
+   bool unknown               = false;
+   bool older_store           = false;
+   for(int age = lsq_age(slot) - 1; age >= 0; age--) {
+      lsq_entry_t& store      = lsq[(lsq_head + age) % lsq_size];
+      if((store.instruction.opcode != SW && store.instruction.opcode != SWS) || store.done)
+         continue;
+      if(!store.address_ready) {
+         if(disambiguation == CONSERVATIVE)
+            return false;
+         unknown              = true;
+         continue;
+      }
+      if(store.address == load.address) {
+         if(store.data_pending != 0)
+            return false;
+         value                = store.data;
+         forwarded            = true;
+         load.speculative     = unknown;
+         lsq_forwards++;
+         return true;
+      }
+      older_store             = true;
+   }
+   value                      = read_memory(load.address);
+   forwarded                  = false;
+   load.speculative           = unknown;
+   lsq_bypasses              += (older_store || unknown);
+   return true;
+}
+
+//----------------------------------------------------------------------
+// Returns true if a store older than the entry has an unknown address
+//----------------------------------------------------------------------
+bool sim_pipe_fp::lsq_unknown_store(unsigned slot){
+   for(unsigned age = 0; age < lsq_age(slot); age++) {
+      lsq_entry_t& store      = lsq[(lsq_head + age) % lsq_size];
+      if((store.instruction.opcode == SW || store.instruction.opcode == SWS) && !store.address_ready)
+         return true;
+   }
+   return false;
+}
+
+//----------------------------------------------------------------------
+// Complete the accesses whose latency elapsed, retire the completed
+// head of the queue and start the accesses of this cycle
+//----------------------------------------------------------------------
+void sim_pipe_fp::lsq_cycle(){
+   for(unsigned age = 0; age < lsq_count; age++) {
+      unsigned slot           = (lsq_head + age) % lsq_size;
+      lsq_entry_t& entry      = lsq[slot];
+      instruction_t& instruction = entry.instruction;
+      if(!entry.started || entry.done || entry.done_cycle > (unsigned)cycleCount)
+         continue;
+      if(instruction.opcode == SW || instruction.opcode == SWS) {
+         write_memory(entry.address, entry.data);
+         entry.done           = true;
+         continue;
+      }
+      if(entry.speculative && lsq_unknown_store(slot))
+         continue;
+      lsq_register_written(instruction.dest, instruction.dest_float_op, entry.value);
+      if(instruction.dest_float_op)
+         set_fp_register(instruction.dest, unsigned2float(entry.value));
+      else
+         set_int_register(instruction.dest, entry.value);
+      entry.done              = true;
+   }
+   while(lsq_count > 0 && lsq[lsq_head].done) {
+      lsq_head                = (lsq_head + 1) % lsq_size;
+      lsq_count--;
+   }
+
+   unsigned loads = 0, stores = 0;
+   bool     older_store       = false;     // older store not started yet
+   bool     older_load        = false;     // older load not completed yet
+   for(unsigned age = 0; age < lsq_count; age++) {
+      unsigned slot           = (lsq_head + age) % lsq_size;
+      lsq_entry_t& entry      = lsq[slot];
+      if(entry.instruction.opcode == SW || entry.instruction.opcode == SWS) {
+         if(!entry.started && !older_store && !older_load && stores < store_ports && entry.address_ready && entry.data_pending == 0) {
+            entry.started     = true;
+            entry.done_cycle  = cycleCount + 1 + memLatency;
+            stores++;
+         }
+         older_store         |= !entry.started;
+         continue;
+      }
+      unsigned value;
+      bool     forwarded;
+      if(!entry.started && loads < load_ports && entry.address_ready && lsq_load_ready(slot, value, forwarded)) {
+         entry.value          = value;
+         entry.started        = true;
+         entry.done_cycle     = cycleCount + 1 + (forwarded ? 0 : load_latency(entry.npc - 4, entry.address));
+         loads++;
+      }
+      older_load             |= !entry.done;
+   }
+}
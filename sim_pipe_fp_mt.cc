@@ -0,0 +1,345 @@
+#include "sim_pipe_fp.h"
+
+using namespace std;
+
+//----------------------------------------------------------------------
+// Multithreaded core
+//
+// Every hardware thread has its own PC, register files and program, and
+// a one-instruction fetch buffer refilled as soon as its instruction
+// issues (never past an unresolved branch or EOP). ID picks the threads
+// that issue according to the thread policy; an instruction issues when
+// it has no RAW or WAW hazard, finds a free instance of its execution
+// unit, and would not leave the execution units in a cycle in which the
+// issue slots are all taken by other results. Operands are captured at
+// issue. A load or store accesses data memory when it enters MEM and
+// then waits there for the memory latency without blocking the
+// pipeline: only its own thread stops issuing until the access
+// completes, while the other threads keep the execution units busy.
+// Branches resolve in MEM.
+//----------------------------------------------------------------------
+
+void sim_pipe_fp::set_threads(unsigned threads, thread_policy_t policy, unsigned issue_slots, unsigned switch_penalty){
+   ASSERT( threads > 0 && issue_slots > 0 && issue_slots <= threads, "Unsupported thread configuration (threads=%d, issue slots=%d)", threads, issue_slots );
+   ASSERT( policy == SIMULTANEOUS || issue_slots == 1, "Only simultaneous multithreading issues several threads per cycle" );
+   ASSERT( scheduler == IN_ORDER && issue_width == 1 && num_mshrs == 0 && store_buffer_size == 0 && data_prefetcher == NULL && dram_model == NULL &&
+           !renaming && lsq_size == 0 && fusion_idioms == 0 && fetch_queue_size == 0 && front_end.empty() && memory_pipe.empty(),
+           "The multithreaded core only models the 5-stage in-order pipeline with a fixed-latency memory stage" );
+   thread_policy           = policy;
+   thread_issue_slots      = issue_slots;
+   this->switch_penalty    = switch_penalty;
+   current_thread          = (policy == SWITCH_ON_STALL) ? 0 : threads - 1;   // thread 0 issues first
+   switch_wait             = 0;
+   thread_switches         = 0;
+
+   thread_context_t context;
+   context.int_file        = NULL;
+   context.fp_file         = NULL;
+   context.instMemory      = NULL;
+   context.instMemSize     = 0;
+   context.base_address    = 0;
+   context.pc              = UNDEFINED;
+   context.has_fetched     = false;
+   context.branch_pending  = false;
+   context.eop_fetched     = false;
+   context.in_flight       = 0;
+   context.memory_pending  = 0;
+   context.done            = false;
+   context.instructions    = 0;
+   context.finish_cycle    = 0;
+   contexts.assign(threads, context);
+
+   contexts[0].int_file         = int_file;
+   contexts[0].fp_file          = fp_file;
+   contexts[0].instMemory       = instMemory;
+   contexts[0].instMemSize      = instMemSize;
+   contexts[0].base_address     = baseAddress;
+   contexts[0].pc               = sp_registers[IF][PC];
+   for(unsigned t = 0; t < threads; t++) {
+      if(t > 0) {
+         contexts[t].int_file   = new int_file_t[NUM_GP_REGISTERS];
+         contexts[t].fp_file    = new fp_file_t[NUM_GP_REGISTERS];
+      }
+      for(int i = 0; i < NUM_GP_REGISTERS; i++) {
+         if(t > 0) {
+            contexts[t].int_file[i].value = UNDEFINED;
+            contexts[t].int_file[i].rob   = -1;
+            contexts[t].int_file[i].fu    = -1;
+            contexts[t].fp_file[i].value  = UNDEFINED;
+            contexts[t].fp_file[i].rob    = -1;
+            contexts[t].fp_file[i].fu     = -1;
+         }
+         contexts[t].int_file[i].busy     = 0;
+         contexts[t].fp_file[i].busy      = 0;
+      }
+   }
+}
+
+//----------------------------------------------------------------------
+// Refill the fetch buffer of every thread whose instruction has issued
+//----------------------------------------------------------------------
+void sim_pipe_fp::THREAD_IF() {
+   for(unsigned t = 0; t < contexts.size(); t++) {
+      thread_context_t& context   = contexts[t];
+      if(context.has_fetched || context.branch_pending || context.eop_fetched)
+         continue;
+      int index                   = (context.pc - context.base_address)/4;
+      ASSERT( context.instMemory != NULL && index >= 0 && index < context.instMemSize, "out of bound access of instruction memory %d (thread %d)", index, t );
+      thread_slot_t slot;
+      slot.instruction            = *(context.instMemory[index]);
+      slot.thread                 = t;
+      slot.npc                    = context.pc + 4;
+      slot.a                      = UNDEFINED;
+      slot.b                      = UNDEFINED;
+      slot.alu_output             = UNDEFINED;
+      slot.lmd                    = UNDEFINED;
+      slot.cond                   = false;
+      slot.ready_cycle            = 0;
+      context.fetched             = slot;
+      context.has_fetched         = true;
+      context.branch_pending      = slot.instruction.branch_op;
+      context.eop_fetched         = (slot.instruction.opcode == EOP);
+      if(!context.eop_fetched)
+         context.pc              += 4;
+   }
+}
+
+//----------------------------------------------------------------------
+// A thread can issue when its instruction has no RAW or WAW hazard, none
+// of its loads/stores waits for data memory, a unit instance is left
+// after the instructions already picked this cycle ("group"), and fewer
+// results than issue slots leave the units in its completion cycle; EOP
+// waits for all the instructions of the thread to write back
+//----------------------------------------------------------------------
+bool sim_pipe_fp::thread_ready(unsigned thread, vector<thread_slot_t>& group) {
+   thread_context_t& context      = contexts[thread];
+   if(!context.has_fetched || context.memory_pending > 0)
+      return false;
+   thread_slot_t& slot            = context.fetched;
+   instruction_t& instruction     = slot.instruction;
+   ASSERT( instruction.opcode != SWAP, "SWAP is only modelled by the scalar in-order pipeline" );
+   if((instruction.src1_op && (instruction.src1_float_op ? context.fp_file[instruction.src1].busy : context.int_file[instruction.src1].busy)) ||
+      (instruction.src2_op && (instruction.src2_float_op ? context.fp_file[instruction.src2].busy : context.int_file[instruction.src2].busy)))
+      return false;
+   if(instruction.dest_op && (instruction.dest_float_op ? context.fp_file[instruction.dest].busy : context.int_file[instruction.dest].busy))
+      return false;
+   if(instruction.opcode == EOP && context.in_flight > 0)
+      return false;
+
+   slot.a                         = !instruction.src1_op ? UNDEFINED : instruction.src1_float_op ? float2unsigned(context.fp_file[instruction.src1].value) : context.int_file[instruction.src1].value;
+   slot.b                         = !instruction.src2_op ? UNDEFINED : instruction.src2_float_op ? float2unsigned(context.fp_file[instruction.src2].value) : context.int_file[instruction.src2].value;
+   exe_unit_t unit                = convert_op_to_exe_unit(instruction.opcode);
+   int latency                    = exLatency(instruction, slot.a, slot.b);
+   int claimed                    = 0;
+   unsigned completing            = 0;
+   for(unsigned i = 0; i < group.size(); i++) {
+      claimed                    += (convert_op_to_exe_unit(group[i].instruction.opcode) == unit);
+      completing                 += (exLatency(group[i].instruction, group[i].a, group[i].b) == latency);
+   }
+   if(float_point_exe_reg[unit].free_instances(cycleCount + 1) <= claimed)
+      return false;
+   for(int i = 0; i < EXE_UNIT_SIZE; i++) {
+      for(int j = 0; j < float_point_exe_reg[i].num_exe_pipe_units; j++)
+         completing              += (float_point_exe_reg[i].exe_pipe_units[j].latency_exe == latency);
+   }
+   return completing < thread_issue_slots;
+}
+
+//----------------------------------------------------------------------
+// Issue the instructions of the threads picked by the thread policy
+//----------------------------------------------------------------------
+void sim_pipe_fp::THREAD_ID() {
+   thread_latch[EX].clear();
+   unsigned threads        = contexts.size();
+   vector<thread_slot_t>& group = thread_latch[EX];
+
+   if(thread_policy == SWITCH_ON_STALL) {
+      if(switch_wait > 0) {
+         switch_wait--;
+         stall_count++;
+         return;
+      }
+      // switch away from a thread waiting for data memory, or done issuing
+      thread_context_t& running = contexts[current_thread];
+      if(running.memory_pending > 0 || (running.eop_fetched && !running.has_fetched)) {
+         for(unsigned k = 1; k < threads; k++) {
+            unsigned t              = (current_thread + k) % threads;
+            thread_context_t& other = contexts[t];
+            if(other.memory_pending > 0 || (other.eop_fetched && !other.has_fetched))
+               continue;
+            current_thread          = t;
+            thread_switches++;
+            if(switch_penalty > 0) {
+               switch_wait          = switch_penalty - 1;
+               stall_count++;
+               return;
+            }
+            break;
+         }
+      }
+      if(thread_ready(current_thread, group))
+         group.push_back(contexts[current_thread].fetched);
+   }
+   else {
+      // a different thread every cycle, starting after the thread issued first in the last cycle
+      for(unsigned k = 1; k <= threads && group.size() < thread_issue_slots; k++) {
+         unsigned t                 = (current_thread + k) % threads;
+         if(thread_ready(t, group))
+            group.push_back(contexts[t].fetched);
+      }
+      if(!group.empty())
+         current_thread             = group[0].thread;
+   }
+
+   for(unsigned i = 0; i < group.size(); i++) {
+      thread_context_t& context     = contexts[group[i].thread];
+      instruction_t& instruction    = group[i].instruction;
+      if(instruction.dest_op) {
+         context.int_file[instruction.dest].busy += !(instruction.dest_float_op);
+         context.fp_file[instruction.dest].busy  +=  (instruction.dest_float_op);
+      }
+      context.in_flight++;
+      context.has_fetched           = false;
+   }
+
+   // count the cycles lost while some thread still had instructions to issue
+   bool issuing = false;
+   for(unsigned t = 0; t < threads; t++)
+      issuing  |= !(contexts[t].eop_fetched && !contexts[t].has_fetched);
+   if(group.empty() && issuing && cycleCount > 0)
+      stall_count++;
+}
+
+//----------------------------------------------------------------------
+// Start the issued instructions on the execution units and collect the
+// results leaving the units this cycle
+//----------------------------------------------------------------------
+void sim_pipe_fp::THREAD_EXE() {
+   for(unsigned i = 0; i < thread_latch[EX].size(); i++) {
+      thread_slot_t& slot  = thread_latch[EX][i];
+      execUnitT& unit      = float_point_exe_reg[convert_op_to_exe_unit(slot.instruction.opcode)];
+      int j                = unit.free_lane(cycleCount);
+      ASSERT( j != -1, "STRUCTURAL HAZARD AT EX DETECTED" );
+      execLaneT& lane      = unit.exe_pipe_units[j];
+      lane.instruction     = slot.instruction;
+      lane.latency_exe     = exLatency(slot.instruction, slot.a, slot.b);
+      lane.a               = slot.a;
+      lane.b               = slot.b;
+      lane.exNpc           = slot.npc;
+      lane.thread          = slot.thread;
+      unit.start(j, cycleCount);
+   }
+
+   thread_latch[MEM].clear();
+   for(int i = 0; i < EXE_UNIT_SIZE; i++) {
+      for(int j = 0; j < float_point_exe_reg[i].num_exe_pipe_units; j++) {
+         execLaneT& lane   = float_point_exe_reg[i].exe_pipe_units[j];
+         if(lane.latency_exe == 0 || --lane.latency_exe != 0)
+            continue;
+         thread_slot_t slot;
+         slot.instruction  = lane.instruction;
+         slot.thread       = lane.thread;
+         slot.npc          = lane.exNpc;
+         slot.a            = lane.a;
+         slot.b            = lane.b;
+         slot.alu_output   = UNDEFINED;
+         slot.lmd          = UNDEFINED;
+         slot.cond         = false;
+         slot.ready_cycle  = 0;
+         if(slot.instruction.opcode != NOP && slot.instruction.opcode != EOP)
+            slot.alu_output = evaluate(slot.instruction, slot.npc, slot.a, slot.b, slot.cond);
+         lane.instruction.set_stall();
+         thread_latch[MEM].push_back(slot);
+      }
+   }
+}
+
+//----------------------------------------------------------------------
+// Resolve branches and start the data memory accesses; the loads and
+// stores wait for the memory latency aside, and move on to WB (oldest
+// first) once it has elapsed
+//----------------------------------------------------------------------
+void sim_pipe_fp::THREAD_MEM() {
+   thread_latch[WB].clear();
+   for(unsigned i = 0; i < parked.size(); ) {
+      if(parked[i].ready_cycle > (unsigned)cycleCount) {
+         i++;
+         continue;
+      }
+      contexts[parked[i].thread].memory_pending--;
+      thread_latch[WB].push_back(parked[i]);
+      parked.erase(parked.begin() + i);
+   }
+   for(unsigned i = 0; i < thread_latch[MEM].size(); i++) {
+      thread_slot_t& slot        = thread_latch[MEM][i];
+      thread_context_t& context  = contexts[slot.thread];
+      opcode_t opcode            = slot.instruction.opcode;
+      bool is_mem                = (opcode >= LW && opcode <= SWS);
+      if(slot.instruction.branch_op) {
+         if(slot.cond)
+            context.pc           = slot.alu_output;
+         context.branch_pending  = false;
+      }
+      if(opcode == LW || opcode == LWS)
+         slot.lmd                = read_memory(slot.alu_output);
+      else if(opcode == SW || opcode == SWS)
+         write_memory(slot.alu_output, slot.b);
+      if(is_mem && memLatency > 0) {
+         slot.ready_cycle        = cycleCount + memLatency;
+         context.memory_pending++;
+         parked.push_back(slot);
+      }
+      else
+         thread_latch[WB].push_back(slot);
+   }
+   thread_latch[MEM].clear();
+}
+
+//----------------------------------------------------------------------
+// Write back to the register files of the threads. Returns true once
+// every thread has written back its EOP
+//----------------------------------------------------------------------
+bool sim_pipe_fp::THREAD_WB() {
+   for(unsigned i = 0; i < thread_latch[WB].size(); i++) {
+      thread_slot_t& slot        = thread_latch[WB][i];
+      thread_context_t& context  = contexts[slot.thread];
+      instruction_t& instruction = slot.instruction;
+      context.in_flight--;
+      if(instruction.opcode == EOP) {
+         context.done            = true;
+         context.finish_cycle    = cycleCount;
+         continue;
+      }
+      if(instruction.dest_op) {
+         unsigned result         = (instruction.opcode == LW || instruction.opcode == LWS) ? slot.lmd : slot.alu_output;
+         if(instruction.dest_float_op) {
+            context.fp_file[instruction.dest].value  = unsigned2float(result);
+            context.fp_file[instruction.dest].busy--;
+         }
+         else {
+            context.int_file[instruction.dest].value = result;
+            context.int_file[instruction.dest].busy--;
+         }
+      }
+      context.instructions++;
+   }
+   thread_latch[WB].clear();
+   for(unsigned t = 0; t < contexts.size(); t++) {
+      if(!contexts[t].done)
+         return false;
+   }
+   return true;
+}
+
+void sim_pipe_fp::run_threads(unsigned cycles){
+   bool run_to_completion = (cycles == 0);
+   while(cycles-- || run_to_completion) {
+      if(THREAD_WB()) return;
+      THREAD_MEM();
+      THREAD_EXE();
+      THREAD_ID();
+      THREAD_IF();
+      account_exec_units();
+      cycleCount++;
+   }
+}
@@ -0,0 +1,376 @@
+#include "sim_pipe_fp.h"
+
+using namespace std;
+
+//----------------------------------------------------------------------
+// Multicore system
+//
+// Every core is a scalar in-order pipeline working on the shared data
+// memory. The latency of a load, store or SWAP is that of the access to
+// the private L1 of its core, looked up (and made coherent) when the
+// instruction enters MEM; the data is read and written in memory once
+// the latency has elapsed, and SWAP reads and writes its word in the
+// same cycle, so no other core sees the word in between. Each system
+// cycle runs one clock cycle of every core in turn; a core has
+// completed its program once a cycle no longer advances its clock.
+//
+// On host threads, the deterministic mode is conservative: a cycle that
+// touches neither the shared data memory nor the L1s only depends on
+// the core itself, so every core runs ahead on its own host thread
+// until its next cycle may touch them (or the quantum ends). Then, as
+// long as the earliest cycle left is such a cycle of some cores, they
+// run it on the calling thread, in core order. The accesses, bus
+// transactions and SWAPs thus take place in the (cycle, core) order of
+// the lock step, with the same timing and results. A core only a few
+// cycles away from its next such cycle runs them in the lock step too:
+// running ahead on its host thread would not pay for the barriers, and
+// the cycles of the cores of the lock step are in the same order.
+//
+// The relaxed mode runs whole quanta instead: loads see the shared data
+// memory as it was at the start of the quantum (and the stores of their
+// own core), stores and SWAPs are logged, and the L1s defer their bus
+// transactions. At the end of the quantum the logs of all the cores are
+// replayed in (cycle, core) order, which hands every SWAP the old value
+// of its word, so a SWAP holds its core until then, and the time spent
+// waiting for the bus is not charged to the cores. It trades timing
+// accuracy for fewer barriers. The order of both modes never depends on
+// the host threads, so they are reproducible.
+//----------------------------------------------------------------------
+
+void sim_pipe_fp::attach(unsigned char *memory, coherence *caches, unsigned core){
+   delete [] data_memory;
+   data_memory          = memory;
+   this->caches         = caches;
+   core_id              = core;
+}
+
+static bool shared_opcode(opcode_t opcode){
+   return opcode == LW || opcode == SW || opcode == LWS || opcode == SWS || opcode == SWAP;
+}
+
+bool sim_pipe_fp::shared_access_ahead(){
+   if(shared_opcode(instruction_register[MEM].opcode))
+      return data_memory_latency_count == 0;      // otherwise MEM keeps holding EX
+   if(shared_opcode(instruction_register[EX].opcode))
+      return true;
+   for(int u = 0; u < EXE_UNIT_SIZE; u++) {
+      for(int j = 0; j < float_point_exe_reg[u].num_exe_pipe_units; j++) {
+         execLaneT& lane = float_point_exe_reg[u].exe_pipe_units[j];
+         if(lane.latency_exe == 1 && shared_opcode(lane.instruction.opcode))
+            return true;
+      }
+   }
+   return false;
+}
+
+//----------------------------------------------------------------------
+// An access in MEM freezes the pipeline for the rest of its latency.
+// Otherwise an access in an execution unit leaves it once its latency
+// has counted down, every instruction takes at least a cycle to move
+// from ID to EX, and the next one to be fetched at least another cycle,
+// so the next load, store or SWAP is at least as far as its distance
+// from EX, counting the straight-line code at the fetch PC up to its
+// first branch. A branch in flight, the fetch queue, a deeper front-end
+// and fusion leave only the bound of the instructions already issued
+//----------------------------------------------------------------------
+unsigned sim_pipe_fp::private_cycles(unsigned limit){
+   if(shared_access_ahead())
+      return 0;
+   if(shared_opcode(instruction_register[MEM].opcode))
+      return min(data_memory_latency_count, limit);
+   unsigned cycles      = limit;
+   bool branch          = instruction_register[ID].branch_op || instruction_register[EX].branch_op || instruction_register[MEM].branch_op;
+   for(int u = 0; u < EXE_UNIT_SIZE; u++) {
+      for(int j = 0; j < float_point_exe_reg[u].num_exe_pipe_units; j++) {
+         execLaneT& lane = float_point_exe_reg[u].exe_pipe_units[j];
+         if(shared_opcode(lane.instruction.opcode))
+            cycles      = min(cycles, (lane.latency_exe > 0) ? (unsigned)lane.latency_exe - 1 : 0);
+         branch        |= lane.instruction.branch_op;
+      }
+   }
+   if(shared_opcode(instruction_register[ID].opcode))
+      return min(1u, cycles);
+   if(branch || fetch_queue_size > 0 || !front_end.empty() || fusion_idioms != 0)
+      return min(2u, cycles);
+   unsigned distance    = 2;
+   for(unsigned pc = sp_registers[IF][PC]; distance < cycles; pc += 4) {
+      instruction_t *instruction = instMemory[(pc - baseAddress)/4];
+      if(instruction->opcode == EOP)
+         return cycles;
+      if(shared_opcode(instruction->opcode))
+         break;
+      distance++;
+      if(instruction->branch_op)
+         break;
+   }
+   return min(distance, cycles);
+}
+
+sim_pipe_fp_multicore::sim_pipe_fp_multicore(unsigned cores, unsigned data_mem_size, unsigned data_mem_latency, coherence_protocol_t protocol,
+                                             unsigned cache_size, unsigned line_size, unsigned ways, unsigned hit_latency,
+                                             unsigned transfer_latency, unsigned bus_cycles){
+   dataMemSize          = data_mem_size;
+   data_memory          = new unsigned char[dataMemSize];
+   memset(data_memory, 0xFF, dataMemSize);
+   caches               = new coherence(cores, protocol, cache_size, line_size, ways, hit_latency, data_mem_latency, transfer_latency, bus_cycles);
+   for(unsigned c = 0; c < cores; c++) {
+      sim_pipe_fp *pipe = new sim_pipe_fp(data_mem_size, data_mem_latency);
+      pipe->attach(data_memory, caches, c);
+      this->cores.push_back(pipe);
+   }
+   finished.assign(cores, false);
+   host_threads         = 0;
+   sync_mode            = DETERMINISTIC;
+   quantum              = 1000;
+   run_ahead            = 16;
+   quantum_cycles       = 0;
+   quanta               = 0;
+   horizon              = 0;
+   stopping             = false;
+   sync                 = NULL;
+}
+
+sim_pipe_fp_multicore::~sim_pipe_fp_multicore(){
+   for(unsigned c = 0; c < cores.size(); c++)
+      delete cores[c];
+   delete caches;
+   delete [] data_memory;
+}
+
+sim_pipe_fp *sim_pipe_fp_multicore::core(unsigned core){
+   ASSERT( core < cores.size(), "Unknown core (=%d)", core );
+   return cores[core];
+}
+
+void sim_pipe_fp_multicore::run(unsigned cycles){
+   for(unsigned c = 0; c < cores.size(); c++) {
+      sim_pipe_fp *pipe = cores[c];
+      ASSERT( pipe->instMemory != NULL, "No program loaded in core %d", c );
+      ASSERT( pipe->scheduler == IN_ORDER && pipe->issue_width == 1 && pipe->contexts.empty() && pipe->num_mshrs == 0 &&
+              pipe->store_buffer_size == 0 && pipe->lsq_size == 0 && pipe->data_prefetcher == NULL && pipe->dram_model == NULL,
+              "The cores of the multicore system are scalar in-order pipelines with a blocking memory stage behind their L1" );
+   }
+   if(host_threads > 0) {
+      run_parallel(cycles);
+      return;
+   }
+   bool run_2_completion = (cycles == 0);
+   while(cycles-- || run_2_completion) {
+      bool running      = false;
+      for(unsigned c = 0; c < cores.size(); c++) {
+         if(finished[c])
+            continue;
+         int clock      = cores[c]->cycleCount;
+         cores[c]->run(1);
+         finished[c]    = (cores[c]->cycleCount == clock);
+         running       |= !finished[c];
+      }
+      if(!running) return;
+   }
+}
+
+void sim_pipe_fp_multicore::set_host_threads(unsigned threads, sync_mode_t mode, unsigned quantum, unsigned run_ahead){
+   ASSERT( quantum > 0, "Unsupported quantum (=%d)", quantum );
+   host_threads         = threads;
+   sync_mode            = mode;
+   this->quantum        = quantum;
+   this->run_ahead      = run_ahead;
+}
+
+//----------------------------------------------------------------------
+// Runs the cores of host thread "thread" for the quantum: up to the
+// horizon or their first cycle that may touch the shared data memory or
+// the L1s (deterministic mode), or the whole quantum (relaxed mode)
+//----------------------------------------------------------------------
+void sim_pipe_fp_multicore::run_quantum(unsigned thread){
+   for(unsigned c = thread; c < cores.size(); c += host_threads) {
+      while(sync_mode == DETERMINISTIC && !finished[c] && (unsigned)cores[c]->cycleCount < horizon && !cores[c]->shared_access_ahead()) {
+         int clock      = cores[c]->cycleCount;
+         cores[c]->run(1);
+         finished[c]    = (cores[c]->cycleCount == clock);
+      }
+      if(finished[c] || sync_mode == DETERMINISTIC)
+         continue;
+      int clock         = cores[c]->cycleCount;
+      cores[c]->run(quantum_cycles);
+      finished[c]       = (cores[c]->cycleCount - clock < (int)quantum_cycles);
+   }
+}
+
+void sim_pipe_fp_multicore::host_worker(unsigned thread){
+   while(true) {
+      sync->wait();
+      if(stopping)
+         return;
+      run_quantum(thread);
+      sync->wait();
+   }
+}
+
+static bool earlier(const memory_event_t& a, const memory_event_t& b){
+   return a.cycle < b.cycle || (a.cycle == b.cycle && a.core < b.core);
+}
+
+//----------------------------------------------------------------------
+// Replays the shared data memory accesses and the bus transactions of
+// the quantum in cycle order, handing every SWAP its old value
+//----------------------------------------------------------------------
+void sim_pipe_fp_multicore::exchange(){
+   vector<memory_event_t> events;
+   for(unsigned c = 0; c < cores.size(); c++) {
+      events.insert(events.end(), cores[c]->memory_events.begin(), cores[c]->memory_events.end());
+      cores[c]->memory_events.clear();
+      cores[c]->own_writes.clear();
+   }
+   stable_sort(events.begin(), events.end(), earlier);
+   for(unsigned i = 0; i < events.size(); i++) {
+      if(events[i].atomic) {
+         cores[events[i].core]->atomic_value = read_memory(events[i].address);
+         cores[events[i].core]->atomic_ready = true;
+      }
+      write_memory(events[i].address, events[i].value);
+   }
+   caches->exchange();
+}
+
+//----------------------------------------------------------------------
+// Returns the earliest clock cycle of the cores still running before
+// "stop" (UINT_MAX once there is none)
+//----------------------------------------------------------------------
+unsigned sim_pipe_fp_multicore::earliest(unsigned stop){
+   unsigned cycle       = UINT_MAX;
+   for(unsigned c = 0; c < cores.size(); c++) {
+      if(!finished[c] && (unsigned)cores[c]->cycleCount < stop)
+         cycle          = min(cycle, (unsigned)cores[c]->cycleCount);
+   }
+   return cycle;
+}
+
+//----------------------------------------------------------------------
+// Runs the earliest clock cycle left in the cores that may touch the
+// shared data memory or the L1s in it, or in fewer than run_ahead
+// cycles, in core order, as long as there are such cores (deterministic
+// mode)
+//----------------------------------------------------------------------
+void sim_pipe_fp_multicore::lock_step(unsigned stop){
+   bool shared          = true;
+   while(shared) {
+      unsigned cycle    = earliest(stop);
+      shared            = false;
+      for(unsigned c = 0; c < cores.size(); c++) {
+         if(finished[c] || (unsigned)cores[c]->cycleCount != cycle || cores[c]->private_cycles(run_ahead) == run_ahead)
+            continue;
+         cores[c]->run(1);
+         finished[c]    = ((unsigned)cores[c]->cycleCount == cycle);
+         shared         = true;
+      }
+   }
+}
+
+void sim_pipe_fp_multicore::run_parallel(unsigned cycles){
+   bool relaxed         = (sync_mode == RELAXED);
+   unsigned stop        = (cycles == 0) ? UINT_MAX : earliest(UINT_MAX) + cycles;
+   vector<thread> workers;
+   sync                 = new barrier(host_threads);
+   stopping             = false;
+   for(unsigned c = 0; c < cores.size(); c++)
+      cores[c]->deferred = relaxed;
+   caches->defer(relaxed);
+   for(unsigned t = 1; t < host_threads; t++)
+      workers.push_back(thread(&sim_pipe_fp_multicore::host_worker, this, t));
+   for(unsigned cycle = earliest(stop); cycle != UINT_MAX; cycle = earliest(stop)) {
+      quantum_cycles    = min(quantum, stop - cycle);
+      horizon           = cycle + quantum_cycles;
+      sync->wait();
+      run_quantum(0);
+      sync->wait();
+      if(relaxed)
+         exchange();
+      else
+         lock_step(stop);
+      quanta++;
+   }
+   stopping             = true;
+   sync->wait();
+   for(unsigned t = 0; t < workers.size(); t++)
+      workers[t].join();
+   for(unsigned c = 0; c < cores.size(); c++)
+      cores[c]->deferred = false;
+   caches->defer(false);
+   delete sync;
+   sync                 = NULL;
+}
+
+unsigned sim_pipe_fp_multicore::get_quanta(){
+   return quanta;
+}
+
+float sim_pipe_fp_multicore::get_timing_error(sim_pipe_fp_multicore *reference){
+   ASSERT( reference->cores.size() == cores.size(), "The reference system has %d cores instead of %d", (int)reference->cores.size(), (int)cores.size() );
+   float error          = 0;
+   for(unsigned c = 0; c < cores.size(); c++) {
+      float expected    = reference->cores[c]->get_clock_cycles();
+      float difference  = cores[c]->get_clock_cycles() - expected;
+      error            += ((difference < 0) ? -difference : difference) / expected;
+   }
+   return error / cores.size();
+}
+
+unsigned sim_pipe_fp_multicore::get_clock_cycles(){
+   unsigned cycles      = 0;
+   for(unsigned c = 0; c < cores.size(); c++)
+      cycles            = max(cycles, cores[c]->get_clock_cycles());
+   return cycles;
+}
+
+float sim_pipe_fp_multicore::get_IPC(){
+   unsigned instructions = 0;
+   for(unsigned c = 0; c < cores.size(); c++)
+      instructions      += cores[c]->get_instructions_executed();
+   return (float)instructions / get_clock_cycles();
+}
+
+unsigned sim_pipe_fp_multicore::get_cache_hits(unsigned core){
+   return caches->get_hits(core);
+}
+
+unsigned sim_pipe_fp_multicore::get_cache_misses(unsigned core){
+   return caches->get_misses(core);
+}
+
+unsigned sim_pipe_fp_multicore::get_bus_transactions(bus_transaction_t transaction){
+   return caches->get_transactions(transaction);
+}
+
+unsigned sim_pipe_fp_multicore::get_invalidations(){
+   return caches->get_invalidations();
+}
+
+unsigned sim_pipe_fp_multicore::get_cache_transfers(){
+   return caches->get_cache_transfers();
+}
+
+unsigned sim_pipe_fp_multicore::get_bus_wait_cycles(){
+   return caches->get_bus_wait_cycles();
+}
+
+void sim_pipe_fp_multicore::print_memory(unsigned start_address, unsigned end_address){
+   cores[0]->print_memory(start_address, end_address);
+}
+
+void sim_pipe_fp_multicore::write_memory(unsigned address, unsigned value){
+   ASSERT( address % 4 == 0 && address < dataMemSize, "Unaligned or out of bounds memory access found at address %x", address );
+   data_memory[address + 0] = value;
+   data_memory[address + 1] = value >> 8;
+   data_memory[address + 2] = value >> 16;
+   data_memory[address + 3] = value >> 24;
+}
+
+unsigned sim_pipe_fp_multicore::read_memory(unsigned address){
+   unsigned value = 0;
+   value |= data_memory[address + 0];
+   value |= data_memory[address + 1] << 8;
+   value |= data_memory[address + 2] << 16;
+   value |= data_memory[address + 3] << 24;
+   return value;
+}
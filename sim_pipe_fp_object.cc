@@ -0,0 +1,150 @@
+#include "sim_pipe_fp.h"
+
+//----------------------------------------------------------------------
+// Object files
+//
+// Same encoding as the integer simulator (see program.h), with the
+// floating point flag of every register field: field A holds the
+// destination, or the register stored by SW and SWS; field B the first
+// source; the tail the second source of an ALU operation, or the
+// immediate. Loading an object file decodes it into the instruction
+// memory in a single pass over the mapped words.
+//----------------------------------------------------------------------
+
+void sim_pipe_fp::assemble(const char *asm_filename, const char *object_filename, unsigned data_start, unsigned data_end){
+   ASSERT( data_start % 4 == 0 && data_end % 4 == 0 && data_start <= data_end, "Misaligned data segment [%x, %x)", data_start, data_end );
+   // parse() builds the program in instMemory
+   instructPT *loaded           = instMemory;
+   instMemory                   = NULL;
+   unsigned size                = parse(asm_filename);
+
+   program object(true);
+   for(unsigned i = 0; i < size; i++) {
+      instruction_t& instruction = *instMemory[i];
+      unsigned dest              = instruction.dest_op ? object.reg_field(instruction.dest, instruction.dest_float_op) : 0;
+      unsigned src1              = instruction.src1_op ? object.reg_field(instruction.src1, instruction.src1_float_op) : 0;
+      unsigned src2              = instruction.src2_op ? object.reg_field(instruction.src2, instruction.src2_float_op) : 0;
+      switch(instruction.opcode) {
+         case ADD ... DIV:
+         case ADDS ... DIVS:
+            object.emit(instruction.opcode, dest, src1, src2);
+            break;
+         case ADDI ... ANDI:
+         case LW:
+         case LWS:
+         case SWAP:
+         case BEQZ ... BGEZ:
+         case JUMP:
+            object.emit(instruction.opcode, dest, src1, object.immediate_field(instruction.imm));
+            break;
+         case SW:
+         case SWS:
+            object.emit(instruction.opcode, src2, src1, object.immediate_field(instruction.imm));
+            break;
+         default:
+            object.emit(instruction.opcode);
+            break;
+      }
+      delete instMemory[i];
+   }
+   free(instMemory);
+   instMemory                   = loaded;
+
+   map<string, unsigned> labels;
+   scan_labels(asm_filename, labels);
+   for(map<string, unsigned>::iterator it = labels.begin(); it != labels.end(); it++) {
+      program::symbol_t symbol = {it->first, it->second};
+      object.symbols.push_back(symbol);
+   }
+   if(data_end > data_start) {
+      program::segment_t segment;
+      segment.address           = data_start;
+      for(unsigned address = data_start; address < data_end; address += 4)
+         segment.words.push_back(read_memory(address));
+      object.data.push_back(segment);
+   }
+   object.save(object_filename);
+}
+
+int sim_pipe_fp::load_object(const char *filename){
+   program object;
+   object.map(filename);
+   ASSERT( object.fp, "%s holds integer simulator instructions", filename );
+   unsigned size                = object.text_count;
+   instMemory                   = (instructPT*) realloc(instMemory, size * sizeof(instructPT));
+   instruction_t *instructions  = new instruction_t[size];
+   for(unsigned i = 0; i < size; i++) {
+      instruction_t& instruction = instructions[i];
+      unsigned a                 = object.field_a(i);
+      unsigned b                 = object.field_b(i);
+      unsigned c                 = object.field_c(i);
+      instMemory[i]             = &instruction;
+      instruction.opcode        = (opcode_t) object.opcode(i);
+      switch(instruction.opcode) {
+         case ADD ... DIV:
+         case ADDS ... DIVS:
+            instruction.dest           = program::reg(a);
+            instruction.src1           = program::reg(b);
+            instruction.src2           = program::reg(c);
+            instruction.dest_float_op  = program::is_float(a);
+            instruction.src1_float_op  = program::is_float(b);
+            instruction.src2_float_op  = program::is_float(c);
+            instruction.dest_op        = true;
+            instruction.src1_op        = true;
+            instruction.src2_op        = true;
+            break;
+         case ADDI ... ANDI:
+         case LW:
+         case LWS:
+            instruction.dest           = program::reg(a);
+            instruction.src1           = program::reg(b);
+            instruction.imm            = object.immediate(i);
+            instruction.dest_float_op  = program::is_float(a);
+            instruction.src1_float_op  = program::is_float(b);
+            instruction.dest_op        = true;
+            instruction.src1_op        = true;
+            break;
+         case SW:
+         case SWS:
+            instruction.src2           = program::reg(a);
+            instruction.src1           = program::reg(b);
+            instruction.imm            = object.immediate(i);
+            instruction.src2_float_op  = program::is_float(a);
+            instruction.src1_float_op  = program::is_float(b);
+            instruction.src2_op        = true;
+            instruction.src1_op        = true;
+            break;
+         case SWAP:
+            instruction.dest           = program::reg(a);
+            instruction.src2           = program::reg(a);
+            instruction.src1           = program::reg(b);
+            instruction.imm            = object.immediate(i);
+            instruction.src1_float_op  = program::is_float(b);
+            instruction.dest_op        = true;
+            instruction.src2_op        = true;
+            instruction.src1_op        = true;
+            break;
+         case BEQZ ... BGEZ:
+            instruction.src1           = program::reg(b);
+            instruction.imm            = object.immediate(i);
+            instruction.src1_float_op  = program::is_float(b);
+            instruction.src1_op        = true;
+            instruction.branch_op      = true;
+            break;
+         case JUMP:
+            instruction.imm            = object.immediate(i);
+            instruction.branch_op      = true;
+            break;
+         case EOP:
+         case NOP:
+            break;
+         default:
+            ASSERT(false, "Unknown operation in object file %s", filename);
+            break;
+      }
+   }
+   for(unsigned s = 0; s < object.data.size(); s++)
+      for(unsigned w = 0; w < object.data[s].words.size(); w++)
+         write_memory(object.data[s].address + 4 * w, object.data[s].words[w]);
+   return size;
+}
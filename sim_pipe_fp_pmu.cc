@@ -0,0 +1,85 @@
+#include "sim_pipe_fp.h"
+
+//----------------------------------------------------------------------
+// Performance monitoring unit
+//
+// The stalls, data memory accesses and taken branches are counted where
+// the pipeline handles them, the instructions as they retire in WB (a
+// fused pair as its two instructions). Once WB has taken its
+// instruction, the clock cycle is counted, along with every execution
+// unit with a lane still executing (in the first instruction issued to
+// it), and the data memory if MEM holds a load or a store, or a load is
+// outstanding in an MSHR.
+//----------------------------------------------------------------------
+
+void sim_pipe_fp::set_pmu(pmu *monitoring){
+   this->monitoring               = monitoring;
+   if(monitoring != NULL)
+      monitoring->attach();
+}
+
+// event of the retirement of "opcode"
+static pmu_event_t retired_class(opcode_t opcode){
+   switch(opcode) {
+      case LW:
+      case LWS:
+         return EVENT_LOAD_OPS;
+      case SW:
+      case SWS:
+      case SWAP:
+         return EVENT_STORE_OPS;
+      case BEQZ ... BGEZ:
+      case JUMP:
+         return EVENT_BRANCH_OPS;
+      case ADDS ... DIVS:
+         return EVENT_FP_OPS;
+      default:
+         return EVENT_INTEGER_OPS;
+   }
+}
+
+//----------------------------------------------------------------------
+// Counts the retirement of "instruction"
+//----------------------------------------------------------------------
+void sim_pipe_fp::pmu_retire(const instruction_t& instruction){
+   if(instruction.fused_opcode != NOP) {
+      // the ALU operation of a fused pair is the instruction before the branch or load
+      monitoring->count(EVENT_INSTRUCTIONS, instruction.pc - 4);
+      monitoring->count(EVENT_INTEGER_OPS, instruction.pc - 4);
+   }
+   monitoring->count(EVENT_INSTRUCTIONS, instruction.pc);
+   monitoring->count(retired_class(instruction.opcode), instruction.pc);
+   monitoring->retired_pc         = instruction.pc;
+}
+
+//----------------------------------------------------------------------
+// Counts "cycles" clock cycles of the pipeline as it is
+//----------------------------------------------------------------------
+void sim_pipe_fp::pmu_cycle(unsigned cycles){
+   monitoring->cycle(cycles);
+   for(int u = 0; u < EXE_UNIT_SIZE; u++) {
+      pmu_event_t event           = (pmu_event_t)(EVENT_INTEGER_BUSY + u);
+      if(!monitoring->counting(event))
+         continue;
+      execLaneT *first            = NULL;
+      for(int j = 0; j < float_point_exe_reg[u].num_exe_pipe_units; j++) {
+         execLaneT& lane          = float_point_exe_reg[u].exe_pipe_units[j];
+         if(lane.latency_exe != 0 && lane.instruction.pc != UNDEFINED && (first == NULL || lane.seq < first->seq))
+            first                 = &lane;
+      }
+      if(first != NULL)
+         monitoring->count(event, first->instruction.pc, cycles);
+   }
+   if(monitoring->counting(EVENT_MEMORY_BUSY)) {
+      opcode_t opcode             = instruction_register[MEM].opcode;
+      unsigned pc                 = UNDEFINED;
+      if(instruction_register[MEM].pc != UNDEFINED && ((opcode >= LW && opcode <= SWS) || opcode == SWAP))
+         pc                       = instruction_register[MEM].pc;
+      for(unsigned i = 0; i < wb_queue.size() && pc == UNDEFINED; i++) {
+         if(wb_queue[i].mshr != -1)
+            pc                    = wb_queue[i].instruction.pc;
+      }
+      if(pc != UNDEFINED)
+         monitoring->count(EVENT_MEMORY_BUSY, pc, cycles);
+   }
+}
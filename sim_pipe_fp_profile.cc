@@ -0,0 +1,134 @@
+#include "sim_pipe_fp.h"
+
+//----------------------------------------------------------------------
+// Per-instruction profile
+//
+// The fetches, stalls, data memory accesses and taken branches are
+// counted where the pipeline handles them; the control stalls are
+// charged to the branch holding up decode. An instruction is stamped
+// with the clock cycle it enters a stage, as seen once WB has taken its
+// instruction (the cycle after the one writing the latch, or the fetch),
+// and the cycles since are added to the stage it leaves: IF as it
+// enters the latch of ID (from the fetch queue or the extra front-end
+// sub-stages), ID and EX (the latch and the execution lane) as it
+// enters the latch of MEM (it carries its cycles of ID through EX), and
+// MEM (with the extra memory sub-stages and the write-back queue) as WB
+// takes it. WB takes one cycle, but none for EOP, which
+// ends the run. A clock cycle is charged to the oldest instruction past
+// EX, or with none to the first issued of the ones executing: the
+// cycles up to a write-back to the instruction written back, the ones
+// with no instruction past EX as the next one leaves EX. A run stopping
+// with instructions in flight counts them in their stages and charges
+// its cycles to the oldest of them (in the lanes, the first issued), or
+// to the PC being fetched when the pipeline is empty.
+//----------------------------------------------------------------------
+
+void sim_pipe_fp::set_profiler(profiler *profiling){
+   ASSERT( profiling == NULL || instMemory != NULL, "No program loaded" );
+   this->profiling                = profiling;
+   profiled_past_ex               = 0;
+   if(profiling != NULL)
+      profiling->start(baseAddress, cycleCount);
+}
+
+//----------------------------------------------------------------------
+// Profiles "instruction" as it leaves EX for MEM, in the current clock
+// cycle. The cycles not charged yet, with no instruction past EX, go to
+// the first issued of the ones executing
+//----------------------------------------------------------------------
+void sim_pipe_fp::profile_memory(instruction_t& instruction){
+   if(instruction.pc == UNDEFINED)
+      return;
+   profiling->execute(instruction.pc, instruction.seq, cycleCount + 1);
+   if(profiled_past_ex++ != 0 || profiling->charged > (unsigned long)cycleCount)
+      return;
+   execLaneT *first               = NULL;
+   for(int u = 0; u < EXE_UNIT_SIZE; u++) {
+      for(int j = 0; j < float_point_exe_reg[u].num_exe_pipe_units; j++) {
+         execLaneT& lane          = float_point_exe_reg[u].exe_pipe_units[j];
+         if(lane.instruction.pc != UNDEFINED && (first == NULL || lane.seq < first->seq))
+            first                 = &lane;       // the lane of "instruction" is still set
+      }
+   }
+   profiling->charge(first != NULL ? first->instruction.pc : instruction.pc, cycleCount + 1);
+}
+
+//----------------------------------------------------------------------
+// Profiles "instruction" as WB takes it, in the current clock cycle
+// (EOP ends the run)
+//----------------------------------------------------------------------
+void sim_pipe_fp::profile_write_back(instruction_t& instruction){
+   unsigned pc                    = instruction.pc;
+   if(instruction.opcode == EOP) {
+      profiling->leave(pc, MEM, instruction.seq, cycleCount);
+      profiled_past_ex--;
+      profiling->charge(pc != UNDEFINED ? pc : sp_registers[IF][PC], cycleCount);
+   }
+   else if(pc != UNDEFINED) {
+      profiling->write_back(pc, instruction.seq, cycleCount);
+      profiled_past_ex--;
+   }
+}
+
+// counts "instruction" in "stage" up to the current clock cycle, the oldest instruction so far
+static void in_stage(profiler *profiling, instruction_t& instruction, stage_t stage, unsigned now, unsigned &oldest){
+   if(instruction.pc == UNDEFINED)
+      return;
+   profiling->leave(instruction.pc, stage, instruction.seq, now);
+   oldest                         = instruction.pc;
+}
+
+//----------------------------------------------------------------------
+// Profiles the instructions in flight up to the current clock cycle, as
+// a run stops (youngest instructions first). The ones in the latch of
+// EX and the lanes still have their cycles of ID. WB has not taken the
+// latch MEM wrote yet; the one of the write-back queue is profiled
+//----------------------------------------------------------------------
+void sim_pipe_fp::profile_flush(){
+   unsigned oldest                = UNDEFINED;
+   for(int i = fetch_queue.size() - 1; i >= 0; i--)
+      in_stage(profiling, fetch_queue[i].instruction, IF, cycleCount, oldest);
+   for(int i = front_end.size() - 1; i >= 0; i--)
+      in_stage(profiling, front_end[i].instruction, IF, cycleCount, oldest);
+   in_stage(profiling, instruction_register[ID], ID, cycleCount, oldest);
+   profiling->flush_decoded(instruction_register[EX].pc, instruction_register[EX].seq);
+   in_stage(profiling, instruction_register[EX], EX, cycleCount, oldest);
+   execLaneT *first               = NULL;
+   for(int u = 0; u < EXE_UNIT_SIZE; u++) {
+      for(int j = 0; j < float_point_exe_reg[u].num_exe_pipe_units; j++) {
+         execLaneT& lane          = float_point_exe_reg[u].exe_pipe_units[j];
+         if(lane.latency_exe == 0 || lane.instruction.pc == UNDEFINED)
+            continue;
+         profiling->flush_decoded(lane.instruction.pc, lane.instruction.seq);
+         profiling->leave(lane.instruction.pc, EX, lane.instruction.seq, cycleCount);
+         if(first == NULL || lane.seq < first->seq)
+            first                 = &lane;
+      }
+   }
+   if(first != NULL)
+      oldest                      = first->instruction.pc;
+   in_stage(profiling, instruction_register[MEM], MEM, cycleCount, oldest);
+   for(int i = wb_queue.size() - 1; i >= 0; i--)
+      in_stage(profiling, wb_queue[i].instruction, MEM, cycleCount, oldest);
+   if(num_mshrs == 0)
+      in_stage(profiling, instruction_register[WB], MEM, cycleCount, oldest);
+   for(int i = memory_pipe.size() - 1; i >= 0; i--)
+      in_stage(profiling, memory_pipe[i].instruction, MEM, cycleCount, oldest);
+   profiling->charge(oldest != UNDEFINED ? oldest : sp_registers[IF][PC], cycleCount);
+}
+
+//----------------------------------------------------------------------
+// PC of the branch that keeps "instruction" from leaving decode: the
+// instruction itself, or the branch in EX or in the integer unit
+//----------------------------------------------------------------------
+unsigned sim_pipe_fp::branch_pc(instruction_t& instruction){
+   if(instruction.branch_op)
+      return instruction.pc;
+   if(instruction_register[EX].branch_op)
+      return instruction_register[EX].pc;
+   for(int i = 0; i < float_point_exe_reg[INTEGER].num_exe_pipe_units; i++) {
+      if(float_point_exe_reg[INTEGER].exe_pipe_units[i].instruction.branch_op)
+         return float_point_exe_reg[INTEGER].exe_pipe_units[i].instruction.pc;
+   }
+   return UNDEFINED;
+}
@@ -0,0 +1,154 @@
+#include "sim_pipe_fp.h"
+
+using namespace std;
+
+//----------------------------------------------------------------------
+// Sampled simulation
+//
+// As in the integer simulator: a sampling unit starts the scalar
+// in-order pipeline empty at the PC reached, and IF ends it by fetching
+// an EOP past the warm-up and measured instructions, which drains the
+// execution units and the memory stage as at the end of the program.
+// The instructions between the units run functionally, training the
+// prefetcher and opening the DRAM rows as the loads and stores would.
+//----------------------------------------------------------------------
+
+void sim_pipe_fp::sample(sampler *sampling){
+   ASSERT( instMemory != NULL, "No program loaded" );
+   ASSERT( scheduler == IN_ORDER && issue_width == 1 && contexts.empty() && replay == NULL && caches == NULL && lsq_size == 0,
+           "Sampling needs the scalar in-order pipeline running a program, with no load/store queue" );
+   this->sampling               = sampling;
+   unsigned pc                  = sp_registers[IF][PC];
+   while(!sampling->get_converged() && sample_unit(pc) && fast_forward(pc, sampling->fast_forward()));
+   if(sampling->get_converged())
+      fast_forward(pc, sampling->fast_forward());
+   sp_registers[IF][PC]         = pc;
+   this->sampling               = NULL;
+}
+
+//----------------------------------------------------------------------
+// Simulates the sampling unit starting at "pc" in detail, and leaves
+// "pc" at the instruction that follows it. Returns false if the unit
+// reached the end of the program
+//----------------------------------------------------------------------
+bool sim_pipe_fp::sample_unit(unsigned &pc){
+   restart(pc);
+   unsigned cycles              = cycleCount;
+   sample_fetch_limit           = instruction_count + sampling->warmup + sampling->unit;
+   sample_commits               = 0;
+   sample_start_cycle           = (sampling->warmup == 0) ? cycleCount : UNDEFINED;
+   sample_end_cycle             = UNDEFINED;
+   run();
+
+   pc                           = sample_resume_pc;
+   sampling->instructions      += sample_commits;
+   sampling->detailed_instructions += sample_commits;
+   sampling->detailed_cycles   += cycleCount - cycles;
+   if(sample_end_cycle != UNDEFINED)
+      sampling->measure(sample_end_cycle - sample_start_cycle);
+   return instMemory[(pc - baseAddress)/4]->opcode != EOP;
+}
+
+//----------------------------------------------------------------------
+// Commit of "instructions" instructions of the sampling unit
+//----------------------------------------------------------------------
+void sim_pipe_fp::sample_commit(unsigned instructions){
+   unsigned warmup              = sampling->warmup;
+   unsigned end                 = warmup + sampling->unit;
+   if(sample_commits < warmup && sample_commits + instructions >= warmup)
+      sample_start_cycle        = cycleCount;
+   if(sample_commits < end && sample_commits + instructions >= end)
+      sample_end_cycle          = cycleCount;
+   sample_commits              += instructions;
+}
+
+//----------------------------------------------------------------------
+// Empties the pipeline, drained by an EOP, to fetch from "pc"
+//----------------------------------------------------------------------
+void sim_pipe_fp::restart(unsigned pc){
+   for(int s = 0; s < NUM_STAGES; s++) {
+      instruction_register[s].set_stall();
+      clear_sp_register((stage_t)s);
+      sp_registers[s][COND]     = 0;
+   }
+   for(int i = 0; i < NUM_GP_REGISTERS; i++) {
+      int_file[i].busy          = 0;
+      fp_file[i].busy           = 0;
+   }
+   for(int u = 0; u < EXE_UNIT_SIZE; u++) {
+      for(int j = 0; j < float_point_exe_reg[u].num_exe_pipe_units; j++) {
+         float_point_exe_reg[u].exe_pipe_units[j].instruction.set_stall();
+         float_point_exe_reg[u].exe_pipe_units[j].latency_exe = 0;
+      }
+   }
+   sp_registers[IF][PC]         = pc;
+   fetch_queue.clear();
+   wb_queue.clear();                            // the EOPs fetched behind the one that ended the unit
+   fetch_wait                   = 0;
+   set_pipeline_depth(fetch_stages, decode_stages, memory_stages);
+   sample_resume_pc             = UNDEFINED;
+}
+
+//----------------------------------------------------------------------
+// Executes up to "instructions" instructions from "pc" without timing,
+// and leaves "pc" at the next one (profiling them if "profile" is not
+// NULL). Returns false if the program ended
+//----------------------------------------------------------------------
+bool sim_pipe_fp::fast_forward(unsigned &pc, unsigned instructions, simpoint *profile){
+   unsigned executed            = 0;
+   bool running                 = true;
+   while(executed < instructions) {
+      instruction_t &instruction = *(instMemory[(pc - baseAddress)/4]);
+      if(instruction.opcode == EOP) {
+         running                = false;
+         break;
+      }
+      unsigned npc              = pc + 4;
+      if(instruction.opcode != NOP) {
+         unsigned a             = !instruction.src1_op ? 0 : instruction.src1_float_op ? float2unsigned(get_fp_register(instruction.src1)) : get_int_register(instruction.src1);
+         unsigned b             = !instruction.src2_op ? 0 : instruction.src2_float_op ? float2unsigned(get_fp_register(instruction.src2)) : get_int_register(instruction.src2);
+         bool cond;
+         unsigned result        = evaluate(instruction, npc, a, b, cond);
+         switch(instruction.opcode) {
+            case LW:
+            case LWS:
+            case SWAP: {
+               unsigned address = result;
+               if(data_prefetcher != NULL && instruction.opcode != SWAP)
+                  data_prefetcher->warm(pc, address);
+               if(dram_model != NULL)
+                  dram_model->warm(address);
+               result           = read_memory(address);
+               if(instruction.opcode == SWAP)
+                  write_memory(address, b);
+               break;
+            }
+
+            case SW:
+            case SWS:
+               if(dram_model != NULL)
+                  dram_model->warm(result);
+               write_memory(result, b);
+               break;
+
+            case BEQZ ... BGEZ:
+            case JUMP:
+               npc              = cond ? result : npc;
+               break;
+
+            default: break;
+         }
+         if(instruction.dest_op && instruction.dest_float_op)
+            set_fp_register(instruction.dest, unsigned2float(result));
+         else if(instruction.dest_op)
+            set_int_register(instruction.dest, result);
+         if(profile != NULL)
+            profile->execute(pc, instruction.branch_op);
+         executed++;
+      }
+      pc                        = npc;
+   }
+   if(sampling != NULL)
+      sampling->instructions   += executed;
+   return running;
+}
@@ -0,0 +1,300 @@
+#include "sim_pipe_fp.h"
+
+using namespace std;
+
+static const char *unit_names[EXE_UNIT_SIZE] = {"INTEGER", "ADDER", "MULTIPLIER", "DIVIDER"};
+static const char *sb_state_names[] = {"issued", "read operands", "executed"};
+
+//----------------------------------------------------------------------
+// Scoreboard (CDC 6600 style) core
+//
+// Every unit instance configured by init_exec_unit is a functional
+// unit. An instruction goes through four stages, one cycle apart:
+//  - issue: in order, once its functional unit is free and no active
+//    instruction writes the same destination (WAW)
+//  - read operands: once no active instruction still has to write a
+//    source register (RAW); instructions may read operands, and hence
+//    execute, out of order
+//  - execute: the unit latency, at least one cycle (plus the data
+//    memory latency for loads and stores, which access memory at the
+//    end of execution)
+//  - write result: once no earlier instruction still has to read the
+//    destination register (WAR)
+// Memory operations conflicting through a store start executing in
+// program order. Issue stops at a branch until the branch writes its
+// result (no speculation).
+//----------------------------------------------------------------------
+
+void sim_pipe_fp::scoreboard_init(){
+   ASSERT( num_mshrs == 0 && store_buffer_size == 0 && dram_model == NULL, "MSHRs, the store buffer and the DRAM model are only modelled by the in-order core" );
+   num_fu               = 0;
+   for(int u = 0; u < EXE_UNIT_SIZE; u++)
+      num_fu           += float_point_exe_reg[u].num_exe_pipe_units;
+   fu_status            = new fu_status_t[num_fu];
+   unsigned f           = 0;
+   for(int u = 0; u < EXE_UNIT_SIZE; u++) {
+      for(int j = 0; j < float_point_exe_reg[u].num_exe_pipe_units; j++, f++) {
+         fu_status[f].busy        = false;
+         fu_status[f].unit        = (exe_unit_t)u;
+         fu_status[f].lane        = j;
+         fu_status[f].ready_cycle = 0;
+         float_point_exe_reg[u].exe_pipe_units[j].latency_exe = 0;
+      }
+   }
+   issue_seq            = 0;
+   fetch_pc             = sp_registers[IF][PC];
+   branch_pending       = false;
+   eop_issued           = false;
+}
+
+//----------------------------------------------------------------------
+// Register result status: functional unit that will write a register
+//----------------------------------------------------------------------
+int &sim_pipe_fp::result_status(unsigned reg, bool isF){
+   return isF ? fp_file[reg].fu : int_file[reg].fu;
+}
+
+//----------------------------------------------------------------------
+// WAR: an earlier instruction has not read the register fu will write
+//----------------------------------------------------------------------
+bool sim_pipe_fp::scoreboard_war_hazard(int fu){
+   instruction_t& instruction = fu_status[fu].instruction;
+   for(unsigned f = 0; f < num_fu; f++) {
+      fu_status_t& other = fu_status[f];
+      if((int)f == fu || !other.busy || other.state != SB_ISSUED)
+         continue;
+      if(other.rj && other.instruction.src1 == instruction.dest && other.instruction.src1_float_op == instruction.dest_float_op)
+         return true;
+      if(other.rk && other.instruction.src2 == instruction.dest && other.instruction.src2_float_op == instruction.dest_float_op)
+         return true;
+   }
+   return false;
+}
+
+//----------------------------------------------------------------------
+// A load or store may start once every earlier memory operation it
+// conflicts with (at least one of the two being a store) has executed
+//----------------------------------------------------------------------
+bool sim_pipe_fp::scoreboard_memory_order(int fu){
+   opcode_t opcode      = fu_status[fu].instruction.opcode;
+   if(opcode < LW || opcode > SWS)
+      return true;
+   bool is_store        = (opcode == SW || opcode == SWS);
+   for(unsigned f = 0; f < num_fu; f++) {
+      fu_status_t& other = fu_status[f];
+      opcode_t other_opcode = other.instruction.opcode;
+      if(!other.busy || other.seq >= fu_status[fu].seq || other.state == SB_EXECUTED || other_opcode < LW || other_opcode > SWS)
+         continue;
+      if(is_store || other_opcode == SW || other_opcode == SWS)
+         return false;
+   }
+   return true;
+}
+
+//----------------------------------------------------------------------
+// Write result: retire the executed instructions free of WAR hazards.
+// Returns true once the program has completed
+//----------------------------------------------------------------------
+bool sim_pipe_fp::scoreboard_write_result(){
+   bool active          = false;
+   for(unsigned f = 0; f < num_fu; f++) {
+      fu_status_t& fu   = fu_status[f];
+      if(!fu.busy)
+         continue;
+      active            = true;
+      if(fu.state != SB_EXECUTED || fu.ready_cycle > (unsigned)cycleCount)
+         continue;
+      instruction_t& instruction = fu.instruction;
+      if(instruction.dest_op && scoreboard_war_hazard(f))
+         continue;
+
+      if(instruction.dest_op) {
+         if(instruction.dest_float_op)
+            fp_file[instruction.dest].value  = unsigned2float(fu.result);
+         else
+            int_file[instruction.dest].value = fu.result;
+         if(result_status(instruction.dest, instruction.dest_float_op) == (int)f)
+            result_status(instruction.dest, instruction.dest_float_op) = -1;
+      }
+      if(instruction.branch_op) {
+         if(fu.cond)
+            fetch_pc    = fu.result;
+         branch_pending = false;
+         sp_registers[IF][PC] = fetch_pc;
+      }
+      for(unsigned g = 0; g < num_fu; g++) {
+         fu_status_t& other = fu_status[g];
+         if(!other.busy)
+            continue;
+         if(other.qj == (int)f) {
+            other.qj          = -1;
+            other.rj          = true;
+            other.ready_cycle = max(other.ready_cycle, (unsigned)cycleCount + 1);
+         }
+         if(other.qk == (int)f) {
+            other.qk          = -1;
+            other.rk          = true;
+            other.ready_cycle = max(other.ready_cycle, (unsigned)cycleCount + 1);
+         }
+      }
+      fu.busy           = false;
+      fu.ready_cycle    = cycleCount + 1;
+   }
+   return eop_issued && !active;
+}
+
+//----------------------------------------------------------------------
+// Execute: advance the functional units that have read their operands
+//----------------------------------------------------------------------
+void sim_pipe_fp::scoreboard_execute(){
+   for(unsigned f = 0; f < num_fu; f++) {
+      fu_status_t& fu   = fu_status[f];
+      if(!fu.busy || fu.state != SB_READ_OPERANDS || fu.ready_cycle > (unsigned)cycleCount)
+         continue;
+      execLaneT& lane   = float_point_exe_reg[fu.unit].exe_pipe_units[fu.lane];
+      if(--lane.latency_exe != 0)
+         continue;
+      fu.result         = evaluate(fu.instruction, fu.npc, fu.vj, fu.vk, fu.cond);
+      switch(fu.instruction.opcode) {
+         case LW:
+         case LWS:
+            fu.result   = read_memory(fu.result);
+            break;
+
+         case SW:
+         case SWS:
+            write_memory(fu.result, fu.vk);
+            break;
+
+         default:
+            break;
+      }
+      fu.state          = SB_EXECUTED;
+      fu.ready_cycle    = cycleCount + 1;
+   }
+}
+
+//----------------------------------------------------------------------
+// Read operands: functional units whose sources are all available read
+// them from the register file and start executing
+//----------------------------------------------------------------------
+void sim_pipe_fp::scoreboard_read_operands(){
+   for(unsigned f = 0; f < num_fu; f++) {
+      fu_status_t& fu   = fu_status[f];
+      instruction_t& instruction = fu.instruction;
+      if(!fu.busy || fu.state != SB_ISSUED || fu.ready_cycle > (unsigned)cycleCount)
+         continue;
+      if((instruction.src1_op && !fu.rj) || (instruction.src2_op && !fu.rk) || !scoreboard_memory_order(f) ||
+            !float_point_exe_reg[fu.unit].accepts(fu.lane, cycleCount))
+         continue;
+      fu.vj             = instruction.src1_op ? regRead(instruction.src1, instruction.src1_float_op) : UNDEFINED;
+      fu.vk             = instruction.src2_op ? regRead(instruction.src2, instruction.src2_float_op) : UNDEFINED;
+      fu.rj             = false;
+      fu.rk             = false;
+      fu.state          = SB_READ_OPERANDS;
+      fu.ready_cycle    = cycleCount + 1;
+      unsigned memory   = 0;
+      if(instruction.opcode == LW || instruction.opcode == LWS)
+         memory         = load_latency(fu.npc - 4, instruction.imm + fu.vj);
+      else if(instruction.opcode == SW || instruction.opcode == SWS)
+         memory         = memLatency;
+      float_point_exe_reg[fu.unit].exe_pipe_units[fu.lane].instruction = instruction;
+      float_point_exe_reg[fu.unit].exe_pipe_units[fu.lane].latency_exe = max(exLatency(instruction, fu.vj, fu.vk) - 1, 1) + (int)memory;
+      float_point_exe_reg[fu.unit].start(fu.lane, cycleCount);
+   }
+}
+
+//----------------------------------------------------------------------
+// Issue: hand the next instruction to a free functional unit of its
+// execution unit, unless its destination is already pending (WAW)
+//----------------------------------------------------------------------
+void sim_pipe_fp::scoreboard_issue(){
+   if(eop_issued)
+      return;
+   if(branch_pending) {
+      stall_count++;
+      return;
+   }
+
+   int index                  = (fetch_pc - baseAddress)/4;
+   ASSERT((index >= 0) && (index < instMemSize), "out of bound access of instruction memory %d", index);
+   instruction_t& next        = *instMemory[index];
+   int free_fu                = -1;
+   ASSERT( next.opcode != SWAP, "SWAP is only modelled by the scalar in-order pipeline" );
+
+   if(next.opcode != EOP && next.opcode != NOP) {
+      exe_unit_t unit         = convert_op_to_exe_unit(next.opcode);
+      for(unsigned f = 0; f < num_fu && free_fu == -1; f++) {
+         if(fu_status[f].unit == unit && !fu_status[f].busy && fu_status[f].ready_cycle <= (unsigned)cycleCount)
+            free_fu           = f;
+      }
+      if(free_fu == -1 || (next.dest_op && result_status(next.dest, next.dest_float_op) != -1)) {
+         stall_count++;
+         return;
+      }
+   }
+
+   instruction_t instruction  = fetchInstruction(fetch_pc);
+   if(free_fu != -1) {
+      fu_status_t& fu         = fu_status[free_fu];
+      fu.busy                 = true;
+      fu.state                = SB_ISSUED;
+      fu.instruction          = instruction;
+      fu.npc                  = fetch_pc + 4;
+      fu.seq                  = issue_seq++;
+      fu.qj                   = instruction.src1_op ? result_status(instruction.src1, instruction.src1_float_op) : -1;
+      fu.qk                   = instruction.src2_op ? result_status(instruction.src2, instruction.src2_float_op) : -1;
+      fu.rj                   = instruction.src1_op && fu.qj == -1;
+      fu.rk                   = instruction.src2_op && fu.qk == -1;
+      fu.ready_cycle          = cycleCount + 1;
+      if(instruction.dest_op)
+         result_status(instruction.dest, instruction.dest_float_op) = free_fu;
+      branch_pending          = instruction.branch_op;
+   }
+
+   if(instruction.opcode == EOP)
+      eop_issued              = true;
+   else
+      fetch_pc               += 4;
+   sp_registers[IF][PC]       = fetch_pc;
+}
+
+void sim_pipe_fp::run_scoreboard(unsigned cycles){
+   bool run_to_completion = (cycles == 0);
+   if(fu_status == NULL)
+      scoreboard_init();
+   while(cycles-- || run_to_completion) {
+      if(scoreboard_write_result()) return;
+      scoreboard_execute();
+      scoreboard_read_operands();
+      scoreboard_issue();
+      account_exec_units();
+      cycleCount++;
+   }
+}
+
+void sim_pipe_fp::print_scoreboard(){
+   cout << "Functional unit status:" << endl;
+   for(unsigned f = 0; f < num_fu; f++) {
+      fu_status_t& fu   = fu_status[f];
+      cout << unit_names[fu.unit] << fu.lane << ": ";
+      if(!fu.busy) {
+         cout << "free" << endl;
+         continue;
+      }
+      instruction_t& instruction = fu.instruction;
+      cout << opcode_str[instruction.opcode];
+      if(instruction.dest_op) cout << " Fi=" << (instruction.dest_float_op ? "F" : "R") << dec << instruction.dest;
+      if(instruction.src1_op) cout << " Fj=" << (instruction.src1_float_op ? "F" : "R") << dec << instruction.src1;
+      if(instruction.src2_op) cout << " Fk=" << (instruction.src2_float_op ? "F" : "R") << dec << instruction.src2;
+      if(fu.qj != -1) cout << " Qj=" << unit_names[fu_status[fu.qj].unit] << fu_status[fu.qj].lane;
+      if(fu.qk != -1) cout << " Qk=" << unit_names[fu_status[fu.qk].unit] << fu_status[fu.qk].lane;
+      cout << " Rj=" << (fu.rj ? "yes" : "no") << " Rk=" << (fu.rk ? "yes" : "no");
+      cout << " (" << sb_state_names[fu.state] << ")" << endl;
+   }
+   cout << "Register result status:" << endl;
+   for(int i = 0; i < NUM_GP_REGISTERS; i++)
+      if(int_file[i].fu != -1) cout << "R" << dec << i << " = " << unit_names[fu_status[int_file[i].fu].unit] << fu_status[int_file[i].fu].lane << endl;
+   for(int i = 0; i < NUM_GP_REGISTERS; i++)
+      if(fp_file[i].fu != -1) cout << "F" << dec << i << " = " << unit_names[fu_status[fp_file[i].fu].unit] << fu_status[fp_file[i].fu].lane << endl;
+}
@@ -0,0 +1,356 @@
+#include "sim_pipe_fp.h"
+
+using namespace std;
+
+//----------------------------------------------------------------------
+// Tomasulo out-of-order core
+//
+// Instructions issue in order into the reservation stations of their
+// execution unit, wait there for their operands (renamed to reorder
+// buffer entries through int_file/fp_file.rob), execute on the unit
+// instances configured by init_exec_unit, broadcast their result on a
+// single common data bus and commit in order from the reorder buffer.
+// Loads and stores compute their address on the INTEGER unit; a load
+// then waits until every older store address is known and is either
+// forwarded from the youngest matching store or reads data memory.
+// Stores write data memory when they commit. Issue stops at a branch
+// until the branch resolves (no speculation).
+//----------------------------------------------------------------------
+
+void sim_pipe_fp::set_reservation_stations(exe_unit_t exec_unit, unsigned stations){
+   ASSERT( stations > 0, "Unsupported number of reservation stations (=%d)", stations );
+   num_rs[exec_unit]    = stations;
+}
+
+void sim_pipe_fp::set_rob_size(unsigned entries){
+   ASSERT( entries > 0, "Unsupported reorder buffer size (=%d)", entries );
+   rob_size             = entries;
+}
+
+//----------------------------------------------------------------------
+// Position of a ROB entry relative to the head (0 = oldest)
+//----------------------------------------------------------------------
+unsigned sim_pipe_fp::rob_age(int entry){
+   return (entry - rob_head + rob_size) % rob_size;
+}
+
+void sim_pipe_fp::tomasulo_init(){
+   ASSERT( num_mshrs == 0 && store_buffer_size == 0 && dram_model == NULL, "MSHRs, the store buffer and the DRAM model are only modelled by the in-order core" );
+   rob                  = new rob_entry_t[rob_size];
+   for(unsigned i = 0; i < rob_size; i++) {
+      rob[i].busy       = false;
+   }
+   for(int u = 0; u < EXE_UNIT_SIZE; u++) {
+      if(num_rs[u] == 0)
+         num_rs[u]      = 2 * float_point_exe_reg[u].num_exe_pipe_units;
+      rs_file[u]        = new reservation_station_t[num_rs[u]];
+      for(unsigned i = 0; i < num_rs[u]; i++) {
+         rs_file[u][i].busy = false;
+      }
+      for(int j = 0; j < float_point_exe_reg[u].num_exe_pipe_units; j++) {
+         float_point_exe_reg[u].exe_pipe_units[j].latency_exe = 0;
+      }
+   }
+   rob_head             = 0;
+   rob_count            = 0;
+   fetch_pc             = sp_registers[IF][PC];
+   branch_pending       = false;
+   eop_issued           = false;
+   commit_latency_count = UNDEFINED;
+}
+
+//----------------------------------------------------------------------
+// Read a source register at issue: either its value or the ROB entry
+// that will produce it
+//----------------------------------------------------------------------
+void sim_pipe_fp::tomasulo_read_operand(unsigned reg, bool isF, unsigned& value, int& tag){
+   int producer         = isF ? fp_file[reg].rob : int_file[reg].rob;
+   tag                  = -1;
+   if(producer == -1) {
+      value             = regRead(reg, isF);
+   } else if(rob[producer].ready) {
+      value             = rob[producer].value;
+   } else {
+      value             = UNDEFINED;
+      tag               = producer;
+   }
+}
+
+//----------------------------------------------------------------------
+// Memory disambiguation for a load whose address is known: it may
+// proceed once all older store addresses are known
+//----------------------------------------------------------------------
+bool sim_pipe_fp::tomasulo_load_ready(reservation_station_t& station, unsigned& value, bool& forwarded){
+   for(int age = rob_age(station.rob) - 1; age >= 0; age--) {
+      rob_entry_t& entry = rob[(rob_head + age) % rob_size];
+      if(entry.instruction.opcode != SW && entry.instruction.opcode != SWS)
+         continue;
+      if(!entry.address_ready)
+         return false;
+      if(entry.address == station.result) {
+         if(!entry.ready)
+            return false;
+         value          = entry.value;
+         forwarded      = true;
+         return true;
+      }
+   }
+   value                = read_memory(station.result);
+   forwarded            = false;
+   return true;
+}
+
+//----------------------------------------------------------------------
+// Commit: retire the ROB head in program order
+//----------------------------------------------------------------------
+bool sim_pipe_fp::tomasulo_commit(){
+   if(rob_count == 0 || !rob[rob_head].ready)
+      return false;
+
+   rob_entry_t& head          = rob[rob_head];
+   instruction_t instruction  = head.instruction;
+   switch(instruction.opcode) {
+      case EOP:
+         return true;
+
+      case SW:
+      case SWS:
+         if(commit_latency_count == UNDEFINED)
+            commit_latency_count = memLatency;
+         if(commit_latency_count > 0) {
+            commit_latency_count--;
+            return false;
+         }
+         commit_latency_count    = UNDEFINED;
+         write_memory(head.address, head.value);
+         break;
+
+      default:
+         if(instruction.dest_op && instruction.dest_float_op) {
+            fp_file[instruction.dest].value = unsigned2float(head.value);
+            if(fp_file[instruction.dest].rob == (int)rob_head)
+               fp_file[instruction.dest].rob = -1;
+         } else if(instruction.dest_op) {
+            int_file[instruction.dest].value = head.value;
+            if(int_file[instruction.dest].rob == (int)rob_head)
+               int_file[instruction.dest].rob = -1;
+         }
+         break;
+   }
+   head.busy                  = false;
+   rob_head                   = (rob_head + 1) % rob_size;
+   rob_count--;
+   return false;
+}
+
+//----------------------------------------------------------------------
+// Write result: broadcast the oldest finished result on the CDB
+//----------------------------------------------------------------------
+void sim_pipe_fp::tomasulo_write_result(){
+   reservation_station_t* winner = NULL;
+   for(int u = 0; u < EXE_UNIT_SIZE; u++) {
+      for(unsigned i = 0; i < num_rs[u]; i++) {
+         reservation_station_t& station = rs_file[u][i];
+         if(station.busy && station.state == RS_DONE && station.done_cycle < (unsigned)cycleCount &&
+               (winner == NULL || rob_age(station.rob) < rob_age(winner->rob)))
+            winner = &station;
+      }
+   }
+   if(winner == NULL)
+      return;
+
+   int tag                    = winner->rob;
+   rob[tag].value             = winner->result;
+   rob[tag].ready             = true;
+   winner->busy               = false;
+
+   if(winner->instruction.branch_op) {
+      if(winner->cond)
+         fetch_pc             = winner->result;
+      branch_pending          = false;
+      sp_registers[IF][PC]    = fetch_pc;
+      return;
+   }
+
+   for(int u = 0; u < EXE_UNIT_SIZE; u++) {
+      for(unsigned i = 0; i < num_rs[u]; i++) {
+         reservation_station_t& station = rs_file[u][i];
+         if(!station.busy)
+            continue;
+         if(station.qj == tag) {
+            station.vj            = winner->result;
+            station.qj            = -1;
+            station.ready_cycle   = max(station.ready_cycle, (unsigned)cycleCount + 1);
+         }
+         if(station.qk == tag) {
+            station.vk            = winner->result;
+            station.qk            = -1;
+            station.ready_cycle   = max(station.ready_cycle, (unsigned)cycleCount + 1);
+         }
+         if(station.state == RS_STORE_DATA && station.qk == -1) {
+            rob[station.rob].value = station.vk;
+            rob[station.rob].ready = true;
+            station.busy           = false;
+         }
+      }
+   }
+}
+
+//----------------------------------------------------------------------
+// Execute: start ready stations on free unit instances (oldest first),
+// advance the instances and start the memory access of one load
+//----------------------------------------------------------------------
+void sim_pipe_fp::tomasulo_execute(){
+   for(int u = 0; u < EXE_UNIT_SIZE; u++) {
+      execUnitT& unit = float_point_exe_reg[u];
+      for(int j = 0; j < unit.num_exe_pipe_units; j++) {
+         if(!unit.accepts(j, cycleCount))
+            continue;
+         int oldest     = -1;
+         for(unsigned i = 0; i < num_rs[u]; i++) {
+            reservation_station_t& station = rs_file[u][i];
+            bool is_store = (station.instruction.opcode == SW || station.instruction.opcode == SWS);
+            if(station.busy && station.state == RS_WAIT && station.qj == -1 && (station.qk == -1 || is_store) &&
+                  station.ready_cycle <= (unsigned)cycleCount &&
+                  (oldest == -1 || rob_age(station.rob) < rob_age(rs_file[u][oldest].rob)))
+               oldest   = i;
+         }
+         if(oldest == -1)
+            break;
+         rs_file[u][oldest].state                 = RS_EXEC;
+         unit.exe_pipe_units[j].instruction       = rs_file[u][oldest].instruction;
+         unit.exe_pipe_units[j].latency_exe       = exLatency(rs_file[u][oldest].instruction, rs_file[u][oldest].vj, rs_file[u][oldest].vk);
+         unit.exe_pipe_units[j].station           = oldest;
+         unit.start(j, cycleCount);
+      }
+
+      for(int j = 0; j < unit.num_exe_pipe_units; j++) {
+         execLaneT& lane = unit.exe_pipe_units[j];
+         if(lane.latency_exe == 0 || --lane.latency_exe != 0)
+            continue;
+         reservation_station_t& station = rs_file[u][lane.station];
+         station.result = evaluate(station.instruction, station.npc, station.vj, station.vk, station.cond);
+         switch(station.instruction.opcode) {
+            case LW:
+            case LWS:
+               station.state             = RS_MEM_WAIT;
+               station.ready_cycle       = cycleCount + 1;
+               break;
+
+            case SW:
+            case SWS:
+               rob[station.rob].address       = station.result;
+               rob[station.rob].address_ready = true;
+               station.state                  = RS_STORE_DATA;
+               if(station.qk == -1) {
+                  rob[station.rob].value      = station.vk;
+                  rob[station.rob].ready      = true;
+                  station.busy                = false;
+               }
+               break;
+
+            default:
+               station.state             = RS_DONE;
+               station.done_cycle        = cycleCount;
+               break;
+         }
+      }
+   }
+
+   reservation_station_t* load = NULL;
+   for(unsigned i = 0; i < num_rs[INTEGER]; i++) {
+      reservation_station_t& station = rs_file[INTEGER][i];
+      if(station.busy && station.state == RS_MEM_WAIT && station.ready_cycle <= (unsigned)cycleCount &&
+            (load == NULL || rob_age(station.rob) < rob_age(load->rob)))
+         load = &station;
+   }
+   unsigned value;
+   bool     forwarded;
+   if(load != NULL && tomasulo_load_ready(*load, value, forwarded)) {
+      load->done_cycle      = cycleCount + (forwarded ? 0 : load_latency(load->npc - 4, load->result));
+      load->result          = value;
+      load->state           = RS_DONE;
+   }
+}
+
+//----------------------------------------------------------------------
+// Issue: move the next instruction into a reservation station and the
+// ROB, renaming its destination register
+//----------------------------------------------------------------------
+void sim_pipe_fp::tomasulo_issue(){
+   if(eop_issued)
+      return;
+
+   int index                  = (fetch_pc - baseAddress)/4;
+   ASSERT((index >= 0) && (index < instMemSize), "out of bound access of instruction memory %d", index);
+   opcode_t opcode            = instMemory[index]->opcode;
+   reservation_station_t* station = NULL;
+   ASSERT( opcode != SWAP, "SWAP is only modelled by the scalar in-order pipeline" );
+
+   if(branch_pending || rob_count == rob_size) {
+      stall_count++;
+      return;
+   }
+   if(opcode != EOP && opcode != NOP) {
+      exe_unit_t unit         = convert_op_to_exe_unit(opcode);
+      for(unsigned i = 0; i < num_rs[unit] && station == NULL; i++) {
+         if(!rs_file[unit][i].busy)
+            station           = &rs_file[unit][i];
+      }
+      if(station == NULL) {
+         stall_count++;
+         return;
+      }
+   }
+
+   instruction_t instruction  = fetchInstruction(fetch_pc);
+   int tag                    = (rob_head + rob_count) % rob_size;
+   rob_count++;
+   rob[tag].busy              = true;
+   rob[tag].ready             = (station == NULL);
+   rob[tag].instruction       = instruction;
+   rob[tag].value             = UNDEFINED;
+   rob[tag].address_ready     = false;
+
+   if(station != NULL) {
+      station->busy           = true;
+      station->state          = RS_WAIT;
+      station->instruction    = instruction;
+      station->npc            = fetch_pc + 4;
+      station->rob            = tag;
+      station->vj             = UNDEFINED;
+      station->vk             = UNDEFINED;
+      station->qj             = -1;
+      station->qk             = -1;
+      station->ready_cycle    = cycleCount + 1;
+      if(instruction.src1_op)
+         tomasulo_read_operand(instruction.src1, instruction.src1_float_op, station->vj, station->qj);
+      if(instruction.src2_op)
+         tomasulo_read_operand(instruction.src2, instruction.src2_float_op, station->vk, station->qk);
+      if(instruction.dest_op && instruction.dest_float_op)
+         fp_file[instruction.dest].rob  = tag;
+      else if(instruction.dest_op)
+         int_file[instruction.dest].rob = tag;
+      branch_pending          = instruction.branch_op;
+   }
+
+   if(instruction.opcode == EOP)
+      eop_issued              = true;
+   else
+      fetch_pc               += 4;
+   sp_registers[IF][PC]       = fetch_pc;
+}
+
+void sim_pipe_fp::run_tomasulo(unsigned cycles){
+   bool run_to_completion = (cycles == 0);
+   if(rob == NULL)
+      tomasulo_init();
+   while(cycles-- || run_to_completion) {
+      if(tomasulo_commit()) return;
+      tomasulo_write_result();
+      tomasulo_execute();
+      tomasulo_issue();
+      account_exec_units();
+      cycleCount++;
+   }
+}
@@ -0,0 +1,146 @@
+#include "sim_pipe_fp.h"
+
+using namespace std;
+
+//----------------------------------------------------------------------
+// Trace recording and replay
+//
+// Recording runs the program one instruction at a time, with no
+// pipeline, and logs every dynamic instruction with its branch outcome
+// and effective address, and the operands of the operations whose
+// latency depends on their values. Replaying feeds the records to the
+// scalar in-order pipeline in place of the program: IF takes the next
+// record, ID takes the latency operands and EX the outcome of the
+// record, while hazards, execution units and every memory option are
+// timed by the same code as when running the program. The cycles a
+// load or store waits on the fixed memory latency, with the whole
+// pipeline frozen behind it, are skipped in one step. Unlike those of
+// sim_pipe, replays always run the pipeline: the lanes, the write port
+// and the WAW checks of the execution units depend on every operation
+// in flight, not just on the record before.
+//----------------------------------------------------------------------
+
+void sim_pipe_fp::record_trace(trace *stream){
+   ASSERT( instMemory != NULL && contexts.empty(), "No program loaded" );
+   ASSERT( stream->fp, "The trace holds integer instructions" );
+   unsigned pc                = sp_registers[IF][PC];
+   while(true) {
+      int index               = (pc - baseAddress)/4;
+      ASSERT((index >= 0) && (index < instMemSize), "out of bound access of instruction memory %d", index);
+      instruction_t instruction = *(instMemory[index]);
+      trace_record_t record;
+      record.pc               = pc;
+      record.opcode           = instruction.opcode;
+      record.dest             = instruction.dest_op ? instruction.dest : 0;
+      record.src1             = instruction.src1_op ? instruction.src1 : 0;
+      record.src2             = instruction.src2_op ? instruction.src2 : 0;
+      record.immediate        = instruction.imm;
+      record.dest_op          = instruction.dest_op;
+      record.src1_op          = instruction.src1_op;
+      record.src2_op          = instruction.src2_op;
+      record.dest_float_op    = instruction.dest_float_op;
+      record.src1_float_op    = instruction.src1_float_op;
+      record.src2_float_op    = instruction.src2_float_op;
+      record.branch_op        = instruction.branch_op;
+      record.taken            = false;
+      record.address          = 0;
+      record.a                = 0;
+      record.b                = 0;
+
+      unsigned a              = !instruction.src1_op ? 0 : instruction.src1_float_op ? float2unsigned(get_fp_register(instruction.src1)) : get_int_register(instruction.src1);
+      unsigned b              = !instruction.src2_op ? 0 : instruction.src2_float_op ? float2unsigned(get_fp_register(instruction.src2)) : get_int_register(instruction.src2);
+      unsigned npc            = pc + 4;
+      if(instruction.opcode == DIV || instruction.opcode == MULTS || instruction.opcode == DIVS) {
+         record.a             = a;
+         record.b             = b;
+      }
+      if(instruction.opcode != NOP && instruction.opcode != EOP) {
+         bool cond;
+         unsigned result      = evaluate(instruction, npc, a, b, cond);
+         switch(instruction.opcode) {
+            case LW:
+            case LWS:
+            case SWAP:
+               record.address = result;
+               result         = read_memory(record.address);
+               if(instruction.opcode == SWAP)
+                  write_memory(record.address, b);
+               break;
+
+            case SW:
+            case SWS:
+               record.address = result;
+               write_memory(record.address, b);
+               break;
+
+            case BEQZ ... BGEZ:
+            case JUMP:
+               record.address = result;
+               record.taken   = cond;
+               npc            = cond ? result : npc;
+               break;
+
+            default: break;
+         }
+         if(instruction.dest_op && instruction.dest_float_op)
+            set_fp_register(instruction.dest, unsigned2float(result));
+         else if(instruction.dest_op)
+            set_int_register(instruction.dest, result);
+      }
+      stream->append(record);
+      if(instruction.opcode == EOP)
+         return;
+      pc                      = npc;
+   }
+}
+
+void sim_pipe_fp::load_trace(trace *stream){
+   ASSERT( stream->fp && stream->size() > 0 && stream->get(stream->size() - 1).opcode == EOP, "Not a complete trace of the floating point simulator" );
+   ASSERT( scheduler == IN_ORDER && issue_width == 1 && contexts.empty() && lsq_size == 0 && caches == NULL,
+           "A trace is only replayed by the scalar in-order pipeline" );
+   replay                     = stream;
+   fetch_seq                  = 0;
+   sp_registers[IF][PC]       = stream->get(0).pc;
+   baseAddress                = stream->get(0).pc;
+}
+
+//----------------------------------------------------------------------
+// Rebuild the instruction of trace record "index"
+//----------------------------------------------------------------------
+instruction_t sim_pipe_fp::decode_record(uint64_t index){
+   const trace_record_t& record = replay->get(index);
+   instruction_t instruction;
+   instruction.opcode         = (opcode_t)record.opcode;
+   instruction.dest           = record.dest_op ? record.dest : UNDEFINED;
+   instruction.src1           = record.src1_op ? record.src1 : UNDEFINED;
+   instruction.src2           = record.src2_op ? record.src2 : UNDEFINED;
+   instruction.imm            = record.immediate;
+   instruction.dest_op        = record.dest_op;
+   instruction.src1_op        = record.src1_op;
+   instruction.src2_op        = record.src2_op;
+   instruction.dest_float_op  = record.dest_float_op;
+   instruction.src1_float_op  = record.src1_float_op;
+   instruction.src2_float_op  = record.src2_float_op;
+   instruction.branch_op      = record.branch_op;
+   instruction.seq            = (unsigned)index;
+   instruction.pc             = record.pc;
+   return instruction;
+}
+
+//----------------------------------------------------------------------
+// Trace record of the instruction numbered "seq" (the low 32 bits of
+// the record), fetched less than 2^32 records before the next one
+//----------------------------------------------------------------------
+uint64_t sim_pipe_fp::replay_record(unsigned seq){
+   return fetch_seq - (unsigned)((unsigned)fetch_seq - seq);
+}
+
+//----------------------------------------------------------------------
+// Cycles the stalled memory stage keeps waiting on the fixed memory
+// latency with nothing else in the pipeline moving
+//----------------------------------------------------------------------
+unsigned sim_pipe_fp::frozen_cycles(){
+   if(dram_model != NULL || store_buffer_size > 0 || num_mshrs > 0 || !memory_pipe.empty())
+      return 0;
+   return data_memory_latency_count;
+}
@@ -0,0 +1,275 @@
+#include "sim_pipe_fp.h"
+
+using namespace std;
+
+//----------------------------------------------------------------------
+// Superscalar (N-wide) in-order core
+//
+// The pipeline latches hold groups of up to issue_width instructions.
+// IF refills the group as instructions issue, never past a branch or
+// EOP. ID issues the group in order into the
+// execution units, stopping at the first instruction that has a RAW,
+// WAW or structural hazard (also against the earlier instructions of
+// its own group), exceeds the per-cycle limits on loads/stores and
+// other operations, or would leave the execution units in a cycle whose
+// write-back ports are all taken; the rest of the group issues in later
+// cycles. Operands are captured at issue. Results leaving the execution
+// units in the same cycle go through MEM and WB together, and the
+// memory latency stalls the whole group. Issue stops after a branch
+// until it resolves, as in the scalar pipeline.
+//----------------------------------------------------------------------
+
+void sim_pipe_fp::set_issue_width(unsigned width){
+   ASSERT( width > 0, "Unsupported issue width (=%d)", width );
+   ASSERT( scheduler == IN_ORDER && num_mshrs == 0 && store_buffer_size == 0 && dram_model == NULL && !renaming && lsq_size == 0 && fusion_idioms == 0 && fetch_queue_size == 0 && front_end.empty() && memory_pipe.empty() && contexts.empty(),
+           "The superscalar core only models the 5-stage single-threaded in-order pipeline with a blocking fixed-latency memory stage, no renaming, no macro-op fusion and no fetch queue" );
+   issue_width          = width;
+   branch_pending       = false;
+   eop_issued           = false;
+   set_issue_limits(width, width, width);
+}
+
+void sim_pipe_fp::set_issue_limits(unsigned mem_ops, unsigned alu_ops, unsigned wb_ports){
+   ASSERT( mem_ops > 0 && alu_ops > 0 && wb_ports > 0, "Unsupported issue limits (mem=%d, alu=%d, wb=%d)", mem_ops, alu_ops, wb_ports );
+   issue_mem_ops        = mem_ops;
+   issue_alu_ops        = alu_ops;
+   this->wb_ports       = wb_ports;
+   issue_histogram.assign(issue_width + 1, 0);
+}
+
+//----------------------------------------------------------------------
+// Refill the fetch group up to the issue width, never past a branch or
+// EOP
+//----------------------------------------------------------------------
+void sim_pipe_fp::WIDE_IF(bool stall) {
+   if(stall)
+      return;
+   while(wide_latch[ID].size() < issue_width) {
+      if(!wide_latch[ID].empty() && (wide_latch[ID].back().instruction.branch_op || wide_latch[ID].back().instruction.opcode == EOP))
+         break;
+      wide_slot_t slot;
+      uint32_t pc                 = sp_registers[IF][PC];
+      slot.instruction            = fetchInstruction(pc);
+      slot.npc                    = pc + 4;
+      wide_latch[ID].push_back(slot);
+      if(slot.instruction.opcode != EOP)
+         sp_registers[IF][PC]     = pc + 4;
+   }
+}
+
+//----------------------------------------------------------------------
+// Issue the longest hazard-free prefix of the fetch group. Returns true
+// when IF must not fetch (branch unresolved or EOP issued)
+//----------------------------------------------------------------------
+bool sim_pipe_fp::WIDE_ID() {
+   wide_latch[EX].clear();
+   if(eop_issued)
+      return true;
+   if(branch_pending) {
+      stall_count++;
+      if(wide_branch_done) {
+         branch_pending       = false;
+         wide_branch_done     = false;
+      }
+      return true;
+   }
+
+   unsigned issued = 0, mem_ops = 0, alu_ops = 0, writes = 0;
+   unsigned claimed[EXE_UNIT_SIZE] = {0};
+   while(issued < wide_latch[ID].size() && !branch_pending && !eop_issued) {
+      wide_slot_t& slot          = wide_latch[ID][issued];
+      instruction_t& instruction = slot.instruction;
+      ASSERT( instruction.opcode != SWAP, "SWAP is only modelled by the scalar in-order pipeline" );
+      exe_unit_t unit            = convert_op_to_exe_unit(instruction.opcode);
+      bool is_mem                = (instruction.opcode >= LW && instruction.opcode <= SWS);
+      bool is_alu                = !is_mem && instruction.opcode != NOP && instruction.opcode != EOP;
+
+      if( (instruction.src1_op && check_busy_status(instruction.src1, instruction.src1_float_op)) ||
+            (instruction.src2_op && check_busy_status(instruction.src2, instruction.src2_float_op)) )
+         break;
+      slot.a                     = (instruction.src1_op) ? regRead(instruction.src1, instruction.src1_float_op) : UNDEFINED;
+      slot.b                     = (instruction.src2_op) ? regRead(instruction.src2, instruction.src2_float_op) : UNDEFINED;
+      int latency                = exLatency(instruction, slot.a, slot.b);
+      if((is_mem && mem_ops == issue_mem_ops) || (is_alu && alu_ops == issue_alu_ops) || (instruction.dest_op && writes == wb_ports))
+         break;
+
+      if(float_point_exe_reg[unit].free_instances(cycleCount + 1) <= (int)claimed[unit])
+         break;
+
+      // results leaving the units in the same cycle, and WAW against the instructions in flight
+      unsigned completing        = 0;
+      bool     waw               = false;
+      for(int i = 0; i < EXE_UNIT_SIZE; i++) {
+         for(int j = 0; j < float_point_exe_reg[i].num_exe_pipe_units; j++) {
+            execLaneT& lane      = float_point_exe_reg[i].exe_pipe_units[j];
+            completing          += (lane.latency_exe == latency);
+            waw                 |= instruction.dest_op && lane.latency_exe != 0 && lane.instruction.dest_op &&
+                                   lane.instruction.dest == instruction.dest && lane.instruction.dest_float_op == instruction.dest_float_op &&
+                                   latency <= lane.latency_exe;
+         }
+      }
+      for(unsigned j = 0; j < wide_latch[EX].size(); j++) {
+         instruction_t& other    = wide_latch[EX][j].instruction;
+         int other_latency       = exLatency(other, wide_latch[EX][j].a, wide_latch[EX][j].b);
+         completing             += (other_latency == latency);
+         waw                    |= instruction.dest_op && other.dest_op && other.dest == instruction.dest &&
+                                   other.dest_float_op == instruction.dest_float_op && latency <= other_latency;
+      }
+      if(completing >= wb_ports || waw)
+         break;
+
+      if(instruction.dest_op){
+         int_file[instruction.dest].busy += !(instruction.dest_float_op);
+         fp_file[instruction.dest].busy  +=  (instruction.dest_float_op);
+      }
+      slot.seq                   = issue_seq++;
+      claimed[unit]++;
+      mem_ops                   += is_mem;
+      alu_ops                   += is_alu;
+      writes                    += instruction.dest_op;
+      branch_pending             = instruction.branch_op;
+      eop_issued                 = (instruction.opcode == EOP);
+      wide_latch[EX].push_back(slot);
+      issued++;
+   }
+   wide_latch[ID].erase(wide_latch[ID].begin(), wide_latch[ID].begin() + issued);
+   issue_histogram[issued]++;
+
+   bool blocked = (issued == 0 && !wide_latch[ID].empty() && wide_latch[ID].front().instruction.opcode != EOP);
+   if(blocked || branch_pending)
+      stall_count++;
+   return branch_pending || eop_issued;
+}
+
+//----------------------------------------------------------------------
+// Start the issued group on the execution units and collect, in program
+// order, the results leaving the units this cycle
+//----------------------------------------------------------------------
+void sim_pipe_fp::WIDE_EXE() {
+   for(unsigned i = 0; i < wide_latch[EX].size(); i++) {
+      wide_slot_t& slot    = wide_latch[EX][i];
+      execUnitT& unit      = float_point_exe_reg[convert_op_to_exe_unit(slot.instruction.opcode)];
+      int j                = unit.free_lane(cycleCount);
+      ASSERT( j != -1, "STRUCTURAL HAZARD AT EX DETECTED" );
+      execLaneT& lane      = unit.exe_pipe_units[j];
+      lane.instruction     = slot.instruction;
+      lane.latency_exe     = (slot.instruction.opcode == EOP) ? getMaxTtl() + 1 : exLatency(slot.instruction, slot.a, slot.b);
+      lane.a               = slot.a;
+      lane.b               = slot.b;
+      lane.exNpc           = slot.npc;
+      lane.seq             = slot.seq;
+      if(slot.instruction.opcode != EOP)
+         unit.start(j, cycleCount);
+   }
+
+   vector<wide_slot_t> done;
+   for(int i = 0; i < EXE_UNIT_SIZE; i++) {
+      for(int j = 0; j < float_point_exe_reg[i].num_exe_pipe_units; j++) {
+         execLaneT& lane   = float_point_exe_reg[i].exe_pipe_units[j];
+         if(lane.latency_exe == 0 || --lane.latency_exe != 0)
+            continue;
+         wide_slot_t slot;
+         slot.instruction  = lane.instruction;
+         slot.npc          = lane.exNpc;
+         slot.a            = lane.a;
+         slot.b            = lane.b;
+         slot.seq          = lane.seq;
+         slot.alu_output   = UNDEFINED;
+         if(slot.instruction.opcode != NOP && slot.instruction.opcode != EOP) {
+            bool cond;
+            slot.alu_output = evaluate(slot.instruction, slot.npc, slot.a, slot.b, cond);
+            if(slot.instruction.branch_op) {
+               wide_branch_done = true;
+               if(cond)
+                  sp_registers[IF][PC] = slot.alu_output;
+            }
+         }
+         lane.instruction.set_stall();
+         vector<wide_slot_t>::iterator pos = done.begin();
+         while(pos != done.end() && pos->seq < slot.seq)
+            pos++;
+         done.insert(pos, slot);
+      }
+   }
+   ASSERT ( done.size() <= wb_ports, "STRUCTURAL HAZARD AT MEM DETECTED" );
+   wide_latch[MEM]            = done;
+   data_memory_latency_count  = 0;
+   for(unsigned i = 0; i < done.size(); i++) {
+      opcode_t opcode         = done[i].instruction.opcode;
+      if(opcode == LW || opcode == LWS)
+         data_memory_latency_count = max(data_memory_latency_count, load_latency(done[i].npc - 4, done[i].alu_output));
+      else if(opcode == SW || opcode == SWS)
+         data_memory_latency_count = max(data_memory_latency_count, memLatency);
+   }
+}
+
+//----------------------------------------------------------------------
+// Access data memory for the group: the whole group waits for the
+// memory latency if it holds a load or a store
+//----------------------------------------------------------------------
+bool sim_pipe_fp::WIDE_MEM() {
+   bool has_mem = false;
+   for(unsigned i = 0; i < wide_latch[MEM].size(); i++) {
+      opcode_t opcode = wide_latch[MEM][i].instruction.opcode;
+      has_mem        |= (opcode >= LW && opcode <= SWS);
+   }
+   if(has_mem && data_memory_latency_count > 0) {
+      data_memory_latency_count--;
+      stall_count++;
+      wide_latch[WB].clear();
+      return true;
+   }
+   for(unsigned i = 0; i < wide_latch[MEM].size(); i++) {
+      wide_slot_t& slot = wide_latch[MEM][i];
+      switch(slot.instruction.opcode) {
+         case LW:
+         case LWS:
+            slot.lmd    = read_memory(slot.alu_output);
+            break;
+
+         case SW:
+         case SWS:
+            write_memory(slot.alu_output, slot.b);
+            break;
+
+         default: break;
+      }
+   }
+   wide_latch[WB]       = wide_latch[MEM];
+   wide_latch[MEM].clear();
+   return false;
+}
+
+//----------------------------------------------------------------------
+// Write back the group in program order
+//----------------------------------------------------------------------
+bool sim_pipe_fp::WIDE_WB() {
+   for(unsigned i = 0; i < wide_latch[WB].size(); i++) {
+      instruction_t& instruction = wide_latch[WB][i].instruction;
+      if(instruction.opcode == EOP)
+         return true;
+      if(!instruction.dest_op)
+         continue;
+      unsigned result = (instruction.opcode == LW || instruction.opcode == LWS) ? wide_latch[WB][i].lmd : wide_latch[WB][i].alu_output;
+      if(instruction.dest_float_op)
+         set_fp_register(instruction.dest, unsigned2float(result));
+      else
+         set_int_register(instruction.dest, result);
+   }
+   wide_latch[WB].clear();
+   return false;
+}
+
+void sim_pipe_fp::run_wide(unsigned cycles){
+   bool run_to_completion = (cycles == 0);
+   while(cycles-- || run_to_completion) {
+      if(WIDE_WB()) return;
+      if( !WIDE_MEM() ) {
+         WIDE_EXE();
+         bool stall          = WIDE_ID();
+         WIDE_IF(stall);
+      }
+      account_exec_units();
+      cycleCount++;
+   }
+}
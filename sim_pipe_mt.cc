@@ -0,0 +1,290 @@
+#include "sim_pipe.h"
+
+//----------------------------------------------------------------------
+// Multithreaded core
+//
+// Every hardware thread has its own PC, register file and program, and
+// a one-instruction fetch buffer refilled as soon as its instruction
+// issues (never past an unresolved branch or EOP). ID picks the threads
+// that issue according to the thread policy; an instruction issues when
+// it has no RAW or WAW hazard. The pipeline latches hold
+// the instructions of different threads, tagged with their thread. A
+// load or store accesses data memory when it enters MEM and then waits
+// there for the memory latency without blocking the pipeline: only its
+// own thread stops issuing until the access completes, while the other
+// threads keep the pipeline busy. Branches resolve in MEM, as in the
+// scalar pipeline.
+//----------------------------------------------------------------------
+
+void sim_pipe::set_threads(unsigned threads, thread_policy_t policy, unsigned issue_slots, unsigned switch_penalty){
+   ASSERT( threads > 0 && issue_slots > 0 && issue_slots <= threads, "Unsupported thread configuration (threads=%d, issue slots=%d)", threads, issue_slots );
+   ASSERT( policy == SIMULTANEOUS || issue_slots == 1, "Only simultaneous multithreading issues several threads per cycle" );
+   ASSERT( issue_width == 1 && num_mshrs == 0 && store_buffer_size == 0 && data_prefetcher == NULL && dram_model == NULL && fusion_idioms == 0 &&
+           fetch_queue_size == 0 && front_end.empty() && memory_pipe.empty(),
+           "The multithreaded core only models the 5-stage scalar pipeline with a fixed-latency memory stage" );
+   thread_policy           = policy;
+   thread_issue_slots      = issue_slots;
+   this->switch_penalty    = switch_penalty;
+   current_thread          = (policy == SWITCH_ON_STALL) ? 0 : threads - 1;   // thread 0 issues first
+   switch_wait             = 0;
+   thread_switches         = 0;
+
+   thread_context_t context;
+   context.int_file        = NULL;
+   context.instruct_memory = NULL;
+   context.base_address    = 0;
+   context.pc              = UNDEFINED;
+   context.has_fetched     = false;
+   context.branch_pending  = false;
+   context.eop_fetched     = false;
+   context.memory_pending  = 0;
+   context.done            = false;
+   context.instructions    = 0;
+   context.finish_cycle    = 0;
+   contexts.assign(threads, context);
+
+   contexts[0].int_file         = int_file;
+   contexts[0].instruct_memory  = instruct_memory;
+   contexts[0].base_address     = baseAddress;
+   contexts[0].pc               = sp_registers[IF][PC];
+   for(unsigned t = 0; t < threads; t++) {
+      if(t > 0)
+         contexts[t].int_file   = new int_file_t[NUM_GP_REGISTERS];
+      for(int i = 0; i < NUM_GP_REGISTERS; i++) {
+         if(t > 0)
+            contexts[t].int_file[i].value = UNDEFINED;
+         contexts[t].int_file[i].busy     = 0;
+      }
+   }
+}
+
+//----------------------------------------------------------------------
+// Refill the fetch buffer of every thread whose instruction has issued
+//----------------------------------------------------------------------
+void sim_pipe::THREAD_IF() {
+   for(unsigned t = 0; t < contexts.size(); t++) {
+      thread_context_t& context   = contexts[t];
+      if(context.has_fetched || context.branch_pending || context.eop_fetched)
+         continue;
+      ASSERT( context.instruct_memory != NULL, "No program loaded in hardware thread %d", t );
+      thread_slot_t slot;
+      slot.instruction            = *(context.instruct_memory[(context.pc - context.base_address)/4]);
+      slot.thread                 = t;
+      slot.npc                    = context.pc + 4;
+      slot.alu_output             = UNDEFINED;
+      slot.lmd                    = UNDEFINED;
+      slot.cond                   = false;
+      slot.ready_cycle            = 0;
+      context.fetched             = slot;
+      context.has_fetched         = true;
+      context.branch_pending      = slot.instruction.branch_op;
+      context.eop_fetched         = (slot.instruction.opcode == EOP);
+      if(!context.eop_fetched)
+         context.pc              += 4;
+   }
+}
+
+//----------------------------------------------------------------------
+// A thread can issue when its instruction has no RAW or WAW hazard and
+// none of its loads/stores waits for data memory; EOP also waits for
+// the loads/stores about to access it
+//----------------------------------------------------------------------
+bool sim_pipe::thread_ready(unsigned thread) {
+   thread_context_t& context      = contexts[thread];
+   if(!context.has_fetched || context.memory_pending > 0)
+      return false;
+   instruction_t& instruction     = context.fetched.instruction;
+   ASSERT( instruction.opcode != SWAP, "SWAP is only modelled by the scalar pipeline" );
+   if((instruction.src1_op && context.int_file[instruction.src1].busy) || (instruction.src2_op && context.int_file[instruction.src2].busy))
+      return false;
+   // the loads/stores entering MEM are the only instructions the next ones can overtake (their thread
+   // stops issuing once they wait for data memory): no write to the destination of such a load, no EOP
+   for(unsigned i = 0; i < thread_latch[MEM].size() && Data_Memory_Latency > 0; i++) {
+      instruction_t& older        = thread_latch[MEM][i].instruction;
+      if(thread_latch[MEM][i].thread != thread || (older.opcode != LW && older.opcode != SW))
+         continue;
+      if(instruction.opcode == EOP || (instruction.dest_op && older.opcode == LW && older.dest == instruction.dest))
+         return false;
+   }
+   return true;
+}
+
+//----------------------------------------------------------------------
+// Issue the instructions of the threads picked by the thread policy
+//----------------------------------------------------------------------
+void sim_pipe::THREAD_ID() {
+   thread_latch[EX].clear();
+   unsigned threads        = contexts.size();
+   vector<unsigned> picked;
+
+   if(thread_policy == SWITCH_ON_STALL) {
+      if(switch_wait > 0) {
+         switch_wait--;
+         stall_count++;
+         return;
+      }
+      // switch away from a thread waiting for data memory, or done issuing
+      thread_context_t& running = contexts[current_thread];
+      if(running.memory_pending > 0 || (running.eop_fetched && !running.has_fetched)) {
+         for(unsigned k = 1; k < threads; k++) {
+            unsigned t              = (current_thread + k) % threads;
+            thread_context_t& other = contexts[t];
+            if(other.memory_pending > 0 || (other.eop_fetched && !other.has_fetched))
+               continue;
+            current_thread          = t;
+            thread_switches++;
+            if(switch_penalty > 0) {
+               switch_wait          = switch_penalty - 1;
+               stall_count++;
+               return;
+            }
+            break;
+         }
+      }
+      if(thread_ready(current_thread))
+         picked.push_back(current_thread);
+   }
+   else {
+      // a different thread every cycle, starting after the thread issued first in the last cycle
+      for(unsigned k = 1; k <= threads && picked.size() < thread_issue_slots; k++) {
+         unsigned t                 = (current_thread + k) % threads;
+         if(thread_ready(t))
+            picked.push_back(t);
+      }
+      if(!picked.empty())
+         current_thread             = picked[0];
+   }
+
+   for(unsigned i = 0; i < picked.size(); i++) {
+      thread_context_t& context     = contexts[picked[i]];
+      instruction_t& instruction    = context.fetched.instruction;
+      if(instruction.dest_op)
+         context.int_file[instruction.dest].busy++;
+      context.has_fetched           = false;
+      thread_latch[EX].push_back(context.fetched);
+   }
+
+   // count the cycles lost while some thread still had instructions to issue
+   bool issuing = false;
+   for(unsigned t = 0; t < threads; t++)
+      issuing  |= !(contexts[t].eop_fetched && !contexts[t].has_fetched);
+   if(picked.empty() && issuing && cc_count > 0)
+      stall_count++;
+}
+
+//----------------------------------------------------------------------
+// Execute the issued instructions on the registers of their threads
+//----------------------------------------------------------------------
+void sim_pipe::THREAD_EXE() {
+   for(unsigned i = 0; i < thread_latch[EX].size(); i++) {
+      thread_slot_t& slot        = thread_latch[EX][i];
+      instruction_t& instruction = slot.instruction;
+      int_file_t *file           = contexts[slot.thread].int_file;
+      int value                  = instruction.src1_op ? file[instruction.src1].value : 0;
+      bool cond                  = false;
+      switch(instruction.opcode) {
+         case ADD ... DIV:
+            slot.alu_output = alu(value, file[instruction.src2].value, instruction.opcode);
+            break;
+         case ADDI ... ANDI:
+            slot.alu_output = alu(value, instruction.immediate, instruction.opcode);
+            break;
+         case LW:
+         case SW:
+            slot.alu_output = instruction.immediate + value;
+            break;
+         case BEQZ: cond = value == 0; break;
+         case BNEZ: cond = value != 0; break;
+         case BLTZ: cond = value <  0; break;
+         case BGTZ: cond = value >  0; break;
+         case BLEZ: cond = value <= 0; break;
+         case BGEZ: cond = value >= 0; break;
+         case JUMP: cond = true;       break;
+         default: break;
+      }
+      if(instruction.branch_op)
+         slot.alu_output         = alu(slot.npc, instruction.immediate, instruction.opcode);
+      slot.cond                  = cond;
+   }
+   thread_latch[MEM]             = thread_latch[EX];
+}
+
+//----------------------------------------------------------------------
+// Resolve branches and start the data memory accesses; the loads and
+// stores wait for the memory latency aside, and move on to WB (oldest
+// first) once it has elapsed
+//----------------------------------------------------------------------
+void sim_pipe::THREAD_MEM() {
+   thread_latch[WB].clear();
+   for(unsigned i = 0; i < parked.size(); ) {
+      if(parked[i].ready_cycle > (unsigned)cc_count) {
+         i++;
+         continue;
+      }
+      contexts[parked[i].thread].memory_pending--;
+      thread_latch[WB].push_back(parked[i]);
+      parked.erase(parked.begin() + i);
+   }
+   for(unsigned i = 0; i < thread_latch[MEM].size(); i++) {
+      thread_slot_t& slot        = thread_latch[MEM][i];
+      thread_context_t& context  = contexts[slot.thread];
+      opcode_t opcode            = slot.instruction.opcode;
+      if(slot.instruction.branch_op) {
+         if(slot.cond)
+            context.pc           = slot.alu_output;
+         context.branch_pending  = false;
+      }
+      if(opcode == LW)
+         slot.lmd                = read_memory(slot.alu_output);
+      else if(opcode == SW)
+         write_memory(slot.alu_output, context.int_file[slot.instruction.src2].value);
+      if((opcode == LW || opcode == SW) && Data_Memory_Latency > 0) {
+         slot.ready_cycle        = cc_count + Data_Memory_Latency;
+         context.memory_pending++;
+         parked.push_back(slot);
+      }
+      else
+         thread_latch[WB].push_back(slot);
+   }
+   thread_latch[MEM].clear();
+}
+
+//----------------------------------------------------------------------
+// Write back to the register files of the threads. Returns true once
+// every thread has written back its EOP
+//----------------------------------------------------------------------
+bool sim_pipe::THREAD_WB() {
+   for(unsigned i = 0; i < thread_latch[WB].size(); i++) {
+      thread_slot_t& slot        = thread_latch[WB][i];
+      thread_context_t& context  = contexts[slot.thread];
+      instruction_t& instruction = slot.instruction;
+      if(instruction.opcode == EOP) {
+         context.done            = true;
+         context.finish_cycle    = cc_count;
+         continue;
+      }
+      if(instruction.dest_op) {
+         context.int_file[instruction.dest].value = (instruction.opcode == LW) ? slot.lmd : slot.alu_output;
+         context.int_file[instruction.dest].busy--;
+      }
+      context.instructions++;
+   }
+   thread_latch[WB].clear();
+   for(unsigned t = 0; t < contexts.size(); t++) {
+      if(!contexts[t].done)
+         return false;
+   }
+   return true;
+}
+
+void sim_pipe::run_threads(unsigned cycles){
+   bool run_2_completion = (cycles == 0);
+   while(cycles-- || run_2_completion) {
+      if(THREAD_WB()) return;
+      THREAD_MEM();
+      THREAD_EXE();
+      THREAD_ID();
+      THREAD_IF();
+      cc_count++;
+   }
+}
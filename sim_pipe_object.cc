@@ -0,0 +1,135 @@
+#include "sim_pipe.h"
+
+//----------------------------------------------------------------------
+// Object files
+//
+// The assembler parses a program once and writes its instructions as
+// 32-bit words (see program.h): field A holds the destination, or the
+// register stored by SW; field B the first source; the tail the second
+// source of an ALU operation, or the immediate (the offset of a branch
+// or jump to its label). Loading an object file maps it and decodes
+// every word into the instruction memory in a single pass, with no
+// text to scan and no labels to resolve, then writes its data segments
+// to data memory.
+//----------------------------------------------------------------------
+
+void sim_pipe::assemble(const char *asm_filename, const char *object_filename, unsigned data_start, unsigned data_end){
+   ASSERT( data_start % 4 == 0 && data_end % 4 == 0 && data_start <= data_end, "Misaligned data segment [%x, %x)", data_start, data_end );
+   // parse() builds the program in instruct_memory
+   instruction_pointer *loaded  = instruct_memory;
+   instruct_memory              = NULL;
+   unsigned size                = parse(asm_filename);
+
+   program object(false);
+   for(unsigned i = 0; i < size; i++) {
+      instruction_t& instruction = *instruct_memory[i];
+      switch(instruction.opcode) {
+         case ADD ... DIV:
+            object.emit(instruction.opcode, object.reg_field(instruction.dest), object.reg_field(instruction.src1), object.reg_field(instruction.src2));
+            break;
+         case ADDI ... ANDI:
+         case LW:
+         case SWAP:
+            object.emit(instruction.opcode, object.reg_field(instruction.dest), object.reg_field(instruction.src1), object.immediate_field(instruction.immediate));
+            break;
+         case SW:
+            object.emit(instruction.opcode, object.reg_field(instruction.src2), object.reg_field(instruction.src1), object.immediate_field(instruction.immediate));
+            break;
+         case BEQZ ... BGEZ:
+            object.emit(instruction.opcode, 0, object.reg_field(instruction.src1), object.immediate_field(instruction.immediate));
+            break;
+         case JUMP:
+            object.emit(instruction.opcode, 0, 0, object.immediate_field(instruction.immediate));
+            break;
+         default:
+            object.emit(instruction.opcode);
+            break;
+      }
+      delete instruct_memory[i];
+   }
+   free(instruct_memory);
+   instruct_memory              = loaded;
+
+   map<string, unsigned> labels;
+   scan_labels(asm_filename, labels);
+   for(map<string, unsigned>::iterator it = labels.begin(); it != labels.end(); it++) {
+      program::symbol_t symbol = {it->first, it->second};
+      object.symbols.push_back(symbol);
+   }
+   if(data_end > data_start) {
+      program::segment_t segment;
+      segment.address           = data_start;
+      for(unsigned address = data_start; address < data_end; address += 4)
+         segment.words.push_back(read_memory(address));
+      object.data.push_back(segment);
+   }
+   object.save(object_filename);
+}
+
+int sim_pipe::load_object(const char *filename){
+   program object;
+   object.map(filename);
+   ASSERT( !object.fp, "%s holds floating point instructions", filename );
+   unsigned size                = object.text_count;
+   instruct_memory              = (instruction_pointer*) realloc(instruct_memory, size * sizeof(instruction_pointer));
+   instruction_t *instructions  = new instruction_t[size];
+   for(unsigned i = 0; i < size; i++) {
+      instruction_t& instruction = instructions[i];
+      instruct_memory[i]        = &instruction;
+      instruction.opcode        = (opcode_t) object.opcode(i);
+      switch(instruction.opcode) {
+         case ADD ... DIV:
+            instruction.dest       = object.field_a(i);
+            instruction.src1       = object.field_b(i);
+            instruction.src2       = object.field_c(i);
+            instruction.dest_op    = true;
+            instruction.src1_op    = true;
+            instruction.src2_op    = true;
+            break;
+         case ADDI ... ANDI:
+         case LW:
+            instruction.dest       = object.field_a(i);
+            instruction.src1       = object.field_b(i);
+            instruction.immediate  = object.immediate(i);
+            instruction.dest_op    = true;
+            instruction.src1_op    = true;
+            break;
+         case SW:
+            instruction.src2       = object.field_a(i);
+            instruction.src1       = object.field_b(i);
+            instruction.immediate  = object.immediate(i);
+            instruction.src2_op    = true;
+            instruction.src1_op    = true;
+            break;
+         case SWAP:
+            instruction.dest       = object.field_a(i);
+            instruction.src2       = object.field_a(i);
+            instruction.src1       = object.field_b(i);
+            instruction.immediate  = object.immediate(i);
+            instruction.dest_op    = true;
+            instruction.src2_op    = true;
+            instruction.src1_op    = true;
+            break;
+         case BEQZ ... BGEZ:
+            instruction.src1       = object.field_b(i);
+            instruction.immediate  = object.immediate(i);
+            instruction.src1_op    = true;
+            instruction.branch_op  = true;
+            break;
+         case JUMP:
+            instruction.immediate  = object.immediate(i);
+            instruction.branch_op  = true;
+            break;
+         case EOP:
+         case NOP:
+            break;
+         default:
+            ASSERT(false, "Unknown operation in object file %s", filename);
+            break;
+      }
+   }
+   for(unsigned s = 0; s < object.data.size(); s++)
+      for(unsigned w = 0; w < object.data[s].words.size(); w++)
+         write_memory(object.data[s].address + 4 * w, object.data[s].words[w]);
+   return size;
+}
@@ -0,0 +1,85 @@
+#include "sim_pipe.h"
+
+//----------------------------------------------------------------------
+// Performance monitoring unit
+//
+// The stalls, data memory accesses and taken branches are counted where
+// the pipeline handles them, the instructions as they retire in WB (a
+// fused pair as its two instructions). Once WB has taken its
+// instruction, the clock cycle is counted, along with the integer unit
+// if EX holds an instruction, and the data memory if MEM holds a load or
+// a store, or a load is outstanding in an MSHR.
+//----------------------------------------------------------------------
+
+void sim_pipe::set_pmu(pmu *monitoring){
+   this->monitoring             = monitoring;
+   if(monitoring != NULL)
+      monitoring->attach();
+}
+
+// event of the retirement of "opcode"
+static pmu_event_t retired_class(opcode_t opcode){
+   switch(opcode) {
+      case LW:
+         return EVENT_LOAD_OPS;
+      case SW:
+      case SWAP:
+         return EVENT_STORE_OPS;
+      case BEQZ ... JUMP:
+         return EVENT_BRANCH_OPS;
+      default:
+         return EVENT_INTEGER_OPS;
+   }
+}
+
+//----------------------------------------------------------------------
+// Counts the retirement of "instruction"
+//----------------------------------------------------------------------
+void sim_pipe::pmu_retire(const instruction_t& instruction){
+   if(instruction.fused_opcode != NOP) {
+      // the ALU operation of a fused pair is the instruction before the branch or load
+      monitoring->count(EVENT_INSTRUCTIONS, instruction.pc - 4);
+      monitoring->count(EVENT_INTEGER_OPS, instruction.pc - 4);
+   }
+   monitoring->count(EVENT_INSTRUCTIONS, instruction.pc);
+   monitoring->count(retired_class(instruction.opcode), instruction.pc);
+   monitoring->retired_pc       = instruction.pc;
+}
+
+//----------------------------------------------------------------------
+// Counts the taken branch and the data memory access of "instruction"
+// as it leaves EX for MEM
+//----------------------------------------------------------------------
+void sim_pipe::pmu_memory(const instruction_t& instruction){
+   if(sp_registers[MEM][COND] == 1) {
+      monitoring->count(EVENT_TAKEN_BRANCHES, instruction.pc);
+      if(sp_registers[MEM][ALU_OUTPUT] <= instruction.pc)
+         monitoring->count(EVENT_BACKWARD_BRANCHES, instruction.pc);
+   }
+   if(instruction.opcode == LW || instruction.opcode == SW || instruction.opcode == SWAP) {
+      monitoring->count(EVENT_MEMORY_ACCESSES, instruction.pc);
+      if(dram_model != NULL || data_memory_latency_count > (caches != NULL ? caches->hit_latency : 0))
+         monitoring->count(EVENT_MEMORY_MISSES, instruction.pc);
+   }
+}
+
+//----------------------------------------------------------------------
+// Counts "cycles" clock cycles of the pipeline as it is
+//----------------------------------------------------------------------
+void sim_pipe::pmu_cycle(unsigned cycles){
+   monitoring->cycle(cycles);
+   if(monitoring->counting(EVENT_INTEGER_BUSY) && instruction_register[EX].pc != UNDEFINED && instruction_register[EX].opcode != EOP)
+      monitoring->count(EVENT_INTEGER_BUSY, instruction_register[EX].pc, cycles);
+   if(monitoring->counting(EVENT_MEMORY_BUSY)) {
+      opcode_t opcode           = instruction_register[MEM].opcode;
+      unsigned pc               = UNDEFINED;
+      if(instruction_register[MEM].pc != UNDEFINED && (opcode == LW || opcode == SW || opcode == SWAP))
+         pc                     = instruction_register[MEM].pc;
+      for(unsigned i = 0; i < wb_queue.size() && pc == UNDEFINED; i++) {
+         if(wb_queue[i].mshr != -1)
+            pc                  = wb_queue[i].instruction.pc;
+      }
+      if(pc != UNDEFINED)
+         monitoring->count(EVENT_MEMORY_BUSY, pc, cycles);
+   }
+}
@@ -0,0 +1,98 @@
+#include "sim_pipe.h"
+
+//----------------------------------------------------------------------
+// Per-instruction profile
+//
+// The fetches, stalls, data memory accesses and taken branches are
+// counted where the pipeline handles them. An instruction is stamped
+// with the clock cycle it enters a stage, as seen once WB has taken its
+// instruction (the cycle after the one writing the latch, or the fetch),
+// and the cycles since are added to the stage it leaves: IF as it
+// enters the latch of ID (from the fetch queue or the extra front-end
+// sub-stages), ID and EX as it enters the latch of MEM (it carries its
+// cycles of ID through EX), and MEM (with the extra memory sub-stages
+// and the write-back queue) as WB takes it.
+// WB takes one cycle, but none for EOP, which ends the run. The clock
+// cycles up to the write-back are charged to the instruction. A run
+// stopping with instructions in flight counts them in their stages and
+// charges its cycles to the oldest of them, or to the PC being fetched
+// when the pipeline is empty.
+//----------------------------------------------------------------------
+
+void sim_pipe::set_profiler(profiler *profiling){
+   ASSERT( profiling == NULL || instruct_memory != NULL, "No program loaded" );
+   this->profiling              = profiling;
+   if(profiling != NULL)
+      profiling->start(baseAddress, cc_count);
+}
+
+//----------------------------------------------------------------------
+// Profiles the instruction in the latch of ID as "instruction" leaves
+// for EX, in the current clock cycle, carrying its cycles of ID along;
+// the first instruction of a fused pair keeps its own. EOP stays, decoded
+// again, and every copy leaving is numbered as an instruction of its own
+//----------------------------------------------------------------------
+void sim_pipe::profile_decode(instruction_t& instruction, bool fused){
+   if(instruction.opcode == EOP)
+      instruction.seq           = ++fetch_seq;
+   profiling->decode(instruction_register[ID].pc, instruction_register[ID].seq, instruction.seq, fused, cc_count + 1);
+}
+
+//----------------------------------------------------------------------
+// Profiles "instruction" as it leaves EX for MEM, in the current clock
+// cycle: its cycles of ID and EX, the branch taken and the data memory
+// access
+//----------------------------------------------------------------------
+void sim_pipe::profile_memory(instruction_t& instruction){
+   profiling->execute(instruction.pc, instruction.seq, cc_count + 1);
+   if(sp_registers[MEM][COND] == 1)
+      profiling->branch(instruction.pc, sp_registers[MEM][ALU_OUTPUT]);
+   if(instruction.opcode == LW || instruction.opcode == SW || instruction.opcode == SWAP)
+      profiling->access(instruction.pc, dram_model != NULL || data_memory_latency_count > (caches != NULL ? caches->hit_latency : 0));
+}
+
+//----------------------------------------------------------------------
+// Profiles "instruction" as WB takes it, in the current clock cycle
+// (EOP ends the run)
+//----------------------------------------------------------------------
+void sim_pipe::profile_write_back(instruction_t& instruction){
+   unsigned pc                  = instruction.pc;
+   if(instruction.opcode == EOP) {
+      profiling->leave(pc, MEM, instruction.seq, cc_count);
+      profiling->charge(pc != UNDEFINED ? pc : sp_registers[IF][PC], cc_count);
+   }
+   else if(pc != UNDEFINED)
+      profiling->write_back(pc, instruction.seq, cc_count);
+}
+
+// counts "instruction" in "stage" up to the current clock cycle, the oldest instruction so far
+static void in_stage(profiler *profiling, instruction_t& instruction, stage_t stage, unsigned now, unsigned &oldest){
+   if(instruction.pc == UNDEFINED)
+      return;
+   profiling->leave(instruction.pc, stage, instruction.seq, now);
+   oldest                       = instruction.pc;
+}
+
+//----------------------------------------------------------------------
+// Profiles the instructions in flight up to the current clock cycle, as
+// a run stops (youngest instructions first). The one in the latch of
+// EX still has its cycles of ID. WB has not taken the latch MEM wrote
+// yet; the one of the write-back queue is profiled
+//----------------------------------------------------------------------
+void sim_pipe::profile_flush(){
+   unsigned oldest              = UNDEFINED;
+   for(int i = fetch_queue.size() - 1; i >= 0; i--)
+      in_stage(profiling, fetch_queue[i].instruction, IF, cc_count, oldest);
+   for(int i = front_end.size() - 1; i >= 0; i--)
+      in_stage(profiling, front_end[i].instruction, IF, cc_count, oldest);
+   profiling->flush_decoded(instruction_register[EX].pc, instruction_register[EX].seq);
+   for(int s = ID; s <= MEM; s++)
+      in_stage(profiling, instruction_register[s], (stage_t)s, cc_count, oldest);
+   for(int i = wb_queue.size() - 1; i >= 0; i--)
+      in_stage(profiling, wb_queue[i].instruction, MEM, cc_count, oldest);
+   if(num_mshrs == 0)
+      in_stage(profiling, instruction_register[WB], MEM, cc_count, oldest);
+   for(int i = memory_pipe.size() - 1; i >= 0; i--)
+      in_stage(profiling, memory_pipe[i].instruction, MEM, cc_count, oldest);
+   profiling->charge(oldest != UNDEFINED ? oldest : sp_registers[IF][PC], cc_count);
+}
@@ -0,0 +1,119 @@
+#include "sim_pipe.h"
+
+//----------------------------------------------------------------------
+// Sampled simulation
+//
+// The program alternates between sampling units simulated in detail
+// and functional execution (see sampler.h). A unit starts the scalar
+// pipeline empty at the PC reached, and IF ends it by fetching an EOP
+// in place of the instruction past the warm-up and measured ones: the
+// pipeline drains as at the end of the program, every instruction
+// fetched commits, and the next one is where functional execution
+// resumes. The measured CPI is taken between the commits of the last
+// warm-up and of the last measured instruction, so neither the empty
+// pipeline nor the drain counts. Functional execution trains the
+// prefetcher and opens the DRAM rows as the loads and stores would.
+//----------------------------------------------------------------------
+
+void sim_pipe::sample(sampler *sampling){
+   ASSERT( instruct_memory != NULL, "No program loaded" );
+   ASSERT( issue_width == 1 && contexts.empty() && replay == NULL && caches == NULL && !steady_state, "Sampling needs the scalar pipeline running a program" );
+   this->sampling               = sampling;
+   unsigned pc                  = sp_registers[IF][PC];
+   while(!sampling->get_converged() && sample_unit(pc) && fast_forward(pc, sampling->fast_forward()));
+   if(sampling->get_converged())
+      fast_forward(pc, sampling->fast_forward());
+   sp_registers[IF][PC]         = pc;
+   this->sampling               = NULL;
+}
+
+//----------------------------------------------------------------------
+// Simulates the sampling unit starting at "pc" in detail, and leaves
+// "pc" at the instruction that follows it. Returns false if the unit
+// reached the end of the program
+//----------------------------------------------------------------------
+bool sim_pipe::sample_unit(unsigned &pc){
+   restart(pc);
+   unsigned cycles              = cc_count;
+   sample_fetch_limit           = instCount + sampling->warmup + sampling->unit;
+   sample_commits               = 0;
+   sample_start_cycle           = (sampling->warmup == 0) ? cc_count : UNDEFINED;
+   sample_end_cycle             = UNDEFINED;
+   run();
+
+   pc                           = sample_resume_pc;
+   sampling->instructions      += sample_commits;
+   sampling->detailed_instructions += sample_commits;
+   sampling->detailed_cycles   += cc_count - cycles;
+   if(sample_end_cycle != UNDEFINED)
+      sampling->measure(sample_end_cycle - sample_start_cycle);
+   return instruct_memory[(pc - baseAddress)/4]->opcode != EOP;
+}
+
+//----------------------------------------------------------------------
+// Commit of "instructions" instructions of the sampling unit
+//----------------------------------------------------------------------
+void sim_pipe::sample_commit(unsigned instructions){
+   unsigned warmup              = sampling->warmup;
+   unsigned end                 = warmup + sampling->unit;
+   if(sample_commits < warmup && sample_commits + instructions >= warmup)
+      sample_start_cycle        = cc_count;
+   if(sample_commits < end && sample_commits + instructions >= end)
+      sample_end_cycle          = cc_count;
+   sample_commits              += instructions;
+}
+
+//----------------------------------------------------------------------
+// Empties the pipeline, drained by an EOP, to fetch from "pc"
+//----------------------------------------------------------------------
+void sim_pipe::restart(unsigned pc){
+   for(int s = 0; s < NUM_STAGES; s++) {
+      instruction_register[s].no_operation();
+      clear_sp_register((stage_t)s);
+      sp_registers[s][COND]     = 0;
+   }
+   for(int i = 0; i < NUM_GP_REGISTERS; i++)
+      int_file[i].busy          = 0;
+   sp_registers[IF][PC]         = pc;
+   fetch_queue.clear();
+   wb_queue.clear();                            // the EOPs fetched behind the one that ended the unit
+   fetch_wait                   = 0;
+   set_pipeline_depth(fetch_stages, decode_stages, memory_stages);
+   sample_resume_pc             = UNDEFINED;
+}
+
+//----------------------------------------------------------------------
+// Executes up to "instructions" instructions from "pc" without timing,
+// and leaves "pc" at the next one (profiling them if "profile" is not
+// NULL). Returns false if the program ended
+//----------------------------------------------------------------------
+bool sim_pipe::fast_forward(unsigned &pc, unsigned instructions, simpoint *profile){
+   int regs[NUM_GP_REGISTERS];
+   for(int r = 0; r < NUM_GP_REGISTERS; r++)
+      regs[r]                   = int_file[r].value;
+   unsigned executed            = 0;
+   unsigned alu_output, lmd;
+   bool cond;
+   bool running                 = true;
+   while(executed < instructions) {
+      opcode_t opcode           = instruct_memory[(pc - baseAddress)/4]->opcode;
+      if(opcode == EOP) {
+         running                = false;
+         break;
+      }
+      unsigned npc              = functional_step(pc, regs, true, alu_output, lmd, cond);
+      if(profile != NULL && opcode != NOP)
+         profile->execute(pc, instruct_memory[(pc - baseAddress)/4]->branch_op);
+      if(opcode == LW && data_prefetcher != NULL)
+         data_prefetcher->warm(pc, alu_output);
+      if((opcode == LW || opcode == SW || opcode == SWAP) && dram_model != NULL)
+         dram_model->warm(alu_output);
+      executed                 += (opcode != NOP);
+      pc                        = npc;
+   }
+   for(int r = 0; r < NUM_GP_REGISTERS; r++)
+      int_file[r].value         = regs[r];
+   if(sampling != NULL)
+      sampling->instructions   += executed;
+   return running;
+}
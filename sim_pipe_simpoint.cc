@@ -0,0 +1,45 @@
+#include "sim_pipe.h"
+
+//----------------------------------------------------------------------
+// Simulation points
+//
+// Profiling is a functional run of the program (the fast-forward of the
+// sampled simulation) that reports every instruction to the simpoint.
+// The points are then simulated in order in a single run: the program
+// runs functionally up to the warm-up of each point, which is simulated
+// as a sampling unit (see sim_pipe_sample.cc), so the state the point
+// starts from is the one it has in the program.
+//----------------------------------------------------------------------
+
+void sim_pipe::profile(simpoint *points){
+   ASSERT( instruct_memory != NULL, "No program loaded" );
+   unsigned pc                  = sp_registers[IF][PC];
+   fast_forward(pc, UINT_MAX, points);
+   sp_registers[IF][PC]         = pc;
+   points->select();
+}
+
+void sim_pipe::simulate_points(simpoint *points){
+   ASSERT( instruct_memory != NULL, "No program loaded" );
+   ASSERT( points->get_clusters() > 0, "No simulation points were chosen" );
+   ASSERT( issue_width == 1 && contexts.empty() && replay == NULL && caches == NULL && !steady_state, "Simulation points need the scalar pipeline running a program" );
+   unsigned pc                  = sp_registers[IF][PC];
+   unsigned long executed       = 0;
+   bool running                 = true;
+   for(unsigned p = 0; running && p < points->points.size(); p++) {
+      simpoint::point_t& point  = points->points[p];
+      unsigned long start       = points->get_start(point);
+      unsigned warmup           = (start > executed) ? min((unsigned long) points->warmup, start - executed) : 0;
+      sampler unit(warmup + points->interval, points->interval, warmup);
+      sampling                  = &unit;
+      running                   = fast_forward(pc, (start > executed) ? start - warmup - executed : 0) && sample_unit(pc);
+      point.cpi                 = unit.get_CPI();
+      executed                 += unit.get_instructions();
+      points->detailed_instructions += unit.detailed_instructions;
+      points->detailed_cycles  += unit.detailed_cycles;
+   }
+   sampling                     = NULL;
+   if(running)
+      fast_forward(pc, UINT_MAX);
+   sp_registers[IF][PC]         = pc;
+}
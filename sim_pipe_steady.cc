@@ -0,0 +1,361 @@
+#include "sim_pipe.h"
+
+//----------------------------------------------------------------------
+// Steady-state extrapolation of loops
+//
+// With the fixed data memory latency, the timing of the scalar
+// pipeline depends on the instructions it fetches, not on the values
+// they compute. Once the pipeline is in the same state at two fetches
+// of a loop head (the same instructions in every latch and sub-stage,
+// the same busy registers and memory latency count), every later
+// iteration fetching the same instructions takes the same cycles and
+// ends in that state again. Those iterations are executed functionally
+// instead, from the oldest instruction in flight, for as long as they
+// follow the path of the iteration observed: the registers and memory
+// are left as they are before the instructions in flight after the
+// last one, whose values are recomputed into the latches, and the
+// counters advance by those of the iteration observed times the
+// iterations executed.
+//----------------------------------------------------------------------
+
+static const unsigned STEADY_MAX_PATH = 1 << 16;    // longest loop iteration tracked, in instructions
+
+// Latch encoding in the steady state key: the PCs of the instructions in flight tell them apart
+static unsigned latch_code(const instruction_t &instruction){
+   return instruction.is_stall | (instruction.opcode << 1) | (instruction.fused_opcode << 6);
+}
+
+void sim_pipe::set_steady_state(bool enable){
+   steady_state           = enable;
+   steady_in_flight.clear();
+   steady_head            = UNDEFINED;
+   steady_head_fetched    = false;
+   steady_path.clear();
+   steady_path_valid      = false;
+   steady_last.valid      = false;
+}
+
+//----------------------------------------------------------------------
+// Fetch of the instruction at "pc": it joins the instructions in flight
+// and the path of the current iteration. A NOP (not told apart from a
+// bubble in the latches) or EOP keeps the iteration from extrapolating
+//----------------------------------------------------------------------
+void sim_pipe::steady_fetch(unsigned pc){
+   opcode_t opcode        = instruct_memory[(pc - baseAddress)/4]->opcode;
+   if(opcode == NOP || opcode == EOP)
+      steady_path_valid   = false;
+   else
+      steady_in_flight.push_back(pc);
+   if(steady_path.size() < STEADY_MAX_PATH)
+      steady_path.push_back(pc);
+   else
+      steady_path_valid   = false;
+   steady_head_fetched   |= (pc == steady_head);
+}
+
+//----------------------------------------------------------------------
+// A backward branch to "head" was taken: the loop it closes becomes the
+// one checked for a steady state
+//----------------------------------------------------------------------
+void sim_pipe::steady_loop(unsigned head){
+   if(head == steady_head)
+      return;
+   steady_head            = head;
+   steady_last.valid      = false;
+}
+
+sim_pipe::steady_checkpoint_t sim_pipe::steady_snapshot(){
+   steady_checkpoint_t checkpoint;
+   vector<unsigned> &key  = checkpoint.key;
+   key.push_back(sp_registers[IF][PC]);
+   key.push_back(sp_registers[MEM][COND]);
+   key.push_back(data_memory_latency_count);
+   key.push_back(fetch_wait);
+   key.push_back(fetch_stopped);
+   key.push_back(fetch_eop);
+   for(int i = 0; i < NUM_GP_REGISTERS; i++)
+      key.push_back(int_file[i].busy);
+   key.push_back(memory_pipe.size());
+   for(unsigned i = 0; i < memory_pipe.size(); i++)
+      key.push_back(latch_code(memory_pipe[i].instruction));
+   for(int s = ID; s < NUM_STAGES; s++)
+      key.push_back(latch_code(instruction_register[s]));
+   key.push_back(front_end.size());
+   for(unsigned i = 0; i < front_end.size(); i++)
+      key.push_back(latch_code(front_end[i].instruction));
+   key.push_back(fetch_queue.size());
+   for(unsigned i = 0; i < fetch_queue.size(); i++)
+      key.push_back(latch_code(fetch_queue[i].instruction));
+   key.push_back(steady_in_flight.size());
+   key.insert(key.end(), steady_in_flight.begin(), steady_in_flight.end());
+
+   checkpoint.valid                   = true;
+   checkpoint.cycles                  = cc_count;
+   checkpoint.stalls                  = stall_count;
+   checkpoint.fetches                 = instCount;
+   checkpoint.starved_cycles          = fetch_starved_cycles;
+   checkpoint.queue_occupancy         = fetch_queue_occupancy;
+   checkpoint.compare_branch_fusions  = compare_branch_fusions;
+   checkpoint.increment_load_fusions  = increment_load_fusions;
+   return checkpoint;
+}
+
+//----------------------------------------------------------------------
+// End of a cycle that fetched the loop head: if the pipeline is in the
+// state it was in at the previous fetch of the head, extrapolates the
+// iterations that follow within "budget" cycles. Returns the cycles
+// skipped
+//----------------------------------------------------------------------
+unsigned sim_pipe::steady_checkpoint(unsigned budget){
+   steady_head_fetched               = false;
+   steady_checkpoint_t now           = steady_snapshot();
+   unsigned skipped                  = 0;
+   if(steady_last.valid && steady_path_valid && now.key == steady_last.key) {
+      steady_state_event_t event;
+      event.head                     = steady_head;
+      event.cycle                    = cc_count;
+      event.cycles                   = now.cycles - steady_last.cycles;
+      event.stalls                   = now.stalls - steady_last.stalls;
+      event.instructions             = now.fetches - steady_last.fetches;
+      event.iterations               = extrapolate(budget / event.cycles);
+      if(event.iterations > 0) {
+         unsigned iterations         = event.iterations;
+         skipped                     = iterations * event.cycles;
+         cc_count                   += skipped;
+         stall_count                += iterations * event.stalls;
+         instCount                  += iterations * event.instructions;
+         fetch_starved_cycles       += iterations * (now.starved_cycles - steady_last.starved_cycles);
+         fetch_queue_occupancy      += iterations * (now.queue_occupancy - steady_last.queue_occupancy);
+         compare_branch_fusions     += iterations * (now.compare_branch_fusions - steady_last.compare_branch_fusions);
+         increment_load_fusions     += iterations * (now.increment_load_fusions - steady_last.increment_load_fusions);
+         steady_state_log.push_back(event);
+         now                         = steady_snapshot();
+      }
+   }
+   steady_last                       = now;
+   steady_path.clear();
+   steady_path_valid                 = true;
+   return skipped;
+}
+
+//----------------------------------------------------------------------
+// Executes up to "max_iterations" iterations of the steady loop without
+// timing, and rebuilds the values held in the latches for the
+// instructions in flight after the last one. Returns the iterations
+// executed
+//----------------------------------------------------------------------
+unsigned sim_pipe::extrapolate(unsigned max_iterations){
+   vector<unsigned> in_flight(steady_in_flight.begin(), steady_in_flight.end());
+   unsigned long m                   = in_flight.size();
+   unsigned long n                   = steady_path.size();
+   if(max_iterations == 0 || m == 0 || n == 0)
+      return 0;
+
+   // the latches holding the instructions in flight, oldest first (the ones after EX hold no values yet)
+   vector<instruction_t*> latches;
+   for(unsigned i = 0; i < memory_pipe.size(); i++)
+      latches.push_back(&memory_pipe[i].instruction);
+   latches.push_back(&instruction_register[WB]);
+   latches.push_back(&instruction_register[MEM]);
+   latches.push_back(&instruction_register[EX]);
+   latches.push_back(&instruction_register[ID]);
+   for(unsigned i = 0; i < front_end.size(); i++)
+      latches.push_back(&front_end[i].instruction);
+   for(unsigned i = 0; i < fetch_queue.size(); i++)
+      latches.push_back(&fetch_queue[i].instruction);
+   unsigned long held                = 0;
+   for(unsigned i = 0; i < latches.size(); i++) {
+      if(latches[i]->opcode != NOP && latches[i]->opcode != EOP)
+         held                       += (latches[i]->fused_opcode != NOP) ? 2 : 1;
+   }
+   if(held != m)
+      return 0;
+
+   // executes the instructions in flight, then the iterations, for as long as they follow the path observed; the
+   // registers are saved after every iteration, and the memory written can be rolled back
+   struct block_t{
+      unsigned long  index;
+      unsigned long  undo;
+      int            regs[NUM_GP_REGISTERS];
+   };
+   deque<block_t> blocks;
+   deque<pair<unsigned, unsigned> > undo;
+   unsigned long undo_base           = 0;
+   block_t block;
+   block.index                       = 0;
+   block.undo                        = 0;
+   for(int r = 0; r < NUM_GP_REGISTERS; r++)
+      block.regs[r]                  = int_file[r].value;
+   blocks.push_back(block);
+
+   int regs[NUM_GP_REGISTERS];
+   memcpy(regs, block.regs, sizeof(regs));
+   unsigned long limit               = max_iterations * n + m;
+   unsigned long i                   = 0;
+   unsigned pc                       = in_flight[0];
+   unsigned alu_output, lmd;
+   bool cond;
+   while(i < limit) {
+      unsigned expected              = (i < m) ? in_flight[i] : steady_path[(i - m) % n];
+      if(pc != expected || instruct_memory[(pc - baseAddress)/4]->opcode == SWAP)
+         break;
+      pc                             = functional_step(pc, regs, true, alu_output, lmd, cond, &undo);
+      i++;
+      if(i % n == 0) {
+         block.index                 = i;
+         block.undo                  = undo_base + undo.size();
+         memcpy(block.regs, regs, sizeof(regs));
+         blocks.push_back(block);
+         // the extrapolation ends past i - m - n, where the older blocks are no longer needed
+         while(blocks.front().index + m + n <= i)
+            blocks.pop_front();
+         for(; undo_base < blocks.front().undo; undo_base++)
+            undo.pop_front();
+      }
+   }
+   unsigned long iterations          = (i < m) ? 0 : min((unsigned long)max_iterations, (i - m) / n);
+   while(blocks.back().index > iterations * n)
+      blocks.pop_back();
+   ASSERT( blocks.back().index == iterations * n, "Lost the end of the extrapolated iterations" );
+   for(; undo_base + undo.size() > blocks.back().undo; undo.pop_back())
+      write_memory(undo.back().first, undo.back().second);
+   if(iterations == 0)
+      return 0;
+
+   // the registers as they are before the instructions in flight, whose values are recomputed into the latches; the
+   // stores already past MEM write data memory again
+   for(int r = 0; r < NUM_GP_REGISTERS; r++)
+      int_file[r].value              = blocks.back().regs[r];
+   memcpy(regs, blocks.back().regs, sizeof(regs));
+   unsigned long k                   = 0;
+   unsigned first_ex                 = memory_pipe.size() + 2;
+   for(unsigned l = 0; l <= first_ex; l++) {
+      instruction_t &instruction     = *latches[l];
+      if(instruction.opcode == NOP || instruction.opcode == EOP)
+         continue;
+      bool past_mem                  = (l < first_ex - 1);
+      unsigned a                     = instruction.src1_op ? regs[instruction.src1] : UNDEFINED;
+      unsigned b                     = instruction.src2_op ? regs[instruction.src2] : UNDEFINED;
+      unsigned fused_value           = UNDEFINED;
+      functional_step(in_flight[k++], regs, past_mem, alu_output, lmd, cond);
+      if(instruction.fused_opcode != NOP) {
+         fused_value                 = alu_output;
+         functional_step(in_flight[k++], regs, past_mem, alu_output, lmd, cond);
+      }
+      if(l < memory_pipe.size()) {
+         memory_pipe[l].alu_output   = alu_output;
+         memory_pipe[l].lmd          = lmd;
+         instruction.fused_value     = fused_value;
+      }
+      else if(l == memory_pipe.size()) {
+         sp_registers[WB][ALU_OUTPUT] = alu_output;
+         sp_registers[WB][LMD]       = lmd;
+         instruction.fused_value     = fused_value;
+      }
+      else if(l == memory_pipe.size() + 1) {
+         sp_registers[MEM][ALU_OUTPUT] = alu_output;
+         sp_registers[MEM][COND]     = cond;
+         sp_registers[MEM][B]        = b;
+         instruction.fused_value     = fused_value;
+      }
+      else {
+         sp_registers[EX][A]         = a;
+         sp_registers[EX][B]         = b;
+      }
+   }
+   return iterations;
+}
+
+//----------------------------------------------------------------------
+// Executes the instruction at "pc" on the register values "regs",
+// accessing data memory if "memory" (logging the old values of the
+// words written in "undo"). Returns the PC of the next instruction, and
+// the values the instruction leaves in the EX/MEM and MEM/WB latches
+//----------------------------------------------------------------------
+unsigned sim_pipe::functional_step(unsigned pc, int *regs, bool memory, unsigned &alu_output, unsigned &lmd, bool &cond, deque<pair<unsigned, unsigned> > *undo){
+   instruction_t &instruction        = *instruct_memory[(pc - baseAddress)/4];
+   int a                             = instruction.src1_op ? regs[instruction.src1] : 0;
+   int b                             = instruction.src2_op ? regs[instruction.src2] : 0;
+   unsigned npc                      = pc + 4;
+   alu_output                        = UNDEFINED;
+   lmd                               = UNDEFINED;
+   cond                              = false;
+   switch(instruction.opcode) {
+      case LW:
+         alu_output                  = instruction.immediate + a;
+         if(memory)
+            lmd                      = read_memory(alu_output);
+         regs[instruction.dest]      = lmd;
+         break;
+
+      case SW:
+         alu_output                  = instruction.immediate + a;
+         if(memory) {
+            if(undo != NULL)
+               undo->push_back(make_pair(alu_output, read_memory(alu_output)));
+            write_memory(alu_output, b);
+         }
+         break;
+
+      case SWAP:
+         alu_output                  = instruction.immediate + a;
+         if(memory) {
+            lmd                      = read_memory(alu_output);
+            if(undo != NULL)
+               undo->push_back(make_pair(alu_output, lmd));
+            write_memory(alu_output, b);
+         }
+         regs[instruction.dest]      = lmd;
+         break;
+
+      case ADD ... DIV:
+         alu_output                  = alu(a, b, instruction.opcode);
+         regs[instruction.dest]      = alu_output;
+         break;
+
+      case ADDI ... ANDI:
+         alu_output                  = alu(a, instruction.immediate, instruction.opcode);
+         regs[instruction.dest]      = alu_output;
+         break;
+
+      case BEQZ ... JUMP:
+         switch(instruction.opcode) {
+            case BEQZ: cond = a == 0; break;
+            case BNEZ: cond = a != 0; break;
+            case BLTZ: cond = a <  0; break;
+            case BGTZ: cond = a >  0; break;
+            case BLEZ: cond = a <= 0; break;
+            case BGEZ: cond = a >= 0; break;
+            default:   cond = true;   break;
+         }
+         alu_output                  = alu(npc, instruction.immediate, instruction.opcode);
+         npc                         = cond ? alu_output : npc;
+         break;
+
+      default: break;
+   }
+   return npc;
+}
+
+unsigned sim_pipe::get_extrapolated_iterations(){
+   unsigned iterations = 0;
+   for(unsigned i = 0; i < steady_state_log.size(); i++)
+      iterations += steady_state_log[i].iterations;
+   return iterations;
+}
+
+unsigned sim_pipe::get_extrapolated_cycles(){
+   unsigned cycles = 0;
+   for(unsigned i = 0; i < steady_state_log.size(); i++)
+      cycles += steady_state_log[i].iterations * steady_state_log[i].cycles;
+   return cycles;
+}
+
+void sim_pipe::print_steady_state(){
+   for(unsigned i = 0; i < steady_state_log.size(); i++) {
+      steady_state_event_t &event = steady_state_log[i];
+      cout << "Loop at 0x" << hex << event.head << ": steady state at cycle " << dec << event.cycle << ", ";
+      cout << event.iterations << " iterations extrapolated (" << event.cycles << " cycles, " << event.stalls << " stalls, ";
+      cout << event.instructions << " instructions each)" << endl;
+   }
+}
@@ -0,0 +1,217 @@
+#include "sim_pipe.h"
+
+//----------------------------------------------------------------------
+// Trace recording and replay
+//
+// Recording runs the program one instruction at a time, with no
+// pipeline, and logs every dynamic instruction with its branch outcome
+// and effective address. Replaying feeds the records to the scalar
+// pipeline in place of the program: IF takes the next record (checking
+// that it is at the PC being fetched) and EX takes the outcome of the
+// record instead of computing it, while hazards, stalls and every
+// memory option are timed by the same code as when running the
+// program. No register or memory value matters to the timing, so the
+// replay takes the same cycles as the program. The cycles a load or
+// store waits on the fixed memory latency, with the whole pipeline
+// frozen behind it, are skipped in one step.
+//
+// With no option that needs the latches (see timed_replay), a replay
+// run to completion skips the pipeline altogether: the cycles each
+// record is fetched, decoded and executed, and the cycle each register
+// is written back, follow from those of the record before it.
+//----------------------------------------------------------------------
+
+void sim_pipe::record_trace(trace *stream){
+   ASSERT( instruct_memory != NULL && contexts.empty(), "No program loaded" );
+   ASSERT( !stream->fp, "The trace holds floating point instructions" );
+   unsigned pc                = sp_registers[IF][PC];
+   while(true) {
+      instruction_t instruction = *(instruct_memory[(pc - baseAddress)/4]);
+      trace_record_t record;
+      record.pc               = pc;
+      record.opcode           = instruction.opcode;
+      record.dest             = instruction.dest_op ? instruction.dest : 0;
+      record.src1             = instruction.src1_op ? instruction.src1 : 0;
+      record.src2             = instruction.src2_op ? instruction.src2 : 0;
+      record.immediate        = instruction.immediate;
+      record.dest_op          = instruction.dest_op;
+      record.src1_op          = instruction.src1_op;
+      record.src2_op          = instruction.src2_op;
+      record.dest_float_op    = false;
+      record.src1_float_op    = false;
+      record.src2_float_op    = false;
+      record.branch_op        = instruction.branch_op;
+      record.taken            = false;
+      record.address          = 0;
+      record.a                = 0;
+      record.b                = 0;
+
+      int a                   = instruction.src1_op ? get_gp_register(instruction.src1) : 0;
+      int b                   = instruction.src2_op ? get_gp_register(instruction.src2) : 0;
+      unsigned npc            = pc + 4;
+      switch(instruction.opcode) {
+         case LW:
+            record.address    = a + instruction.immediate;
+            set_gp_register(instruction.dest, read_memory(record.address));
+            break;
+
+         case SW:
+            record.address    = a + instruction.immediate;
+            write_memory(record.address, b);
+            break;
+
+         case SWAP:
+            record.address    = a + instruction.immediate;
+            set_gp_register(instruction.dest, read_memory(record.address));
+            write_memory(record.address, b);
+            break;
+
+         case ADD ... DIV:
+            set_gp_register(instruction.dest, alu(a, b, instruction.opcode));
+            break;
+
+         case ADDI ... ANDI:
+            set_gp_register(instruction.dest, alu(a, instruction.immediate, instruction.opcode));
+            break;
+
+         case BEQZ ... JUMP:
+            switch(instruction.opcode) {
+               case BEQZ: record.taken = a == 0; break;
+               case BNEZ: record.taken = a != 0; break;
+               case BLTZ: record.taken = a <  0; break;
+               case BGTZ: record.taken = a >  0; break;
+               case BLEZ: record.taken = a <= 0; break;
+               case BGEZ: record.taken = a >= 0; break;
+               default:   record.taken = true;   break;
+            }
+            record.address    = alu(npc, instruction.immediate, instruction.opcode);
+            npc               = record.taken ? record.address : npc;
+            break;
+
+         default: break;
+      }
+      stream->append(record);
+      if(instruction.opcode == EOP)
+         return;
+      pc                      = npc;
+   }
+}
+
+void sim_pipe::load_trace(trace *stream){
+   ASSERT( !stream->fp && stream->size() > 0 && stream->get(stream->size() - 1).opcode == EOP, "Not a complete trace of the integer simulator" );
+   ASSERT( issue_width == 1 && contexts.empty() && caches == NULL, "A trace is only replayed by the scalar pipeline" );
+   replay                     = stream;
+   fetch_seq                  = 0;
+   sp_registers[IF][PC]       = stream->get(0).pc;
+   baseAddress                = stream->get(0).pc;
+}
+
+//----------------------------------------------------------------------
+// Rebuild the instruction of trace record "index"
+//----------------------------------------------------------------------
+instruction_t sim_pipe::decode_record(uint64_t index){
+   const trace_record_t& record = replay->get(index);
+   instruction_t instruction;
+   instruction.opcode         = (opcode_t)record.opcode;
+   instruction.dest           = record.dest_op ? record.dest : UNDEFINED;
+   instruction.src1           = record.src1_op ? record.src1 : UNDEFINED;
+   instruction.src2           = record.src2_op ? record.src2 : UNDEFINED;
+   instruction.immediate      = record.immediate;
+   instruction.dest_op        = record.dest_op;
+   instruction.src1_op        = record.src1_op;
+   instruction.src2_op        = record.src2_op;
+   instruction.branch_op      = record.branch_op;
+   instruction.seq            = (unsigned)index;
+   instruction.pc             = record.pc;
+   return instruction;
+}
+
+//----------------------------------------------------------------------
+// Trace record of the instruction numbered "seq" (the low 32 bits of
+// the record), fetched less than 2^32 records before the next one
+//----------------------------------------------------------------------
+uint64_t sim_pipe::replay_record(unsigned seq){
+   return fetch_seq - (unsigned)((unsigned)fetch_seq - seq);
+}
+
+//----------------------------------------------------------------------
+// Cycles the stalled memory stage keeps waiting on the fixed memory
+// latency with nothing else in the pipeline moving
+//----------------------------------------------------------------------
+unsigned sim_pipe::frozen_cycles(){
+   if(dram_model != NULL || store_buffer_size > 0 || num_mshrs > 0 || !memory_pipe.empty())
+      return 0;
+   return data_memory_latency_count;
+}
+
+//----------------------------------------------------------------------
+// Whether a replay to completion can be timed record by record: the
+// plain scalar pipeline, with the fixed data memory latency or the
+// prefetcher in front of it, from its first cycle
+//----------------------------------------------------------------------
+bool sim_pipe::timed_replay(){
+   return cc_count == 0 && fusion_idioms == 0 && fetch_queue_size == 0 && front_end.empty() && memory_pipe.empty() &&
+          num_mshrs == 0 && store_buffer_size == 0 && dram_model == NULL && profiling == NULL && monitoring == NULL &&
+          !steady_state;
+}
+
+//----------------------------------------------------------------------
+// Replay the whole trace with the timing of the pipeline, record by
+// record. In a cycle the memory stage is not waiting on an access
+// every latch moves, and a load or store entering MEM freezes the
+// cycles of its latency. Decode waits for the record to be fetched,
+// for the cycle following the decode of the one before it and for the
+// write-back of its sources (in WB, before ID reads them); a branch
+// holds fetch until the cycle after its EX. EOP is written back in
+// the last cycle counted
+//----------------------------------------------------------------------
+void sim_pipe::replay_timing(){
+   unsigned ready[NUM_GP_REGISTERS];                      // cycle of the write-back of each register
+   for(unsigned r = 0; r < NUM_GP_REGISTERS; r++)
+      ready[r]                = 0;
+   unsigned fetch             = 0;                        // cycle the record is fetched
+   unsigned prev_exe          = 0;                        // cycle the record before executes, and its latency
+   unsigned prev_latency      = 0;
+   unsigned stalls            = 0;
+   uint64_t records           = replay->size();
+   for(uint64_t i = 0; i < records; i++) {
+      const trace_record_t& record = replay->get(i);
+      unsigned from           = max(fetch + 1, prev_exe);
+      unsigned thaw           = prev_exe + prev_latency + 1;   // first cycle past the access of the record before
+      unsigned decode         = from;
+      if(record.src1_op)
+         decode               = max(decode, ready[record.src1]);
+      if(record.src2_op)
+         decode               = max(decode, ready[record.src2]);
+      if(decode > prev_exe && decode < thaw)
+         decode               = thaw;
+      // RAW stalls: the cycles decode waits, but for the frozen ones
+      unsigned frozen_from    = max(from, prev_exe + 1);
+      unsigned frozen_to      = min(decode, thaw);
+      stalls                 += decode - from - (frozen_to > frozen_from ? frozen_to - frozen_from : 0);
+      unsigned exe            = max(decode + 1, thaw);
+      unsigned latency        = 0;
+      if(record.opcode == LW) {
+         cc_count             = exe;                      // the prefetcher sees the cycle of EX
+         latency              = load_latency(record.pc, record.address);
+      }
+      else if(record.opcode == SW || record.opcode == SWAP)
+         latency              = Data_Memory_Latency;
+      stalls                 += latency + (record.branch_op ? 2 : 0);   // and the 2 control stalls of a branch
+      if(record.dest_op)
+         ready[record.dest]   = exe + latency + 2;
+      if(record.opcode == EOP) {
+         cc_count             = exe + 2;
+         break;
+      }
+      fetch                   = record.branch_op ? exe + 1 : decode;
+      prev_exe                = exe;
+      prev_latency            = latency;
+   }
+   // the pipeline is left drained, with EOP in WB
+   stall_count                = stalls;
+   instCount                  = (int)records;
+   fetch_seq                  = records - 1;
+   sp_registers[IF][PC]       = replay->get(records - 1).pc;
+   instruction_register[WB]   = decode_record(records - 1);
+}
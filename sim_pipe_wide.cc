@@ -0,0 +1,196 @@
+#include "sim_pipe.h"
+
+//----------------------------------------------------------------------
+// Superscalar (N-wide) in-order core
+//
+// Every pipeline latch holds a group of up to issue_width instructions.
+// IF refills the group as instructions issue, never past a branch or
+// EOP. ID issues the group in order, stopping at the first instruction
+// with a RAW hazard (including on an earlier instruction of the same
+// group) or exceeding the per-cycle limits on loads/stores, other
+// operations and write-back ports; the rest of the group issues in
+// later cycles. Branches cost the same two stall cycles as in the
+// scalar pipeline and the memory latency stalls the whole group.
+//----------------------------------------------------------------------
+
+void sim_pipe::set_issue_width(unsigned width){
+   ASSERT( width > 0, "Unsupported issue width (=%d)", width );
+   ASSERT( num_mshrs == 0 && store_buffer_size == 0 && dram_model == NULL && fusion_idioms == 0 && fetch_queue_size == 0 && front_end.empty() && memory_pipe.empty() && contexts.empty(),
+           "MSHRs, the store buffer, the DRAM model, macro-op fusion, the fetch queue, deeper pipelines and hardware threads are only modelled by the scalar pipeline" );
+   issue_width       = width;
+   set_issue_limits(width, width, width);
+}
+
+void sim_pipe::set_issue_limits(unsigned mem_ops, unsigned alu_ops, unsigned wb_ports){
+   ASSERT( mem_ops > 0 && alu_ops > 0 && wb_ports > 0, "Unsupported issue limits (mem=%d, alu=%d, wb=%d)", mem_ops, alu_ops, wb_ports );
+   issue_mem_ops     = mem_ops;
+   issue_alu_ops     = alu_ops;
+   this->wb_ports    = wb_ports;
+   issue_histogram.assign(issue_width + 1, 0);
+}
+
+//----------------------------------------------------------------------
+// Refill the fetch group up to the issue width, never past a branch or
+// EOP
+//----------------------------------------------------------------------
+void sim_pipe::WIDE_IF(bool stall) {
+   if(stall)
+      return;
+   while(wide_latch[ID].size() < issue_width) {
+      if(!wide_latch[ID].empty() && (wide_latch[ID].back().instruction.branch_op || wide_latch[ID].back().instruction.opcode == EOP))
+         break;
+      wide_slot_t slot;
+      unsigned program_counter    = sp_registers[IF][PC];
+      slot.instruction            = index_instruction(program_counter);
+      slot.npc                    = program_counter + 4;
+      wide_latch[ID].push_back(slot);
+      if(slot.instruction.opcode != EOP)
+         sp_registers[IF][PC]     = program_counter + 4;
+   }
+}
+
+//----------------------------------------------------------------------
+// Issue the longest hazard-free prefix of the fetch group. Returns true
+// when IF must not fetch (branch unresolved or EOP issued)
+//----------------------------------------------------------------------
+bool sim_pipe::WIDE_ID() {
+   wide_latch[EX].clear();
+   if(wide_eop_issued)
+      return true;
+   if(wide_branch_in_ex) {
+      stall_count++;
+      return true;
+   }
+
+   unsigned issued = 0, mem_ops = 0, alu_ops = 0, writes = 0;
+   bool     branch = false;
+   while(issued < wide_latch[ID].size() && !branch) {
+      instruction_t& instruction = wide_latch[ID][issued].instruction;
+      ASSERT( instruction.opcode != SWAP, "SWAP is only modelled by the scalar pipeline" );
+      bool is_mem                = (instruction.opcode == LW || instruction.opcode == SW);
+      bool is_alu                = !is_mem && instruction.opcode != NOP && instruction.opcode != EOP;
+      if((instruction.src1_op && int_file[instruction.src1].busy) || (instruction.src2_op && int_file[instruction.src2].busy))
+         break;
+      if((is_mem && mem_ops == issue_mem_ops) || (is_alu && alu_ops == issue_alu_ops) || (instruction.dest_op && writes == wb_ports))
+         break;
+      if(instruction.dest_op)
+         int_file[instruction.dest].busy++;
+      mem_ops                   += is_mem;
+      alu_ops                   += is_alu;
+      writes                    += instruction.dest_op;
+      branch                     = instruction.branch_op;
+      wide_eop_issued            = (instruction.opcode == EOP);
+      wide_latch[EX].push_back(wide_latch[ID][issued++]);
+   }
+   wide_latch[ID].erase(wide_latch[ID].begin(), wide_latch[ID].begin() + issued);
+   issue_histogram[issued]++;
+
+   if((issued == 0 && !wide_latch[ID].empty()) || branch)
+      stall_count++;
+   return branch || wide_eop_issued;
+}
+
+//----------------------------------------------------------------------
+// Execute every instruction of the group, redirecting fetch on a taken
+// branch
+//----------------------------------------------------------------------
+void sim_pipe::WIDE_EXE() {
+   wide_branch_in_ex  = false;
+   for(unsigned i = 0; i < wide_latch[EX].size(); i++) {
+      wide_slot_t& slot          = wide_latch[EX][i];
+      instruction_t& instruction = slot.instruction;
+      int value                  = instruction.src1_op ? get_gp_register(instruction.src1) : 0;
+      bool cond                  = false;
+      switch(instruction.opcode) {
+         case ADD ... DIV:
+            slot.alu_output = alu(value, get_gp_register(instruction.src2), instruction.opcode);
+            break;
+         case ADDI ... ANDI:
+            slot.alu_output = alu(value, instruction.immediate, instruction.opcode);
+            break;
+         case LW:
+         case SW:
+            slot.alu_output = address_gen(instruction);
+            break;
+         case BEQZ: cond = value == 0; break;
+         case BNEZ: cond = value != 0; break;
+         case BLTZ: cond = value <  0; break;
+         case BGTZ: cond = value >  0; break;
+         case BLEZ: cond = value <= 0; break;
+         case BGEZ: cond = value >= 0; break;
+         case JUMP: cond = true;       break;
+         default: break;
+      }
+      if(instruction.branch_op) {
+         slot.alu_output         = alu(slot.npc, instruction.immediate, instruction.opcode);
+         wide_branch_in_ex       = true;
+         if(cond)
+            sp_registers[IF][PC] = slot.alu_output;
+      }
+   }
+   wide_latch[MEM]            = wide_latch[EX];
+   data_memory_latency_count  = 0;
+   for(unsigned i = 0; i < wide_latch[MEM].size(); i++) {
+      wide_slot_t& slot       = wide_latch[MEM][i];
+      if(slot.instruction.opcode == LW)
+         data_memory_latency_count = max(data_memory_latency_count, load_latency(slot.npc - 4, slot.alu_output));
+      else if(slot.instruction.opcode == SW)
+         data_memory_latency_count = max(data_memory_latency_count, Data_Memory_Latency);
+   }
+}
+
+//----------------------------------------------------------------------
+// Access data memory for the group: the whole group waits for the
+// memory latency if it holds a load or a store
+//----------------------------------------------------------------------
+bool sim_pipe::WIDE_MEM() {
+   bool has_mem = false;
+   for(unsigned i = 0; i < wide_latch[MEM].size(); i++) {
+      opcode_t opcode = wide_latch[MEM][i].instruction.opcode;
+      has_mem        |= (opcode == LW || opcode == SW);
+   }
+   if(has_mem && data_memory_latency_count > 0) {
+      data_memory_latency_count--;
+      stall_count++;
+      wide_latch[WB].clear();
+      return true;
+   }
+   for(unsigned i = 0; i < wide_latch[MEM].size(); i++) {
+      wide_slot_t& slot = wide_latch[MEM][i];
+      if(slot.instruction.opcode == LW)
+         slot.lmd       = read_memory(slot.alu_output);
+      else if(slot.instruction.opcode == SW)
+         write_memory(slot.alu_output, get_gp_register(slot.instruction.src2));
+   }
+   wide_latch[WB]       = wide_latch[MEM];
+   wide_latch[MEM].clear();
+   return false;
+}
+
+//----------------------------------------------------------------------
+// Write back the group in program order
+//----------------------------------------------------------------------
+bool sim_pipe::WIDE_WB() {
+   for(unsigned i = 0; i < wide_latch[WB].size(); i++) {
+      instruction_t& instruction = wide_latch[WB][i].instruction;
+      if(instruction.opcode == EOP)
+         return true;
+      if(instruction.dest_op)
+         set_gp_register(instruction.dest, (instruction.opcode == LW) ? wide_latch[WB][i].lmd : wide_latch[WB][i].alu_output);
+   }
+   wide_latch[WB].clear();
+   return false;
+}
+
+void sim_pipe::run_wide(unsigned cycles){
+   bool run_2_completion = (cycles == 0);
+   while(cycles-- || run_2_completion) {
+      if(WIDE_WB()) return;
+      if( !WIDE_MEM() ) {
+         WIDE_EXE();
+         bool stall = WIDE_ID();
+         WIDE_IF(stall);
+      }
+      cc_count++;
+   }
+}
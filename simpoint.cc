@@ -0,0 +1,236 @@
+#include "simpoint.h"
+#include <math.h>
+#include <limits.h>
+#include <random>
+#include <algorithm>
+
+using namespace std;
+
+simpoint::simpoint(unsigned interval, unsigned max_k, unsigned warmup, unsigned dimensions, unsigned seed, double bic_threshold){
+   ASSERT( interval > 0 && max_k > 0 && dimensions > 0, "Unsupported simulation points (interval=%d, clusters=%d, dimensions=%d)", interval, max_k, dimensions );
+   ASSERT( bic_threshold >= 0 && bic_threshold <= 1, "Unsupported BIC threshold (=%f)", bic_threshold );
+   this->interval                = interval;
+   this->max_k                   = max_k;
+   this->warmup                  = warmup;
+   this->dimensions              = dimensions;
+   this->seed                    = seed;
+   this->bic_threshold           = bic_threshold;
+   current_instructions          = 0;
+   block                         = UINT_MAX;
+   instructions                  = 0;
+   k                             = 0;
+   detailed_instructions         = 0;
+   detailed_cycles               = 0;
+}
+
+void simpoint::execute(unsigned pc, bool ends_block){
+   if(block == UINT_MAX)
+      block                      = pc;
+   current[block]++;
+   current_instructions++;
+   instructions++;
+   if(ends_block)
+      block                      = UINT_MAX;
+   if(current_instructions == interval) {
+      vectors.push_back(current);
+      current.clear();
+      current_instructions       = 0;
+   }
+}
+
+static bool earlier(const simpoint::point_t& a, const simpoint::point_t& b){
+   return a.interval < b.interval;
+}
+
+//----------------------------------------------------------------------
+// Clustering of the intervals and choice of the simulation points
+//----------------------------------------------------------------------
+void simpoint::select(){
+   ASSERT( !vectors.empty(), "No complete interval of %d instructions was profiled", interval );
+   // random projection: every basic block gets a row of values uniform in [-1, 1]
+   mt19937 generator(seed);
+   map<unsigned, vector<double> > projection;
+   projected.assign(vectors.size(), vector<double>(dimensions, 0));
+   for(unsigned i = 0; i < vectors.size(); i++) {
+      for(map<unsigned, unsigned>::iterator it = vectors[i].begin(); it != vectors[i].end(); it++) {
+         vector<double>& row     = projection[it->first];
+         for(unsigned d = row.size(); d < dimensions; d++)
+            row.push_back(2.0 * generator() / 4294967295.0 - 1);
+         for(unsigned d = 0; d < dimensions; d++)
+            projected[i][d]     += row[d] * it->second / interval;
+      }
+   }
+
+   // k-means for every number of clusters, keeping the smallest that scores close enough to the best BIC
+   unsigned clusterings          = min(max_k, (unsigned) vectors.size());
+   vector<vector<vector<double> > > centroids(clusterings);
+   vector<vector<unsigned> > clustering(clusterings);
+   bic.clear();
+   for(unsigned c = 0; c < clusterings; c++)
+      bic.push_back(kmeans(c + 1, centroids[c], clustering[c]));
+   double low                    = *min_element(bic.begin(), bic.end());
+   double high                   = *max_element(bic.begin(), bic.end());
+   unsigned chosen               = 0;
+   while(bic[chosen] < low + bic_threshold * (high - low))
+      chosen++;
+   k                             = chosen + 1;
+   assignment                    = clustering[chosen];
+
+   // every cluster is represented by the interval closest to its centroid
+   points.clear();
+   for(unsigned c = 0; c < k; c++) {
+      unsigned members           = 0;
+      unsigned closest           = 0;
+      for(unsigned i = 0; i < assignment.size(); i++) {
+         if(assignment[i] != c)
+            continue;
+         if(members++ == 0 || distance(projected[i], centroids[chosen][c]) < distance(projected[closest], centroids[chosen][c]))
+            closest              = i;
+      }
+      if(members == 0)
+         continue;
+      point_t point              = { closest, (unsigned) points.size(), (double) members / assignment.size(), 0 };
+      points.push_back(point);
+   }
+   sort(points.begin(), points.end(), earlier);
+}
+
+//----------------------------------------------------------------------
+// k-means of the projected intervals in "clusters" clusters, seeded by
+// the furthest-first heuristic from a random interval. Returns the BIC
+// of the clustering, as scored by X-means (spherical Gaussians sharing
+// one variance)
+//----------------------------------------------------------------------
+double simpoint::kmeans(unsigned clusters, vector<vector<double> >& centroids, vector<unsigned>& clustering){
+   unsigned n                    = projected.size();
+   mt19937 generator(seed + clusters);
+   centroids.assign(1, projected[generator() % n]);
+   while(centroids.size() < clusters) {
+      unsigned furthest          = 0;
+      double furthest_distance   = -1;
+      for(unsigned i = 0; i < n; i++) {
+         double nearest          = distance(projected[i], centroids[0]);
+         for(unsigned c = 1; c < centroids.size(); c++)
+            nearest              = min(nearest, distance(projected[i], centroids[c]));
+         if(nearest > furthest_distance) {
+            furthest             = i;
+            furthest_distance    = nearest;
+         }
+      }
+      centroids.push_back(projected[furthest]);
+   }
+
+   clustering.assign(n, UINT_MAX);
+   for(unsigned iteration = 0; iteration < 100; iteration++) {
+      bool changed               = false;
+      for(unsigned i = 0; i < n; i++) {
+         unsigned nearest        = 0;
+         for(unsigned c = 1; c < clusters; c++) {
+            if(distance(projected[i], centroids[c]) < distance(projected[i], centroids[nearest]))
+               nearest           = c;
+         }
+         changed                 = changed || clustering[i] != nearest;
+         clustering[i]           = nearest;
+      }
+      if(!changed)
+         break;
+      // an empty cluster keeps its centroid
+      vector<vector<double> > sums(clusters, vector<double>(dimensions, 0));
+      vector<unsigned> sizes(clusters, 0);
+      for(unsigned i = 0; i < n; i++) {
+         sizes[clustering[i]]++;
+         for(unsigned d = 0; d < dimensions; d++)
+            sums[clustering[i]][d] += projected[i][d];
+      }
+      for(unsigned c = 0; c < clusters; c++) {
+         for(unsigned d = 0; sizes[c] > 0 && d < dimensions; d++)
+            centroids[c][d]      = sums[c][d] / sizes[c];
+      }
+   }
+
+   vector<unsigned> sizes(clusters, 0);
+   double squares                = 0;
+   for(unsigned i = 0; i < n; i++) {
+      sizes[clustering[i]]++;
+      squares                   += distance(projected[i], centroids[clustering[i]]);
+   }
+   double variance               = (n > clusters) ? squares / (n - clusters) : 0;
+   variance                      = max(variance, 1e-12);
+   double likelihood             = 0;
+   for(unsigned c = 0; c < clusters; c++) {
+      if(sizes[c] == 0)
+         continue;
+      double size                = sizes[c];
+      likelihood                += size * log(size) - size * log((double) n) - size / 2 * log(2 * M_PI)
+                                   - size * dimensions / 2 * log(variance) - (size - clusters) / 2;
+   }
+   double parameters             = (clusters - 1) + dimensions * clusters + 1;
+   return likelihood - parameters / 2 * log((double) n);
+}
+
+// squared euclidean distance
+double simpoint::distance(const vector<double>& a, const vector<double>& b){
+   double sum                    = 0;
+   for(unsigned d = 0; d < a.size(); d++)
+      sum                       += (a[d] - b[d]) * (a[d] - b[d]);
+   return sum;
+}
+
+//----------------------------------------------------------------------
+// Simulation points statistics
+//----------------------------------------------------------------------
+unsigned simpoint::get_intervals(){
+   return vectors.size();
+}
+
+unsigned simpoint::get_clusters(){
+   return k;
+}
+
+unsigned long simpoint::get_start(const point_t& point){
+   return (unsigned long) point.interval * interval;
+}
+
+double simpoint::get_CPI(){
+   double cpi                    = 0;
+   for(unsigned p = 0; p < points.size(); p++)
+      cpi                       += points[p].weight * points[p].cpi;
+   return cpi;
+}
+
+double simpoint::get_clock_cycles(){
+   return get_CPI() * instructions;
+}
+
+unsigned long simpoint::get_instructions(){
+   return instructions;
+}
+
+double simpoint::get_detailed_fraction(){
+   return instructions ? (double) detailed_instructions / (double) instructions : 0;
+}
+
+void simpoint::print(){
+   printf("Simulation points = %u of %u intervals of %u instructions (%u clusters)\n", (unsigned) points.size(), get_intervals(), interval, k);
+   for(unsigned p = 0; p < points.size(); p++) {
+      printf("   interval %u (instruction %lu): weight = %.4f", points[p].interval, get_start(points[p]), points[p].weight);
+      if(detailed_instructions > 0)
+         printf(", CPI = %.4f", points[p].cpi);
+      printf("\n");
+   }
+   if(detailed_instructions > 0)
+      printf("Estimated CPI = %.4f, instructions = %lu (%.2f%% in detail), estimated clock cycles = %.0f\n", get_CPI(), instructions,
+             100 * get_detailed_fraction(), get_clock_cycles());
+}
+
+void simpoint::write(const char *points_file, const char *weights_file){
+   FILE *points_out              = fopen(points_file, "w");
+   FILE *weights_out             = fopen(weights_file, "w");
+   ASSERT( points_out != NULL && weights_out != NULL, "Cannot write the simulation points to %s and %s", points_file, weights_file );
+   for(unsigned p = 0; p < points.size(); p++) {
+      fprintf(points_out, "%u %u\n", points[p].interval, points[p].cluster);
+      fprintf(weights_out, "%f %u\n", points[p].weight, points[p].cluster);
+   }
+   fclose(points_out);
+   fclose(weights_out);
+}
@@ -0,0 +1,106 @@
+#ifndef SIMPOINT_H_
+#define SIMPOINT_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+#include <map>
+
+#include "sim_assert.h"
+
+//----------------------------------------------------------------------
+// Representative simulation points of a program run, shared by the
+// integer and floating point simulators
+//
+// Profiling runs the program functionally and splits it into intervals
+// of "interval" instructions. For each interval it records a basic
+// block vector: how many instructions of the interval each basic block
+// executed. Blocks end at the instructions flagged as branches, and are
+// named by the PC of their first instruction. The vectors are
+// normalised and reduced by a random projection to "dimensions"
+// dimensions. They are then clustered by k-means for every number of
+// clusters up to "max_k", and the smallest clustering whose Bayesian
+// information criterion (BIC) scores within "bic_threshold" of the best
+// one is kept. Each cluster is represented by the interval closest to
+// its centroid, weighted by the fraction of the intervals in the
+// cluster. The program's CPI is estimated by the weighted CPI of the
+// points simulated in detail, each after "warmup" instructions (fewer
+// at the start of the program) that bring the pipeline from empty to a
+// representative state. NOPs are not counted as instructions (as in
+// sampler.h), and a last partial interval is not clustered.
+//----------------------------------------------------------------------
+class simpoint{
+
+   public:
+
+      // Simulation point
+      struct point_t{
+         unsigned       interval;                 // index of the interval of the program
+         unsigned       cluster;
+         double         weight;                   // fraction of the intervals in its cluster
+         double         cpi;                      // measured by the detailed simulation (0 before)
+      };
+
+      unsigned          interval;
+      unsigned          max_k;
+      unsigned          warmup;
+      unsigned          dimensions;
+      unsigned          seed;
+      double            bic_threshold;
+
+      // profiling
+      std::vector<std::map<unsigned, unsigned> > vectors;   // basic block vector of every interval
+      std::map<unsigned, unsigned> current;
+      unsigned          current_instructions;
+      unsigned          block;                    // PC of the first instruction of the current block
+      unsigned long     instructions;
+
+      // clustering
+      std::vector<std::vector<double> > projected;           // projected vector of every interval
+      std::vector<unsigned> assignment;           // cluster of every interval
+      std::vector<double> bic;                    // BIC of the clustering in 1..max_k clusters
+      unsigned          k;
+      std::vector<point_t> points;                // by interval
+
+      // detailed simulation
+      unsigned long     detailed_instructions;
+      unsigned long     detailed_cycles;          // pipeline warm-up and drain included
+
+   public:
+
+      simpoint(unsigned interval, unsigned max_k=10, unsigned warmup=1000, unsigned dimensions=15, unsigned seed=1, double bic_threshold=0.9);
+
+      //profiling: the instruction at "pc" executed, and ends its basic block if "ends_block"
+      void     execute(unsigned pc, bool ends_block);
+
+      //clusters the intervals profiled and chooses the simulation points
+      void     select();
+      double   kmeans(unsigned clusters, std::vector<std::vector<double> >& centroids, std::vector<unsigned>& clustering);
+      double   distance(const std::vector<double>& a, const std::vector<double>& b);
+
+      //returns the number of intervals profiled, and the number of clusters chosen
+      unsigned get_intervals();
+      unsigned get_clusters();
+
+      //returns the instruction a point's interval starts at
+      unsigned long get_start(const point_t& point);
+
+      //returns the estimated CPI of the program (weighted CPI of the points)
+      double   get_CPI();
+
+      //returns the estimated clock cycles of the program (estimated CPI times the instructions it executed)
+      double   get_clock_cycles();
+
+      //returns the number of instructions executed by the program, and the fraction simulated in detail
+      unsigned long get_instructions();
+      double   get_detailed_fraction();
+
+      //prints the points with their weights and, once simulated, the estimate
+      void     print();
+
+      //writes the points and their weights in the format of SimPoint ("<interval> <cluster>" and "<weight> <cluster>"
+      //lines)
+      void     write(const char *points_file, const char *weights_file);
+};
+
+#endif /*SIMPOINT_H_*/
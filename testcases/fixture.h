@@ -0,0 +1,116 @@
+#ifndef FIXTURE_H_
+#define FIXTURE_H_
+
+#include <iostream>
+#include <cstring>
+#include <algorithm>
+
+using namespace std;
+
+/* Fixture of the test cases comparing a run of the simulator using a feature with the plain run of the same
+   program: the configurations of the memory and of the pipeline, the program with its array of elements, the
+   registers of the reductions and the comparison of the results. To be included after sim_pipe.h or sim_pipe_fp.h */
+
+#ifdef SIM_PIPE_FP_H_
+typedef sim_pipe_fp simulator_t;
+#else
+typedef sim_pipe simulator_t;
+#endif
+
+/* address of the array of elements */
+#define ARRAY_BASE 0xA000
+
+/* number of entries of the configs table of the test case */
+#define NUM_CONFIGS (sizeof(configs) / sizeof(config_t))
+
+/* configuration of a run; a 0 leaves the default of the simulator */
+struct config_t {
+	unsigned latency;       // data memory latency
+	unsigned prefetch;      // prefetcher (with a degree of 2)
+	bool     dram;          // DRAM model behind the data memory
+	unsigned mshrs;
+	unsigned fusion;        // macro-op fusion idioms
+	unsigned queue_size;    // fetch queue entries (with a fetch width of 1)
+	unsigned depth;         // fetch and decode stages
+	unsigned mem_stages;
+	unsigned renaming;      // physical registers of each file (sim_pipe_fp only)
+};
+
+/* convert a float into an unsigned */
+inline unsigned float2unsigned(float value){
+	unsigned result;
+	memcpy(&result, &value, sizeof value);
+	return result;
+}
+
+/* a simulator with the configuration, the program at 0x10000000 and the array of elements at ARRAY_BASE, with
+   values cycling through 0..49 (multiplied by 0.25 as floats for sim_pipe_fp) */
+inline simulator_t *setup(const config_t &config, const char *filename, unsigned elements){
+	unsigned i, j;
+	simulator_t *mips = new simulator_t(1024*1024, config.latency);
+#ifdef SIM_PIPE_FP_H_
+	mips->init_exec_unit(INTEGER, 1, 1);
+	mips->init_exec_unit(ADDER, 2, 1);
+	mips->init_exec_unit(MULTIPLIER, 6, 1);
+	mips->init_exec_unit(DIVIDER, 20, 1);
+#endif
+	if (config.prefetch != 0) mips->set_prefetcher(config.prefetch, 2);
+	if (config.dram) mips->set_dram(1, 4, 256, OPEN_PAGE, 4, 4, 4);
+	if (config.mshrs > 0) mips->set_mshrs(config.mshrs);
+	if (config.fusion != 0) mips->set_fusion(config.fusion);
+	if (config.queue_size > 0) mips->set_fetch_queue(config.queue_size, 1);
+	if (config.depth > 1 || config.mem_stages > 1)
+		mips->set_pipeline_depth(max(config.depth, 1u), max(config.depth, 1u), max(config.mem_stages, 1u));
+#ifdef SIM_PIPE_FP_H_
+	if (config.renaming > 0) mips->set_register_renaming(config.renaming, config.renaming);
+#endif
+	mips->load_program(filename, 0x10000000);
+#ifdef SIM_PIPE_FP_H_
+	for (i = ARRAY_BASE, j=10; i<ARRAY_BASE+4*elements; i+=4, j=(j*7+3)%50) mips->write_memory(i, float2unsigned(j * 0.25));
+#else
+	for (i = ARRAY_BASE, j=10; i<ARRAY_BASE+4*elements; i+=4, j=(j*7+3)%50) mips->write_memory(i, j);
+#endif
+	return mips;
+}
+
+/* registers of the reductions (asm/reduce.asm, asm/sort.asm, asm/codefp11.asm): the array in R1, the address of the
+   result in R2 and the number of elements in R7; asm/codefp11.asm also takes the address of the lock guarding the
+   result in R8, and both start at 0 */
+inline void set_reduction(simulator_t *mips, unsigned result, unsigned elements){
+#ifdef SIM_PIPE_FP_H_
+	mips->write_memory(result, float2unsigned(0.0));
+	mips->write_memory(result + 4, 0);
+	mips->set_int_register(1, ARRAY_BASE);
+	mips->set_int_register(2, result);
+	mips->set_int_register(7, elements);
+	mips->set_int_register(8, result + 4);
+#else
+	mips->set_gp_register(1, ARRAY_BASE);
+	mips->set_gp_register(2, result);
+	mips->set_gp_register(7, elements);
+#endif
+}
+
+/* whether two runs end with the same registers and the same words of memory in [from, to) */
+inline bool same_results(simulator_t *a, simulator_t *b, unsigned from, unsigned to){
+	bool match = true;
+	for (unsigned r=0; r<NUM_GP_REGISTERS; r++) {
+#ifdef SIM_PIPE_FP_H_
+		match = match && a->get_int_register(r) == b->get_int_register(r);
+		match = match && float2unsigned(a->get_fp_register(r)) == float2unsigned(b->get_fp_register(r));
+#else
+		match = match && a->get_gp_register(r) == b->get_gp_register(r);
+#endif
+	}
+	for (unsigned address=from; address<to; address+=4) match = match && a->read_memory(address) == b->read_memory(address);
+	return match;
+}
+
+/* the statistics of the full simulation an estimate is compared to */
+inline void print_full(simulator_t *full){
+	double cpi = (double) full->get_clock_cycles() / full->get_instructions_executed();
+	cout << "Full simulation: clock cycles = " << dec << full->get_clock_cycles() << ", instructions = " << full->get_instructions_executed();
+	cout << ", CPI = " << cpi << endl;
+}
+
+#endif /*FIXTURE_H_*/
@@ -0,0 +1,60 @@
+#include "sim_pipe.h"
+#include <iostream>
+#include <stdlib.h>
+
+using namespace std;
+
+/* Test case for the DRAM timing model */
+
+int main(int argc, char **argv){
+
+	unsigned i, j;
+
+	// instantiates the simulator with a 1MB data memory
+	sim_pipe *mips = new sim_pipe(1024*1024, 10);
+
+	// one channel with two banks of 32-byte rows, open-page policy, tRCD=3 tCAS=2 tRP=3
+	mips->set_dram(1, 2, 32, OPEN_PAGE, 3, 2, 3);
+	mips->set_mshrs(2);
+	mips->set_store_buffer(2);
+
+	//loads program in instruction memory at address 0x10000000
+	mips->load_program("asm/code.asm", 0x10000000);
+
+	//initialize data memory and prints its content (for the specified address ranges)
+	for (i = 0xA000, j=1; i<0xA020; i+=4, j+=1) mips->write_memory(i,j);
+	
+	cout << "\nBEFORE PROGRAM EXECUTION..." << endl;
+	cout << "======================================================================" << endl << endl;
+	
+	//prints the value of the memory and registers
+	mips->print_registers();
+	mips->print_memory(0xA000, 0xA028);
+	mips->print_memory(0xB000, 0xB028);
+
+	// runs program to completion
+	cout << "EXECUTING PROGRAM TO COMPLETION..." << endl << endl;
+	mips->run(); 
+
+	cout << "PROGRAM TERMINATED\n";
+	cout << "===================" << endl << endl;
+
+	//prints the value of registers and data memory
+	mips->print_registers();
+	mips->print_memory(0xA000, 0xA028);
+	mips->print_memory(0xB000, 0xB028);
+	
+	cout << endl;
+
+	// prints the number of instructions executed and IPC
+	cout << "Instruction executed = " << dec << mips->get_instructions_executed() << endl;
+	cout << "Clock cycles = " << dec << mips->get_clock_cycles() << endl;
+	cout << "Stall inserted = " << dec  << mips->get_stalls() << endl;
+	cout << "IPC = " << dec << mips->get_IPC() << endl;
+	cout << "DRAM row hits = " << mips->get_dram_row_hits() << endl;
+	cout << "DRAM row misses = " << mips->get_dram_row_misses() << endl;
+	cout << "DRAM row conflicts = " << mips->get_dram_row_conflicts() << endl;
+	cout << "DRAM average latency = " << mips->get_dram_avg_latency() << endl;
+
+	delete mips;
+}
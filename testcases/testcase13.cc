@@ -0,0 +1,70 @@
+#include "sim_pipe.h"
+#include <iostream>
+#include <stdlib.h>
+
+using namespace std;
+
+/* Test case for a deeper pipeline: two fetch, two decode and two memory stages */
+
+int main(int argc, char **argv){
+
+	unsigned i, j;
+
+	// instantiates the simulator with a 1MB data memory
+	sim_pipe *mips = new sim_pipe(1024*1024, 2);
+
+	// every branch waits two more cycles for the front-end to refill, every result reaches write-back one cycle later
+	mips->set_pipeline_depth(2, 2, 2);
+
+	//loads program in instruction memory at address 0x10000000
+	mips->load_program("asm/sort.asm", 0x10000000);
+
+	//initialize data memory and prints its content (for the specified address ranges)
+	for (i = 0xA000, j=10; i<0xA028; i+=4, j=(j*7+3)%50) mips->write_memory(i,j);
+	
+	cout << "\nBEFORE PROGRAM EXECUTION..." << endl;
+	cout << "======================================================================" << endl << endl;
+	
+	//prints the value of the memory and registers
+	mips->print_registers();
+	mips->print_memory(0xA000, 0xA028);
+	mips->print_memory(0xB000, 0xB028);
+
+	// executes the program	
+	cout << "\n*****************************" << endl;
+	cout << "STARTING THE PROGRAM..." << endl;
+	cout << "*****************************" << endl << endl;
+
+	// first 20 clock cycles
+	cout << "First 20 clock cycles: inspecting the registers at each clock cycle..." << endl;
+	cout << "======================================================================" << endl << endl;
+
+	for (i=0; i<20; i++){
+		cout << "CLOCK CYCLE #" << dec << i << endl;
+		mips->run(1);
+		mips->print_registers();
+		cout << endl;
+	}
+
+	// runs program to completion
+	cout << "EXECUTING PROGRAM TO COMPLETION..." << endl << endl;
+	mips->run(); 
+
+	cout << "PROGRAM TERMINATED\n";
+	cout << "===================" << endl << endl;
+
+	//prints the value of registers and data memory
+	mips->print_registers();
+	mips->print_memory(0xA000, 0xA028);
+	mips->print_memory(0xB000, 0xB028);
+	
+	cout << endl;
+
+	// prints the number of instructions executed and IPC
+	cout << "Instruction executed = " << dec << mips->get_instructions_executed() << endl;
+	cout << "Clock cycles = " << dec << mips->get_clock_cycles() << endl;
+	cout << "Stall inserted = " << dec  << mips->get_stalls() << endl;
+	cout << "IPC = " << dec << mips->get_IPC() << endl;
+
+	delete mips;
+}
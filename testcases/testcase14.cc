@@ -0,0 +1,61 @@
+#include "sim_pipe.h"
+#include <iostream>
+#include <stdlib.h>
+
+using namespace std;
+
+/* Test case for the multithreaded core: four threads summing their own array with a 10-cycle data memory */
+
+const char *policy_names[] = {"ROUND_ROBIN", "SWITCH_ON_STALL", "SIMULTANEOUS"};
+
+void run_threads(unsigned threads, thread_policy_t policy, unsigned issue_slots){
+
+	unsigned i, t;
+
+	// instantiates the simulator with a 1MB data memory
+	sim_pipe *mips = new sim_pipe(1024*1024, 10);
+
+	// "threads" hardware threads, switching threads costs 2 cycles
+	mips->set_threads(threads, policy, issue_slots, 2);
+
+	//loads the program of every thread at address 0x10000000 of its instruction memory: thread t sums the
+	//16 words at 0xA000 + 0x100*t and stores the sum at 0xB000 + 4*t
+	for (t=0; t<threads; t++){
+		mips->load_program("asm/reduce.asm", 0x10000000, t);
+		mips->set_gp_register(1, 0xA000 + 0x100*t, t);
+		mips->set_gp_register(2, 0xB000 + 4*t, t);
+		mips->set_gp_register(7, 16, t);
+	}
+
+	//initialize data memory
+	for (i = 0xA000; i<0xA400; i+=4) mips->write_memory(i, (i/4)%13);
+
+	// runs program to completion
+	mips->run();
+
+	cout << dec << threads << " thread(s), " << policy_names[policy] << ", " << issue_slots << " issue slot(s)" << endl;
+	cout << "======================================================================" << endl;
+	mips->print_memory(0xB000, 0xB010);
+	for (t=0; t<threads; t++){
+		cout << "Thread " << dec << t << ": R3 = " << mips->get_gp_register(3, t) << ", instructions = " << mips->get_thread_instructions(t);
+		cout << ", clock cycles = " << mips->get_thread_cycles(t) << ", IPC = " << mips->get_thread_IPC(t) << endl;
+	}
+	cout << "Instruction executed = " << dec << mips->get_instructions_executed() << endl;
+	cout << "Clock cycles = " << dec << mips->get_clock_cycles() << endl;
+	cout << "Stall inserted = " << dec  << mips->get_stalls() << endl;
+	cout << "IPC = " << dec << mips->get_IPC() << endl;
+	cout << "Thread switches = " << dec << mips->get_thread_switches() << endl << endl;
+
+	delete mips;
+}
+
+int main(int argc, char **argv){
+
+	// a single thread waits for every load
+	run_threads(1, ROUND_ROBIN, 1);
+
+	// the other threads issue while a thread waits for data memory
+	run_threads(4, ROUND_ROBIN, 1);
+	run_threads(4, SWITCH_ON_STALL, 1);
+	run_threads(4, SIMULTANEOUS, 2);
+}
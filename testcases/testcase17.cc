@@ -0,0 +1,84 @@
+#include "sim_pipe.h"
+#include <iostream>
+#include <stdlib.h>
+#include <thread>
+
+using namespace std;
+
+/* Test case for trace-driven replay: the sort program is recorded once, then replayed under several timing
+   configurations on host threads; every replay takes the same clock cycles as running the program */
+
+#define NUM_CONFIGS 8
+
+const char *config_names[NUM_CONFIGS] = {"latency 2", "latency 10", "latency 0", "stride prefetcher", "store buffer",
+                                         "fusion", "fetch queue", "deep pipeline"};
+
+unsigned cycles[NUM_CONFIGS], stalls[NUM_CONFIGS], instructions[NUM_CONFIGS];
+
+sim_pipe *build(unsigned config){
+	sim_pipe *mips = new sim_pipe(1024*1024, (config == 1) ? 10 : (config == 2) ? 0 : 2);
+	switch(config){
+		case 3: mips->set_prefetcher(PREFETCH_STRIDE, 2); break;
+		case 4: mips->set_store_buffer(4); break;
+		case 5: mips->set_fusion(FUSE_COMPARE_BRANCH | FUSE_INCREMENT_LOAD); break;
+		case 6: mips->set_fetch_queue(4); break;
+		case 7: mips->set_pipeline_depth(2, 2, 1); break;
+		default: break;
+	}
+	return mips;
+}
+
+void replay(trace *stream, unsigned config){
+	sim_pipe *mips = build(config);
+	mips->load_trace(stream);
+	mips->run();
+	cycles[config]       = mips->get_clock_cycles();
+	stalls[config]       = mips->get_stalls();
+	instructions[config] = mips->get_instructions_executed();
+	delete mips;
+}
+
+void init_memory(sim_pipe *mips){
+	unsigned i, j;
+	for (i = 0xA000, j=10; i<0xA028; i+=4, j=(j*7+3)%50) mips->write_memory(i,j);
+}
+
+int main(int argc, char **argv){
+
+	unsigned c;
+
+	// records the dynamic instruction stream of the program, which leaves the sorted array in memory
+	trace stream;
+	sim_pipe *recorder = new sim_pipe(1024*1024, 2);
+	recorder->load_program("asm/sort.asm", 0x10000000);
+	init_memory(recorder);
+	recorder->record_trace(&stream);
+
+	cout << "Trace records = " << dec << stream.size() << endl;
+	recorder->print_memory(0xB000, 0xB028);
+	cout << endl;
+	delete recorder;
+
+	// replays the trace under every configuration, one host thread each
+	vector<thread> workers;
+	for (c=0; c<NUM_CONFIGS; c++)
+		workers.push_back(thread(replay, &stream, c));
+	for (c=0; c<NUM_CONFIGS; c++)
+		workers[c].join();
+
+	// runs the program under every configuration
+	for (c=0; c<NUM_CONFIGS; c++){
+		sim_pipe *mips = build(c);
+		mips->load_program("asm/sort.asm", 0x10000000);
+		init_memory(mips);
+		mips->run();
+
+		cout << config_names[c] << endl;
+		cout << "======================================================================" << endl;
+		cout << "Program: instructions = " << dec << mips->get_instructions_executed() << ", clock cycles = " << mips->get_clock_cycles();
+		cout << ", stalls = " << mips->get_stalls() << endl;
+		cout << "Replay:  instructions = " << dec << instructions[c] << ", clock cycles = " << cycles[c];
+		cout << ", stalls = " << stalls[c] << endl << endl;
+		delete mips;
+	}
+}
@@ -0,0 +1,91 @@
+#include "sim_pipe.h"
+#include <iostream>
+#include <stdlib.h>
+#include <thread>
+
+using namespace std;
+
+/* Test case for trace files: the sort program is recorded into a compressed trace file, whose records are checked
+   against the trace held in memory in a scattered order, then the file is streamed to replays on host threads */
+
+#define NUM_CONFIGS 3
+
+unsigned latencies[NUM_CONFIGS] = {2, 10, 0};
+unsigned cycles[NUM_CONFIGS], stalls[NUM_CONFIGS];
+
+void init_memory(sim_pipe *mips){
+	unsigned i, j;
+	for (i = 0xA000, j=10; i<0xA028; i+=4, j=(j*7+3)%50) mips->write_memory(i,j);
+}
+
+void record(trace *stream){
+	sim_pipe *recorder = new sim_pipe(1024*1024, 2);
+	recorder->load_program("asm/sort.asm", 0x10000000);
+	init_memory(recorder);
+	recorder->record_trace(stream);
+	delete recorder;
+}
+
+bool same(const trace_record_t& a, const trace_record_t& b){
+	return a.pc == b.pc && a.opcode == b.opcode && a.dest == b.dest && a.src1 == b.src1 && a.src2 == b.src2 &&
+	       a.immediate == b.immediate && a.dest_op == b.dest_op && a.src1_op == b.src1_op && a.src2_op == b.src2_op &&
+	       a.branch_op == b.branch_op && a.taken == b.taken && a.address == b.address && a.a == b.a && a.b == b.b;
+}
+
+void replay(unsigned config){
+	// every replay streams the file through a reader of its own
+	trace stream;
+	stream.open("testcase18.trc");
+	sim_pipe *mips = new sim_pipe(1024*1024, latencies[config]);
+	mips->load_trace(&stream);
+	mips->run();
+	cycles[config] = mips->get_clock_cycles();
+	stalls[config] = mips->get_stalls();
+	delete mips;
+}
+
+int main(int argc, char **argv){
+
+	unsigned i, c, mismatches = 0;
+
+	// records the program in memory, and into a trace file of 64-record chunks
+	trace reference, stream;
+	record(&reference);
+	stream.create("testcase18.trc", 64);
+	record(&stream);
+	stream.close();
+
+	cout << "Trace records = " << dec << reference.size() << endl;
+	cout << "In-memory bytes = " << dec << reference.size() * sizeof(trace_record_t) << endl;
+	cout << "Trace file bytes = " << dec << stream.get_file_bytes() << endl;
+	cout << "Bytes per record = " << dec << (float)stream.get_file_bytes() / reference.size() << endl;
+
+	// seeks the records of the file out of order
+	stream.open("testcase18.trc");
+	for (i = 0; i < stream.size(); i++){
+		unsigned index = (i * 97) % stream.size();
+		mismatches += !same(stream.get(index), reference.get(index));
+	}
+	cout << "Records read back = " << dec << stream.size() << ", mismatches = " << mismatches << endl << endl;
+	stream.close();
+
+	// streams the file to replays under several memory latencies, one host thread each
+	vector<thread> workers;
+	for (c=0; c<NUM_CONFIGS; c++)
+		workers.push_back(thread(replay, c));
+	for (c=0; c<NUM_CONFIGS; c++)
+		workers[c].join();
+
+	for (c=0; c<NUM_CONFIGS; c++){
+		sim_pipe *mips = new sim_pipe(1024*1024, latencies[c]);
+		mips->load_trace(&reference);
+		mips->run();
+		cout << "Memory latency " << dec << latencies[c] << endl;
+		cout << "======================================================================" << endl;
+		cout << "In-memory trace: clock cycles = " << dec << mips->get_clock_cycles() << ", stalls = " << mips->get_stalls() << endl;
+		cout << "Trace file:      clock cycles = " << dec << cycles[c] << ", stalls = " << stalls[c] << endl << endl;
+		delete mips;
+	}
+
+	remove("testcase18.trc");
+}
@@ -0,0 +1,75 @@
+#include "sim_pipe.h"
+#include <iostream>
+#include <stdlib.h>
+
+using namespace std;
+
+/* Test case for object files: the sort program is assembled with its input array as initialised data, then the
+   object file is loaded (with no memory set up by the test case) and checked against the assembly program, both
+   instruction by instruction and by running them under two memory latencies */
+
+#define NUM_CONFIGS 2
+
+unsigned latencies[NUM_CONFIGS] = {2, 10};
+
+void init_memory(sim_pipe *mips){
+	unsigned i, j;
+	for (i = 0xA000, j=10; i<0xA028; i+=4, j=(j*7+3)%50) mips->write_memory(i,j);
+}
+
+bool same(const instruction_t& a, const instruction_t& b){
+	return a.opcode == b.opcode && a.dest == b.dest && a.src1 == b.src1 && a.src2 == b.src2 && a.immediate == b.immediate &&
+	       a.dest_op == b.dest_op && a.src1_op == b.src1_op && a.src2_op == b.src2_op && a.branch_op == b.branch_op;
+}
+
+int main(int argc, char **argv){
+
+	unsigned i, c, mismatches = 0;
+
+	// assembles the program, with the array to sort as its data
+	sim_pipe *text = new sim_pipe(1024*1024, 2);
+	text->load_program("asm/sort.asm", 0x10000000);
+	init_memory(text);
+	text->assemble("asm/sort.asm", "testcase19.obj", 0xA000, 0xA028);
+
+	program object;
+	object.map("testcase19.obj");
+	cout << "Instructions = " << dec << object.text_count << ", literals = " << object.pool_count;
+	cout << ", object file bytes = " << object.mapping_bytes << endl;
+	cout << "Symbols:";
+	for (i = 0; i < object.symbols.size(); i++)
+		cout << " " << object.symbols[i].name << "=" << dec << object.symbols[i].index;
+	cout << endl;
+	cout << "Data segment: 0x" << hex << object.data[0].address << ", " << dec << object.data[0].words.size() << " words" << endl;
+
+	// decodes the object file, to compare it with the assembly program
+	sim_pipe *binary = new sim_pipe(1024*1024, 2);
+	binary->load_program("testcase19.obj", 0x10000000);
+	for (i = 0; i < object.text_count; i++)
+		mismatches += !same(*text->instruct_memory[i], *binary->instruct_memory[i]);
+	cout << "Instructions decoded = " << dec << object.text_count << ", mismatches = " << mismatches << endl << endl;
+	delete text;
+	delete binary;
+
+	for (c=0; c<NUM_CONFIGS; c++){
+		sim_pipe *mips = new sim_pipe(1024*1024, latencies[c]);
+		mips->load_program("asm/sort.asm", 0x10000000);
+		init_memory(mips);
+		mips->run();
+
+		sim_pipe *loaded = new sim_pipe(1024*1024, latencies[c]);
+		loaded->load_program("testcase19.obj", 0x10000000);
+		loaded->run();
+
+		cout << "Memory latency " << dec << latencies[c] << endl;
+		cout << "======================================================================" << endl;
+		cout << "Assembly:    clock cycles = " << dec << mips->get_clock_cycles() << ", stalls = " << mips->get_stalls() << endl;
+		cout << "Object file: clock cycles = " << dec << loaded->get_clock_cycles() << ", stalls = " << loaded->get_stalls() << endl;
+		loaded->print_memory(0xB000, 0xB028);
+		cout << endl;
+		delete mips;
+		delete loaded;
+	}
+
+	remove("testcase19.obj");
+}
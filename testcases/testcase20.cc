@@ -0,0 +1,55 @@
+#include "sim_pipe.h"
+#include "fixture.h"
+
+/* Test case for steady-state extrapolation of loops: the reduction of a 1000-element array and the sort program run
+   under several pipeline configurations, simulated in full and with the extrapolation, which must give the same
+   clock cycles, stalls, instructions and results */
+
+#define NUM_ELEMENTS 1000
+
+/* latency, prefetcher, DRAM, MSHRs, fusion, fetch queue, depth, memory stages */
+config_t configs[] = {{2,  0, false, 0, 0,                                         0, 0, 1},
+                      {10, 0, false, 0, 0,                                         0, 0, 1},
+                      {2,  0, false, 0, FUSE_COMPARE_BRANCH | FUSE_INCREMENT_LOAD, 0, 0, 1},
+                      {3,  0, false, 0, 0,                                         4, 0, 1},
+                      {4,  0, false, 0, FUSE_COMPARE_BRANCH,                       0, 0, 2}};
+
+sim_pipe *setup(const char *filename, unsigned c, bool steady){
+	sim_pipe *mips = setup(configs[c], filename, NUM_ELEMENTS);
+	mips->set_steady_state(steady);
+	set_reduction(mips, 0xB000, NUM_ELEMENTS);
+	return mips;
+}
+
+void compare(const char *filename, unsigned c, unsigned result_end){
+	sim_pipe *full = setup(filename, c, false);
+	full->run();
+	sim_pipe *steady = setup(filename, c, true);
+	steady->run();
+
+	cout << filename << ": memory latency " << dec << configs[c].latency << ", fusion " << configs[c].fusion << ", fetch queue " << configs[c].queue_size;
+	cout << ", memory stages " << configs[c].mem_stages << endl;
+	cout << "======================================================================" << endl;
+	cout << "Full simulation: clock cycles = " << dec << full->get_clock_cycles() << ", stalls = " << full->get_stalls();
+	cout << ", instructions = " << full->get_instructions_executed() << endl;
+	cout << "Extrapolated:    clock cycles = " << dec << steady->get_clock_cycles() << ", stalls = " << steady->get_stalls();
+	cout << ", instructions = " << steady->get_instructions_executed() << endl;
+	steady->print_steady_state();
+	cout << "Iterations extrapolated = " << dec << steady->get_extrapolated_iterations() << ", cycles = " << steady->get_extrapolated_cycles() << endl;
+	cout << "Results match = " << same_results(full, steady, 0xB000, result_end) << endl;
+	steady->print_memory(0xB000, result_end);
+	cout << endl;
+	delete full;
+	delete steady;
+}
+
+int main(int argc, char **argv){
+
+	unsigned c;
+
+	for (c=0; c<NUM_CONFIGS; c++)
+		compare("asm/reduce.asm", c, 0xB004);
+
+	for (c=0; c<NUM_CONFIGS; c++)
+		compare("asm/sort.asm", c, 0xB028);
+}
@@ -0,0 +1,44 @@
+#include "sim_pipe.h"
+#include "fixture.h"
+
+/* Test case for sampled simulation: the reduction of a 20000-element array runs under several memory and pipeline
+   configurations, simulated in full and sampled (detailed units separated by functional execution, which warms the
+   prefetcher and the DRAM rows); the sampled CPI must estimate the full one, with the same results */
+
+#define NUM_ELEMENTS 20000
+
+/* latency, prefetcher, DRAM, MSHRs, fusion, fetch queue */
+config_t configs[] = {{2,  0,               false, 0, 0,                                         0},
+                      {10, 0,               false, 0, 0,                                         0},
+                      {10, PREFETCH_STRIDE, false, 0, 0,                                         0},
+                      {2,  0,               true,  0, 0,                                         0},
+                      {4,  0,               false, 0, FUSE_COMPARE_BRANCH | FUSE_INCREMENT_LOAD, 4}};
+
+sim_pipe *setup(unsigned c){
+	sim_pipe *mips = setup(configs[c], "asm/reduce.asm", NUM_ELEMENTS);
+	set_reduction(mips, 0x90000, NUM_ELEMENTS);
+	return mips;
+}
+
+int main(int argc, char **argv){
+
+	for (unsigned c=0; c<NUM_CONFIGS; c++) {
+		sim_pipe *full = setup(c);
+		full->run();
+		sim_pipe *sampled = setup(c);
+		sampler sampling(1000, 100, 200);
+		sampled->sample(&sampling);
+
+		cout << "asm/reduce.asm: memory latency " << dec << configs[c].latency << ", prefetcher " << configs[c].prefetch << ", DRAM " << configs[c].dram;
+		cout << ", fusion " << configs[c].fusion << ", fetch queue " << configs[c].queue_size << endl;
+		cout << "======================================================================" << endl;
+		print_full(full);
+		sampling.print();
+		cout << "Estimate error = " << 100 * (sampling.get_clock_cycles() - full->get_clock_cycles()) / full->get_clock_cycles() << "%" << endl;
+		cout << "Results match = " << same_results(full, sampled, 0x90000, 0x90004) << endl;
+		sampled->print_memory(0x90000, 0x90004);
+		cout << endl;
+		delete full;
+		delete sampled;
+	}
+}
@@ -0,0 +1,63 @@
+#include "sim_pipe.h"
+#include "fixture.h"
+#include <fstream>
+
+/* Test case for simulation points: a program alternating between a memory-bound reduction and an ALU loop is
+   profiled into basic block vectors of 1000-instruction intervals, which are clustered into simulation points; the
+   program is then run simulating only the points in detail, and the weighted CPI must estimate the full simulation,
+   with the same results */
+
+#define NUM_ELEMENTS 3000
+
+/* latency, prefetcher */
+config_t configs[] = {{2,  0},
+                      {10, 0},
+                      {10, PREFETCH_STRIDE}};
+
+sim_pipe *setup(unsigned c){
+	sim_pipe *mips = setup(configs[c], "asm/phases.asm", NUM_ELEMENTS);
+	mips->set_gp_register(2, 0x90000);
+	mips->set_gp_register(3, 0);
+	mips->set_gp_register(6, 0);
+	mips->set_gp_register(9, 6);
+	mips->set_gp_register(10, ARRAY_BASE);
+	mips->set_gp_register(11, NUM_ELEMENTS);
+	mips->set_gp_register(12, 2500);
+	return mips;
+}
+
+int main(int argc, char **argv){
+
+	for (unsigned c=0; c<NUM_CONFIGS; c++) {
+		sim_pipe *full = setup(c);
+		full->run();
+		simpoint points(1000, 10, 500);
+		sim_pipe *profiled = setup(c);
+		profiled->profile(&points);
+		sim_pipe *sampled = setup(c);
+		sampled->simulate_points(&points);
+
+		cout << "asm/phases.asm: memory latency " << dec << configs[c].latency << ", prefetcher " << configs[c].prefetch << endl;
+		cout << "======================================================================" << endl;
+		print_full(full);
+		points.print();
+		if (c == 0) {
+			// the points in the files of SimPoint
+			points.write("testcase22.simpts", "testcase22.weights");
+			ifstream simpts("testcase22.simpts"), weights("testcase22.weights");
+			string line;
+			while (getline(simpts, line)) cout << "simpts: " << line << endl;
+			while (getline(weights, line)) cout << "weights: " << line << endl;
+			remove("testcase22.simpts");
+			remove("testcase22.weights");
+		}
+		cout << "Estimate error = " << 100 * (points.get_clock_cycles() - full->get_clock_cycles()) / full->get_clock_cycles() << "%" << endl;
+		bool match = same_results(full, sampled, 0x90000, 0x90008) && same_results(full, profiled, 0, 0);
+		cout << "Results match = " << match << endl;
+		sampled->print_memory(0x90000, 0x90008);
+		cout << endl;
+		delete full;
+		delete profiled;
+		delete sampled;
+	}
+}
@@ -0,0 +1,83 @@
+#include "sim_pipe.h"
+#include "fixture.h"
+
+/* Test case for the performance monitoring unit: the reduction of a 200-element array runs under several memory and
+   pipeline configurations with 8 programmable counters; the counters of the cycles, instructions and stalls must
+   match the fixed statistics of the simulator, the stalls by cause and the instructions by class must add up, a
+   counter with the PC range of the loop must only count its instructions, a counter stopped must keep its value, and
+   the run must be the one without the PMU */
+
+#define NUM_ELEMENTS 200
+#define LOOP_HEAD 0x10000008
+#define LOOP_TAIL 0x10000018
+
+/* latency, prefetcher, DRAM, MSHRs, fusion, fetch queue, depth, memory stages */
+config_t configs[] = {{2,  0, false, 0, 0,                                         0, 1, 1},
+                      {10, 0, false, 4, 0,                                         0, 1, 1},
+                      {4,  0, false, 0, FUSE_COMPARE_BRANCH | FUSE_INCREMENT_LOAD, 0, 2, 2}};
+
+sim_pipe *setup(unsigned c){
+	sim_pipe *mips = setup(configs[c], "asm/reduce.asm", NUM_ELEMENTS);
+	set_reduction(mips, 0x90000, NUM_ELEMENTS);
+	return mips;
+}
+
+int main(int argc, char **argv){
+
+	pmu_event_t events[2][8] = {{EVENT_CYCLES, EVENT_INSTRUCTIONS, EVENT_STALLS, EVENT_RAW_STALLS, EVENT_STRUCTURAL_STALLS, EVENT_CONTROL_STALLS, EVENT_MEMORY_STALLS, EVENT_MEMORY_ACCESSES},
+	                            {EVENT_INTEGER_OPS, EVENT_LOAD_OPS, EVENT_STORE_OPS, EVENT_BRANCH_OPS, EVENT_INTEGER_BUSY, EVENT_MEMORY_BUSY, EVENT_INSTRUCTIONS, EVENT_TAKEN_BRANCHES}};
+
+	for (unsigned c=0; c<NUM_CONFIGS; c++) {
+		sim_pipe *plain = setup(c);
+		plain->run();
+
+		cout << "asm/reduce.asm: memory latency " << dec << configs[c].latency << ", MSHRs " << configs[c].mshrs << ", fusion " << configs[c].fusion;
+		cout << ", pipeline depth " << configs[c].depth << endl;
+		cout << "======================================================================" << endl;
+		cout << "Clock cycles = " << plain->get_clock_cycles() << ", stalls = " << plain->get_stalls() << ", instructions = " << plain->get_instructions_executed() << endl;
+
+		// two sets of events, the second one with the instructions of the loop only
+		unsigned long values[2][8];
+		bool match = true;
+		for (unsigned set=0; set<2; set++) {
+			sim_pipe *mips = setup(c);
+			pmu counters(8);
+			for (unsigned i=0; i<8; i++) {
+				if (set == 1 && i == 6) counters.configure(i, events[set][i], LOOP_HEAD, LOOP_TAIL);
+				else counters.configure(i, events[set][i]);
+				counters.start(i);
+			}
+			mips->set_pmu(&counters);
+			mips->run();
+			counters.print();
+			for (unsigned i=0; i<8; i++) values[set][i] = counters.read(i);
+			match = match && mips->get_clock_cycles() == plain->get_clock_cycles() && same_results(plain, mips, 0x90000, 0x90004);
+			delete mips;
+		}
+		cout << "Counters match the statistics = " << (values[0][0] == plain->get_clock_cycles() && values[0][1] == plain->get_instructions_executed() && values[0][2] == plain->get_stalls()) << endl;
+		cout << "Stalls add up = " << (values[0][3] + values[0][4] + values[0][5] + values[0][6] == values[0][2]) << endl;
+		cout << "Instructions add up = " << (values[1][0] + values[1][1] + values[1][2] + values[1][3] == values[0][1]) << endl;
+		cout << "Loop instructions = " << values[1][6] << endl;
+
+		// a counter stopped after 100 cycles, and one counting the whole run
+		sim_pipe *mips = setup(c);
+		pmu counters(2);
+		counters.configure(0, EVENT_CYCLES);
+		counters.configure(1, EVENT_CYCLES);
+		counters.start(0);
+		counters.start(1);
+		mips->set_pmu(&counters);
+		mips->run(100);
+		counters.stop(0);
+		mips->run();
+		cout << "Stopped after 100 cycles = " << counters.read(0) << ", whole run = " << counters.read(1);
+		counters.reset(0);
+		cout << ", reset = " << counters.read(0) << endl;
+		match = match && same_results(plain, mips, 0x90000, 0x90004);
+		cout << "Results match = " << match << endl;
+		mips->print_memory(0x90000, 0x90004);
+		cout << endl;
+		delete mips;
+		delete plain;
+	}
+}
@@ -0,0 +1,73 @@
+#include "sim_pipe.h"
+#include <iostream>
+#include <stdlib.h>
+
+using namespace std;
+
+/* Test case for the non-blocking memory stage */
+
+int main(int argc, char **argv){
+
+	unsigned i, j;
+
+	// instantiates the simulator with a 1MB data memory
+	sim_pipe *mips = new sim_pipe(1024*1024, 10);
+
+	// 4 MSHRs: up to 4 loads outstanding at the same time
+	mips->set_mshrs(4);
+
+	//loads program in instruction memory at address 0x10000000
+	mips->load_program("asm/stream.asm", 0x10000000);
+
+	//initialize data memory and prints its content (for the specified address ranges)
+	for (i = 0xA000, j=1; i<0xA030; i+=4, j+=1) mips->write_memory(i,j);
+	
+	cout << "\nBEFORE PROGRAM EXECUTION..." << endl;
+	cout << "======================================================================" << endl << endl;
+	
+	//prints the value of the memory and registers
+	mips->print_registers();
+	mips->print_memory(0xA000, 0xA030);
+	mips->print_memory(0xB000, 0xB010);
+
+	// executes the program	
+	cout << "\n*****************************" << endl;
+	cout << "STARTING THE PROGRAM..." << endl;
+	cout << "*****************************" << endl << endl;
+
+	// first 20 clock cycles
+	cout << "First 20 clock cycles: inspecting the registers at each clock cycle..." << endl;
+	cout << "======================================================================" << endl << endl;
+
+	for (i=0; i<20; i++){
+		cout << "CLOCK CYCLE #" << dec << i << endl;
+		mips->run(1);
+		mips->print_registers();
+		cout << endl;
+	}
+
+	// runs program to completion
+	cout << "EXECUTING PROGRAM TO COMPLETION..." << endl << endl;
+	mips->run(); 
+
+	cout << "PROGRAM TERMINATED\n";
+	cout << "===================" << endl << endl;
+
+	//prints the value of registers and data memory
+	mips->print_registers();
+	mips->print_memory(0xA000, 0xA030);
+	mips->print_memory(0xB000, 0xB010);
+	
+	cout << endl;
+
+	// prints the number of instructions executed and IPC
+	cout << "Instruction executed = " << dec << mips->get_instructions_executed() << endl;
+	cout << "Clock cycles = " << dec << mips->get_clock_cycles() << endl;
+	cout << "Stall inserted = " << dec  << mips->get_stalls() << endl;
+	cout << "IPC = " << dec << mips->get_IPC() << endl;
+	cout << "MSHR full stalls = " << dec << mips->get_mshr_full_stalls() << endl;
+	cout << "MSHR merges = " << dec << mips->get_mshr_merges() << endl;
+	cout << "Max outstanding loads = " << dec << mips->get_max_outstanding_loads() << endl;
+
+	delete mips;
+}
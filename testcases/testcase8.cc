@@ -0,0 +1,73 @@
+#include "sim_pipe.h"
+#include <iostream>
+#include <stdlib.h>
+
+using namespace std;
+
+/* Test case for the store buffer */
+
+int main(int argc, char **argv){
+
+	unsigned i, j;
+
+	// instantiates the simulator with a 1MB data memory
+	sim_pipe *mips = new sim_pipe(1024*1024, 10);
+
+	// 4-entry store buffer: stores retire without waiting for data memory
+	mips->set_store_buffer(4);
+
+	//loads program in instruction memory at address 0x10000000
+	mips->load_program("asm/sort.asm", 0x10000000);
+
+	//initialize data memory and prints its content (for the specified address ranges)
+	for (i = 0xA000, j=10; i<0xA028; i+=4, j=(j*7+3)%50) mips->write_memory(i,j);
+	
+	cout << "\nBEFORE PROGRAM EXECUTION..." << endl;
+	cout << "======================================================================" << endl << endl;
+	
+	//prints the value of the memory and registers
+	mips->print_registers();
+	mips->print_memory(0xA000, 0xA028);
+	mips->print_memory(0xB000, 0xB028);
+
+	// executes the program	
+	cout << "\n*****************************" << endl;
+	cout << "STARTING THE PROGRAM..." << endl;
+	cout << "*****************************" << endl << endl;
+
+	// first 20 clock cycles
+	cout << "First 20 clock cycles: inspecting the registers at each clock cycle..." << endl;
+	cout << "======================================================================" << endl << endl;
+
+	for (i=0; i<20; i++){
+		cout << "CLOCK CYCLE #" << dec << i << endl;
+		mips->run(1);
+		mips->print_registers();
+		cout << endl;
+	}
+
+	// runs program to completion
+	cout << "EXECUTING PROGRAM TO COMPLETION..." << endl << endl;
+	mips->run(); 
+
+	cout << "PROGRAM TERMINATED\n";
+	cout << "===================" << endl << endl;
+
+	//prints the value of registers and data memory
+	mips->print_registers();
+	mips->print_memory(0xA000, 0xA028);
+	mips->print_memory(0xB000, 0xB028);
+	
+	cout << endl;
+
+	// prints the number of instructions executed and IPC
+	cout << "Instruction executed = " << dec << mips->get_instructions_executed() << endl;
+	cout << "Clock cycles = " << dec << mips->get_clock_cycles() << endl;
+	cout << "Stall inserted = " << dec  << mips->get_stalls() << endl;
+	cout << "IPC = " << dec << mips->get_IPC() << endl;
+	cout << "Store buffer full stalls = " << dec << mips->get_store_buffer_full_stalls() << endl;
+	cout << "Store forwarding hits = " << dec << mips->get_store_forwarding_hits() << endl;
+	cout << "Store buffer occupancy = " << dec << mips->get_store_buffer_avg_occupancy() << " (max " << mips->get_store_buffer_max_occupancy() << ")" << endl;
+
+	delete mips;
+}
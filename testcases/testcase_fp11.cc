@@ -0,0 +1,69 @@
+#include "sim_pipe_fp.h"
+#include <iostream>
+#include <cstring>
+#include <stdlib.h>
+
+using namespace std;
+
+/* Test case for register renaming (quotients of negative elements are overwritten while the divide is in flight) */
+
+/* convert a float into an unsigned */
+inline unsigned float2unsigned(float value){
+        unsigned result;
+        memcpy(&result, &value, sizeof value);
+        return result;
+}
+
+int main(int argc, char **argv){
+
+	// instantiates the simulator with a 1MB data memory
+	sim_pipe_fp *mips = new sim_pipe_fp(1024*1024, 2);
+
+	mips->init_exec_unit(INTEGER, 1, 1);
+	mips->init_exec_unit(ADDER, 2, 1);
+	mips->init_exec_unit(MULTIPLIER, 6, 1);
+	mips->init_exec_unit(DIVIDER, 20, 1);
+
+	// 40 integer and 40 FP physical registers
+	mips->set_register_renaming(40, 40);
+
+	//loads program in instruction memory at address 0x10000000
+	mips->load_program("asm/codefp7.asm", 0x10000000);
+
+	//initialize data memory and prints its content (for the specified address ranges)
+	mips->write_memory(0xA000, float2unsigned(2.0));
+	mips->write_memory(0xA004, float2unsigned(0.0));
+	mips->write_memory(0xA008, float2unsigned(3.0));
+	mips->write_memory(0xA00C, float2unsigned(-5.0));
+	mips->write_memory(0xA010, float2unsigned(7.0));
+	mips->write_memory(0xA014, float2unsigned(-1.0));
+	
+	cout << "\nBEFORE PROGRAM EXECUTION..." << endl;
+	cout << "======================================================================" << endl << endl;
+	
+	//prints the value of the memory and registers
+	mips->print_registers();
+	mips->print_memory(0xA000, 0xA028);
+
+	// runs program to completion
+	cout << "EXECUTING PROGRAM TO COMPLETION..." << endl << endl;
+	mips->run(); 
+
+	cout << "PROGRAM TERMINATED\n";
+	cout << "===================" << endl << endl;
+
+	//prints the value of registers and data memory
+	mips->print_registers();
+	mips->print_memory(0xA000, 0xA028);
+	
+	cout << endl;
+
+	// prints the number of instructions executed and IPC
+	cout << "Instruction executed = " << dec << mips->get_instructions_executed() << endl;
+	cout << "Clock cycles = " << dec << mips->get_clock_cycles() << endl;
+	cout << "Stall inserted = " << dec  << mips->get_stalls() << endl;
+	cout << "IPC = " << dec << mips->get_IPC() << endl;
+	cout << "Free list stalls = " << dec << mips->get_free_list_stalls() << endl;
+
+	delete mips;
+}
@@ -0,0 +1,109 @@
+#include "sim_pipe_fp.h"
+#include <iostream>
+#include <cstring>
+#include <stdlib.h>
+
+using namespace std;
+
+/* Test case for the load/store queue (3-point stencil: the loads of the next point bypass the store waiting for the divide;
+   then stores through pointers loaded from a table, some aliasing the next load, under both disambiguation policies) */
+
+/* convert a float into an unsigned */
+inline unsigned float2unsigned(float value){
+        unsigned result;
+        memcpy(&result, &value, sizeof value);
+        return result;
+}
+
+/* pointer table and array of asm/codefp13.asm: every third store hits the element loaded next */
+sim_pipe_fp *setup_pointers(){
+	sim_pipe_fp *mips = new sim_pipe_fp(1024*1024, 4);
+	mips->init_exec_unit(INTEGER, 1, 1);
+	mips->init_exec_unit(ADDER, 2, 1);
+	mips->init_exec_unit(MULTIPLIER, 6, 1);
+	mips->init_exec_unit(DIVIDER, 20, 1);
+	mips->load_program("asm/codefp13.asm", 0x10000000);
+	for(unsigned i = 0; i < 8; i++)
+		mips->write_memory(0xA000 + 4*i, i % 3 == 1 ? 0xA104 + 4*i : 0xA200 + 4*i);
+	for(unsigned i = 0; i <= 8; i++)
+		mips->write_memory(0xA100 + 4*i, float2unsigned(1.0 + i));
+	return mips;
+}
+
+int main(int argc, char **argv){
+
+	// instantiates the simulator with a 1MB data memory
+	sim_pipe_fp *mips = new sim_pipe_fp(1024*1024, 4);
+
+	mips->init_exec_unit(INTEGER, 1, 1);
+	mips->init_exec_unit(ADDER, 2, 1);
+	mips->init_exec_unit(MULTIPLIER, 6, 1);
+	mips->init_exec_unit(DIVIDER, 20, 1);
+
+	// 8-entry load/store queue, 2 load ports and 1 store port, loads speculating past unknown store addresses
+	mips->set_load_store_queue(8, 2, 1, SPECULATIVE);
+
+	//loads program in instruction memory at address 0x10000000
+	mips->load_program("asm/codefp8.asm", 0x10000000);
+
+	//initialize data memory and prints its content (for the specified address ranges)
+	mips->write_memory(0xA000, float2unsigned(3.0));
+	for(unsigned i = 1; i <= 7; i++)
+		mips->write_memory(0xA000 + 4*i, float2unsigned(i * 1.5));
+	
+	cout << "\nBEFORE PROGRAM EXECUTION..." << endl;
+	cout << "======================================================================" << endl << endl;
+	
+	//prints the value of the memory and registers
+	mips->print_registers();
+	mips->print_memory(0xA000, 0xA044);
+
+	// runs program to completion
+	cout << "EXECUTING PROGRAM TO COMPLETION..." << endl << endl;
+	mips->run(); 
+
+	cout << "PROGRAM TERMINATED\n";
+	cout << "===================" << endl << endl;
+
+	//prints the value of registers and data memory
+	mips->print_registers();
+	mips->print_memory(0xA000, 0xA044);
+	
+	cout << endl;
+
+	// prints the number of instructions executed and IPC
+	cout << "Instruction executed = " << dec << mips->get_instructions_executed() << endl;
+	cout << "Clock cycles = " << dec << mips->get_clock_cycles() << endl;
+	cout << "Stall inserted = " << dec  << mips->get_stalls() << endl;
+	cout << "IPC = " << dec << mips->get_IPC() << endl;
+	cout << "Load/store queue full stalls = " << dec << mips->get_lsq_full_stalls() << endl;
+	cout << "Forwarded loads = " << dec << mips->get_lsq_forwards() << endl;
+	cout << "Loads bypassing stores = " << dec << mips->get_lsq_bypasses() << endl;
+	cout << "Replayed loads = " << dec << mips->get_lsq_replays() << endl;
+
+	delete mips;
+
+	// stores whose address comes from a load: the younger loads speculate past them or wait for their addresses
+	sim_pipe_fp *plain = setup_pointers();
+	plain->run();
+	disambiguation_t policies[2] = {SPECULATIVE, CONSERVATIVE};
+	const char *names[2] = {"SPECULATIVE", "CONSERVATIVE"};
+	cout << endl << "STORES THROUGH LOADED POINTERS (asm/codefp13.asm), " << dec << plain->get_clock_cycles() << " clock cycles without the queue" << endl;
+	cout << "======================================================================" << endl;
+	for(unsigned p = 0; p < 2; p++) {
+		mips = setup_pointers();
+		mips->set_load_store_queue(8, 2, 1, policies[p]);
+		mips->run();
+		bool match = true;
+		for(unsigned a = 0xA100; a <= 0xA120; a += 4)
+			match = match && mips->read_memory(a) == plain->read_memory(a);
+		for(unsigned a = 0xA200; a < 0xA220; a += 4)
+			match = match && mips->read_memory(a) == plain->read_memory(a);
+		cout << names[p] << ": clock cycles = " << dec << mips->get_clock_cycles() << ", forwarded loads = " << mips->get_lsq_forwards();
+		cout << ", loads bypassing stores = " << mips->get_lsq_bypasses() << ", replayed loads = " << mips->get_lsq_replays() << endl;
+		cout << "Results match = " << match << endl;
+		mips->print_memory(0xA100, 0xA124);
+		delete mips;
+	}
+	delete plain;
+}
@@ -0,0 +1,67 @@
+#include "sim_pipe_fp.h"
+#include <iostream>
+#include <cstring>
+#include <stdlib.h>
+
+using namespace std;
+
+/* Test case for the decoupled front-end (fetch runs ahead into the queue while the store waits for the divide) */
+
+/* convert a float into an unsigned */
+inline unsigned float2unsigned(float value){
+        unsigned result;
+        memcpy(&result, &value, sizeof value);
+        return result;
+}
+
+int main(int argc, char **argv){
+
+	// instantiates the simulator with a 1MB data memory
+	sim_pipe_fp *mips = new sim_pipe_fp(1024*1024, 4);
+
+	mips->init_exec_unit(INTEGER, 1, 2);
+	mips->init_exec_unit(ADDER, 2, 1);
+	mips->init_exec_unit(MULTIPLIER, 6, 1);
+	mips->init_exec_unit(DIVIDER, 20, 1);
+
+	// 8-entry fetch queue, instruction memory accesses take 2 cycles
+	mips->set_fetch_queue(8, 2);
+
+	//loads program in instruction memory at address 0x10000000
+	mips->load_program("asm/codefp9.asm", 0x10000000);
+
+	//initialize data memory and prints its content (for the specified address ranges)
+	mips->write_memory(0xA000, float2unsigned(3.0));
+	for(unsigned i = 1; i <= 4; i++)
+		mips->write_memory(0xA000 + 4*i, float2unsigned(i * 1.5));
+	
+	cout << "\nBEFORE PROGRAM EXECUTION..." << endl;
+	cout << "======================================================================" << endl << endl;
+	
+	//prints the value of the memory and registers
+	mips->print_registers();
+	mips->print_memory(0xA000, 0xA044);
+
+	// runs program to completion
+	cout << "EXECUTING PROGRAM TO COMPLETION..." << endl << endl;
+	mips->run(); 
+
+	cout << "PROGRAM TERMINATED\n";
+	cout << "===================" << endl << endl;
+
+	//prints the value of registers and data memory
+	mips->print_registers();
+	mips->print_memory(0xA000, 0xA044);
+	
+	cout << endl;
+
+	// prints the number of instructions executed and IPC
+	cout << "Instruction executed = " << dec << mips->get_instructions_executed() << endl;
+	cout << "Clock cycles = " << dec << mips->get_clock_cycles() << endl;
+	cout << "Stall inserted = " << dec  << mips->get_stalls() << endl;
+	cout << "IPC = " << dec << mips->get_IPC() << endl;
+	cout << "Fetch queue occupancy = " << dec << mips->get_fetch_queue_avg_occupancy() << " (max " << mips->get_fetch_queue_max_occupancy() << ")" << endl;
+	cout << "Decode starved cycles = " << dec << mips->get_fetch_starved_cycles() << endl;
+
+	delete mips;
+}
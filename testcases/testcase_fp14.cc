@@ -0,0 +1,76 @@
+#include "sim_pipe_fp.h"
+#include <iostream>
+#include <cstring>
+#include <stdlib.h>
+
+using namespace std;
+
+/* Test case for the multithreaded core: threads summing the squares of their own array share the execution units */
+
+/* convert a float into an unsigned */
+inline unsigned float2unsigned(float value){
+        unsigned result;
+        memcpy(&result, &value, sizeof value);
+        return result;
+}
+
+const char *policy_names[] = {"ROUND_ROBIN", "SWITCH_ON_STALL", "SIMULTANEOUS"};
+
+void run_threads(unsigned threads, thread_policy_t policy, unsigned issue_slots){
+
+	unsigned i, t;
+
+	// instantiates the simulator with a 1MB data memory
+	sim_pipe_fp *mips = new sim_pipe_fp(1024*1024, 8);
+
+	mips->init_exec_unit(INTEGER, 1, 2);
+	mips->init_exec_unit(ADDER, 2, 1);
+	mips->init_exec_unit(MULTIPLIER, 4, 1);
+	mips->init_exec_unit(DIVIDER, 10, 1);
+	mips->set_initiation_interval(MULTIPLIER, 1);
+
+	// "threads" hardware threads, switching threads costs 1 cycle
+	mips->set_threads(threads, policy, issue_slots, 1);
+
+	//loads the program of every thread at address 0x10000000 of its instruction memory: thread t sums the
+	//squares of the 8 floats at 0xA000 + 0x100*t and stores the sum at 0xB000 + 4*t
+	for (t=0; t<threads; t++){
+		mips->load_program("asm/codefp10.asm", 0x10000000, t);
+		mips->set_int_register(1, 0xA000 + 0x100*t, t);
+		mips->set_int_register(2, 0xB000 + 4*t, t);
+		mips->set_int_register(7, 8, t);
+	}
+
+	//initialize data memory
+	for (i = 0; i<0x100; i++) mips->write_memory(0xA000 + 4*i, float2unsigned((i%8) * 0.5 + i/64));
+
+	// runs program to completion
+	mips->run();
+
+	cout << dec << threads << " thread(s), " << policy_names[policy] << ", " << issue_slots << " issue slot(s)" << endl;
+	cout << "======================================================================" << endl;
+	mips->print_memory(0xB000, 0xB010);
+	for (t=0; t<threads; t++){
+		cout << "Thread " << dec << t << ": F1 = " << mips->get_fp_register(1, t) << ", instructions = " << mips->get_thread_instructions(t);
+		cout << ", clock cycles = " << mips->get_thread_cycles(t) << ", IPC = " << mips->get_thread_IPC(t) << endl;
+	}
+	cout << "Instruction executed = " << dec << mips->get_instructions_executed() << endl;
+	cout << "Clock cycles = " << dec << mips->get_clock_cycles() << endl;
+	cout << "Stall inserted = " << dec  << mips->get_stalls() << endl;
+	cout << "IPC = " << dec << mips->get_IPC() << endl;
+	cout << "Thread switches = " << dec << mips->get_thread_switches() << endl;
+	cout << "MULTIPLIER utilization = " << dec << mips->get_unit_utilization(MULTIPLIER) << endl << endl;
+
+	delete mips;
+}
+
+int main(int argc, char **argv){
+
+	// a single thread waits for every load and every dependent FP operation
+	run_threads(1, ROUND_ROBIN, 1);
+
+	// the other threads issue while a thread waits for data memory or for its operands
+	run_threads(4, ROUND_ROBIN, 1);
+	run_threads(4, SWITCH_ON_STALL, 1);
+	run_threads(4, SIMULTANEOUS, 2);
+}
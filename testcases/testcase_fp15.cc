@@ -0,0 +1,88 @@
+#include "sim_pipe_fp.h"
+#include <iostream>
+#include <cstring>
+#include <stdlib.h>
+
+using namespace std;
+
+/* Test case for the multicore system: the cores sum the squares of their slice of a shared array, then add the
+   partial sums to a shared total under a SWAP spin lock */
+
+/* convert a float into an unsigned */
+inline unsigned float2unsigned(float value){
+        unsigned result;
+        memcpy(&result, &value, sizeof value);
+        return result;
+}
+
+/* convert an unsigned into a float */
+inline float unsigned2float(unsigned value){
+        float result;
+        memcpy(&result, &value, sizeof value);
+        return result;
+}
+
+const char *protocol_names[] = {"MSI", "MESI"};
+const char *transaction_names[] = {"BusRd", "BusRdX", "BusUpgr", "Writeback"};
+
+void run_cores(unsigned cores, coherence_protocol_t protocol){
+
+	unsigned i, c;
+	unsigned words = 64;
+
+	// instantiates the system with a 1MB data memory with an 8-cycle latency, 1KB 2-way private L1s with 16B lines
+	sim_pipe_fp_multicore *system = new sim_pipe_fp_multicore(cores, 1024*1024, 8, protocol, 1024, 16, 2);
+
+	//loads the program of every core at address 0x10000000: core c sums the squares of its floats of the array at
+	//0xA000 and adds the sum to the total at 0x10, holding the lock at 0x0
+	for (c=0; c<cores; c++){
+		sim_pipe_fp *mips = system->core(c);
+		mips->init_exec_unit(INTEGER, 1, 1);
+		mips->init_exec_unit(ADDER, 2, 1);
+		mips->init_exec_unit(MULTIPLIER, 4, 1);
+		mips->init_exec_unit(DIVIDER, 10, 1);
+		mips->load_program("asm/codefp11.asm", 0x10000000);
+		mips->set_int_register(1, 0xA000 + 4*c*(words/cores));
+		mips->set_int_register(2, 0x10);
+		mips->set_int_register(7, words/cores);
+		mips->set_int_register(8, 0x0);
+	}
+
+	//initialize data memory
+	system->write_memory(0x0, 0);
+	system->write_memory(0x10, float2unsigned(0.0));
+	for (i = 0; i<words; i++) system->write_memory(0xA000 + 4*i, float2unsigned((i%8) * 0.5));
+
+	// runs program to completion
+	system->run();
+
+	cout << dec << cores << " core(s), " << protocol_names[protocol] << endl;
+	cout << "======================================================================" << endl;
+	cout << "Total = " << unsigned2float(system->read_memory(0x10)) << endl;
+	for (c=0; c<cores; c++){
+		cout << "Core " << dec << c << ": F1 = " << system->core(c)->get_fp_register(1) << ", instructions = " << system->core(c)->get_instructions_executed();
+		cout << ", clock cycles = " << system->core(c)->get_clock_cycles() << ", IPC = " << system->core(c)->get_IPC();
+		cout << ", L1 hits = " << system->get_cache_hits(c) << ", L1 misses = " << system->get_cache_misses(c) << endl;
+	}
+	cout << "Clock cycles = " << dec << system->get_clock_cycles() << endl;
+	cout << "IPC = " << dec << system->get_IPC() << endl;
+	for (i=0; i<NUM_BUS_TRANSACTIONS; i++)
+		cout << transaction_names[i] << " = " << dec << system->get_bus_transactions((bus_transaction_t)i) << endl;
+	cout << "Invalidations = " << dec << system->get_invalidations() << endl;
+	cout << "Cache-to-cache transfers = " << dec << system->get_cache_transfers() << endl;
+	cout << "Bus wait cycles = " << dec << system->get_bus_wait_cycles() << endl << endl;
+
+	delete system;
+}
+
+int main(int argc, char **argv){
+
+	// the same reduction from 1 to 8 cores
+	run_cores(1, MESI);
+	run_cores(2, MESI);
+	run_cores(4, MESI);
+	run_cores(8, MESI);
+
+	// without the exclusive state
+	run_cores(4, MSI);
+}
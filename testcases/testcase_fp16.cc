@@ -0,0 +1,125 @@
+#include "sim_pipe_fp.h"
+#include <iostream>
+#include <cstring>
+#include <stdlib.h>
+
+using namespace std;
+
+/* Test case for the host-parallel multicore simulation: the parallel sum of squares of testcase_fp15 run in lock
+   step, then on host threads with deterministic and relaxed quanta; the deterministic runs must be the lock step
+   run */
+
+/* convert a float into an unsigned */
+inline unsigned float2unsigned(float value){
+        unsigned result;
+        memcpy(&result, &value, sizeof value);
+        return result;
+}
+
+/* convert an unsigned into a float */
+inline float unsigned2float(unsigned value){
+        float result;
+        memcpy(&result, &value, sizeof value);
+        return result;
+}
+
+const char *mode_names[] = {"deterministic", "relaxed"};
+
+sim_pipe_fp_multicore *build_system(unsigned cores){
+
+	unsigned i, c;
+	unsigned words = 64;
+
+	// instantiates the system with a 1MB data memory with an 8-cycle latency, 1KB 2-way private L1s with 16B lines
+	sim_pipe_fp_multicore *system = new sim_pipe_fp_multicore(cores, 1024*1024, 8, MESI, 1024, 16, 2);
+
+	//loads the program of every core at address 0x10000000: core c sums the squares of its floats of the array at
+	//0xA000 and adds the sum to the total at 0x10, holding the lock at 0x0
+	for (c=0; c<cores; c++){
+		sim_pipe_fp *mips = system->core(c);
+		mips->init_exec_unit(INTEGER, 1, 1);
+		mips->init_exec_unit(ADDER, 2, 1);
+		mips->init_exec_unit(MULTIPLIER, 4, 1);
+		mips->init_exec_unit(DIVIDER, 10, 1);
+		mips->load_program("asm/codefp11.asm", 0x10000000);
+		mips->set_int_register(1, 0xA000 + 4*c*(words/cores));
+		mips->set_int_register(2, 0x10);
+		mips->set_int_register(7, words/cores);
+		mips->set_int_register(8, 0x0);
+	}
+
+	//initialize data memory
+	system->write_memory(0x0, 0);
+	system->write_memory(0x10, float2unsigned(0.0));
+	for (i = 0; i<words; i++) system->write_memory(0xA000 + 4*i, float2unsigned((i%8) * 0.5));
+
+	return system;
+}
+
+void print_system(sim_pipe_fp_multicore *system, sim_pipe_fp_multicore *reference){
+	cout << "Total = " << unsigned2float(system->read_memory(0x10)) << endl;
+	for (unsigned c=0; c<system->cores.size(); c++){
+		cout << "Core " << dec << c << ": instructions = " << system->core(c)->get_instructions_executed();
+		cout << ", clock cycles = " << system->core(c)->get_clock_cycles();
+		cout << ", L1 hits = " << system->get_cache_hits(c) << ", L1 misses = " << system->get_cache_misses(c) << endl;
+	}
+	cout << "Clock cycles = " << dec << system->get_clock_cycles() << endl;
+	cout << "Quanta = " << dec << system->get_quanta() << endl;
+	cout << "Invalidations = " << dec << system->get_invalidations() << endl;
+	cout << "Bus wait cycles = " << dec << system->get_bus_wait_cycles() << endl;
+	if (reference != NULL) cout << "Timing error = " << dec << system->get_timing_error(reference) << endl;
+}
+
+bool same_as(sim_pipe_fp_multicore *system, sim_pipe_fp_multicore *reference){
+	bool same = system->read_memory(0x10) == reference->read_memory(0x10) && system->get_invalidations() == reference->get_invalidations() &&
+	            system->get_bus_wait_cycles() == reference->get_bus_wait_cycles();
+	for (unsigned c=0; c<system->cores.size(); c++){
+		same = same && system->core(c)->get_instructions_executed() == reference->core(c)->get_instructions_executed();
+		same = same && system->core(c)->get_clock_cycles() == reference->core(c)->get_clock_cycles();
+		same = same && system->get_cache_hits(c) == reference->get_cache_hits(c) && system->get_cache_misses(c) == reference->get_cache_misses(c);
+	}
+	return same;
+}
+
+void run_parallel(sim_pipe_fp_multicore *reference, unsigned cores, unsigned threads, sync_mode_t mode, unsigned quantum, unsigned run_ahead=16){
+	sim_pipe_fp_multicore *system = build_system(cores);
+	system->set_host_threads(threads, mode, quantum, run_ahead);
+	system->run();
+
+	cout << dec << cores << " core(s), " << threads << " host thread(s), " << mode_names[mode] << ", quantum = " << system->quantum;
+	if (mode == DETERMINISTIC) cout << ", run ahead = " << system->run_ahead;
+	cout << endl;
+	cout << "======================================================================" << endl;
+	print_system(system, reference);
+	if (mode == DETERMINISTIC) cout << "Same as lock step = " << same_as(system, reference) << endl;
+	cout << endl;
+	delete system;
+}
+
+int main(int argc, char **argv){
+
+	unsigned cores = 4;
+
+	// reference: lock step on the calling thread
+	sim_pipe_fp_multicore *reference = build_system(cores);
+	reference->run();
+	cout << dec << cores << " core(s), lock step" << endl;
+	cout << "======================================================================" << endl;
+	print_system(reference, NULL);
+	cout << endl;
+
+	// the cycles touching the shared data memory or the L1s run in lock step, with those of the cores about to touch
+	// them: the lock step run whatever the number of host threads, the quantum and the run ahead; a run ahead of 1
+	// synchronizes the host threads before every such cycle
+	run_parallel(reference, cores, 1, DETERMINISTIC, 1000);
+	run_parallel(reference, cores, 2, DETERMINISTIC, 1000);
+	run_parallel(reference, cores, 4, DETERMINISTIC, 1000);
+	run_parallel(reference, cores, 4, DETERMINISTIC, 5);
+	run_parallel(reference, cores, 4, DETERMINISTIC, 1000, 1);
+
+	// quanta exchanging the shared data memory accesses at their end: a timing error growing with the quantum
+	run_parallel(reference, cores, 4, RELAXED, 20);
+	run_parallel(reference, cores, 4, RELAXED, 100);
+
+	delete reference;
+}
@@ -0,0 +1,101 @@
+#include "sim_pipe_fp.h"
+#include <iostream>
+#include <cstring>
+#include <stdlib.h>
+#include <thread>
+
+using namespace std;
+
+/* Test case for trace-driven replay: the quotient program of testcase_fp11 (with a zero dividend) is recorded once,
+   then replayed under several execution unit and memory configurations on host threads; every replay takes the same
+   clock cycles as running the program */
+
+/* convert a float into an unsigned */
+inline unsigned float2unsigned(float value){
+        unsigned result;
+        memcpy(&result, &value, sizeof value);
+        return result;
+}
+
+#define NUM_CONFIGS 8
+
+const char *config_names[NUM_CONFIGS] = {"divider 20", "divider 8", "pipelined divider", "operand-dependent latency",
+                                         "latency 10", "renaming", "store buffer", "fetch queue"};
+
+unsigned cycles[NUM_CONFIGS], stalls[NUM_CONFIGS], instructions[NUM_CONFIGS];
+
+sim_pipe_fp *build(unsigned config){
+	sim_pipe_fp *mips = new sim_pipe_fp(1024*1024, (config == 4) ? 10 : 2);
+	mips->init_exec_unit(INTEGER, 1, 1);
+	mips->init_exec_unit(ADDER, 2, 1);
+	mips->init_exec_unit(MULTIPLIER, 6, 1);
+	mips->init_exec_unit(DIVIDER, (config == 1) ? 8 : 20, 1);
+	switch(config){
+		case 2: mips->set_initiation_interval(DIVIDER, 1); break;
+		case 3: mips->set_operand_dependent_latency(true, true); break;
+		case 5: mips->set_register_renaming(40, 40); break;
+		case 6: mips->set_store_buffer(4); break;
+		case 7: mips->set_fetch_queue(4); break;
+		default: break;
+	}
+	return mips;
+}
+
+void replay(trace *stream, unsigned config){
+	sim_pipe_fp *mips = build(config);
+	mips->load_trace(stream);
+	mips->run();
+	cycles[config]       = mips->get_clock_cycles();
+	stalls[config]       = mips->get_stalls();
+	instructions[config] = mips->get_instructions_executed();
+	delete mips;
+}
+
+void init_memory(sim_pipe_fp *mips){
+	mips->write_memory(0xA000, float2unsigned(2.0));
+	mips->write_memory(0xA004, float2unsigned(0.0));
+	mips->write_memory(0xA008, float2unsigned(3.0));
+	mips->write_memory(0xA00C, float2unsigned(-5.0));
+	mips->write_memory(0xA010, float2unsigned(0.0));
+	mips->write_memory(0xA014, float2unsigned(-1.0));
+}
+
+int main(int argc, char **argv){
+
+	unsigned c;
+
+	// records the dynamic instruction stream of the program, which leaves the quotients in memory
+	trace stream(true);
+	sim_pipe_fp *recorder = build(0);
+	recorder->load_program("asm/codefp7.asm", 0x10000000);
+	init_memory(recorder);
+	recorder->record_trace(&stream);
+
+	cout << "Trace records = " << dec << stream.size() << endl;
+	recorder->print_memory(0xA000, 0xA028);
+	cout << endl;
+	delete recorder;
+
+	// replays the trace under every configuration, one host thread each
+	vector<thread> workers;
+	for (c=0; c<NUM_CONFIGS; c++)
+		workers.push_back(thread(replay, &stream, c));
+	for (c=0; c<NUM_CONFIGS; c++)
+		workers[c].join();
+
+	// runs the program under every configuration
+	for (c=0; c<NUM_CONFIGS; c++){
+		sim_pipe_fp *mips = build(c);
+		mips->load_program("asm/codefp7.asm", 0x10000000);
+		init_memory(mips);
+		mips->run();
+
+		cout << config_names[c] << endl;
+		cout << "======================================================================" << endl;
+		cout << "Program: instructions = " << dec << mips->get_instructions_executed() << ", clock cycles = " << mips->get_clock_cycles();
+		cout << ", stalls = " << mips->get_stalls() << endl;
+		cout << "Replay:  instructions = " << dec << instructions[c] << ", clock cycles = " << cycles[c];
+		cout << ", stalls = " << stalls[c] << endl << endl;
+		delete mips;
+	}
+}
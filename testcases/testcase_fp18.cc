@@ -0,0 +1,77 @@
+#include "sim_pipe_fp.h"
+#include <iostream>
+#include <cstring>
+#include <stdlib.h>
+
+using namespace std;
+
+/* Test case for trace files: the quotient program of testcase_fp17 is recorded into a trace file of small chunks,
+   which is then streamed to replays with and without the operand-dependent latencies */
+
+/* convert a float into an unsigned */
+inline unsigned float2unsigned(float value){
+        unsigned result;
+        memcpy(&result, &value, sizeof value);
+        return result;
+}
+
+sim_pipe_fp *build(bool operand_dependent){
+	sim_pipe_fp *mips = new sim_pipe_fp(1024*1024, 2);
+	mips->init_exec_unit(INTEGER, 1, 1);
+	mips->init_exec_unit(ADDER, 2, 1);
+	mips->init_exec_unit(MULTIPLIER, 6, 1);
+	mips->init_exec_unit(DIVIDER, 20, 1);
+	mips->set_operand_dependent_latency(operand_dependent, operand_dependent);
+	return mips;
+}
+
+void init_memory(sim_pipe_fp *mips){
+	mips->write_memory(0xA000, float2unsigned(2.0));
+	mips->write_memory(0xA004, float2unsigned(0.0));
+	mips->write_memory(0xA008, float2unsigned(3.0));
+	mips->write_memory(0xA00C, float2unsigned(-5.0));
+	mips->write_memory(0xA010, float2unsigned(0.0));
+	mips->write_memory(0xA014, float2unsigned(-1.0));
+}
+
+int main(int argc, char **argv){
+
+	unsigned i;
+
+	// records the program into a trace file of 8-record chunks
+	trace stream(true);
+	stream.create("testcase_fp18.trc", 8);
+	sim_pipe_fp *recorder = build(false);
+	recorder->load_program("asm/codefp7.asm", 0x10000000);
+	init_memory(recorder);
+	recorder->record_trace(&stream);
+	stream.close();
+	delete recorder;
+
+	cout << "Trace file bytes = " << dec << stream.get_file_bytes() << endl << endl;
+
+	// runs the program, then streams the file to a replay, with and without the operand-dependent latencies
+	for (i=0; i<2; i++){
+		sim_pipe_fp *mips = build(i);
+		mips->load_program("asm/codefp7.asm", 0x10000000);
+		init_memory(mips);
+		mips->run();
+
+		sim_pipe_fp *replayer = build(i);
+		stream.open("testcase_fp18.trc");
+		replayer->load_trace(&stream);
+		replayer->run();
+		stream.close();
+
+		cout << (i ? "Operand-dependent latencies" : "Fixed latencies") << endl;
+		cout << "======================================================================" << endl;
+		cout << "Program:    instructions = " << dec << mips->get_instructions_executed() << ", clock cycles = " << mips->get_clock_cycles();
+		cout << ", stalls = " << mips->get_stalls() << endl;
+		cout << "Trace file: instructions = " << dec << replayer->get_instructions_executed() << ", clock cycles = " << replayer->get_clock_cycles();
+		cout << ", stalls = " << replayer->get_stalls() << endl << endl;
+		delete mips;
+		delete replayer;
+	}
+
+	remove("testcase_fp18.trc");
+}
@@ -0,0 +1,87 @@
+#include "sim_pipe_fp.h"
+#include <iostream>
+#include <cstring>
+#include <stdlib.h>
+
+using namespace std;
+
+/* Test case for object files: the quotient program of testcase_fp17 is assembled with its operands as initialised
+   data, then the object file is loaded (with no memory set up by the test case) and checked against the assembly
+   program, both instruction by instruction and by running them */
+
+/* convert a float into an unsigned */
+inline unsigned float2unsigned(float value){
+        unsigned result;
+        memcpy(&result, &value, sizeof value);
+        return result;
+}
+
+sim_pipe_fp *build(){
+	sim_pipe_fp *mips = new sim_pipe_fp(1024*1024, 2);
+	mips->init_exec_unit(INTEGER, 1, 1);
+	mips->init_exec_unit(ADDER, 2, 1);
+	mips->init_exec_unit(MULTIPLIER, 6, 1);
+	mips->init_exec_unit(DIVIDER, 20, 1);
+	return mips;
+}
+
+void init_memory(sim_pipe_fp *mips){
+	mips->write_memory(0xA000, float2unsigned(2.0));
+	mips->write_memory(0xA004, float2unsigned(0.0));
+	mips->write_memory(0xA008, float2unsigned(3.0));
+	mips->write_memory(0xA00C, float2unsigned(-5.0));
+	mips->write_memory(0xA010, float2unsigned(0.0));
+	mips->write_memory(0xA014, float2unsigned(-1.0));
+}
+
+bool same(const instruction_t& a, const instruction_t& b){
+	return a.opcode == b.opcode && a.dest == b.dest && a.src1 == b.src1 && a.src2 == b.src2 && a.imm == b.imm &&
+	       a.dest_op == b.dest_op && a.src1_op == b.src1_op && a.src2_op == b.src2_op && a.branch_op == b.branch_op &&
+	       a.dest_float_op == b.dest_float_op && a.src1_float_op == b.src1_float_op && a.src2_float_op == b.src2_float_op;
+}
+
+int main(int argc, char **argv){
+
+	unsigned i, mismatches = 0;
+
+	// assembles the program, with the dividends and divisors as its data
+	sim_pipe_fp *text = build();
+	text->load_program("asm/codefp7.asm", 0x10000000);
+	init_memory(text);
+	text->assemble("asm/codefp7.asm", "testcase_fp19.obj", 0xA000, 0xA018);
+
+	program object;
+	object.map("testcase_fp19.obj");
+	cout << "Instructions = " << dec << object.text_count << ", literals = " << object.pool_count;
+	cout << ", object file bytes = " << object.mapping_bytes << endl;
+	cout << "Symbols:";
+	for (i = 0; i < object.symbols.size(); i++)
+		cout << " " << object.symbols[i].name << "=" << dec << object.symbols[i].index;
+	cout << endl;
+
+	// decodes the object file, to compare it with the assembly program
+	sim_pipe_fp *binary = build();
+	binary->load_program("testcase_fp19.obj", 0x10000000);
+	for (i = 0; i < object.text_count; i++)
+		mismatches += !same(*text->instMemory[i], *binary->instMemory[i]);
+	cout << "Instructions decoded = " << dec << object.text_count << ", mismatches = " << mismatches << endl << endl;
+	delete text;
+	delete binary;
+
+	sim_pipe_fp *mips = build();
+	mips->load_program("asm/codefp7.asm", 0x10000000);
+	init_memory(mips);
+	mips->run();
+
+	sim_pipe_fp *loaded = build();
+	loaded->load_program("testcase_fp19.obj", 0x10000000);
+	loaded->run();
+
+	cout << "Assembly:    clock cycles = " << dec << mips->get_clock_cycles() << ", stalls = " << mips->get_stalls() << endl;
+	cout << "Object file: clock cycles = " << dec << loaded->get_clock_cycles() << ", stalls = " << loaded->get_stalls() << endl;
+	loaded->print_memory(0xA000, 0xA028);
+	delete mips;
+	delete loaded;
+
+	remove("testcase_fp19.obj");
+}
@@ -0,0 +1,49 @@
+#include "sim_pipe_fp.h"
+#include "fixture.h"
+
+/* Test case for the per-instruction profile: the sum of squares of a 200-element array runs under several memory and
+   pipeline configurations with a profiler attached; the report maps the counters back to the lines of the source and
+   ranks its loops, the cycles and the stalls of the instructions must add up to those of the run, and the results
+   must be those of the run without the profiler */
+
+#define NUM_ELEMENTS 200
+
+/* latency, prefetcher, DRAM, MSHRs, fusion, fetch queue, depth, memory stages, renaming */
+config_t configs[] = {{2,  0,               false, 0, 0,                                         0, 0, 0, 0},
+                      {10, PREFETCH_STRIDE, false, 0, 0,                                         0, 0, 0, 0},
+                      {4,  0,               false, 0, 0,                                         0, 0, 0, 40},
+                      {4,  0,               false, 0, FUSE_COMPARE_BRANCH | FUSE_INCREMENT_LOAD, 4, 0, 0, 0}};
+
+sim_pipe_fp *setup(unsigned c){
+	sim_pipe_fp *mips = setup(configs[c], "asm/codefp11.asm", NUM_ELEMENTS);
+	set_reduction(mips, 0x90000, NUM_ELEMENTS);
+	return mips;
+}
+
+int main(int argc, char **argv){
+
+	for (unsigned c=0; c<NUM_CONFIGS; c++) {
+		sim_pipe_fp *plain = setup(c);
+		plain->run();
+		sim_pipe_fp *mips = setup(c);
+		profiler profile;
+		mips->set_profiler(&profile);
+		mips->run();
+
+		cout << "asm/codefp11.asm: memory latency " << dec << configs[c].latency << ", prefetcher " << configs[c].prefetch << ", renaming " << configs[c].renaming;
+		cout << ", fusion " << configs[c].fusion << ", fetch queue " << configs[c].queue_size << endl;
+		cout << "======================================================================" << endl;
+		cout << "Clock cycles = " << mips->get_clock_cycles() << ", stalls = " << mips->get_stalls() << ", instructions = " << mips->get_instructions_executed() << endl;
+		profile.print("asm/codefp11.asm");
+		unsigned long stalls = 0;
+		for (unsigned pc = 0x10000000; pc < 0x10000000 + 4*16; pc+=4)
+			for (unsigned s = 0; s < NUM_STALL_CAUSES; s++) stalls += profile.get(pc).stalls[s];
+		cout << "Cycles add up = " << (profile.get_cycles() == mips->get_clock_cycles()) << ", stalls add up = " << (stalls == mips->get_stalls()) << endl;
+		bool match = plain->get_clock_cycles() == mips->get_clock_cycles() && same_results(plain, mips, 0x90000, 0x90004);
+		cout << "Results match = " << match << endl;
+		mips->print_memory(0x90000, 0x90008);
+		cout << endl;
+		delete plain;
+		delete mips;
+	}
+}
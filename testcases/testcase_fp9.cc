@@ -0,0 +1,69 @@
+#include "sim_pipe_fp.h"
+#include <iostream>
+#include <cstring>
+#include <stdlib.h>
+
+using namespace std;
+
+/* Test case for pipelined execution units (initiation interval) */
+
+/* convert a float into an unsigned */
+inline unsigned float2unsigned(float value){
+        unsigned result;
+        memcpy(&result, &value, sizeof value);
+        return result;
+}
+
+int main(int argc, char **argv){
+
+	unsigned i, j;
+
+	// instantiates the simulator with a 1MB data memory
+	sim_pipe_fp *mips = new sim_pipe_fp(1024*1024, 2);
+
+	mips->init_exec_unit(INTEGER, 0, 1);
+	mips->init_exec_unit(ADDER, 4, 1);
+	mips->init_exec_unit(MULTIPLIER, 6, 1);
+	mips->init_exec_unit(DIVIDER, 12, 1);
+
+	// fully pipelined adder, multiplier accepting an operation every other cycle, divider every 10 cycles
+	mips->set_initiation_interval(ADDER, 1);
+	mips->set_initiation_interval(MULTIPLIER, 2);
+	mips->set_initiation_interval(DIVIDER, 10);
+
+	//loads program in instruction memory at address 0x10000000
+	mips->load_program("asm/codefp5.asm", 0x10000000);
+
+	//initialize data memory and prints its content (for the specified address ranges)
+	for (i = 0xA000, j=1; i<0xA008; i+=4, j+=1) mips->write_memory(i,float2unsigned((float)j/2));
+	
+	cout << "\nBEFORE PROGRAM EXECUTION..." << endl;
+	cout << "======================================================================" << endl << endl;
+	
+	//prints the value of the memory and registers
+	mips->print_registers();
+	mips->print_memory(0xA000, 0xA028);
+
+	// runs program to completion
+	cout << "EXECUTING PROGRAM TO COMPLETION..." << endl << endl;
+	mips->run(); 
+
+	cout << "PROGRAM TERMINATED\n";
+	cout << "===================" << endl << endl;
+
+	//prints the value of registers and data memory
+	mips->print_registers();
+	mips->print_memory(0xA000, 0xA028);
+	
+	cout << endl;
+
+	// prints the number of instructions executed and IPC
+	cout << "Instruction executed = " << dec << mips->get_instructions_executed() << endl;
+	cout << "Clock cycles = " << dec << mips->get_clock_cycles() << endl;
+	cout << "Stall inserted = " << dec  << mips->get_stalls() << endl;
+	cout << "IPC = " << dec << mips->get_IPC() << endl;
+	for (i=ADDER; i<=DIVIDER; i++)
+		cout << "Unit " << i << ": average occupancy = " << mips->get_unit_avg_occupancy((exe_unit_t)i) << ", peak occupancy = " << mips->get_unit_max_occupancy((exe_unit_t)i) << ", utilization = " << mips->get_unit_utilization((exe_unit_t)i) << endl;
+
+	delete mips;
+}
@@ -0,0 +1,384 @@
+#include "trace.h"
+
+using namespace std;
+
+// Trace file layout: header (magic, flags, records per chunk), chunks, index (offset, compressed and encoded
+// sizes, records of every chunk), footer (index offset, chunks, records, magic); little-endian throughout
+static const unsigned TRACE_MAGIC   = 0x32435254;    // "TRC2": 64-bit record counts
+static const unsigned HEADER_BYTES  = 12;
+static const unsigned INDEX_BYTES   = 24;
+static const unsigned FOOTER_BYTES  = 28;
+
+static void put_u32(vector<unsigned char>& out, unsigned value){
+   for(int i = 0; i < 4; i++)
+      out.push_back(value >> (8 * i));
+}
+
+static void put_u64(vector<unsigned char>& out, unsigned long long value){
+   put_u32(out, value);
+   put_u32(out, value >> 32);
+}
+
+static unsigned get_u32(const unsigned char *in){
+   return in[0] | (in[1] << 8) | (in[2] << 16) | ((unsigned)in[3] << 24);
+}
+
+static unsigned long long get_u64(const unsigned char *in){
+   return get_u32(in) | ((unsigned long long)get_u32(in + 4) << 32);
+}
+
+static void put_varint(vector<unsigned char>& out, unsigned value){
+   while(value >= 0x80) {
+      out.push_back(value | 0x80);
+      value >>= 7;
+   }
+   out.push_back(value);
+}
+
+static unsigned get_varint(const unsigned char *&in){
+   unsigned value = 0;
+   for(int shift = 0; ; shift += 7) {
+      value |= (*in & 0x7F) << shift;
+      if(!(*in++ & 0x80))
+         return value;
+   }
+}
+
+static unsigned zigzag(unsigned value){
+   return (value << 1) ^ -(value >> 31);
+}
+
+static unsigned unzigzag(unsigned value){
+   return (value >> 1) ^ -(value & 1);
+}
+
+//----------------------------------------------------------------------
+// Record encoding: the opcode byte also flags a sequential PC, a stored
+// address (the target of a branch is implied by its immediate) and
+// stored operand values; a second byte holds the operand flags. PCs and
+// addresses are deltas from the previous ones of the chunk
+//----------------------------------------------------------------------
+static void encode_record(vector<unsigned char>& out, const trace_record_t& record, unsigned& last_pc, unsigned& last_address){
+   ASSERT( record.opcode < 32, "Unsupported opcode in trace (=%d)", record.opcode );
+   unsigned implied        = record.branch_op ? record.pc + 4 + record.immediate : 0;
+   bool sequential         = (record.pc == last_pc + 4);
+   bool has_address        = (record.address != implied);
+   bool has_operands       = (record.a != 0 || record.b != 0);
+   out.push_back(record.opcode | (sequential << 5) | (has_address << 6) | (has_operands << 7));
+   out.push_back(record.dest_op | (record.src1_op << 1) | (record.src2_op << 2) | (record.dest_float_op << 3) |
+                 (record.src1_float_op << 4) | (record.src2_float_op << 5) | (record.branch_op << 6) | (record.taken << 7));
+   if(!sequential)
+      put_varint(out, zigzag(record.pc - (last_pc + 4)));
+   last_pc                 = record.pc;
+   if(record.dest_op)
+      out.push_back(record.dest);
+   if(record.src1_op)
+      out.push_back(record.src1);
+   if(record.src2_op)
+      out.push_back(record.src2);
+   put_varint(out, zigzag(record.immediate));
+   if(has_address) {
+      put_varint(out, zigzag(record.address - last_address));
+      last_address         = record.address;
+   }
+   if(has_operands) {
+      put_varint(out, record.a);
+      put_varint(out, record.b);
+   }
+}
+
+static void decode_record(const unsigned char *&in, trace_record_t& record, unsigned& last_pc, unsigned& last_address){
+   unsigned char head      = *in++;
+   unsigned char flags     = *in++;
+   record.opcode           = head & 0x1F;
+   record.dest_op          = flags & 1;
+   record.src1_op          = (flags >> 1) & 1;
+   record.src2_op          = (flags >> 2) & 1;
+   record.dest_float_op    = (flags >> 3) & 1;
+   record.src1_float_op    = (flags >> 4) & 1;
+   record.src2_float_op    = (flags >> 5) & 1;
+   record.branch_op        = (flags >> 6) & 1;
+   record.taken            = (flags >> 7) & 1;
+   record.pc               = last_pc + 4 + ((head & 0x20) ? 0 : unzigzag(get_varint(in)));
+   last_pc                 = record.pc;
+   record.dest             = record.dest_op ? *in++ : 0;
+   record.src1             = record.src1_op ? *in++ : 0;
+   record.src2             = record.src2_op ? *in++ : 0;
+   record.immediate        = unzigzag(get_varint(in));
+   record.address          = record.branch_op ? record.pc + 4 + record.immediate : 0;
+   if(head & 0x40) {
+      record.address       = last_address + unzigzag(get_varint(in));
+      last_address         = record.address;
+   }
+   record.a                = 0;
+   record.b                = 0;
+   if(head & 0x80) {
+      record.a             = get_varint(in);
+      record.b             = get_varint(in);
+   }
+}
+
+//----------------------------------------------------------------------
+// LZ77 codec: a sequence is a token (literal count and match length
+// minus 4, a nibble each, 15 continued in bytes of up to 255), the
+// literals, and the 16-bit offset of the match; the last sequence has
+// literals only. Matches are found through a hash of 4-byte words
+//----------------------------------------------------------------------
+static void put_length(vector<unsigned char>& out, unsigned length){
+   for(length -= 15; length >= 255; length -= 255)
+      out.push_back(255);
+   out.push_back(length);
+}
+
+static unsigned get_length(const unsigned char *&in, unsigned length){
+   if(length == 15) {
+      unsigned char byte;
+      do {
+         byte              = *in++;
+         length           += byte;
+      } while(byte == 255);
+   }
+   return length;
+}
+
+static void put_sequence(vector<unsigned char>& out, const unsigned char *literals, unsigned count, unsigned offset, unsigned length){
+   unsigned match          = (offset != 0) ? length - 4 : 0;
+   out.push_back((min(count, 15u) << 4) | min(match, 15u));
+   if(count >= 15)
+      put_length(out, count);
+   out.insert(out.end(), literals, literals + count);
+   if(offset == 0)
+      return;
+   out.push_back(offset);
+   out.push_back(offset >> 8);
+   if(match >= 15)
+      put_length(out, match);
+}
+
+static void compress(const vector<unsigned char>& in, vector<unsigned char>& out){
+   vector<int> table(1 << 12, -1);
+   unsigned n              = in.size();
+   unsigned anchor         = 0;
+   unsigned i              = 0;
+   while(i + 4 <= n) {
+      unsigned word        = get_u32(&in[i]);
+      unsigned hash        = (word * 2654435761u) >> 20;
+      int candidate        = table[hash];
+      table[hash]          = i;
+      if(candidate < 0 || i - candidate > 0xFFFF || get_u32(&in[candidate]) != word) {
+         i++;
+         continue;
+      }
+      unsigned length      = 4;
+      while(i + length < n && in[candidate + length] == in[i + length])
+         length++;
+      put_sequence(out, &in[anchor], i - anchor, i - candidate, length);
+      i                   += length;
+      anchor               = i;
+   }
+   put_sequence(out, &in[0] + anchor, n - anchor, 0, 0);
+}
+
+static void decompress(const vector<unsigned char>& in, vector<unsigned char>& out){
+   const unsigned char *p  = &in[0];
+   const unsigned char *end = p + in.size();
+   while(p < end) {
+      unsigned token       = *p++;
+      unsigned count       = get_length(p, token >> 4);
+      out.insert(out.end(), p, p + count);
+      p                   += count;
+      if(p >= end)
+         break;
+      unsigned offset      = p[0] | (p[1] << 8);
+      p                   += 2;
+      unsigned length      = get_length(p, token & 15) + 4;
+      ASSERT( offset != 0 && offset <= out.size(), "Corrupted trace chunk" );
+      for(unsigned start = out.size() - offset, j = 0; j < length; j++)
+         out.push_back(out[start + j]);
+   }
+}
+
+trace::trace(bool fp){
+   this->fp               = fp;
+   first                  = 0;
+   file                   = NULL;
+   writing                = false;
+   chunk_records          = 0;
+   total                  = 0;
+   file_bytes             = 0;
+   current                = 0;
+}
+
+trace::~trace(){
+   close();
+}
+
+void trace::create(const char *filename, unsigned chunk_records){
+   ASSERT( chunk_records > 0, "Unsupported chunk size (=%d records)", chunk_records );
+   clear();
+   file                   = fopen(filename, "wb");
+   ASSERT( file != NULL, "Cannot create trace file %s", filename );
+   writing                = true;
+   this->chunk_records    = chunk_records;
+   vector<unsigned char> header;
+   put_u32(header, TRACE_MAGIC);
+   put_u32(header, fp);
+   put_u32(header, chunk_records);
+   fwrite(&header[0], 1, header.size(), file);
+   file_bytes             = header.size();
+}
+
+void trace::open(const char *filename){
+   clear();
+   file                   = fopen(filename, "rb");
+   ASSERT( file != NULL, "Cannot open trace file %s", filename );
+   unsigned char header[HEADER_BYTES], footer[FOOTER_BYTES];
+   fseek(file, 0, SEEK_END);
+   file_bytes             = ftell(file);
+   ASSERT( file_bytes >= (long)(HEADER_BYTES + FOOTER_BYTES), "Not a trace file: %s", filename );
+   fseek(file, 0, SEEK_SET);
+   ASSERT( fread(header, 1, HEADER_BYTES, file) == HEADER_BYTES && get_u32(header) == TRACE_MAGIC, "Not a trace file: %s", filename );
+   fseek(file, file_bytes - FOOTER_BYTES, SEEK_SET);
+   ASSERT( fread(footer, 1, FOOTER_BYTES, file) == FOOTER_BYTES && get_u32(footer + 24) == TRACE_MAGIC, "Trace file %s is incomplete", filename );
+   fp                     = get_u32(header + 4) & 1;
+   chunk_records          = get_u32(header + 8);
+   total                  = get_u64(footer + 16);
+
+   vector<unsigned char> index(get_u64(footer + 8) * INDEX_BYTES);
+   fseek(file, get_u64(footer), SEEK_SET);
+   ASSERT( index.empty() || fread(&index[0], 1, index.size(), file) == index.size(), "Trace file %s is incomplete", filename );
+   for(size_t i = 0; i < index.size(); i += INDEX_BYTES) {
+      chunk_t chunk       = {(long)get_u64(&index[i]), get_u32(&index[i + 8]), get_u32(&index[i + 12]), get_u64(&index[i + 16])};
+      chunks.push_back(chunk);
+   }
+   if(!chunks.empty()) {
+      load_chunk(0, &records);
+      start_loader();
+   }
+}
+
+//----------------------------------------------------------------------
+// Encode, compress and write the records of the chunk being recorded
+//----------------------------------------------------------------------
+void trace::flush_chunk(){
+   vector<unsigned char> raw, packed;
+   unsigned last_pc       = 0;
+   unsigned last_address  = 0;
+   for(unsigned i = 0; i < records.size(); i++)
+      encode_record(raw, records[i], last_pc, last_address);
+   compress(raw, packed);
+   chunk_t chunk          = {file_bytes, (unsigned)packed.size(), (unsigned)raw.size(), records.size()};
+   fwrite(&packed[0], 1, packed.size(), file);
+   file_bytes            += packed.size();
+   chunks.push_back(chunk);
+   total                 += records.size();
+   first                 += records.size();
+   records.clear();
+}
+
+//----------------------------------------------------------------------
+// Read, decompress and decode chunk "chunk" into "target" (on the
+// loader thread while the current chunk is replayed)
+//----------------------------------------------------------------------
+void trace::load_chunk(uint64_t chunk, vector<trace_record_t> *target){
+   vector<unsigned char> packed(chunks[chunk].bytes), raw;
+   raw.reserve(chunks[chunk].raw_bytes);
+   fseek(file, chunks[chunk].offset, SEEK_SET);
+   ASSERT( fread(&packed[0], 1, packed.size(), file) == packed.size(), "Trace chunk %llu is truncated", (unsigned long long) chunk );
+   decompress(packed, raw);
+   ASSERT( raw.size() == chunks[chunk].raw_bytes, "Corrupted trace chunk %llu", (unsigned long long) chunk );
+   target->resize(chunks[chunk].count);
+   const unsigned char *p = &raw[0];
+   unsigned last_pc       = 0;
+   unsigned last_address  = 0;
+   for(uint64_t i = 0; i < chunks[chunk].count; i++)
+      decode_record(p, (*target)[i], last_pc, last_address);
+}
+
+void trace::start_loader(){
+   if(current + 1 < chunks.size())
+      loader              = thread(&trace::load_chunk, this, current + 1, &ahead);
+}
+
+void trace::stop_loader(){
+   if(loader.joinable())
+      loader.join();
+}
+
+void trace::close(){
+   if(file == NULL)
+      return;
+   stop_loader();
+   if(writing) {
+      if(!records.empty())
+         flush_chunk();
+      vector<unsigned char> index;
+      for(unsigned i = 0; i < chunks.size(); i++) {
+         put_u64(index, chunks[i].offset);
+         put_u32(index, chunks[i].bytes);
+         put_u32(index, chunks[i].raw_bytes);
+         put_u64(index, chunks[i].count);
+      }
+      put_u64(index, file_bytes);
+      put_u64(index, chunks.size());
+      put_u64(index, total);
+      put_u32(index, TRACE_MAGIC);
+      fwrite(&index[0], 1, index.size(), file);
+      file_bytes         += index.size();
+   }
+   fclose(file);
+   file                   = NULL;
+   writing                = false;
+   records.clear();
+   previous.clear();
+   ahead.clear();
+   chunks.clear();
+   first                  = 0;
+   total                  = 0;
+   current                = 0;
+}
+
+void trace::append(const trace_record_t& record){
+   ASSERT( file == NULL || writing, "The trace file is open for replay" );
+   records.push_back(record);
+   if(file != NULL && records.size() == chunk_records)
+      flush_chunk();
+}
+
+uint64_t trace::size(){
+   return (file != NULL) ? total + writing * records.size() : records.size();
+}
+
+const trace_record_t& trace::get(uint64_t index){
+   if(index - first < records.size())
+      return records[index - first];
+   ASSERT( file != NULL && !writing && index < total, "Trace record %llu out of range (%llu records)", (unsigned long long) index, (unsigned long long) size() );
+   if(index - (first - previous.size()) < previous.size())
+      return previous[index - (first - previous.size())];
+
+   // the next chunk is already decoded by the loader, any other one is read now
+   uint64_t chunk         = index / chunk_records;
+   stop_loader();
+   if(chunk == current + 1) {
+      previous.swap(records);
+      records.swap(ahead);
+   } else {
+      load_chunk(chunk, &records);
+      previous.clear();
+   }
+   current                = chunk;
+   first                  = chunk * chunk_records;
+   start_loader();
+   return records[index - first];
+}
+
+void trace::clear(){
+   close();
+   records.clear();
+   first                  = 0;
+   file_bytes             = 0;
+}
+
+long trace::get_file_bytes(){
+   return file_bytes;
+}
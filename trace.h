@@ -0,0 +1,126 @@
+#ifndef TRACE_H_
+#define TRACE_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include <vector>
+#include <thread>
+
+#include "sim_assert.h"
+
+// Dynamic instruction of a trace: the decoded instruction, its outcome, and the operand values its latency
+// depends on
+typedef struct{
+   unsigned             pc;
+   unsigned char        opcode;         // opcode_t of the simulator that recorded the trace
+   unsigned char        dest;
+   unsigned char        src1;
+   unsigned char        src2;
+   unsigned             immediate;
+   bool                 dest_op;
+   bool                 src1_op;
+   bool                 src2_op;
+   bool                 dest_float_op;  // floating point simulator only
+   bool                 src1_float_op;
+   bool                 src2_float_op;
+   bool                 branch_op;
+   bool                 taken;
+   unsigned             address;        // effective address of a load, store or SWAP, target of a branch
+   unsigned             a;              // source operand values of DIV, MULTS and DIVS (floating point simulator)
+   unsigned             b;
+} trace_record_t;
+
+//----------------------------------------------------------------------
+// Dynamic instruction stream of a program, shared by the integer and
+// floating point simulators
+//
+// A simulator records the stream once, running the program without
+// timing; any number of simulators, configured with other latencies or
+// memory options, then replay it through their pipelines instead of
+// the program. The records are only read while replaying, so a trace
+// held in memory can feed several simulators running on different host
+// threads.
+//
+// A trace can also live in a file, written while it is recorded and
+// read back while it is replayed, so neither side holds more than a few
+// chunks of records. A chunk encodes its records in a few bytes each
+// (PCs and addresses as deltas, registers only when used, branch
+// targets implied by the immediate) and is then compressed with a
+// small LZ77 codec; every chunk starts from a clean encoder state, and
+// an index at the end of the file locates them, so any record can be
+// sought. Record counts and indices are 64-bit, so a trace can outgrow
+// the 32-bit range of the simulated clock. The reader keeps the previous and current chunks decoded for
+// the instructions in flight, and decodes the next one on a host thread
+// of its own while the current one is replayed. A trace opened from a
+// file has a reader of its own, so every replaying simulator opens the
+// file in its own trace.
+//----------------------------------------------------------------------
+class trace{
+
+   public:
+
+      // Location of a chunk in the trace file
+      struct chunk_t{
+         long           offset;
+         unsigned       bytes;                    // compressed
+         unsigned       raw_bytes;                // encoded
+         uint64_t       count;                    // records
+      };
+
+      bool              fp;                       // recorded by the floating point simulator
+      std::vector<trace_record_t> records;        // in program order, EOP last (the current chunk of a file)
+      uint64_t          first;                    // index of records[0]
+
+      // Trace file (none when NULL), written or read "chunk_records" records at a time
+      FILE              *file;
+      bool              writing;
+      unsigned          chunk_records;
+      uint64_t          total;
+      std::vector<chunk_t> chunks;
+      long              file_bytes;
+
+      // Streaming reader: the chunk before the current one, and the next one decoded by "loader"
+      uint64_t          current;
+      std::vector<trace_record_t> previous;
+      std::vector<trace_record_t> ahead;
+      std::thread       loader;
+
+   public:
+
+      trace(bool fp=false);
+
+      ~trace();
+
+      //creates the trace file "filename": the records appended from then on are encoded and compressed
+      //"chunk_records" at a time and written to the file
+      void create(const char *filename, unsigned chunk_records=4096);
+
+      //opens the trace file "filename" for replay, replacing the records held
+      void open(const char *filename);
+
+      //writes out the last chunk and the index of a file being created, and closes the file
+      void close();
+
+      //appends the next dynamic instruction
+      void append(const trace_record_t& record);
+
+      //returns the number of records, EOP included
+      uint64_t size();
+
+      //returns the record of the "index"-th dynamic instruction
+      const trace_record_t& get(uint64_t index);
+
+      //removes all the records
+      void clear();
+
+      //returns the size of the trace file, in bytes
+      long get_file_bytes();
+
+      void flush_chunk();
+      void load_chunk(uint64_t chunk, std::vector<trace_record_t> *target);
+      void start_loader();
+      void stop_loader();
+};
+
+#endif /*TRACE_H_*/